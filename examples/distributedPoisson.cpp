@@ -0,0 +1,85 @@
+/** @file distributedPoisson.cpp
+
+    @brief Solves a multipatch Poisson problem by conjugate gradients
+    with a system assembled over several MPI processes.
+
+    Execute (eg. with 4 processes):
+
+    mpirun -np 4 ./bin/distributedPoisson
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+int main(int argc, char* argv[])
+{
+    const gsMpi & mpi = gsMpi::init(argc, argv);
+    gsMpiComm comm = mpi.worldComm();
+
+    index_t numPatches = 4;
+    index_t numRefine  = 3;
+    index_t numElevate = 1;
+
+    gsCmdLine cmd("Solves a Poisson problem assembled on several processes.");
+    cmd.addInt("n","patches", "Number of patches in each direction", numPatches);
+    cmd.addInt("r","uniformRefine", "Number of uniform h-refinement steps", numRefine);
+    cmd.addInt("e","degreeElevation", "Number of degree elevation steps", numElevate);
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    // Geometry, basis and boundary conditions
+    gsMultiPatch<>::uPtr patches(gsNurbsCreator<>::BSplineSquareGrid(numPatches, numPatches, 0.5));
+    gsMultiBasis<> bases(*patches);
+    bases.degreeElevate(numElevate);
+    for (index_t i = 0; i < numRefine; ++i)
+        bases.uniformRefine();
+
+    gsFunctionExpr<> f("((pi*1)^2 + (pi*2)^2)*sin(pi*x*1)*sin(pi*y*2)",2);
+    gsFunctionExpr<> g("sin(pi*x*1)*sin(pi*y*2)",2);
+    gsBoundaryConditions<> bcInfo;
+    for (gsMultiPatch<>::const_biterator bit = patches->bBegin(); bit != patches->bEnd(); ++bit)
+        bcInfo.addCondition( *bit, condition_type::dirichlet, &g );
+
+    gsPoissonAssembler<real_t> assembler(*patches, bases, bcInfo, f);
+
+    // Every process assembles and stores the rows of its own patches
+    gsDistributedSystem<real_t> dist(assembler, comm);
+    dist.assemble();
+    if (0 == comm.rank())
+        gsInfo << "Number of degrees of freedom: " << dist.owners().size()
+               << " on " << comm.size() << " processes\n";
+
+    const real_t tol = 1e-10;
+    gsConjugateGradient cg(dist.matrix());
+    cg.setTolerance(tol);
+    gsMatrix<> solLocal;
+    solLocal.setZero(dist.matrix()->rows(), 1);
+    cg.solve(dist.rhs(), solLocal);
+
+    gsMatrix<> solDist;
+    dist.gatherSolution(solLocal, solDist);
+
+    // Compare with the system assembled by a single process
+    assembler.assemble();
+    gsConjugateGradient cgSerial(assembler.matrix());
+    cgSerial.setTolerance(tol);
+    gsMatrix<> solSerial;
+    solSerial.setZero(assembler.numDofs(), 1);
+    cgSerial.solve(assembler.rhs(), solSerial);
+
+    const real_t diff = (solDist - solSerial).norm() / solSerial.norm();
+    if (0 == comm.rank())
+        gsInfo << "CG (distributed): " << cg.iterations() << " iterations\n"
+               << "CG (serial):      " << cgSerial.iterations() << " iterations\n"
+               << "Relative difference of the solutions: " << diff << "\n";
+
+    return ( diff < 1e-8 && cg.error() <= tol ) ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+/** @file elementCachePoisson.cpp
+
+    @brief Checks that the element cache of gsAssembler
+    ("CacheElements") reproduces the system of the uncached assembly.
+
+    The cached assembler is called repeatedly, after clearCache(),
+    with a quadrature rule of the same number of nodes but different
+    nodes, and after a modification of the geometry; the last two must
+    not reuse the cached data. The combination with the option
+    "Parallel" has to be rejected.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+// Sets the quadrature options and assembles from scratch
+void assemble(gsPoissonAssembler<real_t> & assembler, real_t quA, index_t quB)
+{
+    assembler.options().setReal("quA", quA);
+    assembler.options().setInt ("quB", quB);
+    assembler.system().setZero(); // assemble() adds to the matrix
+    assembler.assemble();
+}
+
+// Maximum difference of the systems of the two assemblers
+real_t difference(const gsPoissonAssembler<real_t> & a, const gsPoissonAssembler<real_t> & b)
+{
+    const gsMatrix<> diff = a.matrix() - b.matrix();
+    return math::max( diff.cwiseAbs().maxCoeff(),
+                      (a.rhs() - b.rhs()).cwiseAbs().maxCoeff() );
+}
+
+int main(int argc, char* argv[])
+{
+    index_t numRefine = 2;
+
+    gsCmdLine cmd("Checks the element cache of gsAssembler.");
+    cmd.addInt("r","uniformRefine", "Number of uniform h-refinement steps", numRefine);
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    // Two patches with degrees 2 and 3, so that the rules with
+    // (quA,quB) = (1,1) and (4,-6) both have 12 nodes
+    gsMultiPatch<>::uPtr patches = safe( gsNurbsCreator<>::BSplineSquareGrid(2, 1, 0.5) );
+    patches->patch(0).coefs()(0,0) -= 0.1; // not affine
+    gsMultiBasis<> bases(*patches);
+    bases.degreeElevate(1);
+    bases.degreeElevate(1, 1);
+    for (index_t i = 0; i < numRefine; ++i)
+        bases.uniformRefine();
+
+    gsFunctionExpr<> f("((pi*1)^2 + (pi*2)^2)*sin(pi*x*1)*sin(pi*y*2)",2);
+    gsFunctionExpr<> g("sin(pi*x*1)*sin(pi*y*2)",2);
+    gsFunctionExpr<> h("x*y",2);
+    gsBoundaryConditions<> bcInfo;
+    bcInfo.addCondition(0, boundary::west,  condition_type::dirichlet, &g);
+    bcInfo.addCondition(1, boundary::east,  condition_type::dirichlet, &g);
+    bcInfo.addCondition(0, boundary::south, condition_type::neumann,   &h);
+    bcInfo.addCondition(1, boundary::north, condition_type::neumann,   &h);
+
+    gsPoissonAssembler<real_t> plain (*patches, bases, bcInfo, f);
+    gsPoissonAssembler<real_t> cached(*patches, bases, bcInfo, f);
+    cached.options().setSwitch("CacheElements", true);
+
+    real_t maxDiff = 0;
+    assemble(plain, 1, 1);
+    for (index_t i = 0; i != 3; ++i)
+    {
+        assemble(cached, 1, 1);
+        maxDiff = math::max(maxDiff, difference(plain, cached));
+    }
+    gsInfo << "Repeated assembly:   difference " << maxDiff
+           << ", cache " << cached.cacheMemoryUsage() << " bytes\n";
+
+    cached.clearCache();
+    assemble(cached, 1, 1);
+    const real_t diffClear = difference(plain, cached);
+    gsInfo << "After clearCache():  difference " << diffClear << "\n";
+    maxDiff = math::max(maxDiff, diffClear);
+
+    // Another rule with the same number of nodes
+    assemble(plain , 4, -6);
+    assemble(cached, 4, -6);
+    const real_t diffRule = difference(plain, cached);
+    gsInfo << "Other rule:          difference " << diffRule << "\n";
+    maxDiff = math::max(maxDiff, diffRule);
+
+    // Modification of the geometry of a PDE which is not owned by
+    // the assembler, without clearCache()
+    gsPoissonPde<> pde(*patches, bcInfo, f);
+    gsPoissonAssembler<real_t> moved(pde, bases);
+    moved.options().setSwitch("CacheElements", true);
+    assemble(moved, 1, 1);
+    pde.patches().patch(0).coefs()(0,1) -= 0.05;
+    assemble(moved, 1, 1);
+    gsPoissonAssembler<real_t> plainMoved(pde.patches(), bases, bcInfo, f);
+    assemble(plainMoved, 1, 1);
+    assemble(plain, 1, 1);
+    const real_t diffMoved = difference(plainMoved, moved);
+    const bool changed = difference(plain, plainMoved) > 1e-6;
+    gsInfo << "Modified geometry:   difference " << diffMoved
+           << (changed ? "" : ", geometry NOT CHANGED") << "\n";
+    maxDiff = math::max(maxDiff, changed ? diffMoved : 1);
+
+    bool rejected = false;
+    cached.options().setSwitch("Parallel", true);
+    try { assemble(cached, 1, 1); }
+    catch (std::exception &) { rejected = true; }
+    gsInfo << "Parallel and cache:  " << (rejected ? "rejected" : "NOT REJECTED") << "\n";
+
+    return maxDiff < 1e-13 && rejected ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+/** @file fittingAssembly.cpp
+
+    @brief Checks the least-squares system of gsFitting on a THB-spline
+    basis against a point-by-point assembly.
+
+    The system is assembled with one and with all OpenMP threads, the
+    results have to be identical. The basis is then refined and the
+    points are sorted again by the refined elements. Finally a basis
+    which cannot locate the elements of the points is used.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+// A tensor basis without gsBasis::elementIndex()
+class noElementsBasis : public gsTensorBSplineBasis<2>
+{
+public:
+    explicit noElementsBasis(const gsKnotVector<> & kv)
+    : gsTensorBSplineBasis<2>(kv, kv) { }
+
+    int elementIndex(const gsVector<> &) const { GISMO_NO_IMPLEMENTATION }
+};
+
+// Assembles the normal equations point by point
+void assembleReference(const gsBasis<> & basis, const gsMatrix<> & params,
+                       const gsMatrix<> & points, gsSparseMatrix<> & A, gsMatrix<> & B)
+{
+    A.resize(basis.size(), basis.size());
+    B.setZero(basis.size(), points.rows());
+    gsMatrix<> val;
+    gsMatrix<unsigned> act;
+    for (index_t k = 0; k != params.cols(); ++k)
+    {
+        basis.eval_into  (params.col(k), val);
+        basis.active_into(params.col(k), act);
+        for (index_t i = 0; i != act.rows(); ++i)
+        {
+            B.row(act(i,0)) += val(i,0) * points.col(k).transpose();
+            for (index_t j = 0; j != act.rows(); ++j)
+                A.coeffRef(act(i,0), act(j,0)) += val(i,0) * val(j,0);
+        }
+    }
+}
+
+// Relative difference of the system assembled by gsFitting to the
+// reference system
+real_t compare(gsFitting<> & fit, const gsMatrix<> & params, const gsMatrix<> & points,
+               gsSparseMatrix<> & A, gsMatrix<> & B)
+{
+    const gsBasis<> & basis = fit.getBasis();
+    gsSparseMatrix<> Aref;
+    gsMatrix<> Bref;
+    assembleReference(basis, params, points, Aref, Bref);
+
+    A.resize(basis.size(), basis.size());
+    B.setZero(basis.size(), points.rows());
+    fit.assembleSystem(A, B);
+
+    const real_t errA = gsMatrix<>(A - Aref).norm() / Aref.norm();
+    const real_t errB = (B - Bref).norm() / Bref.norm();
+    gsInfo << "Basis size " << basis.size() << ": relative difference of the matrix "
+           << errA << ", of the right-hand side " << errB << "\n";
+    return math::max(errA, errB);
+}
+
+int main(int argc, char* argv[])
+{
+    index_t numPoints = 20000;
+
+    gsCmdLine cmd("Checks the least-squares system of gsFitting on a THB-spline basis.");
+    cmd.addInt("n","points", "Number of sample points", numPoints);
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    gsKnotVector<> kv(0, 1, 7, 3);
+    gsTensorBSplineBasis<2> tens(kv, kv);
+    gsTHBSplineBasis<2> thb(tens);
+    gsMatrix<> box(2,2);
+    box << 0, 0.5, 0.25, 0.75;
+    thb.refine(box);
+
+    // Random parameters, some of them on the boundary, and a smooth
+    // surface through them
+    gsMatrix<> params = gsMatrix<>::Random(2, numPoints);
+    params.array() = (params.array() + 1) / 2;
+    params.row(0).head(numPoints / 100).setOnes();
+    gsMatrix<> points(3, numPoints);
+    points.row(0) = params.row(0);
+    points.row(1) = params.row(1);
+    points.row(2) = (params.row(0).array() * 3).sin() * params.row(1).array().exp();
+
+    gsFitting<> fit(params, points, thb);
+
+    bool passed = true;
+    gsSparseMatrix<> A, A1;
+    gsMatrix<> B, B1;
+    passed &= compare(fit, params, points, A, B) < 1e-12;
+
+    // The result does not depend on the number of threads
+    const int numThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    A1.resize(thb.size(), thb.size());
+    B1.setZero(thb.size(), 3);
+    fit.assembleSystem(A1, B1);
+    omp_set_num_threads(numThreads);
+    const bool same = ( 0 == gsMatrix<>(A - A1).cwiseAbs().maxCoeff() &&
+                        0 == (B - B1).cwiseAbs().maxCoeff() );
+    gsInfo << "Identical with 1 and " << numThreads << " threads: "
+           << (same ? "yes" : "no") << "\n";
+    passed &= same;
+
+    // Refine and sort the points by the new elements
+    box << 0.5, 1, 0, 0.5;
+    thb.refine(box);
+    thb.refine(box / 2);
+    fit.binPoints();
+    passed &= compare(fit, params, points, A, B) < 1e-12;
+
+    // The points are not sorted by elements, the system is the same
+    noElementsBasis plain(kv);
+    gsFitting<> fit2(params, points, plain);
+    passed &= compare(fit2, params, points, A, B) < 1e-12;
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+/** @file gridEvaluation.cpp
+
+    @brief Checks the evaluation on tensor grids
+    (gsFunction::evalOnGrid_into, gsBasis::evalFuncOnGrid_into)
+    against eval_into() on the expanded grid points.
+
+    Tensor-product B-spline and NURBS geometries in 2D and 3D are
+    evaluated through the univariate collocation matrices, other
+    functions (a truncated hierarchical basis, a function given by an
+    expression) by the default implementation. The grids have
+    different numbers of random coordinates per direction, including
+    the ends of the parameter domain.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <algorithm>
+#include <gismo.h>
+
+using namespace gismo;
+
+// Sorted random coordinates in [0,1] per direction, with the ends
+std::vector< gsVector<> > randomGrid(int d)
+{
+    std::vector< gsVector<> > result(d);
+    for (int i = 0; i != d; ++i)
+    {
+        result[i] = gsVector<>::Random(5 + 3 * i);
+        result[i].array() = (result[i].array() + 1) / 2;
+        result[i][0] = 0;
+        result[i][1] = 1;
+        std::sort(result[i].data(), result[i].data() + result[i].size());
+    }
+    return result;
+}
+
+// Compares the grid evaluation of func with eval_into at the points
+bool check(const gsFunction<> & func, const std::string & name)
+{
+    const std::vector< gsVector<> > cwise = randomGrid(func.domainDim());
+    const gsMatrix<> u = gsPointGrid<real_t>(cwise);
+
+    gsMatrix<> grid, ref;
+    func.evalOnGrid_into(cwise, grid);
+    func.eval_into(u, ref);
+
+    const bool sameSize = grid.rows() == ref.rows() && grid.cols() == ref.cols();
+    const real_t err = sameSize ? (grid - ref).cwiseAbs().maxCoeff() : 1;
+    const bool passed = err < 1e-12;
+    gsInfo << name << ", " << u.cols() << " points: " << err << ": "
+           << (passed ? "passed" : "FAILED") << "\n";
+    return passed;
+}
+
+// Compares gsBasis::evalFuncOnGrid_into with evalFunc_into
+bool checkBasis(const gsBasis<> & basis, index_t tdim, const std::string & name)
+{
+    const gsMatrix<> coefs = gsMatrix<>::Random(basis.size(), tdim);
+    const std::vector< gsVector<> > cwise = randomGrid(basis.dim());
+    const gsMatrix<> u = gsPointGrid<real_t>(cwise);
+
+    gsMatrix<> grid, ref;
+    basis.evalFuncOnGrid_into(cwise, coefs, grid);
+    basis.evalFunc_into(u, coefs, ref);
+
+    const bool sameSize = grid.rows() == ref.rows() && grid.cols() == ref.cols();
+    const real_t err = sameSize ? (grid - ref).cwiseAbs().maxCoeff() : 1;
+    const bool passed = err < 1e-12;
+    gsInfo << name << ", " << u.cols() << " points: " << err << ": "
+           << (passed ? "passed" : "FAILED") << "\n";
+    return passed;
+}
+
+int main(int argc, char* argv[])
+{
+    gsCmdLine cmd("Checks the evaluation on tensor grids.");
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    gsKnotVector<> kv1(0, 1, 3, 4), kv2(0, 1, 2, 3), kv3(0, 1, 4, 2);
+    kv1.insert(0.3, 2);
+    gsTensorBSplineBasis<2> b2(kv1, kv2);
+    gsTensorBSplineBasis<3> b3(kv1, kv2, kv3);
+
+    // Positive weights between 1/2 and 3/2
+    gsMatrix<> w2 = gsMatrix<>::Random(b2.size(), 1), w3 = gsMatrix<>::Random(b3.size(), 1);
+    w2.array() = w2.array() / 2 + 1;
+    w3.array() = w3.array() / 2 + 1;
+
+    const gsTensorBSpline<2> spline2(b2, gsMatrix<>::Random(b2.size(), 3));
+    const gsTensorBSpline<3> spline3(b3, gsMatrix<>::Random(b3.size(), 3));
+    const gsTensorNurbs<2> nurbs2(gsTensorNurbsBasis<2>(b2.clone(), w2),
+                                  gsMatrix<>::Random(b2.size(), 3));
+    const gsTensorNurbs<3> nurbs3(gsTensorNurbsBasis<3>(b3.clone(), w3),
+                                  gsMatrix<>::Random(b3.size(), 2));
+
+    bool passed = check(spline2, "B-spline surface   ");
+    passed &= check(spline3, "B-spline volume    ");
+    passed &= check(nurbs2 , "NURBS surface      ");
+    passed &= check(nurbs3 , "NURBS volume       ");
+    passed &= checkBasis(b3, 1, "B-spline basis     ");
+    passed &= checkBasis(gsTensorNurbsBasis<2>(b2.clone(), w2), 2, "NURBS basis        ");
+
+    // Default implementations
+    gsTHBSplineBasis<2> thb(b2);
+    std::vector<unsigned> box(5);
+    box[0] = 1; box[1] = 0; box[2] = 0; box[3] = 4; box[4] = 2;
+    thb.refineElements(box);
+    passed &= checkBasis(thb, 2, "THB-spline basis   ");
+    passed &= check(gsFunctionExpr<>("x*y^2", "sin(x+y)", 2), "Expression         ");
+
+    return passed ? 0 : 1;
+}
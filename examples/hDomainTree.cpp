@@ -0,0 +1,139 @@
+/** @file hDomainTree.cpp
+
+    @brief Checks copying, compressing and refining the kd-tree of
+    hierarchical meshes (gsHDomain).
+
+    A tree is refined and compressed (which moves all nodes in their
+    pool), copied with the copy constructor and the assignment, and
+    the copies are refined and compressed again independently. After
+    every step the level of every cell is compared with a tree built
+    from scratch by inserting the same boxes, and the leaves are
+    counted with a leaf iterator.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+typedef gsHDomain<2> tree2;
+typedef tree2::point point2;
+
+// Finest level used for the comparison
+const int maxLvl = 4;
+
+// A box given by its corners on level maxLvl (multiples of
+// 2^maxLvl, ie. aligned on every level) and its level
+struct levelBox
+{
+    levelBox(unsigned l0, unsigned l1, unsigned u0, unsigned u1, int lvl_)
+    : lvl(lvl_) { low << l0, l1; upp << u0, u1; }
+    point2 low, upp;
+    int lvl;
+};
+
+void insert(tree2 & tree, const levelBox & b)
+{
+    const point2 low = b.low / (1u << (maxLvl - b.lvl)),
+                 upp = b.upp / (1u << (maxLvl - b.lvl));
+    tree.insertBox(low, upp, b.lvl);
+}
+
+// Compares tree with a tree built from the boxes
+bool check(const tree2 & tree, const std::vector<levelBox> & boxes, const std::string & name)
+{
+    const point2 upp0 = tree.upperCorner() / (1u << tree.getIndexLevel());
+    tree2 ref(upp0);
+    for (size_t i = 0; i != boxes.size(); ++i)
+        insert(ref, boxes[i]);
+
+    // The level of every cell on level maxLvl
+    const unsigned n0 = upp0[0] << maxLvl, n1 = upp0[1] << maxLvl;
+    point2 low, upp;
+    index_t numWrong = 0;
+    for (unsigned i = 0; i != n0; ++i)
+        for (unsigned j = 0; j != n1; ++j)
+        {
+            low << i, j;
+            upp << i + 1, j + 1;
+            if ( tree.query3(low, upp, maxLvl) != ref.query3(low, upp, maxLvl) )
+                ++numWrong;
+        }
+
+    // The leaf iterator reaches every leaf of the tree
+    int numLeaves = 0;
+    for (tree2::const_literator it = tree.beginLeafIterator(); it.good(); it.next())
+        ++numLeaves;
+
+    const bool passed = ( 0 == numWrong && numLeaves == tree.leafSize() );
+    gsInfo << name << ": " << tree.leafSize() << " leaves, " << tree.size()
+           << " nodes: " << (passed ? "passed" : "FAILED") << "\n";
+    return passed;
+}
+
+int main(int argc, char* argv[])
+{
+    gsCmdLine cmd("Checks copying, compressing and refining hierarchical meshes.");
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    point2 upp0;
+    upp0 << 8, 8;
+    tree2 tree(upp0);
+    std::vector<levelBox> boxes;
+    boxes.push_back(levelBox(  0,  0,  64, 64, 1));
+    boxes.push_back(levelBox( 16, 16,  48, 80, 2));
+    boxes.push_back(levelBox( 32,  0, 128, 32, 1));
+    for (size_t i = 0; i != boxes.size(); ++i)
+        insert(tree, boxes[i]);
+    bool passed = check(tree, boxes, "Refined            ");
+    tree.makeCompressed();
+    passed &= check(tree, boxes, "Compressed         ");
+
+    // Copies of the compressed tree
+    tree2 copy(tree), assigned;
+    assigned = tree;
+    passed &= check(copy    , boxes, "Copied             ");
+    passed &= check(assigned, boxes, "Assigned           ");
+
+    // Refine the trees independently
+    std::vector<levelBox> boxesTree(boxes), boxesCopy(boxes), boxesAssigned(boxes);
+    boxesTree    .push_back(levelBox( 16, 16,  32,  32, 3));
+    boxesCopy    .push_back(levelBox( 48, 48, 112, 112, 2));
+    boxesAssigned.push_back(levelBox(  0, 96,  16, 112, 4));
+    insert(tree    , boxesTree    .back());
+    insert(copy    , boxesCopy    .back());
+    insert(assigned, boxesAssigned.back());
+    passed &= check(tree    , boxesTree    , "Original refined   ");
+    passed &= check(copy    , boxesCopy    , "Copy refined       ");
+    passed &= check(assigned, boxesAssigned, "Assigned refined   ");
+
+    // Compress again, then copy and refine a copy of the copy
+    tree    .makeCompressed();
+    copy    .makeCompressed();
+    assigned.makeCompressed();
+    passed &= check(tree    , boxesTree    , "Original compressed");
+    passed &= check(copy    , boxesCopy    , "Copy compressed    ");
+    passed &= check(assigned, boxesAssigned, "Assigned compressed");
+
+    // The second box makes many siblings equal, which are merged
+    tree2 second(copy);
+    const size_t numBoxes = boxesCopy.size();
+    boxesCopy.push_back(levelBox( 64, 0,  80,  16, 4));
+    boxesCopy.push_back(levelBox(  0, 0, 128, 128, 2));
+    insert(second, boxesCopy[numBoxes]);
+    insert(second, boxesCopy[numBoxes+1]);
+    passed &= check(second, boxesCopy, "Second copy        ");
+    second.makeCompressed();
+    passed &= check(second, boxesCopy, "Second compressed  ");
+    boxesCopy.erase(boxesCopy.begin() + numBoxes, boxesCopy.end());
+    passed &= check(copy  , boxesCopy, "Copy unchanged     ");
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+/** @file hierarchicalActives.cpp
+
+    @brief Checks the table of the active functions per element of
+    hierarchical bases against a level-by-level computation.
+
+    After every refinement the active functions returned by
+    active_into() and by the domain iterator are compared with the
+    active functions of all tensor-product levels which are present in
+    the hierarchical basis. The queries are done from several threads.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+// The active functions at the point u, level by level
+template<unsigned d>
+void levelActives(const gsHTensorBasis<d> & basis, const gsMatrix<> & u,
+                  std::vector<unsigned> & result)
+{
+    result.clear();
+    gsMatrix<unsigned> act;
+    for (unsigned lvl = 0; lvl <= basis.maxLevel(); ++lvl)
+    {
+        basis.tensorLevel(lvl).active_into(u, act);
+        for (index_t i = 0; i != act.rows(); ++i)
+        {
+            const int k = basis.flatTensorIndexToHierachicalIndex(act(i,0), lvl);
+            if ( -1 != k )
+                result.push_back(k);
+        }
+    }
+    std::sort(result.begin(), result.end());
+}
+
+// Number of points and elements where the table differs from
+// levelActives()
+template<unsigned d>
+index_t check(const gsHTensorBasis<d> & basis, const gsMatrix<> & points)
+{
+    index_t numWrong = 0;
+
+#   pragma omp parallel
+    {
+        gsMatrix<unsigned> act;
+        std::vector<unsigned> ref, cur;
+
+#       pragma omp for reduction(+:numWrong)
+        for (index_t k = 0; k < points.cols(); ++k)
+        {
+            basis.active_into(points.col(k), act);
+            cur.assign(act.data(), act.data() + act.rows());
+            std::sort(cur.begin(), cur.end());
+            levelActives(basis, points.col(k), ref);
+            if ( cur != ref )
+                ++numWrong;
+        }
+    }
+
+    std::vector<unsigned> ref, cur;
+    gsMatrix<unsigned> act;
+    typename gsBasis<>::domainIter domIt = basis.makeDomainIterator();
+    for (; domIt->good(); domIt->next())
+    {
+        act = domIt->computeActiveFunctions();
+        cur.assign(act.data(), act.data() + act.rows());
+        std::sort(cur.begin(), cur.end());
+        levelActives(basis, domIt->centerPoint(), ref);
+        if ( cur != ref )
+            ++numWrong;
+    }
+
+    return numWrong;
+}
+
+template<unsigned d>
+bool run(gsHTensorBasis<d> & basis)
+{
+    // Points inside the elements, away from the mesh lines
+    gsMatrix<> points = gsMatrix<>::Random(d, 5000);
+    points.array() = (points.array() + 1) / 2;
+
+    gsMatrix<> box(d, 2);
+    bool passed = true;
+    for (index_t r = 0; r != 4; ++r)
+    {
+        // Overlapping boxes
+        box.col(0).setConstant( 0.1 + 0.15 * r );
+        box.col(1) = box.col(0).array() + 0.6 - 0.1 * r;
+        basis.refine(box);
+
+        const index_t numWrong = check(basis, points);
+        gsInfo << basis.dim() << "D, " << basis.maxLevel() << " levels, "
+               << basis.size() << " functions: "
+               << (numWrong ? "FAILED" : "passed") << "\n";
+        passed &= ( 0 == numWrong );
+    }
+
+    // The table is copied along with the basis
+    gsHTensorBasis<d> * copy = basis.clone();
+    passed &= ( 0 == check(*copy, points) );
+    delete copy;
+    return passed;
+}
+
+int main(int argc, char* argv[])
+{
+    gsCmdLine cmd("Checks the active functions per element of hierarchical bases.");
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    gsKnotVector<> kv(0, 1, 3, 3);
+    gsTensorBSplineBasis<2> tens2(kv, kv);
+    gsTensorBSplineBasis<3> tens3(kv, kv, kv);
+
+    gsTHBSplineBasis<2> thb2(tens2);
+    gsHBSplineBasis<2>  hb2 (tens2);
+    gsTHBSplineBasis<3> thb3(tens3);
+
+    bool passed = run(thb2);
+    passed &= run(hb2);
+    passed &= run(thb3);
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,233 @@
+/** @file hierarchicalBoxes.cpp
+
+    @brief Checks the refinement of hierarchical bases by many boxes
+    at once against bases built from scratch.
+
+    refineElements() inserts all its boxes in one traversal of the tree
+    (gsHDomain::insertBoxes(), which merges adjacent boxes), and then
+    updates the active functions, the table of the active functions
+    per element and the truncations only around the modified cells.
+    Each refinement gets many boxes of several levels, adjacent and
+    overlapping ones, and boxes which are refined already. After every
+    refinement the mesh, the active functions, the active functions of
+    the elements and the truncations have to be identical to the ones
+    of a basis constructed from all boxes inserted so far, one by one.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <map>
+#include <gismo.h>
+
+using namespace gismo;
+
+// Returns true if every leaf of a has the same level in b
+template<unsigned d>
+bool sameMesh(const gsHDomain<d> & a, const gsHDomain<d> & b)
+{
+    gsMatrix<unsigned> b1, b2;
+    gsVector<unsigned> level;
+    a.getBoxesInLevelIndex(b1, b2, level);
+    gsVector<unsigned,d> lower, upper;
+    for (index_t i = 0; i != b1.rows(); ++i)
+    {
+        lower = b1.row(i).transpose();
+        upper = b2.row(i).transpose();
+        if ( b.query3(lower, upper, level[i]) != static_cast<int>(level[i]) ||
+             b.query4(lower, upper, level[i]) != static_cast<int>(level[i]) )
+            return false;
+    }
+    return true;
+}
+
+// The active functions of every element, by level and lower corner
+template<unsigned d>
+std::map<std::vector<real_t>, std::vector<unsigned> >
+elementActives(const gsHTensorBasis<d> & basis)
+{
+    std::map<std::vector<real_t>, std::vector<unsigned> > result;
+    typename gsBasis<>::domainIter domIt = basis.makeDomainIterator();
+    gsMatrix<unsigned> act;
+    for (; domIt->good(); domIt->next())
+    {
+        const gsVector<> & low = domIt->lowerCorner();
+        std::vector<real_t> key(low.data(), low.data() + d);
+        key.push_back( domIt->upperCorner()[0] - low[0] );
+        act = domIt->computeActiveFunctions();
+        result[key].assign(act.data(), act.data() + act.rows());
+    }
+    return result;
+}
+
+// Compares the basis refined by refineElements() with the one built
+// from scratch
+template<unsigned d>
+bool sameAsFresh(const gsHTensorBasis<d> & basis, const gsHTensorBasis<d> & fresh)
+{
+    if ( basis.size() != fresh.size() || basis.maxLevel() != fresh.maxLevel() ||
+         ! sameMesh(basis.tree(), fresh.tree()) || ! sameMesh(fresh.tree(), basis.tree()) )
+        return false;
+
+    // The active functions of all levels (update_activ1)
+    for (unsigned i = 0; i != basis.size(); ++i)
+        if ( basis.levelOf(i) != fresh.levelOf(i) ||
+             basis.flatTensorIndexOf(i) != fresh.flatTensorIndexOf(i) )
+            return false;
+
+    // The active functions per element, and at some points
+    if ( elementActives(basis) != elementActives(fresh) )
+        return false;
+    gsMatrix<> u = gsMatrix<>::Random(d, 200);
+    u.array() = (u.array() + 1) / 2;
+    gsMatrix<unsigned> act, actFresh;
+    basis.active_into(u, act);
+    fresh.active_into(u, actFresh);
+    return act == actFresh;
+}
+
+// Compares the truncations of the bases
+template<unsigned d>
+bool sameTruncations(const gsTHBSplineBasis<d> & basis, const gsTHBSplineBasis<d> & fresh)
+{
+    if ( basis.numTruncated() != fresh.numTruncated() )
+        return false;
+    for (unsigned i = 0; i != basis.size(); ++i)
+    {
+        if ( basis.isTruncated(i) != fresh.isTruncated(i) )
+            return false;
+        if ( ! basis.isTruncated(i) )
+            continue;
+        const typename gsTHBSplineBasis<d>::CoefsView
+            coefs = basis.getCoefs(i), coefsFresh = fresh.getCoefs(i);
+        if ( coefs.rows() != coefsFresh.rows() ||
+             coefs.nonZeros() != coefsFresh.nonZeros() )
+            return false;
+        typename gsTHBSplineBasis<d>::CoefsView::InnerIterator c(coefs, 0), cf(coefsFresh, 0);
+        for (; c; ++c, ++cf)
+            if ( c.index() != cf.index() || c.value() != cf.value() )
+                return false;
+    }
+    return true;
+}
+
+// Appends the box of level lvl with corners low and low + size, cut
+// to the n cells per direction of the level
+template<unsigned d>
+void appendBox(unsigned lvl, const unsigned * low, const unsigned * size,
+               unsigned n, std::vector<unsigned> & boxes)
+{
+    boxes.push_back(lvl);
+    for (unsigned k = 0; k != d; ++k)
+        boxes.push_back( math::min(low[k], n - 1) );
+    for (unsigned k = 0; k != d; ++k)
+        boxes.push_back( math::min(low[k] + size[k], n) );
+}
+
+// The boxes of the refinement step r, on a mesh with n0 elements per
+// direction on level 0
+template<unsigned d>
+void refinementBoxes(index_t r, unsigned n0, std::vector<unsigned> & boxes)
+{
+    boxes.clear();
+    unsigned low[d], size[d];
+    const unsigned lvl = r + 1;
+    const unsigned n   = n0 << lvl;
+
+    // A row of adjacent boxes, which are merged
+    for (unsigned i = 0; i != n / 4; ++i)
+    {
+        for (unsigned k = 0; k != d; ++k)
+        {
+            low [k] = n / 4;
+            size[k] = 2;
+        }
+        low [0] = 2 * i;
+        appendBox<d>(lvl, low, size, n, boxes);
+    }
+
+    // Overlapping boxes of this level and of a finer one, some of
+    // them are refined already
+    unsigned seed = 17 * r + 5;
+    for (unsigned i = 0; i != 20; ++i)
+    {
+        const unsigned l  = lvl + i % 2;
+        const unsigned nl = n0 << l;
+        for (unsigned k = 0; k != d; ++k)
+        {
+            seed = (1103515245u * seed + 12345u) % 2147483648u;
+            low [k] = (seed >> 8) % nl;
+            size[k] = 1 + (seed >> 20) % (nl / 4);
+        }
+        appendBox<d>(l, low, size, nl, boxes);
+    }
+
+    // A box inside the first box of the row
+    for (unsigned k = 0; k != d; ++k)
+    {
+        low [k] = n / 4;
+        size[k] = 1;
+    }
+    appendBox<d>(lvl, low, size, n, boxes);
+}
+
+template<unsigned d>
+bool run(gsHTensorBasis<d> & basis, const std::string & name)
+{
+    const unsigned n0 = basis.tensorLevel(0).knots(0).numElements();
+    std::vector<unsigned> boxes, all;
+    bool passed = true;
+    for (index_t r = 0; r != 3; ++r)
+    {
+        refinementBoxes<d>(r, n0, boxes);
+        basis.refineElements(boxes);
+        all.insert(all.end(), boxes.begin(), boxes.end());
+
+        gsHTensorBasis<d> * fresh = NULL;
+        bool same;
+        if ( gsTHBSplineBasis<d> * thb = dynamic_cast<gsTHBSplineBasis<d>*>(&basis) )
+        {
+            gsTHBSplineBasis<d> * freshThb = new gsTHBSplineBasis<d>(basis.tensorLevel(0), all);
+            same = sameTruncations(*thb, *freshThb);
+            fresh = freshThb;
+        }
+        else
+        {
+            fresh = new gsHBSplineBasis<d>(basis.tensorLevel(0), all);
+            same = true;
+        }
+        same &= sameAsFresh(basis, *fresh);
+        delete fresh;
+
+        gsInfo << name << ", " << boxes.size() / (2 * d + 1) << " boxes, "
+               << basis.maxLevel() << " levels, " << basis.size() << " functions: "
+               << (same ? "passed" : "FAILED") << "\n";
+        passed &= same;
+    }
+    return passed;
+}
+
+int main(int argc, char* argv[])
+{
+    gsCmdLine cmd("Checks the refinement of hierarchical bases by many boxes.");
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    gsKnotVector<> kv(0, 1, 7, 3), kv3(0, 1, 3, 3);
+    gsTensorBSplineBasis<2> tens2(kv, kv);
+    gsTensorBSplineBasis<3> tens3(kv3, kv3, kv3);
+
+    gsTHBSplineBasis<2> thb2(tens2);
+    gsHBSplineBasis<2>  hb2 (tens2);
+    gsTHBSplineBasis<3> thb3(tens3);
+
+    bool passed = run(thb2, "THB 2D");
+    passed &= run(hb2 , "HB 2D ");
+    passed &= run(thb3, "THB 3D");
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+/** @file invertPoints.cpp
+
+    @brief Checks the point inversion of gsGeometry::invertPoints() and
+    of gsPointLocator.
+
+    Random parameters of a curved surface are mapped and inverted
+    again. The locator of invertPoints() is reused by the following
+    calls and built again after the coefficients have changed. Points
+    with non-finite coordinates are reported as not located.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+// Maximum difference of the inverted points to the parameters u
+real_t inversionError(gsGeometry<> & geo, const gsMatrix<> & u, double & time)
+{
+    const gsMatrix<> pts = geo.eval(u);
+    gsMatrix<> res;
+    gsStopwatch clock;
+    geo.invertPoints(pts, res, 1e-10);
+    time = clock.stop();
+    return (res - u).cwiseAbs().maxCoeff();
+}
+
+int main(int argc, char* argv[])
+{
+    index_t numRefine = 4;
+    index_t numPoints = 1000;
+
+    gsCmdLine cmd("Checks the point inversion of geometries.");
+    cmd.addInt("r","uniformRefine", "Number of uniform h-refinement steps", numRefine);
+    cmd.addInt("n","points", "Number of points", numPoints);
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    // A quarter annulus
+    gsGeometry<>::uPtr geo( gsNurbsCreator<>::NurbsQuarterAnnulus() );
+    for (index_t i = 0; i < numRefine; ++i)
+        geo->uniformRefine();
+
+    gsMatrix<> u = gsMatrix<>::Random(2, numPoints);
+    u.array() = (u.array() + 1) / 2;
+
+    bool passed = true;
+    double timeFirst, timeSecond, timeChanged;
+    const real_t errFirst  = inversionError(*geo, u, timeFirst );
+    const real_t errSecond = inversionError(*geo, u, timeSecond);
+    gsInfo << "First call:          error " << errFirst  << ", time " << timeFirst  << " s\n"
+           << "Second call:         error " << errSecond << ", time " << timeSecond << " s\n";
+    passed &= errFirst < 1e-8 && errSecond < 1e-8;
+
+    // Changing the coefficients invalidates the locator
+    geo->coefs().col(0) *= 2;
+    geo->coefs().col(1).array() += 1;
+    const real_t errChanged = inversionError(*geo, u, timeChanged);
+    gsInfo << "New coefficients:    error " << errChanged << ", time " << timeChanged << " s\n";
+    passed &= errChanged < 1e-8;
+
+    // A copy inverts with its own locator
+    gsGeometry<>::uPtr copy( geo->clone() );
+    copy->coefs().col(1).array() -= 1;
+    const real_t errCopy = inversionError(*copy, u, timeChanged);
+    const real_t errOrig = inversionError(*geo , u, timeChanged);
+    gsInfo << "Copy:                error " << errCopy << ", original " << errOrig << "\n";
+    passed &= errCopy < 1e-8 && errOrig < 1e-8;
+
+    // Non-finite points
+    gsMatrix<> pts = geo->eval(u.leftCols(3));
+    pts(0,0) = std::numeric_limits<real_t>::quiet_NaN();
+    pts(1,1) = std::numeric_limits<real_t>::infinity();
+    gsPointLocator<> loc(*geo);
+    gsVector<index_t> patches;
+    gsMatrix<> params;
+    gsVector<> dist;
+    loc.locate(pts, patches, params, dist);
+    const bool nonFinite =
+        -1 == patches[0] && -1 == patches[1] && 0 == patches[2] &&
+        (math::isnan)(params(0,0)) && (math::isnan)(params(0,1)) &&
+        !(math::isfinite)(dist[0]) && !(math::isfinite)(dist[1]) &&
+        dist[2] < 1e-6;
+    gsInfo << "Non-finite points:   " << (nonFinite ? "passed" : "FAILED") << "\n";
+    passed &= nonFinite;
+
+    return passed ? 0 : 1;
+}
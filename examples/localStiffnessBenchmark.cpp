@@ -0,0 +1,106 @@
+/** @file localStiffnessBenchmark.cpp
+
+    @brief Times the computation of the local stiffness matrices of a
+    trivariate patch: the per-node products against the single rank
+    update used by gsVisitorPoisson and gsVisitorGradGrad.
+
+    Only the local-matrix part is timed. The basis and the geometry
+    are evaluated once per element beforehand.
+
+    The visitors work on one element at a time, with the sizes of the
+    element known at run time only. There is no batching of several
+    elements and no kernel specialised per degree, so the gain is
+    bounded by the dense product: about 2x for degrees 2 and 3.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+int main(int argc, char* argv[])
+{
+    index_t degree    = 3;
+    index_t numRefine = 2;
+    index_t numRepeat = 20;
+
+    gsCmdLine cmd("Times the local stiffness matrices of a trivariate patch.");
+    cmd.addInt("p","degree", "Polynomial degree", degree);
+    cmd.addInt("r","uniformRefine", "Number of uniform h-refinement steps", numRefine);
+    cmd.addInt("n","repeat", "Number of repetitions per element", numRepeat);
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    // A distorted cube, so that the Jacobians are not constant
+    gsTensorBSpline<3,real_t>::uPtr geo = gsNurbsCreator<>::BSplineCube(1);
+    geo->coefs().row(7) *= 1.5;
+    geo->degreeElevate(degree - 1);
+    for (index_t i = 0; i < numRefine; ++i)
+        geo->uniformRefine();
+    const gsBasis<> & basis = geo->basis();
+
+    gsOptionList opt = gsAssembler<>::defaultOptions();
+    gsGaussRule<real_t> rule(basis, opt.getReal("quA"), opt.getInt("quB"));
+    typename gsGeometry<>::Evaluator geoEval(
+        geo->evaluator(NEED_MEASURE | NEED_GRAD_TRANSFORM) );
+
+    gsMatrix<> quNodes, bGrads, physGrad, matNode, matRank;
+    gsVector<> quWeights, weights;
+    double timeNode = 0, timeRank = 0, maxDiff = 0;
+    index_t numElements = 0;
+    gsStopwatch time;
+
+    typename gsBasis<>::domainIter domIt = basis.makeDomainIterator();
+    for (; domIt->good(); domIt->next(), ++numElements)
+    {
+        rule.mapTo(domIt->lowerCorner(), domIt->upperCorner(), quNodes, quWeights);
+        basis.deriv_into(quNodes, bGrads);
+        geoEval->evaluateAt(quNodes);
+        const index_t numActive = bGrads.rows() / 3;
+
+        // One product per quadrature node
+        time.restart();
+        for (index_t r = 0; r < numRepeat; ++r)
+        {
+            matNode.setZero(numActive, numActive);
+            for (index_t k = 0; k < quWeights.rows(); ++k)
+            {
+                const real_t weight = quWeights[k] * geoEval->measure(k);
+                geoEval->transformGradients(k, bGrads, physGrad);
+                matNode.noalias() += weight * (physGrad.transpose() * physGrad);
+            }
+        }
+        timeNode += time.stop();
+
+        // All nodes at once, one symmetric rank update
+        time.restart();
+        for (index_t r = 0; r < numRepeat; ++r)
+        {
+            matRank.setZero(numActive, numActive);
+            weights.noalias() = quWeights.cwiseProduct( geoEval->measures() );
+            geoEval->transformAllGradients(bGrads, physGrad);
+            for (index_t k = 0; k < quWeights.rows(); ++k)
+                physGrad.middleRows(k*3, 3) *= math::sqrt(weights[k]);
+            matRank.selfadjointView<Lower>().rankUpdate(physGrad.transpose());
+            matRank.triangularView<StrictlyUpper>() = matRank.transpose();
+        }
+        timeRank += time.stop();
+
+        maxDiff = math::max(maxDiff, (matNode - matRank).norm() / matNode.norm());
+    }
+
+    gsInfo << "Degree " << degree << ", " << numElements << " elements, "
+           << basis.size() << " dofs, " << numRepeat << " repetitions\n"
+           << "Per-node products: " << timeNode << " s\n"
+           << "Rank update:       " << timeRank << " s\n"
+           << "Speedup:           " << timeNode / timeRank << "\n"
+           << "Relative difference of the local matrices: " << maxDiff << "\n";
+
+    return maxDiff < 1e-12 ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+/** @file matrixFreePoisson.cpp
+
+    @brief Solves a Poisson problem by conjugate gradients with a
+    matrix-free operator and a Jacobi preconditioner.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+int main(int argc, char* argv[])
+{
+    index_t numRefine  = 3;
+    index_t numElevate = 1;
+
+    gsCmdLine cmd("Solves a Poisson problem with a matrix-free operator.");
+    cmd.addInt("r","uniformRefine", "Number of uniform h-refinement steps", numRefine);
+    cmd.addInt("e","degreeElevation", "Number of degree elevation steps", numElevate);
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    // Geometry, basis and boundary conditions
+    gsMultiPatch<> patches(*gsNurbsCreator<>::BSplineFatQuarterAnnulus());
+    gsMultiBasis<> bases(patches);
+    bases.degreeElevate(numElevate);
+    for (index_t i = 0; i < numRefine; ++i)
+        bases.uniformRefine();
+
+    gsFunctionExpr<> f("((pi*1)^2 + (pi*2)^2)*sin(pi*x*1)*sin(pi*y*2)",2);
+    gsFunctionExpr<> g("sin(pi*x*1)*sin(pi*y*2)",2);
+    gsBoundaryConditions<> bcInfo;
+    for (gsMultiPatch<>::const_biterator bit = patches.bBegin(); bit != patches.bEnd(); ++bit)
+        bcInfo.addCondition( *bit, condition_type::dirichlet, &g );
+
+    // The right-hand side is taken from the assembler, the assembled
+    // matrix is only used for comparison
+    gsPoissonAssembler<real_t> assembler(patches, bases, bcInfo, f);
+    assembler.assemble();
+    gsInfo << "Number of degrees of freedom: " << assembler.numDofs() << "\n";
+
+    const real_t tol = 1e-10;
+
+    // Solve with the assembled matrix
+    gsSparseMatrix<> mat = assembler.fullMatrix();
+    gsConjugateGradient cgMat(mat, gsLinearOperator<>::Ptr(makeJacobiOp(mat)));
+    cgMat.setTolerance(tol);
+    gsMatrix<> solMat;
+    solMat.setZero(assembler.numDofs(), 1);
+    cgMat.solve(assembler.rhs(), solMat);
+    gsInfo << "CG (assembled):   " << cgMat.iterations() << " iterations\n";
+
+    // Solve matrix-free, the Jacobi preconditioner uses the diagonal
+    // computed element-wise
+    gsMatrixFreePoissonOp<real_t> op(assembler);
+    gsLinearOperator<>::Ptr opPtr = memory::make_shared_not_owned(&op);
+    gsLinearOperator<>::Ptr prec(op.jacobiOp());
+    gsConjugateGradient cgFree(opPtr, prec);
+    cgFree.setTolerance(tol);
+    gsMatrix<> solFree;
+    solFree.setZero(assembler.numDofs(), 1);
+    cgFree.solve(assembler.rhs(), solFree);
+    gsInfo << "CG (matrix-free): " << cgFree.iterations() << " iterations\n";
+
+    const real_t diff = (solMat - solFree).norm() / solMat.norm();
+    gsInfo << "Relative difference of the solutions: " << diff << "\n";
+
+    return ( diff < 1e-8 && cgFree.error() <= tol ) ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+/** @file multiGridPoisson.cpp
+
+    @brief Solves a Poisson problem by conjugate gradients with a
+    geometric multigrid preconditioner on a sequence of refinements.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+int main(int argc, char* argv[])
+{
+    index_t numLevels  = 5;
+    index_t numElevate = 1;
+    std::string smoother("SymmetricGaussSeidel");
+
+    gsCmdLine cmd("Solves a Poisson problem with a multigrid preconditioned CG method.");
+    cmd.addInt("l","levels", "Number of levels of the finest grid hierarchy", numLevels);
+    cmd.addInt("e","degreeElevation", "Number of degree elevation steps", numElevate);
+    cmd.addString("s","smoother", "Smoother: Jacobi, GaussSeidel or SymmetricGaussSeidel", smoother);
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    // Four patches, glued at the interfaces
+    gsMultiPatch<> patches(*gsNurbsCreator<>::BSplineSquareGrid(2, 2, 0.5));
+
+    gsFunctionExpr<> f("((pi*1)^2 + (pi*2)^2)*sin(pi*x*1)*sin(pi*y*2)",2);
+    gsFunctionExpr<> g("sin(pi*x*1)*sin(pi*y*2)",2);
+    gsBoundaryConditions<> bcInfo;
+    for (gsMultiPatch<>::const_biterator bit = patches.bBegin(); bit != patches.bEnd(); ++bit)
+        bcInfo.addCondition( *bit, condition_type::dirichlet, &g );
+
+    gsOptionList mgOpt = gsMultiGridOp<>::defaultOptions();
+    mgOpt.setString("Smoother", smoother);
+
+    const real_t tol = 1e-8;
+    index_t minIter = 1000, maxIter = 0;
+
+    for (index_t nl = 2; nl <= numLevels; ++nl)
+    {
+        // Grid hierarchy, starting from the (once refined) patches
+        gsMultiBasis<> bases(patches);
+        bases.degreeElevate(numElevate);
+        bases.uniformRefine();
+        std::vector< gsSparseMatrix<real_t,RowMajor> > transfers;
+        gsMultiGridOp<>::buildHierarchy(bases, bcInfo, gsAssembler<>::defaultOptions(),
+                                        nl, transfers);
+
+        gsPoissonAssembler<real_t> assembler(patches, bases, bcInfo, f);
+        assembler.assemble();
+        const gsSparseMatrix<> & mat = assembler.matrix();
+
+        gsMultiGridOp<>::Ptr mg( gsMultiGridOp<>::make(mat, transfers, mgOpt) );
+
+        // Multigrid as preconditioner for CG
+        gsConjugateGradient cg(mat, mg);
+        cg.setTolerance(tol);
+        gsMatrix<> sol;
+        sol.setZero(assembler.numDofs(), 1);
+        cg.solve(assembler.rhs(), sol);
+
+        // Standalone multigrid iteration
+        index_t mgIter = 0;
+        gsMatrix<> x;
+        x.setZero(assembler.numDofs(), 1);
+        const real_t rhsNorm = assembler.rhs().norm();
+        while ( (assembler.rhs() - mat * x).norm() > tol * rhsNorm && mgIter < 100 )
+        {
+            mg->step(assembler.rhs(), x);
+            ++mgIter;
+        }
+
+        gsInfo << "Levels: " << nl << ", dofs: " << assembler.numDofs()
+               << ", MG-CG iterations: " << cg.iterations()
+               << ", MG iterations: " << mgIter << "\n";
+
+        minIter = math::min(minIter, (index_t)cg.iterations());
+        maxIter = math::max(maxIter, (index_t)cg.iterations());
+        if ( cg.error() > tol )
+            return 1;
+    }
+
+    // The number of iterations should be bounded independently of h
+    return ( maxIter <= minIter + 3 ) ? 0 : 1;
+}
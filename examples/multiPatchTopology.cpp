@@ -0,0 +1,107 @@
+/** @file multiPatchTopology.cpp
+
+    @brief Checks gsMultiPatch::computeTopology() and
+    gsMultiPatch::closeGaps() on a grid of patches with perturbed
+    corners.
+
+    If the corners are moved by less than the tolerance, all
+    interfaces are found. Larger gaps are found with a larger
+    tolerance only; closeGaps() closes the gaps of the interfaces
+    which were found and adds no interfaces. After closeGaps() the
+    interfaces match exactly. When a patch is moved, computeTopology()
+    finds the interfaces of the new geometry.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+// Moves the corner control points of every patch randomly by at most
+// size in every coordinate
+void perturbCorners(gsMultiPatch<> & mp, real_t size)
+{
+    for (size_t p = 0; p != mp.nPatches(); ++p)
+    {
+        gsGeometry<> & geo = mp.patch(p);
+        for (boxCorner c = boxCorner::getFirst(2); c < boxCorner::getEnd(2); ++c)
+            geo.coef(geo.basis().functionAtCorner(c)) += size * gsMatrix<>::Random(1, geo.geoDim());
+    }
+}
+
+// Computes the topology with tolerance tol, closes the gaps and
+// checks the number of interfaces
+bool run(index_t n, real_t size, real_t tol)
+{
+    gsMultiPatch<> mp( *safe( gsNurbsCreator<>::BSplineSquareGrid(n, n, 1) ) );
+    mp.degreeElevate();
+    perturbCorners(mp, size);
+
+    const index_t numIfaces = 2 * n * (n - 1);
+    mp.computeTopology(1e-4);
+    const index_t found = mp.nInterfaces();
+    mp.computeTopology(tol);
+    const index_t foundTol = mp.nInterfaces();
+    mp.closeGaps(tol);
+    const index_t closed = mp.nInterfaces();
+
+    // The gaps are closed up to round-off
+    mp.computeTopology(1e-12);
+    const bool passed = ( (size < 1e-4 / 4) == (found == numIfaces) ) &&
+        numIfaces == foundTol && numIfaces == closed &&
+        numIfaces == mp.nInterfaces() && 4 * n == mp.nBoundary();
+
+    gsInfo << n << "x" << n << " patches, corners moved by " << size << ": "
+           << found << " of " << numIfaces << " interfaces found, "
+           << foundTol << " with tolerance " << tol << ", " << closed
+           << " after closeGaps(): " << (passed ? "passed" : "FAILED") << "\n";
+    return passed;
+}
+
+// Checks that closeGaps() adds no interfaces and that computeTopology()
+// follows a patch which is moved
+bool runMoved(index_t n)
+{
+    gsMultiPatch<> mp( *safe( gsNurbsCreator<>::BSplineSquareGrid(n, n, 1) ) );
+    perturbCorners(mp, 1e-3);
+    mp.computeTopology(1e-4);
+    const index_t found = mp.nInterfaces();
+    mp.closeGaps(1e-2);
+    bool passed = ( found == mp.nInterfaces() );
+
+    // Move the first patch away and back
+    mp.computeTopology(1e-2);
+    const index_t all = mp.nInterfaces();
+    mp.patch(0).coefs().col(0).array() -= 10;
+    mp.computeTopology(1e-2);
+    passed &= ( all - 2 == mp.nInterfaces() );
+    mp.patch(0).coefs().col(0).array() += 10;
+    mp.computeTopology(1e-2);
+    passed &= ( all == mp.nInterfaces() );
+
+    gsInfo << "closeGaps() without new interfaces, moved patch: "
+           << (passed ? "passed" : "FAILED") << "\n";
+    return passed;
+}
+
+int main(int argc, char* argv[])
+{
+    index_t n = 20;
+
+    gsCmdLine cmd("Checks the topology of a multipatch with perturbed corners.");
+    cmd.addInt("n","patches", "Number of patches per direction", n);
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    bool passed = run(n, 1e-6, 1e-4);
+    passed &= run(n, 1e-3, 1e-2);
+    passed &= runMoved(n);
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,192 @@
+/** @file parallelAssembly.cpp
+
+    @brief Checks that the assembly with the option "Parallel" gives
+    the same system as the serial assembly.
+
+    A Poisson problem with Dirichlet and Neumann conditions is
+    assembled on a distorted multi-patch domain, serially and in
+    parallel with several numbers of threads. The matrices and right
+    hand sides have to be identical, ie. the parallel assembly is
+    deterministic. Without OpenMP the option has no effect.
+    The same is checked on a truncated hierarchical basis, and an
+    exception thrown by the right hand side has to leave the parallel
+    assembly with its original type.
+
+    The threads move their domain iterators by several elements at
+    once; these jumps are compared with single steps for tensor and
+    hierarchical meshes, on the interior and on the boundary.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+// The exception thrown by xLimited
+struct xError : public std::runtime_error
+{
+    xError() : std::runtime_error("Point outside of the admissible region") { }
+};
+
+// The function 1, which throws an xError for x > xMax
+class xLimited : public gsFunction<real_t>
+{
+public:
+    explicit xLimited(real_t xMax) : m_xMax(xMax) { }
+
+    xLimited * clone() const { return new xLimited(*this); }
+
+    // The same function on every patch
+    const xLimited & piece(const index_t) const { return *this; }
+
+    int domainDim() const { return 2; }
+
+    void eval_into(const gsMatrix<real_t> & u, gsMatrix<real_t> & result) const
+    {
+        if ( u.row(0).maxCoeff() > m_xMax )
+            throw xError();
+        result.setOnes(1, u.cols());
+    }
+
+private:
+    real_t m_xMax;
+};
+
+// Compares the jumps by 1 to 5 elements of the domain iterator of
+// basis with single steps
+bool checkJumps(const gsBasis<> & basis, boxSide side, const std::string & name)
+{
+    bool passed = true;
+    index_t numEl = 0;
+    for (index_t inc = 1; inc <= 5; ++inc)
+    {
+        gsBasis<>::domainIter ref = basis.makeDomainIterator(side);
+        gsBasis<>::domainIter it  = basis.makeDomainIterator(side);
+        numEl = ref->numElements();
+        index_t count = 0;
+        for (; it->good(); ++count)
+        {
+            passed &= ref->good() && ref->lowerCorner() == it->lowerCorner() &&
+                ref->upperCorner() == it->upperCorner();
+            it->next(inc);
+            for (index_t i = 0; i < inc && ref->good(); ++i)
+                ref->next();
+        }
+        passed &= ! ref->good() && count == (numEl + inc - 1) / inc;
+    }
+    gsInfo << name << ", " << numEl << " elements: jumps "
+           << (passed ? "passed" : "FAILED") << "\n";
+    return passed;
+}
+
+// Assembles the system with or without the option "Parallel"
+void assemble(gsPoissonAssembler<real_t> & assembler, bool parallel)
+{
+    assembler.options().setSwitch("Parallel", parallel);
+    assembler.system().setZero(); // assemble() adds to the matrix
+    assembler.assemble();
+}
+
+// Maximum difference of the systems of the two assemblers
+real_t difference(const gsPoissonAssembler<real_t> & a, const gsPoissonAssembler<real_t> & b)
+{
+    const gsSparseMatrix<> diff = a.matrix() - b.matrix();
+    real_t result = (a.rhs() - b.rhs()).cwiseAbs().maxCoeff();
+    for (index_t k = 0; k != diff.outerSize(); ++k)
+        for (gsSparseMatrix<>::InnerIterator it(diff, k); it; ++it)
+            result = math::max(result, math::abs(it.value()));
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    index_t numRefine = 3;
+    index_t numDegElev = 1;
+
+    gsCmdLine cmd("Checks the parallel assembly against the serial one.");
+    cmd.addInt("r","uniformRefine", "Number of uniform h-refinement steps", numRefine);
+    cmd.addInt("e","degreeElevation", "Number of degree elevation steps", numDegElev);
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    // 3x2 patches, the first one not affine
+    gsMultiPatch<>::uPtr patches = safe( gsNurbsCreator<>::BSplineSquareGrid(3, 2, 0.5) );
+    patches->patch(0).coefs()(0,0) -= 0.1;
+    gsMultiBasis<> bases(*patches);
+    bases.degreeElevate(numDegElev);
+    for (index_t i = 0; i < numRefine; ++i)
+        bases.uniformRefine();
+
+    gsFunctionExpr<> f("((pi*1)^2 + (pi*2)^2)*sin(pi*x*1)*sin(pi*y*2)",2);
+    gsFunctionExpr<> g("sin(pi*x*1)*sin(pi*y*2)",2);
+    gsFunctionExpr<> h("x*y",2);
+    gsBoundaryConditions<> bcInfo;
+    for (gsMultiPatch<>::const_biterator bit = patches->bBegin(); bit != patches->bEnd(); ++bit)
+        bcInfo.addCondition(*bit, boundary::south == bit->side() ? condition_type::neumann
+                            : condition_type::dirichlet, boundary::south == bit->side() ? &h : &g);
+
+    gsPoissonAssembler<real_t> serial  (*patches, bases, bcInfo, f);
+    gsPoissonAssembler<real_t> parallel(*patches, bases, bcInfo, f);
+    assemble(serial, false);
+
+    bool passed = true;
+    const int maxThreads = omp_get_max_threads();
+    for (int numThreads = 1; numThreads <= math::max(4, maxThreads); numThreads *= 2)
+    {
+        omp_set_num_threads(numThreads);
+        assemble(parallel, true);
+        const real_t diff = difference(serial, parallel);
+        gsInfo << numThreads << " thread(s): difference to the serial assembly "
+               << diff << "\n";
+        passed &= ( 0 == diff );
+    }
+
+    // Truncated hierarchical basis on a single patch, refined on two
+    // overlapping boxes
+    gsTHBSplineBasis<2> thb( bases.basis(0) );
+    std::vector<unsigned> boxes(10);
+    boxes[0] = 1; boxes[1] = 0; boxes[2] = 0; boxes[3] = 4; boxes[4] = 6;
+    boxes[5] = 2; boxes[6] = 2; boxes[7] = 4; boxes[8] = 6; boxes[9] = 8;
+    thb.refineElements(boxes);
+    const gsMultiPatch<> square( patches->patch(0) );
+    const gsMultiBasis<> hbases(thb);
+    gsBoundaryConditions<> hbcInfo;
+    for (gsMultiPatch<>::const_biterator bit = square.bBegin(); bit != square.bEnd(); ++bit)
+        hbcInfo.addCondition(*bit, condition_type::neumann, &h);
+    gsPoissonAssembler<real_t> hSerial  (square, hbases, hbcInfo, f);
+    gsPoissonAssembler<real_t> hParallel(square, hbases, hbcInfo, f);
+    assemble(hSerial, false);
+
+    // The right hand side throws on the patches with x > 1
+    gsPoissonAssembler<real_t> throwing(*patches, bases, bcInfo, xLimited(1));
+
+    for (int numThreads = 1; numThreads <= math::max(4, maxThreads); numThreads *= 2)
+    {
+        omp_set_num_threads(numThreads);
+        assemble(hParallel, true);
+        const real_t diff = difference(hSerial, hParallel);
+
+        bool rethrown = false;
+        try { assemble(throwing, true); }
+        catch (xError &) { rethrown = true; }
+        catch (...) { }
+
+        gsInfo << numThreads << " thread(s): hierarchical basis, difference "
+               << diff << ", exception " << (rethrown ? "rethrown" : "LOST") << "\n";
+        passed &= ( 0 == diff ) && rethrown;
+    }
+    omp_set_num_threads(maxThreads);
+
+    passed &= checkJumps(bases.basis(0), boundary::none,  "Tensor basis           ");
+    passed &= checkJumps(bases.basis(0), boundary::north, "Tensor basis, north    ");
+    passed &= checkJumps(thb,            boundary::none,  "Hierarchical basis     ");
+    passed &= checkJumps(thb,            boundary::east,  "Hierarchical basis, east");
+
+    return passed ? 0 : 1;
+}
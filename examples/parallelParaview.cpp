@@ -0,0 +1,142 @@
+/** @file parallelParaview.cpp
+
+    @brief Checks the parallel export of multipatch objects by
+    gsWriteParaview.
+
+    Multipatch geometries, fields and bases are written with one
+    thread and with several threads; the files have to be identical.
+    The geometry is also written in compressed format, passed to the
+    call, while the default format is ascii.
+    A field whose function throws an exception on some patches is
+    written as well: the exception has to leave gsWriteParaview with
+    its original type, whatever the number of threads.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <gismo.h>
+
+using namespace gismo;
+
+// The exception thrown by patchFunction
+struct patchError : public std::runtime_error
+{
+    explicit patchError(real_t x_)
+    : std::runtime_error("Point outside of the admissible region"), x(x_) { }
+    real_t x;
+};
+
+// The function x*y, which throws a patchError for x > xMax
+class patchFunction : public gsFunction<real_t>
+{
+public:
+    explicit patchFunction(real_t xMax) : m_xMax(xMax) { }
+
+    patchFunction * clone() const { return new patchFunction(*this); }
+
+    int domainDim() const { return 2; }
+
+    void eval_into(const gsMatrix<real_t> & u, gsMatrix<real_t> & result) const
+    {
+        const real_t x = u.row(0).maxCoeff();
+        if ( x > m_xMax )
+            throw patchError(x);
+        result = u.row(0).cwiseProduct(u.row(1));
+    }
+
+private:
+    real_t m_xMax;
+};
+
+// Reads the whole file fn
+std::string readFile(const std::string & fn)
+{
+    std::ifstream file(fn.c_str(), std::ios::in | std::ios::binary);
+    std::ostringstream result;
+    result << file.rdbuf();
+    return result.str();
+}
+
+// Reads and deletes the files written for the n patches of fn
+std::string takeFiles(const std::string & fn, index_t n, const std::string & ext,
+                      const std::string & meshExt)
+{
+    std::string result = readFile(fn + ".pvd");
+    std::remove((fn + ".pvd").c_str());
+    for (index_t i = 0; i != n; ++i)
+    {
+        const std::string fi = fn + util::to_string(i);
+        result += readFile(fi + ext) + readFile(fi + "_mesh" + meshExt);
+        std::remove((fi + ext).c_str());
+        std::remove((fi + "_mesh" + meshExt).c_str());
+    }
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string fn = "parallelParaview";
+
+    gsCmdLine cmd("Checks the parallel export of multipatch objects to Paraview.");
+    cmd.addString("f","file", "Base name of the temporary files", fn);
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    // 3x2 patches on [0,1.5]x[0,1]
+    gsMultiPatch<> mp( *safe( gsNurbsCreator<>::BSplineSquareGrid(3, 2, 0.5) ) );
+    mp.degreeElevate();
+    const index_t n = mp.nPatches();
+    const gsMultiBasis<> mb(mp);
+    gsPiecewiseFunction<> f, g;
+    for (index_t i = 0; i != n; ++i)
+    {
+        f.addPiece(patchFunction(2));
+        g.addPiece(patchFunction(1));
+    }
+    const gsField<> field(mp, f), bad(mp, g);
+
+    const int maxThreads = omp_get_max_threads();
+    std::string serial[4];
+    bool passed = true;
+    for (int numThreads = 1; numThreads <= math::max(4, maxThreads); numThreads *= 2)
+    {
+        omp_set_num_threads(numThreads);
+        std::string out[4];
+        gsWriteParaview(mp, fn, 100, true, false);
+        out[0] = takeFiles(fn, n, ".vts", ".vtp");
+        gsWriteParaview(field, fn, 100, true);
+        out[1] = takeFiles(fn, n, ".vts", ".vtp");
+        gsWriteParaview(mb, mp, fn, 100);
+        out[2] = takeFiles(fn, n, ".none", ".vtp");
+        gsWriteParaview(mp, fn, 100, true, false, paraview::compressed);
+        out[3] = takeFiles(fn, n, ".vts", ".vtp");
+        if ( 1 == numThreads )
+            std::copy(out, out + 4, serial);
+        const bool same = out[0] == serial[0] && out[1] == serial[1] &&
+            out[2] == serial[2] && out[3] == serial[3] && ! out[0].empty() &&
+            out[3] != out[0] && std::string::npos != out[3].find("vtkZLibDataCompressor");
+
+        // The patches with x > 1 throw
+        bool rethrown = false;
+        try { gsWriteParaview(bad, fn, 100, false); }
+        catch (patchError & e) { rethrown = e.x > 1; }
+        catch (...) { }
+        takeFiles(fn, n, ".vts", ".none");
+
+        gsInfo << numThreads << " thread(s): output "
+               << (same ? "identical to 1 thread" : "DIFFERENT") << ", exception "
+               << (rethrown ? "rethrown" : "LOST") << "\n";
+        passed &= same && rethrown;
+    }
+    omp_set_num_threads(maxThreads);
+
+    return passed ? 0 : 1;
+}
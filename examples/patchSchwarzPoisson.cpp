@@ -0,0 +1,97 @@
+/** @file patchSchwarzPoisson.cpp
+
+    @brief Solves a multipatch Poisson problem by CG with the
+    patch-wise additive Schwarz preconditioner, for a growing number
+    of patches.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+int main(int argc, char* argv[])
+{
+    index_t maxPatches = 8;
+    index_t numRefine  = 2;
+    index_t numElevate = 1;
+    index_t overlap    = 0;
+    std::string localSolver("Direct");
+
+    gsCmdLine cmd("Solves a Poisson problem with a patch-wise Schwarz preconditioned CG method.");
+    cmd.addInt("n","patches", "Maximal number of patches in each direction", maxPatches);
+    cmd.addInt("r","uniformRefine", "Number of uniform h-refinement steps", numRefine);
+    cmd.addInt("e","degreeElevation", "Number of degree elevation steps", numElevate);
+    cmd.addInt("o","overlap", "Number of layers of dofs added to the patches", overlap);
+    cmd.addString("s","localSolver", "Local solver: Direct or FastDiagonalization", localSolver);
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    gsFunctionExpr<> f("((pi*1)^2 + (pi*2)^2)*sin(pi*x*1)*sin(pi*y*2)",2);
+    gsFunctionExpr<> g("sin(pi*x*1)*sin(pi*y*2)",2);
+
+    gsOptionList opt = gsPatchSchwarzOp<>::defaultOptions();
+    opt.setInt   ("Overlap"    , overlap);
+    opt.setString("LocalSolver", localSolver);
+
+    const real_t tol = 1e-8;
+    index_t prevIter = 0, lastIter = 0;
+
+    for (index_t n = 2; n <= maxPatches; n *= 2)
+    {
+        // n x n patches on the unit square, with the same number of
+        // elements per patch
+        gsMultiPatch<>::uPtr patches(gsNurbsCreator<>::BSplineSquareGrid(n, n, 1.0 / n));
+        gsMultiBasis<> bases(*patches);
+        bases.degreeElevate(numElevate);
+        for (index_t i = 0; i < numRefine; ++i)
+            bases.uniformRefine();
+
+        gsBoundaryConditions<> bcInfo;
+        for (gsMultiPatch<>::const_biterator bit = patches->bBegin(); bit != patches->bEnd(); ++bit)
+            bcInfo.addCondition( *bit, condition_type::dirichlet, &g );
+
+        gsPoissonAssembler<real_t> assembler(*patches, bases, bcInfo, f);
+        assembler.assemble();
+        gsSparseMatrix<> mat = assembler.fullMatrix();
+
+        // Two-level Schwarz
+        gsPatchSchwarzOp<>::Ptr prec( gsPatchSchwarzOp<>::make(
+            mat, bases, assembler.system().colMapper(0), opt) );
+        gsConjugateGradient cg(mat, prec);
+        cg.setTolerance(tol);
+        gsMatrix<> sol;
+        sol.setZero(assembler.numDofs(), 1);
+        cg.solve(assembler.rhs(), sol);
+
+        // One-level Schwarz, for comparison
+        gsOptionList opt1 = opt;
+        opt1.setSwitch("CoarseSpace", false);
+        gsPatchSchwarzOp<>::Ptr prec1( gsPatchSchwarzOp<>::make(
+            mat, bases, assembler.system().colMapper(0), opt1) );
+        gsConjugateGradient cg1(mat, prec1);
+        cg1.setTolerance(tol);
+        gsMatrix<> sol1;
+        sol1.setZero(assembler.numDofs(), 1);
+        cg1.solve(assembler.rhs(), sol1);
+
+        gsInfo << "Patches: " << n*n << ", dofs: " << assembler.numDofs()
+               << ", CG iterations: " << cg.iterations()
+               << " (without coarse space: " << cg1.iterations() << ")\n";
+
+        prevIter = lastIter;
+        lastIter = cg.iterations();
+        if ( cg.error() > tol )
+            return 1;
+    }
+
+    // The number of iterations should be bounded independently of
+    // the number of patches, ie. it should not grow any more
+    return ( lastIter <= prevIter + 3 ) ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+/** @file sparsityPatternPoisson.cpp
+
+    @brief Checks the assembly into a precomputed sparsity pattern
+    (gsAssembler::computePattern()).
+
+    The Poisson system of a multi-patch domain is assembled repeatedly
+    into the pattern, serially and with the option "Parallel". The
+    result has to agree with the assembly without pattern, and the
+    re-assembly must not change the structure of the matrix: the index
+    arrays keep their address and content and the matrix stays
+    compressed. The timings of both variants are printed.
+
+    Random element matrices are also pushed into a system whose row
+    mapper eliminates the Dirichlet dofs while its column mapper keeps
+    them, with and without pattern.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+// Pushes the same element matrices into systems with and without
+// pattern, which have different row and column mappers
+bool checkMappers(const gsMultiBasis<> & bases, const gsBoundaryConditions<> & bcInfo)
+{
+    std::vector<gsDofMapper> mappers(2);
+    bases.getMapper(true, bcInfo, mappers[0]); // eliminates the Dirichlet dofs
+    bases.getMapper(true, mappers[1]);
+    std::vector<gsDofMapper> mappers2(mappers);
+    gsSparseSystem<> plain(mappers, 1, 1), ptrn(mappers2, 1, 1);
+    plain.reserve(64, 1);
+    ptrn.computePattern( std::vector<gsMultiBasis<> >(1, bases) );
+    ptrn.reserve(64, 1);
+    const index_t nnz = ptrn.matrix().nonZeros();
+
+    gsMatrix<unsigned> act, actRow, actCol;
+    const gsMatrix<> noDofs;
+    for (size_t k = 0; k != bases.nBases(); ++k)
+    {
+        gsBasis<>::domainIter domIt = bases[k].makeDomainIterator();
+        for (index_t el = 0; domIt->good(); domIt->next(), ++el)
+        {
+            bases[k].active_into(domIt->centerPoint(), act);
+            plain.mapRowIndices(act, k, actRow);
+            plain.mapColIndices(act, k, actCol);
+            const gsMatrix<> localMat = gsMatrix<>::Random(act.rows(), act.rows());
+            plain.pushToMatrix(localMat, actRow, actCol, noDofs);
+            ptrn.setElement(k, el);
+            ptrn.pushToMatrix(localMat, actRow, actCol, noDofs);
+        }
+    }
+
+    const gsSparseMatrix<> diff = ptrn.matrix() - plain.matrix();
+    const bool samePattern = ptrn.matrix().isCompressed() && nnz == ptrn.matrix().nonZeros();
+    const bool passed = samePattern && diff.norm() < 1e-12 && plain.matrix().rows() < plain.matrix().cols();
+    gsInfo << "Different row and column mappers: difference " << diff.norm() << ", pattern "
+           << (samePattern ? "unchanged" : "CHANGED") << ": " << (passed ? "passed" : "FAILED") << "\n";
+    return passed;
+}
+
+int main(int argc, char* argv[])
+{
+    index_t numRefine = 3;
+    index_t numDegElev = 1;
+    index_t numRepeat = 5;
+
+    gsCmdLine cmd("Checks the assembly into a precomputed sparsity pattern.");
+    cmd.addInt("r","uniformRefine", "Number of uniform h-refinement steps", numRefine);
+    cmd.addInt("e","degreeElevation", "Number of degree elevation steps", numDegElev);
+    cmd.addInt("n","repeat", "Number of assembly calls", numRepeat);
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    gsMultiPatch<>::uPtr patches = safe( gsNurbsCreator<>::BSplineSquareGrid(2, 2, 0.5) );
+    gsMultiBasis<> bases(*patches);
+    bases.degreeElevate(numDegElev);
+    for (index_t i = 0; i < numRefine; ++i)
+        bases.uniformRefine();
+
+    gsFunctionExpr<> f("((pi*1)^2 + (pi*2)^2)*sin(pi*x*1)*sin(pi*y*2)",2);
+    gsFunctionExpr<> g("sin(pi*x*1)*sin(pi*y*2)",2);
+    gsBoundaryConditions<> bcInfo;
+    for (gsMultiPatch<>::const_biterator bit = patches->bBegin(); bit != patches->bEnd(); ++bit)
+        bcInfo.addCondition(*bit, condition_type::dirichlet, &g);
+
+    gsPoissonAssembler<real_t> plain(*patches, bases, bcInfo, f);
+    gsStopwatch time;
+    for (index_t i = 0; i != numRepeat; ++i)
+    {
+        plain.system().setZero(); // assemble() adds to the matrix
+        plain.assemble();
+    }
+    const double timePlain = time.stop();
+
+    bool passed = true;
+    for (int parallel = 0; parallel != 2; ++parallel)
+    {
+        gsPoissonAssembler<real_t> ptrn(*patches, bases, bcInfo, f);
+        ptrn.options().setSwitch("Parallel", 0 != parallel);
+        ptrn.computePattern();
+
+        const gsSparseMatrix<> & A = ptrn.matrix();
+        const index_t * outer = A.outerIndexPtr();
+        const index_t * inner = A.innerIndexPtr();
+        const real_t  * value = A.valuePtr();
+        const std::vector<index_t> outerCopy(outer, outer + A.outerSize() + 1);
+        const std::vector<index_t> innerCopy(inner, inner + A.nonZeros());
+
+        real_t maxDiff = 0;
+        bool samePattern = true;
+        double timePtrn = 0;
+        for (index_t i = 0; i != numRepeat; ++i)
+        {
+            time.restart();
+            ptrn.assemble();
+            timePtrn += time.stop();
+            samePattern &= A.isCompressed() &&
+                outer == A.outerIndexPtr() && inner == A.innerIndexPtr() &&
+                value == A.valuePtr() &&
+                static_cast<index_t>(innerCopy.size()) == A.nonZeros() &&
+                std::equal(outerCopy.begin(), outerCopy.end(), A.outerIndexPtr()) &&
+                std::equal(innerCopy.begin(), innerCopy.end(), A.innerIndexPtr());
+            const gsSparseMatrix<> diff = A - plain.matrix();
+            maxDiff = math::max(maxDiff, diff.norm());
+            maxDiff = math::max(maxDiff, (ptrn.rhs() - plain.rhs()).cwiseAbs().maxCoeff());
+        }
+
+        gsInfo << (parallel ? "Parallel" : "Serial  ") << " assembly into the pattern: "
+               << "difference " << maxDiff << ", pattern "
+               << (samePattern ? "unchanged" : "CHANGED") << ", time "
+               << timePtrn << " s (without pattern " << timePlain << " s)\n";
+        passed &= samePattern && maxDiff < 1e-12;
+    }
+
+    passed &= checkMappers(bases, bcInfo);
+
+    return passed ? 0 : 1;
+}
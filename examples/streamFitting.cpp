@@ -0,0 +1,100 @@
+/** @file streamFitting.cpp
+
+    @brief Checks the out-of-core least squares fitting
+    (gsStreamFitting) against gsFitting on the same points.
+
+    The points are written to a binary file and read back in chunks
+    by gsFilePointStream. With many points the pending contributions
+    outnumber the triplet limit of gsStreamFitting and are summed into
+    the matrix before the end of the stream. The fit, its errors and
+    the fit of the points added chunk by chunk from memory are
+    compared with gsFitting, with and without smoothing.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <cstdio>
+#include <gismo.h>
+
+using namespace gismo;
+
+// Maximum difference of the coefficients relative to their maximum
+real_t relDiff(const gsGeometry<> & a, const gsGeometry<> & b)
+{
+    return (a.coefs() - b.coefs()).cwiseAbs().maxCoeff() / b.coefs().cwiseAbs().maxCoeff();
+}
+
+bool run(gsBasis<> & basis, index_t numPoints, index_t chunkSize,
+         real_t lambda, const std::string & fileName)
+{
+    // Random parameters and points on a smooth surface
+    gsMatrix<> params = gsMatrix<>::Random(2, numPoints);
+    params.array() = (params.array() + 1) / 2;
+    gsMatrix<> points(3, numPoints);
+    points.topRows(2) = params;
+    points.row(2) = (params.row(0).array() * 3).sin() * params.row(1).array();
+
+    gsFitting<> ref(params, points, basis);
+    ref.compute(lambda);
+    ref.computeErrors();
+
+    // From a file, in chunks
+    gsFilePointStream<>::write(fileName, params, points);
+    gsFilePointStream<> stream(fileName, 2, 3, chunkSize);
+    gsStreamFitting<> fit(basis);
+    fit.addPoints(stream);
+    fit.compute(lambda);
+    fit.computeErrors(stream);
+    std::remove(fileName.c_str());
+
+    // From memory, in chunks of different sizes
+    gsStreamFitting<> fit2(basis);
+    for (index_t i = 0, n = 1; i < numPoints; i += n, n *= 3)
+    {
+        const index_t m = math::min(n, numPoints - i);
+        fit2.addPoints(params.middleCols(i, m), points.middleCols(i, m));
+    }
+    fit2.compute(lambda);
+
+    const real_t err  = relDiff(*fit .result(), *ref.result());
+    const real_t err2 = relDiff(*fit2.result(), *ref.result());
+    const real_t errMax = math::abs(fit.maxPointError() - ref.maxPointError());
+    const real_t errMin = math::abs(fit.minPointError() - ref.minPointError());
+    const bool passed = err < 1e-10 && err2 < 1e-10 && fit.numPoints() == numPoints &&
+        errMax < 1e-10 && errMin < 1e-10;
+
+    // The triplet limit of gsStreamFitting
+    const bool flushed = numPoints * math::ipow(basis.maxDegree() + 1, 4) > (1 << 22);
+    gsInfo << numPoints << " points in chunks of " << chunkSize << ", lambda " << lambda
+           << (flushed ? " (flushed)" : "") << ": " << err << ", " << err2
+           << ", max. error " << fit.maxPointError()
+           << ": " << (passed ? "passed" : "FAILED") << "\n";
+    return passed;
+}
+
+int main(int argc, char* argv[])
+{
+    index_t numPoints = 20000;
+    std::string fileName = "streamFitting.bin";
+
+    gsCmdLine cmd("Checks the out-of-core fitting against gsFitting.");
+    cmd.addInt   ("n","points", "Number of points of the large run", numPoints);
+    cmd.addString("f","file", "Temporary file for the points", fileName);
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    // Bicubic basis, 256 triplets per point
+    gsKnotVector<> kv(0, 1, 7, 4);
+    gsTensorBSplineBasis<2> basis(kv, kv);
+
+    bool passed = run(basis, 1000, 128, 0, fileName);
+    passed &= run(basis, 1000, 1000, 1e-6, fileName);
+    passed &= run(basis, numPoints, 3000, 0, fileName);
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+/** @file sumFactorization.cpp
+
+    @brief Checks the mass and stiffness matrices assembled by sum
+    factorization (gsVisitorTPmass, gsVisitorTPgradGrad) against
+    gsGenericAssembler::assembleMass() and assembleStiffness().
+
+    Distorted B-spline patches in 2D (multi-patch) and 3D are used, as
+    well as a NURBS patch, for which the visitors fall back to the
+    standard evaluation. The timings of both variants are printed.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+// Relative difference of two sparse matrices
+real_t relDiff(const gsSparseMatrix<> & a, const gsSparseMatrix<> & b)
+{
+    const gsSparseMatrix<> diff = a - b;
+    return diff.norm() / b.norm();
+}
+
+bool run(const gsMultiPatch<> & mp, index_t numDegElev, index_t numRefine,
+         const std::string & name)
+{
+    gsMultiBasis<> bases(mp);
+    bases.degreeElevate(numDegElev);
+    for (index_t i = 0; i < numRefine; ++i)
+        bases.uniformRefine();
+
+    gsGenericAssembler<real_t> assembler(mp, bases);
+    gsStopwatch time;
+    const gsSparseMatrix<> mass = assembler.assembleMass();
+    const double tMass = time.stop();
+    time.restart();
+    const gsSparseMatrix<> massTP = assembler.assembleMass2();
+    const double tMassTP = time.stop();
+    time.restart();
+    const gsSparseMatrix<> stiff = assembler.assembleStiffness();
+    const double tStiff = time.stop();
+    time.restart();
+    const gsSparseMatrix<> stiffTP = assembler.assembleStiffness2();
+    const double tStiffTP = time.stop();
+
+    const real_t errMass  = relDiff(massTP , mass );
+    const real_t errStiff = relDiff(stiffTP, stiff);
+    const bool passed = errMass < 1e-12 && errStiff < 1e-12;
+    gsInfo << name << ", " << mass.rows() << " dofs: "
+           << "mass " << errMass  << " (" << tMassTP  << " s vs " << tMass  << " s), "
+           << "stiffness " << errStiff << " (" << tStiffTP << " s vs " << tStiff << " s): "
+           << (passed ? "passed" : "FAILED") << "\n";
+    return passed;
+}
+
+int main(int argc, char* argv[])
+{
+    index_t numRefine = 2;
+
+    gsCmdLine cmd("Checks the sum factorization of mass and stiffness matrices.");
+    cmd.addInt("r","uniformRefine", "Number of uniform h-refinement steps", numRefine);
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    // 2x2 patches with a moved interior vertex
+    gsMultiPatch<> square( *safe( gsNurbsCreator<>::BSplineSquareGrid(2, 2, 0.5) ) );
+    for (size_t p = 0; p != square.nPatches(); ++p)
+        for (unsigned i = 0; i != square.patch(p).coefsSize(); ++i)
+            if ( (square.patch(p).coef(i).array() == 0.5).all() )
+                square.patch(p).coef(i) << 0.6, 0.45;
+
+    // A cube with one corner moved
+    gsGeometry<>::uPtr cube( gsNurbsCreator<>::BSplineCube(1) );
+    cube->coefs().row(7) *= 1.5;
+
+    // NURBS, not a tensor-product basis of B-splines
+    gsGeometry<>::uPtr annulus( gsNurbsCreator<>::NurbsQuarterAnnulus() );
+
+    bool passed = run(square, 1, numRefine, "2D, degree 2");
+    passed &= run(square, 2, numRefine, "2D, degree 3");
+    passed &= run(gsMultiPatch<>(*cube), 1, numRefine - 1, "3D, degree 2");
+    passed &= run(gsMultiPatch<>(*cube), 2, numRefine - 1, "3D, degree 3");
+    passed &= run(gsMultiPatch<>(*annulus), 1, numRefine, "NURBS");
+
+    return passed ? 0 : 1;
+}
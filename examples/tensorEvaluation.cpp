@@ -0,0 +1,124 @@
+/** @file tensorEvaluation.cpp
+
+    @brief Checks the evaluation of functions given by coefficients
+    in tensor-product and rational bases against the linear
+    combination of the values of the basis functions.
+
+    gsTensorBasis evaluates the values, first and second derivatives
+    of such functions by contracting the coefficients with the
+    univariate values one direction at a time, and gsRationalBasis
+    applies the quotient rule to the numerator and the denominator
+    evaluated by its source basis. The results are compared with
+    gsBasis::linearCombination_into() applied to eval_into(),
+    deriv_into() and deriv2_into() of the basis, for tensor B-splines
+    and NURBS in 2D and 3D.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <gismo.h>
+
+using namespace gismo;
+
+// Maximum difference of a and b relative to the maximum of b
+real_t relDiff(const gsMatrix<> & a, const gsMatrix<> & b)
+{
+    if ( a.rows() != b.rows() || a.cols() != b.cols() )
+        return std::numeric_limits<real_t>::infinity();
+    return (a - b).cwiseAbs().maxCoeff() / math::max(real_t(1), b.cwiseAbs().maxCoeff());
+}
+
+// Compares the evaluation of the function given by coefs with the
+// linear combination of the basis functions at the points u
+bool check(const gsBasis<> & basis, const gsMatrix<> & coefs,
+           const gsMatrix<> & u, const std::string & name)
+{
+    gsMatrix<unsigned> actives;
+    basis.active_into(u, actives);
+
+    // Generic evaluation
+    gsMatrix<> values[3], ref[3];
+    basis.eval_into  (u, values[0]);
+    basis.deriv_into (u, values[1]);
+    basis.deriv2_into(u, values[2]);
+    for (int k = 0; k != 3; ++k)
+        gsBasis<>::linearCombination_into(coefs, actives, values[k], ref[k]);
+
+    // Evaluation of the function
+    gsMatrix<> func[3];
+    basis.evalFunc_into  (u, coefs, func[0]);
+    basis.derivFunc_into (u, coefs, func[1]);
+    basis.deriv2Func_into(u, coefs, func[2]);
+    std::vector< gsMatrix<> > all;
+    basis.evalAllDersFunc_into(u, coefs, 2, all);
+
+    real_t err = 0;
+    for (int k = 0; k != 3; ++k)
+    {
+        err = math::max(err, relDiff(func[k], ref[k]));
+        err = math::max(err, relDiff(all[k] , ref[k]));
+    }
+
+    const bool passed = err < 1e-12;
+    gsInfo << name << ": " << err << ": " << (passed ? "passed" : "FAILED") << "\n";
+    return passed;
+}
+
+// Random points in [0,1]^d, including the corners of the domain
+gsMatrix<> points(int d, index_t numPoints)
+{
+    gsMatrix<> result = gsMatrix<>::Random(d, numPoints);
+    result.array() = (result.array() + 1) / 2;
+    result.col(0).setZero();
+    result.col(1).setOnes();
+    return result;
+}
+
+template<unsigned d>
+bool run(const gsTensorBSplineBasis<d> & basis, index_t numPoints)
+{
+    const gsMatrix<> u = points(d, numPoints);
+    bool passed = true;
+    for (int tdim = 1; tdim <= 3; tdim += 2)
+    {
+        const gsMatrix<> coefs = gsMatrix<>::Random(basis.size(), tdim);
+        std::ostringstream name;
+        name << d << "D, " << tdim << " component(s), B-spline";
+        passed &= check(basis, coefs, u, name.str());
+
+        // Positive weights between 1/2 and 3/2
+        gsMatrix<> weights = gsMatrix<>::Random(basis.size(), 1);
+        weights.array() = weights.array() / 2 + 1;
+        const gsTensorNurbsBasis<d> nurbs(basis.clone(), weights);
+        name.str("");
+        name << d << "D, " << tdim << " component(s), NURBS   ";
+        passed &= check(nurbs, coefs, u, name.str());
+    }
+    return passed;
+}
+
+int main(int argc, char* argv[])
+{
+    index_t numPoints = 100;
+
+    gsCmdLine cmd("Checks the evaluation of tensor-product and rational functions.");
+    cmd.addInt("n","points", "Number of evaluation points", numPoints);
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    // Different degrees and knots in every direction, one knot is
+    // repeated
+    gsKnotVector<> kv1(0, 1, 3, 4), kv2(0, 1, 2, 3), kv3(0, 1, 4, 2);
+    kv1.insert(0.3, 2);
+    kv2.insert(0.7);
+
+    bool passed = run(gsTensorBSplineBasis<2>(kv1, kv2), numPoints);
+    passed &= run(gsTensorBSplineBasis<3>(kv1, kv2, kv3), numPoints);
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+/** @file tensorFitting.cpp
+
+    @brief Checks the least squares fit of gsFitting on tensor grids of
+    parameters, which is computed by univariate solvers, against the
+    general assembly and solver.
+
+    The points on a tensor grid are fitted once in grid order, where
+    gsFitting detects the grid, and once in shuffled order, where the
+    full system is assembled and solved iteratively. The two fits
+    agree up to the tolerance of the iterative solver.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <algorithm>
+#include <gismo.h>
+
+using namespace gismo;
+
+// Fits the points of a smooth function on the grid cwise in grid
+// order and in shuffled order
+bool check(gsBasis<> & basis, const std::vector< gsVector<> > & cwise)
+{
+    const gsMatrix<> params = gsPointGrid<real_t>(cwise);
+    const index_t N = params.cols();
+    gsMatrix<> points(2, N);
+    points.row(0) = (params.colwise().sum().array() * 2).sin();
+    points.row(1) = params.row(0).array() * params.bottomRows(1).array().exp();
+
+    gsStopwatch time;
+    gsFitting<> tensor(params, points, basis);
+    tensor.compute();
+    const double tTensor = time.stop();
+
+    std::vector<index_t> perm(N);
+    for (index_t i = 0; i != N; ++i)
+        perm[i] = (7919 * i) % N; // N is not a multiple of 7919
+    gsMatrix<> params2(params.rows(), N), points2(2, N);
+    for (index_t i = 0; i != N; ++i)
+    {
+        params2.col(i) = params.col(perm[i]);
+        points2.col(i) = points.col(perm[i]);
+    }
+    time.restart();
+    gsFitting<> general(params2, points2, basis);
+    general.compute();
+    const double tGeneral = time.stop();
+
+    const gsMatrix<> & c1 = tensor .result()->coefs();
+    const gsMatrix<> & c2 = general.result()->coefs();
+    const real_t err = (c1 - c2).cwiseAbs().maxCoeff() / c2.cwiseAbs().maxCoeff();
+    tensor .computeErrors();
+    general.computeErrors();
+    const real_t errMax = math::abs(tensor.maxPointError() - general.maxPointError());
+    const bool passed = err < 1e-8 && errMax < 1e-8;
+    gsInfo << basis.dim() << "D, " << basis.size() << " functions, " << N << " points: "
+           << "difference " << err << ", time " << tTensor << "s (grid) vs. "
+           << tGeneral << "s: " << (passed ? "passed" : "FAILED") << "\n";
+    return passed;
+}
+
+// n uniform parameters per direction, with the ends
+std::vector< gsVector<> > uniformGrid(const std::vector<index_t> & n)
+{
+    std::vector< gsVector<> > result(n.size());
+    for (size_t i = 0; i != n.size(); ++i)
+        result[i] = gsVector<>::LinSpaced(n[i], 0, 1);
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    gsCmdLine cmd("Checks the fit on tensor grids against the general fit.");
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    gsKnotVector<> kv1(0, 1, 7, 4), kv2(0, 1, 3, 3);
+    gsTensorBSplineBasis<2> b2(kv1, kv2);
+    gsTensorBSplineBasis<3> b3(kv2, kv2, kv1);
+
+    std::vector<index_t> n2(2), n3(3);
+    n2[0] = 31; n2[1] = 23;
+    n3[0] = 11; n3[1] = 9; n3[2] = 17;
+
+    bool passed = check(b2, uniformGrid(n2));
+    passed &= check(b3, uniformGrid(n3));
+
+    return passed ? 0 : 1;
+}
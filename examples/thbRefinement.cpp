@@ -77,7 +77,7 @@ int main(int argc, char *argv[])
     if (numTr < 1000) 
         gsInfo <<"\nCoefficient count for each truncated function: \n";
     unsigned ccount = 0;
-    typedef std::map<unsigned, gsSparseVector<> >::const_iterator trIter;
+    typedef gsTHBSplineBasis<2,real_t>::truncatedIterator trIter;
     for( trIter it = thb.truncatedBegin(); it != thb.truncatedEnd(); ++it)
     {
         const int lvl = thb.levelOf(it->first);
@@ -0,0 +1,213 @@
+/** @file thbTruncation.cpp
+
+    @brief Checks the truncated representations of THB-spline bases,
+    which are updated locally after a refinement, against the
+    representations of a basis built from scratch.
+
+    The values and the first and second derivatives of the basis
+    functions (evalSingle(), eval_into() and so on) are compared with
+    the ones of the representations applied to the functions of the
+    tensor-product levels.
+
+    Uniform and non-uniform knot vectors (with a repeated interior
+    knot) are refined in 2D and 3D, with refine(), refine() with an
+    extension and refineElements().
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <algorithm>
+#include <gismo.h>
+
+using namespace gismo;
+
+// Compares the representations of thb with the ones of a THB-spline
+// basis constructed from the same mesh
+template<unsigned d>
+bool sameAsFresh(const gsTHBSplineBasis<d> & thb)
+{
+    gsMatrix<unsigned> b1, b2;
+    gsVector<unsigned> level;
+    thb.tree().getBoxesInLevelIndex(b1, b2, level);
+    std::vector<unsigned> boxes;
+    for (index_t i = 0; i != b1.rows(); ++i)
+    {
+        boxes.push_back(level[i]);
+        for (unsigned k = 0; k != d; ++k)
+            boxes.push_back(b1(i,k));
+        for (unsigned k = 0; k != d; ++k)
+            boxes.push_back(b2(i,k));
+    }
+    const gsTHBSplineBasis<d> fresh(thb.tensorLevel(0), boxes);
+
+    if ( fresh.size() != thb.size() || fresh.numTruncated() != thb.numTruncated() )
+        return false;
+
+    typedef typename gsTHBSplineBasis<d>::truncatedIterator trIter;
+    trIter it = thb.truncatedBegin(), itFresh = fresh.truncatedBegin();
+    for (; it != thb.truncatedEnd(); ++it, ++itFresh)
+    {
+        if ( itFresh == fresh.truncatedEnd() || it->first != itFresh->first )
+            return false;
+        const typename gsTHBSplineBasis<d>::CoefsView
+            coefs = it->second, coefsFresh = itFresh->second;
+        if ( coefs.rows() != coefsFresh.rows() ||
+             coefs.nonZeros() != coefsFresh.nonZeros() )
+            return false;
+        // Identical indices and coefficients
+        typename gsTHBSplineBasis<d>::CoefsView::InnerIterator c(coefs, 0), cf(coefsFresh, 0);
+        for (; c; ++c, ++cf)
+            if ( c.index() != cf.index() || c.value() != cf.value() )
+                return false;
+    }
+    return itFresh == fresh.truncatedEnd();
+}
+
+// Compares the values and derivatives of order n at the points u of
+// the functions of thb, one by one and all together, with their
+// representations applied to the tensor-product functions
+template<unsigned d>
+real_t evalError(const gsTHBSplineBasis<d> & thb, const gsMatrix<> & u, int n)
+{
+    gsMatrix<> all, single, ref, tmp;
+    gsMatrix<unsigned> act;
+    thb.active_into(u, act);
+    if ( 0 == n )
+        thb.eval_into(u, all);
+    else if ( 1 == n )
+        thb.deriv_into(u, all);
+    else
+        thb.deriv2_into(u, all);
+    const index_t numDers = all.rows() / act.rows();
+
+    // The functions which are nonzero at some point
+    std::vector<unsigned> funcs(act.data(), act.data() + act.size());
+    std::sort(funcs.begin(), funcs.end());
+    funcs.erase(std::unique(funcs.begin(), funcs.end()), funcs.end());
+
+    real_t err = 0;
+    for (size_t f = 0; f != funcs.size(); ++f)
+    {
+        const unsigned i = funcs[f];
+        // The level of the representation, on which the number of
+        // tensor-product functions is the size of the representation
+        unsigned lvl = thb.levelOf(i);
+        while ( thb.isTruncated(i) &&
+                thb.tensorLevel(lvl).size() != thb.getCoefs(i).rows() )
+            ++lvl;
+        const gsTensorBSplineBasis<d> & tp = thb.tensorLevel(lvl);
+
+        ref.setZero(numDers, u.cols());
+        if ( thb.isTruncated(i) )
+        {
+            for (typename gsTHBSplineBasis<d>::CoefsView::InnerIterator
+                     c(thb.getCoefs(i), 0); c; ++c)
+            {
+                if ( 0 == n )
+                    tp.evalSingle_into(c.index(), u, tmp);
+                else if ( 1 == n )
+                    tp.derivSingle_into(c.index(), u, tmp);
+                else
+                    tp.deriv2Single_into(c.index(), u, tmp);
+                ref += c.value() * tmp;
+            }
+        }
+        else if ( 0 == n )
+            tp.evalSingle_into(thb.flatTensorIndexOf(i), u, ref);
+        else if ( 1 == n )
+            tp.derivSingle_into(thb.flatTensorIndexOf(i), u, ref);
+        else
+            tp.deriv2Single_into(thb.flatTensorIndexOf(i), u, ref);
+
+        if ( 0 == n )
+            thb.evalSingle_into(i, u, single);
+        else if ( 1 == n )
+            thb.derivSingle_into(i, u, single);
+        else
+            thb.deriv2Single_into(i, u, single);
+        err = math::max(err, (single - ref).cwiseAbs().maxCoeff());
+
+        // The rows of i in the evaluation of all active functions,
+        // the active indices are padded with zeros
+        for (index_t pt = 0; pt != u.cols(); ++pt)
+            for (index_t r = 0; r != act.rows(); ++r)
+                if ( act(r, pt) == i )
+                {
+                    err = math::max(err, (all.block(r * numDers, pt, numDers, 1)
+                                          - ref.col(pt)).cwiseAbs().maxCoeff());
+                    break;
+                }
+    }
+    return err;
+}
+
+template<unsigned d>
+bool run(gsTHBSplineBasis<d> & thb, const std::string & name)
+{
+    gsMatrix<> box(d, 2);
+    bool passed = true;
+    for (index_t r = 0; r != 6; ++r)
+    {
+        box.col(0).setConstant( 0.05 + 0.1 * r );
+        box.col(1) = box.col(0).array() + 0.5 - 0.05 * r;
+        box(0,1) = 0.95;
+        if ( 2 == r )
+            thb.refine(box, 1); // with extension
+        else if ( 4 == r )
+        {
+            // The elements of the first corner on the finest level
+            std::vector<unsigned> elements(2 * d + 1, 0);
+            elements[0] = thb.maxLevel();
+            for (unsigned k = 0; k != d; ++k)
+                elements[1 + d + k] = 2;
+            thb.refineElements(elements);
+        }
+        else
+            thb.refine(box);
+
+        const bool same = sameAsFresh(thb);
+        const gsMatrix<> u = (gsMatrix<>::Random(d, 20).array() + 1) / 2;
+        real_t err = 0;
+        for (int n = 0; n != 3; ++n)
+            err = math::max(err, evalError(thb, u, n));
+        const bool correct = err < 1e-10;
+        gsInfo << name << ", " << thb.maxLevel() << " levels, " << thb.size()
+               << " functions, " << thb.numTruncated() << " truncated: "
+               << (same ? "same as fresh" : "DIFFERENT") << ", evaluation error "
+               << err << ": " << (same && correct ? "passed" : "FAILED") << "\n";
+        passed &= same && correct;
+    }
+    return passed;
+}
+
+int main(int argc, char* argv[])
+{
+    gsCmdLine cmd("Checks the local update of THB-spline truncations.");
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    gsKnotVector<> kv(0, 1, 7, 3);
+
+    // Non-uniform, with a double interior knot
+    gsKnotVector<> kvn(0, 1, 0, 3);
+    kvn.insert(0.1);
+    kvn.insert(0.15);
+    kvn.insert(0.4, 2);
+    kvn.insert(0.7);
+
+    gsTHBSplineBasis<2> thb2 ( gsTensorBSplineBasis<2>(kv, kv) );
+    gsTHBSplineBasis<2> thb2n( gsTensorBSplineBasis<2>(kvn, kv) );
+    gsKnotVector<> kv3(0, 1, 3, 3);
+    gsTHBSplineBasis<3> thb3 ( gsTensorBSplineBasis<3>(kv3, kvn, kv3) );
+
+    bool passed = run(thb2 , "2D uniform    ");
+    passed &= run(thb2n, "2D non-uniform");
+    passed &= run(thb3 , "3D            ");
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+/** @file xmlBase64.cpp
+
+    @brief Checks the base64 encoding of numeric arrays in XML data,
+    in particular that whitespace in the encoded text is skipped.
+
+    Matrices, sparse matrices and knot vectors are written with
+    xml::base64 encoding. Their encoded text is wrapped into lines
+    and indented, as other tools do, and read back. Readers which
+    ignore the encoding must find no numbers, and data of an unknown
+    version of the encoding must be rejected.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <iostream>
+#include <sstream>
+#include <gismo.h>
+
+using namespace gismo;
+using namespace gismo::internal;
+
+// Breaks the base64 text of node into indented lines of width characters
+void wrap(gsXmlNode * node, gsXmlTree & data, size_t width)
+{
+    node = node->first_node("base64");
+    const std::string value(node->value(), node->value_size());
+    std::string result("\n    ");
+    for (size_t i = 0; i < value.size(); i += width)
+        result += value.substr(i, width) + "\n\t  ";
+    node->value(data.allocate_string(result.c_str()), result.size());
+}
+
+// Writes obj, wraps the encoded text and reads it back
+template<class Object>
+Object roundTrip(const Object & obj, size_t width)
+{
+    gsXmlTree data;
+    gsXmlNode * node = gsXml<Object>::put(obj, data);
+    wrap(node, data, width);
+    Object result;
+    gsXml<Object>::get_into(node, result);
+    return result;
+}
+
+// Checks that a reader which ignores the encoding finds no numbers
+// in the node of obj, and that a newer version is rejected
+template<class Object>
+bool oldAndNewReaders(const Object & obj)
+{
+    gsXmlTree data;
+    gsXmlNode * node = gsXml<Object>::put(obj, data);
+    std::istringstream str(node->value());
+    real_t val;
+    const bool noNumbers = !gsGetReal(str, val);
+
+    node->first_attribute("version")->value("2");
+    bool rejected = false;
+    Object result;
+    try { gsXml<Object>::get_into(node, result); }
+    catch (std::exception &) { rejected = true; }
+    return noNumbers && rejected;
+}
+
+int main(int argc, char* argv[])
+{
+    gsCmdLine cmd("Checks base64-encoded XML data with whitespace.");
+    const bool ok = cmd.getValues(argc,argv);
+    if (!ok) { gsWarn << "Error during parsing the command line!\n"; return 0;}
+
+    xml::setDefaultEncoding(xml::base64);
+    bool passed = true;
+
+    // Byte strings of every length modulo 3, with whitespace between
+    // all characters
+    for (size_t n = 0; n != 8; ++n)
+    {
+        std::string bytes(n, 0);
+        for (size_t i = 0; i != n; ++i)
+            bytes[i] = static_cast<char>(37 * i + 200);
+        const std::string enc = encodeBase64(bytes.data(), n);
+        std::string spaced(" ");
+        for (size_t i = 0; i != enc.size(); ++i)
+            (spaced += enc[i]) += (i % 3 ? " " : "\r\n");
+        std::string dec(base64DecodedSize(spaced.data(), spaced.size()), 0);
+        decodeBase64(spaced.data(), spaced.size(), &dec[0]);
+        passed &= ( dec == bytes );
+    }
+    gsInfo << "Byte strings:   " << (passed ? "passed" : "FAILED") << "\n";
+
+    gsMatrix<> mat = gsMatrix<>::Random(7, 5);
+    gsSparseMatrix<> smat(9, 9);
+    for (index_t i = 0; i != 9; ++i)
+    {
+        smat.insert(i, i) = 1.0 / (i + 1);
+        smat.insert(i, (5 * i) % 9 == i ? (i + 1) % 9 : (5 * i) % 9) = -0.5 * i;
+    }
+    smat.makeCompressed();
+    gsKnotVector<> kv(0, 1, 5, 3, 2);
+
+    for (size_t width = 1; width <= 64; width *= 4)
+    {
+        const gsMatrix<>       mat2  = roundTrip(mat , width);
+        const gsSparseMatrix<> smat2 = roundTrip(smat, width);
+        const gsKnotVector<>   kv2   = roundTrip(kv  , width);
+        const gsSparseMatrix<> sdiff = smat2 - smat;
+        const bool same = mat2 == mat && 0 == sdiff.norm() &&
+            smat2.nonZeros() == smat.nonZeros() && kv2 == kv;
+        gsInfo << "Lines of " << width << ": " << (same ? "passed" : "FAILED") << "\n";
+        passed &= same;
+    }
+
+    const bool versions = oldAndNewReaders(mat) && oldAndNewReaders(smat) &&
+        oldAndNewReaders(kv);
+    gsInfo << "Old readers and newer versions: " << (versions ? "passed" : "FAILED") << "\n";
+    passed &= versions;
+
+    xml::setDefaultEncoding(xml::ascii);
+    return passed ? 0 : 1;
+}
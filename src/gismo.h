@@ -67,6 +67,7 @@ namespace internal
 
 #include <gsCore/gsBoxTopology.h>
 #include <gsCore/gsMultiPatch.h>
+#include <gsCore/gsPointLocator.h>
 #include <gsCore/gsField.h>
 
 #include <gsCore/gsBasis.h>
@@ -111,6 +112,7 @@ namespace internal
 #include <gsModeling/gsTriMeshToSolid.h>
 //#include <gsSegment/gsVolumeSegment.h> 
 #include <gsModeling/gsFitting.h>
+#include <gsModeling/gsStreamFitting.h>
 #include <gsModeling/gsCurveFitting.h>
 
 /* ----------- Pde ----------- */
@@ -138,6 +140,7 @@ namespace internal
 #include <gsAssembler/gsPoissonAssembler.h>
 #include <gsAssembler/gsCDRAssembler.h>
 #include <gsAssembler/gsHeatEquation.h>
+#include <gsAssembler/gsMatrixFreePoissonOp.h>
 
 /* ----------- Solver ----------- */
 #include <gsSolver/gsLinearOperator.h>
@@ -145,6 +148,9 @@ namespace internal
 #include <gsSolver/gsGMRes.h>
 #include <gsSolver/gsConjugateGradient.h>
 #include <gsSolver/gsSimpleOps.h>
+#include <gsSolver/gsMultiGrid.h>
+#include <gsSolver/gsKroneckerOp.h>
+#include <gsSolver/gsPatchSchwarz.h>
 
 /* ----------- IO ----------- */
 #include <gsIO/gsOptionList.h>
@@ -160,11 +166,14 @@ namespace internal
 
 /* ----------- MPI ----------- */
 #include <gsMpi/gsMpi.h>
+#include <gsMpi/gsOpenMP.h>
+#include <gsMpi/gsDistributedSystem.h>
 
 /* ----------- Utilities ----------- */
 //#include <gsUtils/gsUtils.h> - in gsForwardDeclarations.h
 #include <gsUtils/gsNorms.h>
 #include <gsUtils/gsStopwatch.h>
+#include <gsUtils/gsSpatialGrid.h>
 #include <gsUtils/gsFunctionWithDerivatives.h>
 
 /* ----------- MPI ----------- */
@@ -28,6 +28,9 @@
 
 #include <gsAssembler/gsQuadRule.h>
 #include <gsAssembler/gsSparseSystem.h>
+#include <gsAssembler/gsElementCache.h>
+
+#include <gsMpi/gsOpenMP.h>
 
 
 
@@ -63,6 +66,10 @@ protected: // *** Input data members ***
     /// Options
     gsOptionList m_options;
 
+    /// The patches which are assembled, see restrictToPatches(). An
+    /// empty vector stands for all patches
+    std::vector<bool> m_activePatches;
+
 protected: // *** Output data members *** 
     
     /// Global sparse linear system
@@ -73,6 +80,11 @@ protected: // *** Output data members ***
     /// must fit m_system.colBlocks().
     std::vector<gsMatrix<T> > m_ddof;
 
+    /// Element data kept between assembly calls, if the option
+    /// "CacheElements" is set. The cache is filled by the serial
+    /// element loop only, it cannot be combined with "Parallel"
+    gsElementCache<T> m_cache;
+
 public:
 
     gsAssembler() : m_options(defaultOptions())
@@ -112,6 +124,7 @@ public:
         m_pde_ptr = pde;
         m_bases = bases;
         m_options = opt;
+        m_cache.clear();
         refresh(); // virtual call to derived
         GISMO_ASSERT( check(), "Something went wrong in assembler initialization");
     }
@@ -134,6 +147,7 @@ public:
         m_bases.clear();
         m_bases.push_back(bases);
         m_options = opt;
+        m_cache.clear();
         refresh(); // virtual call to derived
         GISMO_ASSERT( check(), "Something went wrong in assembler initialization");
     }
@@ -155,6 +169,7 @@ public:
             m_bases.push_back(gsMultiBasis<T>(basis[c]));
 
         m_options = opt;
+        m_cache.clear();
         refresh(); // virtual call to derived
         GISMO_ASSERT( check(), "Something went wrong in assembler initialization");
     }
@@ -183,6 +198,44 @@ public:
         return m_system.numColNz(m_bases.front()[0], m_options);
     }
 
+    /// @brief Computes the exact sparsity pattern of the system
+    /// matrix (symbolic phase). Subsequent calls of assemble() only
+    /// compute the values of the matrix entries, see
+    /// gsSparseSystem::computePattern(). The pattern is discarded by
+    /// refresh().
+    void computePattern() { m_system.computePattern(m_bases, m_activePatches); }
+
+    /// @brief Restricts the assembly to the patches \a patches, ie.
+    /// the element visitors are applied only to the patches \a k with
+    /// patches[k] true, to their boundaries and to the interfaces
+    /// whose master side (see pushInterface()) is on one of them.
+    /// The system keeps its global numbering.
+    ///
+    /// Assembling the patches of a partition separately and summing
+    /// up the results gives the system of the whole domain, which is
+    /// used for distributed assembly (see gsDistributedSystem).
+    /// Passing an empty vector restores the assembly of all patches.
+    void restrictToPatches(const std::vector<bool> & patches)
+    {
+        GISMO_ASSERT( patches.empty() ||
+                      patches.size() == m_pde_ptr->domain().nPatches(),
+                      "Invalid number of patches");
+        m_activePatches = patches;
+    }
+
+    /// @brief Returns true if patch \a np is assembled, see
+    /// restrictToPatches()
+    bool isActivePatch(index_t np) const
+    { return m_activePatches.empty() || m_activePatches[np]; }
+
+    /// @brief Discards the element data stored due to the option
+    /// "CacheElements". The data of a patch are discarded
+    /// automatically when its geometry or basis changes.
+    void clearCache() { m_cache.clear(); }
+
+    /// @brief Returns the memory used by the element cache, in bytes
+    std::size_t cacheMemoryUsage() const { return m_cache.memoryUsage(); }
+
 public:  /* Virtual assembly routines*/
 
     /// @brief Creates the mappers and setups the sparse system.
@@ -198,6 +251,7 @@ public:  /* Virtual assembly routines*/
     virtual void assemble(const gsMultiPatch<T> & curSolution);
 
     gsOptionList & options() {return m_options;}
+    const gsOptionList & options() const {return m_options;}
 
 public: /* Element visitors */
 
@@ -208,6 +262,7 @@ public: /* Element visitors */
     {
         for (unsigned np=0; np < m_pde_ptr->domain().nPatches(); ++np )
         {
+            if ( ! isActivePatch(np) ) continue;
             ElementVisitor visitor(*m_pde_ptr);
             //Assemble (fill m_matrix and m_rhs) on patch np
             apply(visitor, np);
@@ -222,6 +277,7 @@ public: /* Element visitors */
         for (typename bcContainer::const_iterator it
              = BCs.begin(); it!= BCs.end(); ++it)
         {
+            if ( ! isActivePatch(it->patch()) ) continue;
             BElementVisitor visitor(*m_pde_ptr, *it);
             //Assemble (fill m_matrix and m_rhs) contribution from this BC
             apply(visitor, it->patch(), it->side());
@@ -235,6 +291,7 @@ public: /* Element visitors */
     {
         for (unsigned np=0; np < m_pde_ptr->domain().nPatches(); ++np )
         {
+            if ( ! isActivePatch(np) ) continue;
             ElementVisitor curVisitor = visitor;
             //Assemble (fill m_matrix and m_rhs) on patch np
             apply(curVisitor, np);
@@ -256,7 +313,8 @@ public: /* Element visitors */
                 ( m_bases[0][it->first() .patch].numElements(it->first() .side() ) <
                   m_bases[0][it->second().patch].numElements(it->second().side() ) ?
                   it->getInverse() : *it );
-            
+
+            if ( ! isActivePatch(iFace.first().patch) ) continue;
             this->apply(visitor, iFace);
         }
     }
@@ -442,7 +500,90 @@ void gsAssembler<T>::apply(ElementVisitor & visitor,
     //gsDebug<< "Apply to patch "<< patchIndex <<"("<< side <<")\n";
     
     const gsBasisRefs<T> bases(m_bases, patchIndex);
+
+    const bool useCache =
+        m_options.askSwitch("CacheElements", false) && 1 == m_bases.size();
+    GISMO_ENSURE( ! ( useCache && m_options.askSwitch("Parallel", false) ),
+                  "The options \"Parallel\" and \"CacheElements\" are exclusive.");
     
+#   ifdef _OPENMP
+    if ( m_options.askSwitch("Parallel", false) )
+    {
+        // The elements are distributed cyclically among the
+        // threads. Every thread works on its own copy of the visitor,
+        // quadrature rule, geometry evaluator and domain iterator,
+        // which jumps to the next element of the thread in constant
+        // time for tensor meshes.
+        // The local contributions are pushed to the global system in
+        // element order, therefore the result is identical to the one
+        // of the serial loop. An exception of a thread is rethrown
+        // after the parallel region, its remaining elements are
+        // skipped.
+        const index_t numEl = bases[0].makeDomainIterator(side)->numElements();
+        internal::gsParallelError error;
+
+#       pragma omp parallel
+        {
+            gsQuadRule<T> tQuRule;
+            gsMatrix<T>   tQuNodes;
+            gsVector<T>   tQuWeights;
+            unsigned      tEvFlags(0);
+
+            memory::unique_ptr<ElementVisitor> tVisitor;
+            typename gsGeometry<T>::Evaluator geoEval;
+            typename gsBasis<T>::domainIter domIt;
+            index_t curEl = 0;
+            bool ok = true;
+            try
+            {
+                tVisitor.reset( new ElementVisitor(visitor) );
+                tVisitor->initialize(bases, patchIndex, m_options, tQuRule, tEvFlags);
+                geoEval.reset( m_pde_ptr->patches()[patchIndex].evaluator(tEvFlags) );
+                domIt   = bases[0].makeDomainIterator(side);
+            }
+            catch (...) { error.store(); ok = false; }
+
+            // Every iteration passes the ordered region, also after
+            // a failure
+#           pragma omp for ordered schedule(static, 1)
+            for (index_t el = 0; el < numEl; ++el)
+            {
+                if ( ok )
+                {
+                    try
+                    {
+                        // Move the iterator of this thread to element el
+                        domIt->next(el - curEl);
+                        curEl = el;
+
+                        tQuRule.mapTo( domIt->lowerCorner(), domIt->upperCorner(), tQuNodes, tQuWeights );
+                        tVisitor->evaluate(bases, *geoEval, tQuNodes);
+                        tVisitor->assemble(*domIt, *geoEval, tQuWeights);
+                    }
+                    catch (...) { error.store(); ok = false; }
+                }
+
+#               pragma omp ordered
+                {
+                    if ( ok )
+                    {
+                        try
+                        {
+                            if ( boundary::none == side )
+                                m_system.setElement(patchIndex, el);
+                            tVisitor->localToGlobal(patchIndex, m_ddof, m_system);
+                        }
+                        catch (...) { error.store(); ok = false; }
+                    }
+                }
+            }
+        }
+        m_system.setElement(patchIndex, -1);
+        error.rethrow();
+        return;
+    }
+#   endif
+
     gsQuadRule<T> QuRule ; // Quadrature rule
     gsMatrix<T> quNodes  ; // Temp variable for mapped nodes
     gsVector<T> quWeights; // Temp variable for mapped weights
@@ -458,10 +599,61 @@ void gsAssembler<T>::apply(ElementVisitor & visitor,
     
     // Initialize domain element iterator -- using unknown 0
     typename gsBasis<T>::domainIter domIt = bases[0].makeDomainIterator(side);
+
+    if ( useCache )
+    {
+        // Quadrature, basis and geometry data are taken from the
+        // cache, or computed and stored on the first visit
+        m_cache.setMemoryLimit( static_cast<std::size_t>(
+            m_options.askInt("CacheMemory", 1024) ) << 20 );
+        m_cache.setRevision(patchIndex, gsElementCache<T>::revision(
+                                m_pde_ptr->patches()[patchIndex], bases[0]) );
+        typename gsElementCache<T>::Block & cache =
+            m_cache.block(patchIndex, side, QuRule, geoEval->getFlags(),
+                          domIt->numElements());
+        gsCachedBasis<T> cBasis(bases[0], m_cache);
+        gsCachedGeometryEvaluator<T> cGeoEval(*geoEval, m_cache);
+
+        for (index_t el = 0; domIt->good(); domIt->next(), ++el )
+        {
+            if ( boundary::none == side )
+                m_system.setElement(patchIndex, el);
+            typename gsElementCache<T>::Element & elData = cache[el];
+            if ( 0 == elData.quWeights.size() )
+            {
+                QuRule.mapTo( domIt->lowerCorner(), domIt->upperCorner(), quNodes, quWeights );
+                if ( m_cache.full() )
+                {
+                    // Evaluate as usual
+                    cBasis  .setElement(NULL);
+                    cGeoEval.setElement(NULL);
+                    visitor.evaluate(cBasis, cGeoEval, quNodes);
+                    visitor.assemble(*domIt, cGeoEval, quWeights);
+                    visitor.localToGlobal(patchIndex, m_ddof, m_system);
+                    continue;
+                }
+                elData.quNodes   = quNodes;
+                elData.quWeights = quWeights;
+                m_cache.addMemory( sizeof(T) * (quNodes.size() + quWeights.size()) );
+            }
+
+            cBasis  .setElement(&elData);
+            cGeoEval.setElement(&elData);
+            visitor.evaluate(cBasis, cGeoEval, elData.quNodes);
+            visitor.assemble(*domIt, cGeoEval, elData.quWeights);
+            visitor.localToGlobal(patchIndex, m_ddof, m_system);
+        }
+        m_system.setElement(patchIndex, -1);
+        return;
+    }
     
     // Start iteration over elements
-    for (; domIt->good(); domIt->next() )
+    for (index_t el = 0; domIt->good(); domIt->next(), ++el )
     {
+        // Select the element in the precomputed sparsity pattern
+        if ( boundary::none == side )
+            m_system.setElement(patchIndex, el);
+
         // Map the Quadrature rule to the element
         QuRule.mapTo( domIt->lowerCorner(), domIt->upperCorner(), quNodes, quWeights );
         
@@ -474,6 +666,7 @@ void gsAssembler<T>::apply(ElementVisitor & visitor,
         // Push to global matrix and right-hand side vector
         visitor.localToGlobal(patchIndex, m_ddof, m_system);
     }
+    m_system.setElement(patchIndex, -1);
 }
 
 
@@ -36,6 +36,9 @@ gsOptionList gsAssembler<T>::defaultOptions()
     opt.addReal("bdA", "Estimated nonzeros per column of the matrix: bdA*deg + bdB", 2.0  );
     opt.addInt ("bdB", "Estimated nonzeros per column of the matrix: bdA*deg + bdB", 1    );
     opt.addReal("bdO", "Overhead of sparse mem. allocation: (1+bdO)(bdA*deg + bdB) [0..1]", 0.333);
+    opt.addSwitch("Parallel", "Assemble the elements of each patch in parallel (needs OpenMP, not with CacheElements)", false);
+    opt.addSwitch("CacheElements", "Keep the element quadrature, basis and geometry data for subsequent assemblies, until the geometry or basis changes (not with Parallel)", false);
+    opt.addInt ("CacheMemory", "Memory limit of the element cache in megabytes", 1024);
     return opt;
 }
 
@@ -145,6 +148,7 @@ void gsAssembler<T>::penalizeDirichletDofs(int unk)
           it = m_pde_ptr->bc().dirichletBegin();
           it != m_pde_ptr->bc().dirichletEnd(); ++it )
     {
+        if ( ! isActivePatch(it->patch()) ) continue;
         const gsBasis<T> & basis = mbasis[it->patch()];
 
         gsMatrix<unsigned> bnd = basis.boundary(it->side() );
@@ -165,6 +169,7 @@ void gsAssembler<T>::penalizeDirichletDofs(int unk)
           it = m_pde_ptr->bc().cornerBegin();
           it != m_pde_ptr->bc().cornerEnd(); ++it )
     {
+        if ( ! isActivePatch(it->patch) ) continue;
         const int i  = mbasis[it->patch].functionAtCorner(it->corner);
         const int ii = mapper.bindex( i , it->patch );
         m_system.matrix()(ii,ii)       = PP;
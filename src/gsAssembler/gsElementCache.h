@@ -0,0 +1,586 @@
+/** @file gsElementCache.h
+
+    @brief Cache of element-wise quadrature, basis and geometry data
+    which is reused between several assembly calls
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <gsCore/gsBasis.h>
+#include <gsCore/gsGeometryEvaluator.h>
+#include <gsAssembler/gsQuadRule.h>
+
+namespace gismo
+{
+
+/**
+   @brief Stores per element the mapped quadrature nodes and weights,
+   the active functions and derivatives of the basis and the
+   quantities of the geometry evaluator.
+
+   The cache is owned by gsAssembler and is used when the option
+   "CacheElements" is set. The data are stored separately for every
+   patch, side, quadrature rule (identified by its reference nodes and
+   weights) and set of geometry evaluation flags, so that different
+   visitors can share the cache.
+
+   The visitors access the data transparently through gsCachedBasis
+   and gsCachedGeometryEvaluator. The data of a patch are discarded
+   as soon as its revision, which is computed from the coefficients
+   of the geometry and the sizes of the bases (see revision()),
+   changes, eg. after refinement or modification of the geometry.
+
+   The cache is not thread-safe, it is filled and read by the serial
+   element loop only.
+
+   If the memory limit is reached no further data are stored, the
+   remaining elements are evaluated as usual.
+
+   \ingroup Assembler
+*/
+template <class T>
+class gsElementCache
+{
+public:
+
+    /// Basis data at one set of points
+    struct BasisRecord
+    {
+        gsMatrix<T>               points;
+        gsMatrix<unsigned>        actives;
+        std::vector<gsMatrix<T> > ders;   // derivatives up to ders.size()-1
+    };
+
+    /// Data of one element
+    struct Element
+    {
+        gsMatrix<T> quNodes;
+        gsVector<T> quWeights;
+        std::vector<BasisRecord> basis;
+        typename gsGeometryEvaluator<T>::Data geo;
+    };
+
+    typedef std::vector<Element> Block;
+
+public:
+
+    gsElementCache() : m_maxBytes(0), m_bytes(0)
+    { }
+
+    /// Removes all stored data
+    void clear()
+    {
+        m_blocks.clear();
+        m_revisions.clear();
+        m_bytes = 0;
+    }
+
+    /// Sets the maximum memory to be used, in bytes
+    void setMemoryLimit(std::size_t bytes) { m_maxBytes = bytes; }
+
+    /// Returns the memory currently used, in bytes (approximately)
+    std::size_t memoryUsage() const { return m_bytes; }
+
+    /// Returns true if no more data can be stored
+    bool full() const { return m_bytes >= m_maxBytes; }
+
+    /// Accounts for \a bytes of newly stored data
+    void addMemory(std::size_t bytes) { m_bytes += bytes; }
+
+    /// Accounts for \a bytes of released data
+    void releaseMemory(std::size_t bytes) { m_bytes -= std::min(bytes, m_bytes); }
+
+    /// @brief Returns a number which identifies the state of the
+    /// geometry \a geo and the basis \a basis of a patch
+    ///
+    /// The coefficients of the geometry, the size of its basis and
+    /// the size and number of elements of \a basis are hashed, hence
+    /// any modification or refinement changes the revision.
+    static std::size_t revision(const gsGeometry<T> & geo, const gsBasis<T> & basis)
+    {
+        // FNV-1a
+        std::size_t result = 2166136261u;
+        const gsMatrix<T> & coefs = geo.coefs();
+        hash(result, reinterpret_cast<const unsigned char*>(coefs.data()),
+             sizeof(T) * coefs.size() );
+        const index_t sizes[5] = { coefs.rows(), coefs.cols(), geo.basis().size(),
+                                   basis.size(), basis.numElements() };
+        hash(result, reinterpret_cast<const unsigned char*>(sizes), sizeof(sizes) );
+        return result;
+    }
+
+    /// @brief Sets the revision of patch \a patch, see revision().
+    /// If it differs from the previous one the data of the patch are
+    /// discarded.
+    void setRevision(index_t patch, std::size_t rev)
+    {
+        typename std::map<index_t,std::size_t>::iterator it = m_revisions.find(patch);
+        if ( it != m_revisions.end() && it->second == rev )
+            return;
+        m_revisions[patch] = rev;
+
+        typename std::map<Key,Block>::iterator b = m_blocks.begin();
+        while ( b != m_blocks.end() )
+        {
+            if ( b->first.patch == patch )
+            {
+                for (typename Block::const_iterator e = b->second.begin();
+                     e != b->second.end(); ++e)
+                    releaseMemory( bytes(*e) );
+                m_blocks.erase(b++);
+            }
+            else
+                ++b;
+        }
+    }
+
+    /// @brief Returns the storage of the \a numElements elements of
+    /// patch \a patch (or its side \a side) for the quadrature rule
+    /// \a rule and geometry evaluation flags \a flags
+    ///
+    /// Rules are distinguished by their reference nodes and weights,
+    /// not only by their number of nodes.
+    Block & block(index_t patch, boxSide side, const gsQuadRule<T> & rule,
+                  unsigned flags, index_t numElements)
+    {
+        const Key key(patch, side, rule, flags);
+        Block & result = m_blocks[key];
+        if ( static_cast<index_t>(result.size()) != numElements )
+        {
+            GISMO_ENSURE( result.empty(), "Number of elements changed, the revision of the patch is outdated");
+            result.resize(numElements);
+        }
+        return result;
+    }
+
+private:
+
+    static void hash(std::size_t & h, const unsigned char * data, std::size_t n)
+    {
+        for (std::size_t i = 0; i != n; ++i)
+            h = (h ^ data[i]) * 16777619u;
+    }
+
+    // Memory occupied by the data of an element, in bytes
+    static std::size_t bytes(const Element & e)
+    {
+        std::size_t result = sizeof(T) * (e.quNodes.size() + e.quWeights.size())
+            + e.geo.bytes();
+        for (std::size_t i = 0; i != e.basis.size(); ++i)
+        {
+            const BasisRecord & rec = e.basis[i];
+            result += sizeof(T) * rec.points.size() + sizeof(unsigned) * rec.actives.size();
+            for (std::size_t j = 0; j != rec.ders.size(); ++j)
+                result += sizeof(T) * rec.ders[j].size();
+        }
+        return result;
+    }
+
+private:
+
+    struct Key
+    {
+        Key(index_t p, boxSide s, const gsQuadRule<T> & rule, unsigned f)
+        : patch(p), side(s), flags(f),
+          nodes(rule.referenceNodes()), weights(rule.referenceWeights())
+        { }
+
+        bool operator<(const Key & other) const
+        {
+            if ( patch != other.patch ) return patch < other.patch;
+            if ( side  != other.side  ) return side  < other.side;
+            if ( flags != other.flags ) return flags < other.flags;
+            if ( nodes.rows() != other.nodes.rows() )
+                return nodes.rows() < other.nodes.rows();
+            if ( weights.size() != other.weights.size() )
+                return weights.size() < other.weights.size();
+            if ( nodes != other.nodes )
+                return std::lexicographical_compare(
+                    nodes.data(), nodes.data() + nodes.size(),
+                    other.nodes.data(), other.nodes.data() + other.nodes.size() );
+            return std::lexicographical_compare(
+                weights.data(), weights.data() + weights.size(),
+                other.weights.data(), other.weights.data() + other.weights.size() );
+        }
+
+        index_t     patch;
+        int         side;
+        unsigned    flags;
+        gsMatrix<T> nodes;   // reference nodes of the quadrature rule
+        gsVector<T> weights; // reference weights of the quadrature rule
+    };
+
+    std::map<Key,Block> m_blocks;
+
+    std::map<index_t,std::size_t> m_revisions;
+
+    std::size_t m_maxBytes;
+
+    std::size_t m_bytes;
+};
+
+
+/**
+   @brief Basis which forwards the evaluation to another basis and
+   reuses the results stored for the current element of a
+   gsElementCache.
+
+   Only the active functions and the values and derivatives (up to
+   second order) are cached. A result is reused only if the
+   evaluation points coincide with the stored ones; it is copied to
+   the result argument once. All other members of the gsBasis
+   interface are forwarded to the underlying basis.
+
+   \ingroup Assembler
+*/
+template <class T>
+class gsCachedBasis : public gsBasis<T>
+{
+public:
+    typedef typename gsBasis<T>::domainIter domainIter;
+
+    gsCachedBasis(const gsBasis<T> & basis, gsElementCache<T> & cache)
+    : m_basis(basis), m_cache(cache), m_elem(NULL)
+    { }
+
+    /// Sets the current element, or NULL for no caching
+    void setElement(typename gsElementCache<T>::Element * elem) { m_elem = elem; }
+
+public:
+
+    void active_into(const gsMatrix<T> & u, gsMatrix<unsigned>& result) const
+    {
+        typename gsElementCache<T>::BasisRecord * rec = record(u);
+        if ( NULL == rec )
+        {
+            m_basis.active_into(u, result);
+            return;
+        }
+        if ( 0 == rec->actives.size() )
+        {
+            m_basis.active_into(u, rec->actives);
+            m_cache.addMemory( sizeof(unsigned) * rec->actives.size() );
+        }
+        result = rec->actives;
+    }
+
+    void eval_into(const gsMatrix<T> & u, gsMatrix<T>& result) const
+    { getDers(u, 0, result); }
+
+    void deriv_into(const gsMatrix<T> & u, gsMatrix<T>& result) const
+    { getDers(u, 1, result); }
+
+    void deriv2_into(const gsMatrix<T> & u, gsMatrix<T>& result) const
+    { getDers(u, 2, result); }
+
+    void evalAllDers_into(const gsMatrix<T> & u, int n,
+                          std::vector<gsMatrix<T> >& result) const
+    {
+        typename gsElementCache<T>::BasisRecord * rec = ( n > 2 ? NULL : record(u) );
+        if ( NULL == rec )
+        {
+            m_basis.evalAllDers_into(u, n, result);
+            return;
+        }
+        computeDers(*rec, n);
+        result.assign(rec->ders.begin(), rec->ders.begin() + n + 1);
+    }
+
+public: // forwarded to the underlying basis
+
+    int domainDim() const { return m_basis.domainDim(); }
+    int targetDim() const { return m_basis.targetDim(); }
+    index_t size() const { return m_basis.size(); }
+    int degree(int i) const { return m_basis.degree(i); }
+    int maxDegree() const { return m_basis.maxDegree(); }
+    int minDegree() const { return m_basis.minDegree(); }
+    int totalDegree() const { return m_basis.totalDegree(); }
+    int numElements() const { return m_basis.numElements(); }
+    int numElements(boxSide const & s) const { return m_basis.numElements(s); }
+    int elementIndex(const gsVector<T> & u) const { return m_basis.elementIndex(u); }
+    T getMinCellLength() const { return m_basis.getMinCellLength(); }
+    T getMaxCellLength() const { return m_basis.getMaxCellLength(); }
+
+    void evalSingle_into(unsigned i, const gsMatrix<T> & u, gsMatrix<T>& result) const
+    { m_basis.evalSingle_into(i, u, result); }
+
+    void derivSingle_into(unsigned i, const gsMatrix<T> & u, gsMatrix<T>& result) const
+    { m_basis.derivSingle_into(i, u, result); }
+
+    void deriv2Single_into(unsigned i, const gsMatrix<T> & u, gsMatrix<T>& result) const
+    { m_basis.deriv2Single_into(i, u, result); }
+
+    void evalAllDersSingle_into(unsigned i, const gsMatrix<T> & u, int n,
+                                gsMatrix<T>& result) const
+    { m_basis.evalAllDersSingle_into(i, u, n, result); }
+
+    void evalDerSingle_into(unsigned i, const gsMatrix<T> & u, int n,
+                            gsMatrix<T>& result) const
+    { m_basis.evalDerSingle_into(i, u, n, result); }
+
+    void evalFuncOnGrid_into(const std::vector< gsVector<T> > & cwise,
+                             const gsMatrix<T> & coefs, gsMatrix<T>& result) const
+    { m_basis.evalFuncOnGrid_into(cwise, coefs, result); }
+
+    gsMatrix<T> * laplacian(const gsMatrix<T> & u) const { return m_basis.laplacian(u); }
+
+    void numActive_into(const gsMatrix<T> & u, gsVector<unsigned>& result) const
+    { m_basis.numActive_into(u, result); }
+
+    bool isActive(const unsigned i, const gsVector<T> & u) const
+    { return m_basis.isActive(i, u); }
+
+    gsMatrix<unsigned> allBoundary() const { return m_basis.allBoundary(); }
+
+    gsMatrix<unsigned> boundaryOffset(boxSide const & s, unsigned offset) const
+    { return m_basis.boundaryOffset(s, offset); }
+
+    unsigned functionAtCorner(boxCorner const & c) const { return m_basis.functionAtCorner(c); }
+
+    gsBasis<T> * boundaryBasis(boxSide const & s) const { return m_basis.boundaryBasis(s); }
+
+    gsMatrix<T> support() const { return m_basis.support(); }
+    gsMatrix<T> support(const unsigned & i) const { return m_basis.support(i); }
+
+    void anchors_into(gsMatrix<T>& result) const { m_basis.anchors_into(result); }
+    void anchor_into(unsigned i, gsMatrix<T>& result) const { m_basis.anchor_into(i, result); }
+
+    void connectivityAtAnchors(gsMesh<T> & mesh) const { m_basis.connectivityAtAnchors(mesh); }
+    void connectivity(const gsMatrix<T> & nodes, gsMesh<T> & mesh) const
+    { m_basis.connectivity(nodes, mesh); }
+
+    gsDomain<T> * domain() const { return m_basis.domain(); }
+
+    const gsBasis<T> & component(unsigned i) const { return m_basis.component(i); }
+    const gsBasis<T> & source() const { return m_basis.source(); }
+
+    domainIter makeDomainIterator() const { return m_basis.makeDomainIterator(); }
+    domainIter makeDomainIterator(const boxSide & s) const { return m_basis.makeDomainIterator(s); }
+
+    gsBasis<T> * clone() const { return m_basis.clone(); }
+    gsBasis<T> * create() const { return m_basis.create(); }
+    gsBasis<T> * makeNonRational() const { return m_basis.makeNonRational(); }
+    gsGeometry<T> * makeGeometry(gsMatrix<T> coefs) const
+    { return m_basis.makeGeometry(give(coefs)); }
+
+    std::ostream & print(std::ostream &os) const
+    { os << "Cached "; return m_basis.print(os); }
+
+    std::string detail() const { return "Cached " + m_basis.detail(); }
+
+private:
+
+    // Returns the record of the current element for the points u,
+    // or NULL if nothing can be cached
+    typename gsElementCache<T>::BasisRecord * record(const gsMatrix<T> & u) const
+    {
+        if ( NULL == m_elem )
+            return NULL;
+        std::vector<typename gsElementCache<T>::BasisRecord> & recs = m_elem->basis;
+        for (std::size_t i = 0; i != recs.size(); ++i)
+            if ( recs[i].points.cols() == u.cols() && recs[i].points == u )
+                return &recs[i];
+        if ( m_cache.full() )
+            return NULL;
+        recs.push_back( typename gsElementCache<T>::BasisRecord() );
+        recs.back().points = u;
+        m_cache.addMemory( sizeof(T) * u.size() );
+        return &recs.back();
+    }
+
+    void computeDers(typename gsElementCache<T>::BasisRecord & rec, int n) const
+    {
+        if ( static_cast<int>(rec.ders.size()) > n )
+            return;
+        for (std::size_t i = 0; i != rec.ders.size(); ++i)
+            m_cache.releaseMemory( sizeof(T) * rec.ders[i].size() );
+        m_basis.evalAllDers_into(rec.points, n, rec.ders);
+        for (std::size_t i = 0; i != rec.ders.size(); ++i)
+            m_cache.addMemory( sizeof(T) * rec.ders[i].size() );
+    }
+
+    void getDers(const gsMatrix<T> & u, int n, gsMatrix<T>& result) const
+    {
+        typename gsElementCache<T>::BasisRecord * rec = record(u);
+        if ( NULL == rec )
+        {
+            switch (n)
+            {
+            case 0 : m_basis.eval_into  (u, result); break;
+            case 1 : m_basis.deriv_into (u, result); break;
+            default: m_basis.deriv2_into(u, result); break;
+            }
+            return;
+        }
+        computeDers(*rec, n);
+        result = rec->ders[n];
+    }
+
+private:
+    const gsBasis<T> & m_basis;
+    gsElementCache<T> & m_cache;
+    typename gsElementCache<T>::Element * m_elem;
+};
+
+
+/**
+   @brief Geometry evaluator which forwards to another evaluator and
+   reuses the quantities stored for the current element of a
+   gsElementCache.
+
+   The stored quantities are not copied: they are swapped into this
+   evaluator for the accessors, and lent to the underlying evaluator
+   for the duration of each transformation.
+
+   \ingroup Assembler
+*/
+template <class T>
+class gsCachedGeometryEvaluator : public gsGeometryEvaluator<T>
+{
+public:
+    typedef gsGeometryEvaluator<T> Base;
+
+    gsCachedGeometryEvaluator(gsGeometryEvaluator<T> & geoEval, gsElementCache<T> & cache)
+    : Base(geoEval.geometry(), geoEval.getFlags()),
+      m_eval(geoEval), m_cache(cache), m_elem(NULL), m_held(NULL)
+    { }
+
+    ~gsCachedGeometryEvaluator() { release(); }
+
+    /// Sets the current element, or NULL for no caching
+    void setElement(typename gsElementCache<T>::Element * elem)
+    {
+        release();
+        m_elem = elem;
+    }
+
+    void setFlags(unsigned newFlags)
+    {
+        m_eval.setFlags(newFlags);
+        Base::setFlags(m_eval.getFlags());
+    }
+
+    void evaluateAt(const gsMatrix<T>& u)
+    {
+        release();
+
+        // Only the evaluation at the quadrature nodes is cached
+        const bool cacheable = NULL != m_elem &&
+            m_elem->quNodes.cols() == u.cols() && m_elem->quNodes == u;
+
+        if ( cacheable && 0 != m_elem->geo.numPts )
+        {
+            GISMO_ASSERT( (m_elem->geo.flags & this->m_flags) == this->m_flags,
+                          "Stored data lacks requested quantities");
+            hold(m_elem->geo);
+            return;
+        }
+
+        m_eval.evaluateAt(u);
+        if ( cacheable && ! m_cache.full() )
+        {
+            // The new quantities move to the cache
+            m_eval.swapData(m_elem->geo);
+            m_elem->geo.flags = m_eval.getFlags();
+            m_cache.addMemory( m_elem->geo.bytes() );
+            hold(m_elem->geo);
+        }
+        else
+        {
+            // The new quantities move to this evaluator
+            m_eval.swapData(m_tmp);
+            this->swapData(m_tmp);
+        }
+    }
+
+public: // forwarded to the underlying evaluator, on the data of this one
+
+    void transformGradients(index_t k, const gsMatrix<T>& allGrads, gsMatrix<T>& trfGradsK) const
+    { Lend l(*this); m_eval.transformGradients(k, allGrads, trfGradsK); }
+
+    void transformGradients(index_t k, const typename gsMatrix<T>::Block allGrads, gsMatrix<T>& trfGradsK) const
+    { Lend l(*this); m_eval.transformGradients(k, gsMatrix<T>(allGrads), trfGradsK); }
+
+    void transformAllGradients(const gsMatrix<T>& allGrads, gsMatrix<T>& result) const
+    { Lend l(*this); m_eval.transformAllGradients(allGrads, result); }
+
+    void transformValuesHdiv(index_t k, const std::vector<gsMatrix<T> >& allValues,
+                             gsMatrix<T> & result) const
+    { Lend l(*this); m_eval.transformValuesHdiv(k, allValues, result); }
+
+    void transformLaplaceHgrad(index_t k, const gsMatrix<T> & allGrads,
+                               const gsMatrix<T> & allHessians, gsMatrix<T> & result) const
+    { Lend l(*this); m_eval.transformLaplaceHgrad(k, allGrads, allHessians, result); }
+
+    void transformDeriv2Hgrad(index_t k, const gsMatrix<T> & allGrads,
+                              const gsMatrix<T> & allHessians, gsMatrix<T> & result) const
+    { Lend l(*this); m_eval.transformDeriv2Hgrad(k, allGrads, allHessians, result); }
+
+    void outerNormal(index_t k, boxSide s, gsVector<T> & result) const
+    { Lend l(*this); m_eval.outerNormal(k, s, result); }
+
+    void normal(index_t k, gsVector<T> & result) const
+    { Lend l(*this); m_eval.normal(k, result); }
+
+    void divergence(gsVector<T> & result) const
+    { Lend l(*this); m_eval.divergence(result); }
+
+private:
+
+    // Swaps the quantities stored in data into this evaluator
+    void hold(typename Base::Data & data)
+    {
+        this->swapData(data);
+        m_held = &data;
+    }
+
+    // Returns the held quantities to the cache
+    void release()
+    {
+        if ( NULL != m_held )
+        {
+            this->swapData(*m_held);
+            m_held = NULL;
+        }
+    }
+
+    // Moves the quantities of the evaluator to the underlying
+    // evaluator during its lifetime, by three swaps
+    struct Lend
+    {
+        explicit Lend(const gsCachedGeometryEvaluator & ev)
+        : m_ev(const_cast<gsCachedGeometryEvaluator&>(ev))
+        { exchange(); }
+
+        ~Lend() { exchange(); }
+
+        void exchange()
+        {
+            m_ev.swapData(m_ev.m_tmp);
+            m_ev.m_eval.swapData(m_ev.m_tmp);
+            m_ev.swapData(m_ev.m_tmp);
+        }
+
+        gsCachedGeometryEvaluator & m_ev;
+    };
+
+private:
+    gsGeometryEvaluator<T> & m_eval;
+    gsElementCache<T> & m_cache;
+    typename gsElementCache<T>::Element * m_elem;
+
+    // Cached quantities currently swapped into this evaluator
+    typename Base::Data * m_held;
+
+    // Exchange storage
+    typename Base::Data m_tmp;
+};
+
+
+} // namespace gismo
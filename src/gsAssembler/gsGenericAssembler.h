@@ -15,7 +15,8 @@
 
 #include <gsAssembler/gsAssembler.h>
 #include <gsAssembler/gsVisitorMass.h>
-//#include <gsAssembler/gsVisitorTPmass.h>
+#include <gsAssembler/gsVisitorTPmass.h>
+#include <gsAssembler/gsVisitorTPgradGrad.h>
 #include <gsAssembler/gsVisitorGradGrad.h>
 #include <gsAssembler/gsVisitorMoments.h>
 
@@ -102,14 +103,21 @@ public:
         return m_system.matrix();
     }
 
-    /// Mass assembly routine
+    /// Mass assembly routine using sum factorization on
+    /// tensor-product patches (see gsVisitorTPmass)
     const gsSparseMatrix<T> & assembleMass2()
     {
         // Clean the sparse system
         gsGenericAssembler::refresh();
+        const index_t nz = gsAssemblerOptions::numColNz(m_bases[0][0],2,1,0.333333);
+        m_system.matrix().reservePerColumn(nz);
         
-        //this->template push<gsVisitorTPmass<T> >();
+        // Assemble mass integrals
+        this->template push<gsVisitorTPmass<T> >();
+
+        // Assembly is done, compress the matrix
         this->finalize();
+
         return m_system.matrix();
     }
 
@@ -130,6 +138,24 @@ public:
         return m_system.matrix();
     }
 
+    /// Stiffness assembly routine using sum factorization on
+    /// tensor-product patches (see gsVisitorTPgradGrad)
+    const gsSparseMatrix<T> & assembleStiffness2()
+    {
+        // Clean the sparse system
+        gsGenericAssembler::refresh();
+        const index_t nz = gsAssemblerOptions::numColNz(m_bases[0][0],2,1,0.333333);
+        m_system.matrix().reservePerColumn(nz);
+
+        // Assemble stiffness integrals
+        this->template push<gsVisitorTPgradGrad<T> >();
+
+        // Assembly is done, compress the matrix
+        this->finalize();
+
+        return m_system.matrix();
+    }
+
     /// Moments assembly routine
     const gsMatrix<T> & assembleMoments(const gsFunction<T> & func)
     {
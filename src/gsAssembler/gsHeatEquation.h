@@ -215,6 +215,7 @@ void gsHeatEquation<T>::assembleMass()
     gsVisitorMass<T> mass;
     for (unsigned np=0; np < m_pde_ptr->domain().nPatches(); ++np )
     {
+        if ( ! this->isActivePatch(np) ) continue;
         //Assemble mass matrix for this patch
         this->apply(mass, np);
     }
@@ -0,0 +1,129 @@
+/** @file gsMatrixFreePoissonOp.h
+
+    @brief Matrix-free application of the Poisson (stiffness) operator
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <gsSolver/gsLinearOperator.h>
+#include <gsSolver/gsSimpleOps.h>
+#include <gsAssembler/gsAssembler.h>
+
+namespace gismo
+{
+
+/** @brief Applies the stiffness operator
+    \f[ (\nabla u,\nabla v)_\Omega \f]
+    on the free degrees of freedom without assembling a sparse matrix.
+
+    In every application the elements are visited one by one, the
+    physical gradients of the basis functions are computed at the
+    quadrature nodes and the input vector is multiplied directly by
+    the element contribution. Only the geometry, the basis and the
+    dof mapper are stored, hence the memory consumption does not
+    depend on the number of nonzeros of the matrix.
+
+    The eliminated (Dirichlet) degrees of freedom are skipped, so that
+    the operator coincides with the matrix of gsPoissonAssembler (with
+    elimination and without Neumann/Nitsche terms).
+
+    The diagonal of the operator is computed element-wise as well, and
+    can be used for a Jacobi preconditioner, see jacobiOp().
+
+    The geometry, the basis and the mapper are kept by reference and
+    must outlive the operator.
+
+    Example:
+    \code
+    gsMatrixFreePoissonOp<real_t> op(assembler);
+    gsLinearOperator<real_t>::Ptr opPtr = memory::make_shared_not_owned(&op);
+    gsLinearOperator<real_t>::Ptr prec(op.jacobiOp());
+    gsConjugateGradient cg(opPtr, prec);
+    cg.solve(assembler.rhs(), x);
+    \endcode
+
+    \ingroup Assembler
+*/
+template <class T>
+class gsMatrixFreePoissonOp : public gsLinearOperator<T>
+{
+public:
+    /// Shared pointer for gsMatrixFreePoissonOp
+    typedef memory::shared_ptr<gsMatrixFreePoissonOp> Ptr;
+
+    /// Unique pointer for gsMatrixFreePoissonOp
+    typedef memory::unique_ptr<gsMatrixFreePoissonOp> uPtr;
+
+public:
+
+    /// @brief Constructor from the geometry \a patches, the
+    /// discretization \a bases and the \a mapper of the degrees of
+    /// freedom. The quadrature is chosen by the options "quA" and
+    /// "quB", see gsAssembler::defaultOptions().
+    gsMatrixFreePoissonOp(const gsMultiPatch<T> & patches,
+                          const gsMultiBasis<T> & bases,
+                          const gsDofMapper     & mapper,
+                          const gsOptionList    & opt = gsAssembler<T>::defaultOptions())
+    : m_patches(patches), m_bases(bases), m_mapper(mapper), m_options(opt)
+    { }
+
+    /// @brief Constructor using the geometry, the first basis, the
+    /// column mapper and the options of \a assembler
+    explicit gsMatrixFreePoissonOp(const gsAssembler<T> & assembler)
+    : m_patches(assembler.patches()), m_bases(assembler.multiBasis(0)),
+      m_mapper(assembler.system().colMapper(0)), m_options(assembler.options())
+    { }
+
+    static uPtr make(const gsMultiPatch<T> & patches,
+                     const gsMultiBasis<T> & bases,
+                     const gsDofMapper     & mapper,
+                     const gsOptionList    & opt = gsAssembler<T>::defaultOptions())
+    { return memory::make_unique( new gsMatrixFreePoissonOp(patches, bases, mapper, opt) ); }
+
+    static uPtr make(const gsAssembler<T> & assembler)
+    { return memory::make_unique( new gsMatrixFreePoissonOp(assembler) ); }
+
+public:
+
+    /// Computes \a x = A * \a input element by element
+    void apply(const gsMatrix<T> & input, gsMatrix<T> & x) const;
+
+    /// Computes the diagonal of the operator without assembling it
+    void diagonal(gsMatrix<T> & result) const;
+
+    /// @brief Returns a Jacobi preconditioner for this operator. The
+    /// diagonal is computed by diagonal() and stored in the returned
+    /// operator.
+    typename gsJacobiOp<gsSparseMatrix<T> >::uPtr jacobiOp() const;
+
+    index_t rows() const { return m_mapper.freeSize(); }
+    index_t cols() const { return m_mapper.freeSize(); }
+
+private:
+
+    /// Loops over all elements and adds to \a result either the
+    /// product with \a input or, if \a input is NULL, the diagonal
+    void elementLoop(const gsMatrix<T> * input, gsMatrix<T> & result) const;
+
+private:
+
+    const gsMultiPatch<T> & m_patches;
+
+    const gsMultiBasis<T> & m_bases;
+
+    const gsDofMapper & m_mapper;
+
+    gsOptionList m_options;
+};
+
+} // namespace gismo
+
+#ifndef GISMO_BUILD_LIB
+#include GISMO_HPP_HEADER(gsMatrixFreePoissonOp.hpp)
+#endif
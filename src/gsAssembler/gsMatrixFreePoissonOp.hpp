@@ -0,0 +1,126 @@
+/** @file gsMatrixFreePoissonOp.hpp
+
+    @brief Matrix-free application of the Poisson (stiffness) operator
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <gsAssembler/gsGaussRule.h>
+#include <gsCore/gsGeometryEvaluator.h>
+
+namespace gismo
+{
+
+template <class T>
+void gsMatrixFreePoissonOp<T>::apply(const gsMatrix<T> & input, gsMatrix<T> & x) const
+{
+    GISMO_ASSERT( input.rows() == cols(), "Wrong input size");
+    x.setZero(rows(), input.cols());
+    elementLoop(&input, x);
+}
+
+template <class T>
+void gsMatrixFreePoissonOp<T>::diagonal(gsMatrix<T> & result) const
+{
+    result.setZero(rows(), 1);
+    elementLoop(NULL, result);
+}
+
+template <class T>
+typename gsJacobiOp<gsSparseMatrix<T> >::uPtr gsMatrixFreePoissonOp<T>::jacobiOp() const
+{
+    gsMatrix<T> diag;
+    diagonal(diag);
+
+    // Diagonal matrix, i.e. one nonzero per column
+    typename gsSparseMatrix<T>::Ptr dmat(new gsSparseMatrix<T>(rows(), cols()));
+    dmat->reserve( gsVector<index_t>::Ones(cols()) );
+    for (index_t i = 0; i != diag.rows(); ++i)
+        dmat->insert(i, i) = diag(i, 0);
+    dmat->makeCompressed();
+
+    return gsJacobiOp<gsSparseMatrix<T> >::make(dmat);
+}
+
+template <class T>
+void gsMatrixFreePoissonOp<T>::elementLoop(const gsMatrix<T> * input,
+                                           gsMatrix<T> & result) const
+{
+    const unsigned evFlags = NEED_MEASURE | NEED_GRAD_TRANSFORM;
+
+    gsMatrix<T> quNodes, bGrads, physGrads, locIn, locGrads, locOut;
+    gsVector<T> quWeights;
+    gsMatrix<unsigned> actives;
+
+    for (size_t np = 0; np != m_patches.nPatches(); ++np)
+    {
+        const gsBasis<T> & basis = m_bases[np];
+
+        // Reference quadrature rule for this patch
+        gsGaussRule<T> QuRule(basis, m_options);
+
+        typename gsGeometry<T>::Evaluator geoEval(m_patches[np].evaluator(evFlags));
+
+        typename gsBasis<T>::domainIter domIt = basis.makeDomainIterator();
+        for (; domIt->good(); domIt->next() )
+        {
+            QuRule.mapTo( domIt->lowerCorner(), domIt->upperCorner(), quNodes, quWeights );
+
+            basis.active_into(quNodes.col(0), actives);
+            basis.deriv_into(quNodes, bGrads);
+            geoEval->evaluateAt(quNodes);
+
+            // Physical gradients as a (Dim*NumNodes) x NumActive matrix
+            geoEval->transformAllGradients(bGrads, physGrads);
+            const index_t numAct = actives.rows();
+            const index_t dim    = physGrads.rows() / quWeights.rows();
+            quWeights.array() *= geoEval->measures().array();
+
+            m_mapper.localToGlobal(actives, np, actives);
+
+            if ( NULL == input ) // diagonal
+            {
+                for (index_t i = 0; i != numAct; ++i)
+                {
+                    const index_t ii = actives(i,0);
+                    if ( m_mapper.is_free_index(ii) )
+                        for (index_t k = 0; k != quWeights.rows(); ++k)
+                            result(ii, 0) += quWeights[k] *
+                                physGrads.col(i).segment(k*dim, dim).squaredNorm();
+                }
+                continue;
+            }
+
+            // Gather the local coefficients
+            locIn.setZero(numAct, input->cols());
+            for (index_t i = 0; i != numAct; ++i)
+            {
+                const index_t ii = actives(i,0);
+                if ( m_mapper.is_free_index(ii) )
+                    locIn.row(i) = input->row(ii);
+            }
+
+            // Weighted gradients of the local function at the nodes
+            locGrads.noalias() = physGrads * locIn;
+            for (index_t k = 0; k != quWeights.rows(); ++k)
+                locGrads.middleRows(k*dim, dim) *= quWeights[k];
+
+            // Test against all local gradients and scatter
+            locOut.noalias() = physGrads.transpose() * locGrads;
+            for (index_t i = 0; i != numAct; ++i)
+            {
+                const index_t ii = actives(i,0);
+                if ( m_mapper.is_free_index(ii) )
+                    result.row(ii) += locOut.row(i);
+            }
+        }
+    }
+}
+
+} // namespace gismo
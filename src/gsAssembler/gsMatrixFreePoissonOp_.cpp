@@ -0,0 +1,9 @@
+#include <gsCore/gsTemplateTools.h>
+
+#include <gsAssembler/gsMatrixFreePoissonOp.h>
+#include <gsAssembler/gsMatrixFreePoissonOp.hpp>
+
+namespace gismo
+{
+    CLASS_TEMPLATE_INST gsMatrixFreePoissonOp<real_t>;
+}
@@ -101,6 +101,10 @@ public:
     /// \brief Dimension of the rule
     index_t dim() const { return m_nodes.rows(); }
 
+    /// \brief Number of nodes per direction if the rule is a tensor
+    /// product of univariate rules, otherwise empty
+    const gsVector<index_t> & numNodesPerDir() const { return m_numNodes; }
+
 
     /**\brief Maps quadrature rule (i.e., points and weights) from the
      * reference domain to an element.
@@ -154,6 +158,9 @@ protected:
     /// [-1,1]).
     gsVector<T> m_weights;
 
+    /// \brief Number of nodes per direction of a tensor-product rule
+    gsVector<index_t> m_numNodes;
+
 }; // class gsQuadRule
 
 
@@ -79,11 +79,11 @@ gsQuadRule<T>::computeTensorProductRule(const std::vector<gsVector<T> > & nodes,
     // compute the tensor quadrature rule
     gsPointGrid(nodes, m_nodes);
     
-    gsVector<index_t> numNodes(d);
+    m_numNodes.resize(d);
     for( int i=0; i<d; ++i )
-        numNodes[i] = weights[i].rows();
+        m_numNodes[i] = weights[i].rows();
 
-    GISMO_ASSERT( m_nodes.cols() == numNodes.prod(), 
+    GISMO_ASSERT( m_nodes.cols() == m_numNodes.prod(), 
                   "Inconsistent sizes in nodes and weights.");
     
     // Compute weight products
@@ -96,7 +96,7 @@ gsQuadRule<T>::computeTensorProductRule(const std::vector<gsVector<T> > & nodes,
         for (int i=1; i<d; ++i)
             m_weights[r] *= weights[i][curr[i]];
         ++r;
-    } while (nextLexicographic(curr, numNodes));
+    } while (nextLexicographic(curr, m_numNodes));
 }
 
 
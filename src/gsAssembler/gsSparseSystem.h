@@ -76,10 +76,50 @@ protected:
     /// uses multibasis m_cvar[i]. So this allows e.g. a single multibasis for several components.
     gsVector<index_t> m_cvar;
 
+    /// @brief column offsets of the precomputed sparsity pattern of
+    /// the matrix, in compressed column storage. Empty if no pattern
+    /// was computed, see computePattern()
+    std::vector<index_t> m_ptrnOuter;
+
+    /// @brief row indices of the precomputed sparsity pattern of the
+    /// matrix, in compressed column storage
+    std::vector<index_t> m_ptrnInner;
+
+    /// @brief number of the first element of every patch in the
+    /// element tables below, -1 for patches without pattern. The last
+    /// entry is the total number of elements
+    std::vector<index_t> m_ptrnPatch;
+
+    /// @brief start of the mapped active functions of element \a e
+    /// and block \a b in \a m_ptrnRowActs and \a m_ptrnColActs, at
+    /// position e*nb+b
+    std::vector<index_t> m_ptrnActStart;
+
+    /// @brief active functions (without shifts) of all elements and
+    /// row blocks, mapped by the row mappers
+    std::vector<unsigned> m_ptrnRowActs;
+
+    /// @brief active functions (without shifts) of all elements and
+    /// column blocks, mapped by the column mappers
+    std::vector<unsigned> m_ptrnColActs;
+
+    /// @brief start of the offsets of element \a e and block pair
+    /// (\a r,\a c) in \a m_ptrnOffs, at position (e*nb+r)*nb+c
+    std::vector<index_t> m_ptrnOffStart;
+
+    /// @brief offsets of the local matrix entries into the values of
+    /// the compressed matrix, row by row for every element and block
+    /// pair; -1 for entries which are not stored
+    std::vector<index_t> m_ptrnOffs;
+
+    /// @brief element currently assembled, index into the element
+    /// tables, or -1, see setElement()
+    index_t m_ptrnElement;
+
 
 public:
 
-    gsSparseSystem()
+    gsSparseSystem() : m_ptrnElement(-1)
     { }
 
     /**
@@ -93,7 +133,8 @@ public:
           m_col    (1),
           m_rstr   (1),
           m_cstr   (1),
-          m_cvar   (1)
+          m_cvar   (1),
+          m_ptrnElement(-1)
     {
         m_row [0] =  m_col [0] =
                 m_rstr[0] =  m_cstr[0] =
@@ -137,7 +178,8 @@ public:
         : m_row(dims.sum()),
           m_col(dims.sum()),
           m_rstr(dims.sum()),
-          m_cstr(dims.sum())
+          m_cstr(dims.sum()),
+          m_ptrnElement(-1)
     {
         const index_t d = dims.size();
         const index_t s = dims.sum();
@@ -203,7 +245,8 @@ public:
         : m_row (gsVector<size_t>::LinSpaced(rows,0,rows-1)),
           m_col (gsVector<size_t>::LinSpaced(cols,0,cols-1)),
           m_rstr(rows),
-          m_cstr(cols)
+          m_cstr(cols),
+          m_ptrnElement(-1)
     {
         GISMO_ASSERT( rows > 0 && cols > 0, "Block dimensions must be positive");
 
@@ -271,7 +314,8 @@ public:
         : m_row (rowInd),
           m_col (colInd),
           m_rstr((index_t)rowInd.size()),
-          m_cstr((index_t)colInd.size())
+          m_cstr((index_t)colInd.size()),
+          m_ptrnElement(-1)
         // ,m_cvar(colvar) //<< Bug
     {
         m_cvar = colvar;
@@ -306,6 +350,15 @@ public:
         m_rstr   .swap(other.m_rstr   );
         m_cstr   .swap(other.m_cstr   );
         m_cvar   .swap(other.m_cvar   );
+        m_ptrnOuter.swap(other.m_ptrnOuter);
+        m_ptrnInner.swap(other.m_ptrnInner);
+        m_ptrnPatch.swap(other.m_ptrnPatch);
+        m_ptrnActStart.swap(other.m_ptrnActStart);
+        m_ptrnRowActs.swap(other.m_ptrnRowActs);
+        m_ptrnColActs.swap(other.m_ptrnColActs);
+        m_ptrnOffStart.swap(other.m_ptrnOffStart);
+        m_ptrnOffs.swap(other.m_ptrnOffs);
+        std::swap(m_ptrnElement, other.m_ptrnElement);
     }
     
     /**
@@ -318,7 +371,10 @@ public:
         GISMO_ASSERT( 0 != m_mappers.size(), "Sparse system was not initialized");
         if ( 0 != m_matrix.cols() )
         {
-            m_matrix.reservePerColumn(nz);
+            if ( hasPattern() )
+                resetToPattern();
+            else
+                m_matrix.reservePerColumn(nz);
             if ( 0 != numRhs )
                 m_rhs.setZero(m_matrix.cols(), numRhs);
         }
@@ -358,13 +414,215 @@ public:
         return cast<T,index_t>(nz*(1.0+bdO));
     }
 
-    /// @brief set everything to zero
+    /// @brief set everything to zero. If a sparsity pattern was
+    /// computed, the matrix keeps this pattern with zero values
     void setZero()
     {
-        m_matrix.setZero();
+        if ( hasPattern() )
+            resetToPattern();
+        else
+            m_matrix.setZero();
         m_rhs   .setZero();
     }
 
+    /**
+     * @brief Computes the exact sparsity pattern of the system matrix
+     * (symbolic phase).
+     *
+     * The pattern is deduced from the dof mappers and the active
+     * basis functions on the elements of  bases, and the matrix is
+     * allocated with exactly these non-zero entries, stored in
+     * compressed form. Afterwards, assembling only writes into the
+     * existing entries (numeric phase): reserve() and setZero() only
+     * reset the values to zero and keep the pattern, so that
+     * re-assembly (eg. in Newton iterations or time stepping) never
+     * rebuilds the matrix structure.
+     *
+     * For every element the offsets of its local matrix entries into
+     * the values of the compressed matrix are stored as well. When
+     * the element is selected with setElement(), push() adds the
+     * local matrix through these offsets, without searching the
+     * matrix. Contributions outside the pattern (eg. from DG interface
+     * terms) are still accepted, they are inserted into the matrix as
+     * usual.
+     *
+     * It is assumed that row block \a i uses the same basis as column
+     * block \a i (Galerkin setting); their dof mappers may differ, the
+     * actives are mapped and stored separately for rows and columns.
+     * The pattern is discarded when a new system is constructed,
+     * eg. after refinement.
+     *
+     * @param[in] bases the multi-bases of the unknowns, indexed as
+     * given by colBasis()
+     * @param[in] patches if not empty, only the elements of the
+     * patches \a k with patches[k] true are taken into account (see
+     * gsAssembler::restrictToPatches())
+     */
+    void computePattern(const std::vector<gsMultiBasis<T> > & bases,
+                        const std::vector<bool> & patches = std::vector<bool>())
+    {
+        GISMO_ASSERT( 0 != m_mappers.size(), "Sparse system was not initialized");
+        GISMO_ASSERT( m_row.size() == m_col.size(),
+                      "The pattern can be computed only for square block structure");
+
+        const index_t nb = m_col.size();
+        const gsMultiBasis<T> & mb = bases[m_cvar[0]];
+
+        // Sorted row indices of every column
+        std::vector<std::vector<index_t> > colRows(m_matrix.cols());
+
+        gsMatrix<unsigned> act;
+        std::vector<gsMatrix<unsigned> > ract(nb), cact(nb);
+        std::vector<index_t>::iterator pos;
+
+        m_ptrnPatch.assign(mb.nBases() + 1, -1);
+        m_ptrnActStart.clear();
+        m_ptrnRowActs.clear();
+        m_ptrnColActs.clear();
+        index_t numEl = 0;
+
+        for (size_t k = 0; k != mb.nBases(); ++k) // for all patches
+        {
+            if ( ! patches.empty() && ! patches[k] ) continue;
+            m_ptrnPatch[k] = numEl;
+            typename gsBasis<T>::domainIter domIt = mb[k].makeDomainIterator();
+            for (; domIt->good(); domIt->next(), ++numEl ) // for all elements
+            {
+                for (index_t c = 0; c != nb; ++c)
+                {
+                    bases[m_cvar[c]][k].active_into(domIt->centerPoint(), act);
+                    m_mappers[m_row[c]].localToGlobal(act, k, ract[c]);
+                    m_mappers[m_col[c]].localToGlobal(act, k, cact[c]);
+                    // Keep the actives as push() receives them
+                    m_ptrnActStart.push_back(m_ptrnColActs.size());
+                    m_ptrnRowActs.insert(m_ptrnRowActs.end(), ract[c].data(),
+                                         ract[c].data() + ract[c].rows());
+                    m_ptrnColActs.insert(m_ptrnColActs.end(), cact[c].data(),
+                                         cact[c].data() + cact[c].rows());
+                }
+
+                for (index_t r = 0; r != nb; ++r)
+                    for (index_t c = 0; c != nb; ++c)
+                    {
+                        const gsDofMapper & rowMap = m_mappers[m_row[r]];
+                        const gsDofMapper & colMap = m_mappers[m_col[c]];
+                        for (index_t j = 0; j != cact[c].rows(); ++j)
+                        {
+                            if ( ! colMap.is_free_index(cact[c].at(j)) ) continue;
+                            const index_t jj = m_cstr[c] + cact[c].at(j);
+                            std::vector<index_t> & rows = colRows[jj];
+
+                            for (index_t i = 0; i != ract[r].rows(); ++i)
+                            {
+                                if ( ! rowMap.is_free_index(ract[r].at(i)) ) continue;
+                                const index_t ii = m_rstr[r] + ract[r].at(i);
+                                // If matrix is symmetric, we store only lower
+                                // triangular part
+                                if ( symm && jj > ii ) continue;
+                                pos = std::lower_bound(rows.begin(), rows.end(), ii);
+                                if ( pos == rows.end() || *pos != ii )
+                                    rows.insert(pos, ii);
+                            }
+                        }
+                    }
+            }
+        }
+
+        // Store the pattern in compressed column storage
+        m_ptrnOuter.resize(colRows.size() + 1);
+        m_ptrnOuter[0] = 0;
+        for (size_t j = 0; j != colRows.size(); ++j)
+            m_ptrnOuter[j+1] = m_ptrnOuter[j] + colRows[j].size();
+
+        m_ptrnInner.resize(m_ptrnOuter.back());
+        for (size_t j = 0; j != colRows.size(); ++j)
+            std::copy(colRows[j].begin(), colRows[j].end(),
+                      m_ptrnInner.begin() + m_ptrnOuter[j]);
+        m_ptrnPatch.back() = numEl;
+        m_ptrnActStart.push_back(m_ptrnColActs.size());
+
+        // Offsets of the local matrix entries of every element, as
+        // push() writes them: row ii and column jj are the shifted
+        // actives of the row and column block
+        m_ptrnOffStart.clear();
+        m_ptrnOffs.clear();
+        const index_t * inner = m_ptrnInner.empty() ? NULL : &m_ptrnInner.front();
+        for (index_t e = 0; e != numEl; ++e)
+            for (index_t r = 0; r != nb; ++r)
+                for (index_t c = 0; c != nb; ++c)
+                {
+                    m_ptrnOffStart.push_back(m_ptrnOffs.size());
+                    const index_t rb = m_ptrnActStart[e*nb+r], re = m_ptrnActStart[e*nb+r+1];
+                    const index_t cb = m_ptrnActStart[e*nb+c], ce = m_ptrnActStart[e*nb+c+1];
+                    for (index_t i = rb; i != re; ++i)
+                    {
+                        const index_t ii = m_rstr[r] + m_ptrnRowActs[i];
+                        for (index_t j = cb; j != ce; ++j)
+                        {
+                            const index_t jj = m_cstr[c] + m_ptrnColActs[j];
+                            index_t off = -1;
+                            if ( ii < m_matrix.rows() && jj < m_matrix.cols() )
+                            {
+                                const index_t * beg = inner + m_ptrnOuter[jj];
+                                const index_t * end = inner + m_ptrnOuter[jj+1];
+                                const index_t * p   = std::lower_bound(beg, end, ii);
+                                if ( p != end && *p == ii )
+                                    off = p - inner;
+                            }
+                            m_ptrnOffs.push_back(off);
+                        }
+                    }
+                }
+        m_ptrnOffStart.push_back(m_ptrnOffs.size());
+        m_ptrnElement = -1;
+
+        resetToPattern();
+    }
+
+    /**
+     * @brief Selects the element whose local matrix is pushed next.
+     *
+     * If a pattern was computed, the local matrices of element \a el
+     * of patch \a patch (in the order of the domain iterator) are
+     * added through the offsets stored by computePattern(). The
+     * actives given to push() are compared with the stored ones, a
+     * wrong or missing selection only falls back to searching the
+     * entries. Use a negative \a el to unselect the element, eg. for
+     * boundary and interface contributions.
+     */
+    void setElement(const index_t patch, const index_t el)
+    {
+        m_ptrnElement = -1;
+        if ( el < 0 || patch < 0 ||
+             patch + 1 >= static_cast<index_t>(m_ptrnPatch.size()) ||
+             -1 == m_ptrnPatch[patch] )
+            return;
+        const index_t e = m_ptrnPatch[patch] + el;
+        // The next patch with a pattern starts after this one
+        index_t next = patch + 1;
+        while ( -1 == m_ptrnPatch[next] ) ++next;
+        if ( e < m_ptrnPatch[next] )
+            m_ptrnElement = e;
+    }
+
+    /// @brief Returns true if the sparsity pattern of the matrix was
+    /// computed, see computePattern()
+    bool hasPattern() const { return !m_ptrnOuter.empty(); }
+
+    /// @brief Discards the precomputed sparsity pattern
+    void clearPattern()
+    {
+        m_ptrnOuter.clear();
+        m_ptrnInner.clear();
+        m_ptrnPatch.clear();
+        m_ptrnActStart.clear();
+        m_ptrnRowActs.clear();
+        m_ptrnColActs.clear();
+        m_ptrnOffStart.clear();
+        m_ptrnOffs.clear();
+        m_ptrnElement = -1;
+    }
+
     /// @brief the number of matrix columns
     index_t cols() const { return m_matrix.cols(); }
 
@@ -622,6 +880,7 @@ public: /* Add local contributions to system matrix */
                       const size_t r = 0, const size_t c = 0)
     {
         const index_t numActive = actives.rows();
+        const index_t * offs = elementOffsets(actives, actives, r, c);
         const gsDofMapper & rowMap = m_mappers[m_row.at(r)];
         GISMO_ASSERT( &rowMap == &m_mappers[m_col.at(c)], "Error");
 
@@ -640,7 +899,7 @@ public: /* Add local contributions to system matrix */
                         // If matrix is symmetric, we store only lower
                         // triangular part
                         if ( (!symm) || jj <= ii )
-                            m_matrix.coeffRef(ii, jj) += localMat(i, j);
+                            entry(offs, i*numActive+j, ii, jj) += localMat(i, j);
                     }
                     else if(0!=eliminatedDofs.size())
                     {
@@ -674,6 +933,7 @@ public: /* Add local contributions to system matrix */
     {
         const index_t numActive_i = actives_i.rows();
         const index_t numActive_j = actives_j.rows();
+        const index_t * offs = elementOffsets(actives_i, actives_j, r, c);
 
         const gsDofMapper & rowMap = m_mappers[m_row.at(r)];
         const gsDofMapper & colMap = m_mappers[m_col.at(c)];
@@ -693,7 +953,7 @@ public: /* Add local contributions to system matrix */
                         // If matrix is symmetric, we store only lower
                         // triangular part
                         if ( (!symm) || jj <= ii )
-                            m_matrix.coeffRef(ii, jj) += localMat(i, j);
+                            entry(offs, i*numActive_j+j, ii, jj) += localMat(i, j);
                     }
                     else
                     {
@@ -722,6 +982,7 @@ public: /* Add local contributions to system matrix */
                              const size_t r = 0, const size_t c = 0)
     {
         const index_t numActive = actives.rows();
+        const index_t * offs = elementOffsets(actives, actives, r, c);
         GISMO_ASSERT( &m_mappers[m_row.at(r)] == &m_mappers[m_col.at(c)], "Error");
 
         for (index_t i = 0; i != numActive; ++i)
@@ -735,7 +996,7 @@ public: /* Add local contributions to system matrix */
                 // If matrix is symmetric, we store only lower
                 // triangular part
                 if ( (!symm) || jj <= ii )
-                    m_matrix.coeffRef(ii, jj) += localMat(i, j);
+                    entry(offs, i*numActive+j, ii, jj) += localMat(i, j);
 
 
             }
@@ -761,6 +1022,7 @@ public: /* Add local contributions to system matrix */
     {
         const index_t numActive_i = actives_i.rows();
         const index_t numActive_j = actives_j.rows();
+        const index_t * offs = elementOffsets(actives_i, actives_j, r, c);
 
         for (index_t i = 0; i != numActive_i; ++i)
         {
@@ -773,7 +1035,7 @@ public: /* Add local contributions to system matrix */
                 // If matrix is symmetric, we store only lower
                 // triangular part
                 if ( (!symm) || jj <= ii )
-                    m_matrix.coeffRef(ii, jj) += localMat(i, j);
+                    entry(offs, i*numActive_j+j, ii, jj) += localMat(i, j);
             }
         }
     }
@@ -846,6 +1108,7 @@ public: /* Add local contributions to system matrix and right-hand side */
               const size_t r = 0, const size_t c = 0)
     {
         const index_t numActive = actives.rows();
+        const index_t * offs = elementOffsets(actives, actives, r, c);
         const gsDofMapper & rowMap = m_mappers[m_row.at(r)];
 
         GISMO_ASSERT( &rowMap == &m_mappers[m_col.at(c)], "Error");
@@ -867,7 +1130,7 @@ public: /* Add local contributions to system matrix and right-hand side */
                         // If matrix is symmetric, we store only lower
                         // triangular part
                         if ( (!symm) || jj <= ii )
-                            m_matrix.coeffRef(ii, jj) += localMat(i, j);
+                            entry(offs, i*numActive+j, ii, jj) += localMat(i, j);
                     }
                     else // if ( mapper.is_boundary_index(jj) ) // Fixed DoF?
                     {
@@ -901,6 +1164,7 @@ public: /* Add local contributions to system matrix and right-hand side */
     {
         const index_t numActive_i = actives_i.rows();
         const index_t numActive_j = actives_j.rows();
+        const index_t * offs = elementOffsets(actives_i, actives_j, r, c);
         const gsDofMapper & rowMap = m_mappers[m_row.at(r)];
         const gsDofMapper & colMap = m_mappers[m_col.at(c)];
 
@@ -922,7 +1186,7 @@ public: /* Add local contributions to system matrix and right-hand side */
                         // If matrix is symmetric, we store only lower
                         // triangular part
                         if ( (!symm) || jj <= ii )
-                            m_matrix.coeffRef(ii, jj) += localMat(i, j);
+                            entry(offs, i*numActive_j+j, ii, jj) += localMat(i, j);
                     }
                     else // if ( mapper.is_boundary_index(jj) ) // Fixed DoF?
                     {
@@ -1016,7 +1280,7 @@ public: /* Add local contributions to system matrix and right-hand side */
                                 // If matrix is symmetric, we store only lower
                                 // triangular part
                                 if ( (!symm) || jj <= ii )
-                                    m_matrix.coeffRef(ii, jj) += localMat(i, j); //  + c * ..
+                                    entry(ii, jj) += localMat(i, j); //  + c * ..
                             }
                             else // if ( mapper.is_boundary_index(jj) ) // Fixed DoF?
                             {
@@ -1076,6 +1340,7 @@ public: /* Add local contributions to system matrix and right-hand side */
                       const size_t r = 0, const size_t c = 0)
     {
         const index_t numActive = actives.rows();
+        const index_t * offs = elementOffsets(actives, actives, r, c);
         const gsDofMapper & rowMap = m_mappers[m_row.at(r)];
         GISMO_ASSERT( &rowMap == &m_mappers[m_col.at(c)], "Error");
 
@@ -1093,7 +1358,7 @@ public: /* Add local contributions to system matrix and right-hand side */
                         // If matrix is symmetric, we store only lower
                         // triangular part
                         if ( (!symm) || jj <= ii )
-                            m_matrix.coeffRef(ii, jj) += localMat(i, j);
+                            entry(offs, i*numActive+j, ii, jj) += localMat(i, j);
                 }
             }
         }
@@ -1121,6 +1386,7 @@ public: /* Add local contributions to system matrix and right-hand side */
     {
         const index_t numActive_i = actives_i.rows();
         const index_t numActive_j = actives_j.rows();
+        const index_t * offs = elementOffsets(actives_i, actives_j, r, c);
 
         const gsDofMapper & rowMap = m_mappers[m_row.at(r)];
         const gsDofMapper & colMap = m_mappers[m_col.at(c)];
@@ -1139,7 +1405,7 @@ public: /* Add local contributions to system matrix and right-hand side */
                         // If matrix is symmetric, we store only lower
                         // triangular part
                         if ( (!symm) || jj <= ii )
-                            m_matrix.coeffRef(ii, jj) += localMat(i, j);
+                            entry(offs, i*numActive_j+j, ii, jj) += localMat(i, j);
                 }
             }
         }
@@ -1165,6 +1431,7 @@ public: /* Add local contributions to system matrix and right-hand side */
         GISMO_ASSERT( m_matrix.cols() == m_rhs.rows(), "gsSparseSystem is not allocated");
         
         const index_t numActive = actives.rows();
+        const index_t * offs = elementOffsets(actives, actives, r, c);
         const gsDofMapper & rowMap = m_mappers[m_row.at(r)];
         GISMO_ASSERT( &rowMap == &m_mappers[m_col.at(c)], "Error");
 
@@ -1183,7 +1450,7 @@ public: /* Add local contributions to system matrix and right-hand side */
                         // If matrix is symmetric, we store only lower
                         // triangular part
                         if ( (!symm) || jj <= ii )
-                            m_matrix.coeffRef(ii, jj) += localMat(i, j);
+                            entry(offs, i*numActive+j, ii, jj) += localMat(i, j);
                     }
                 }
             }
@@ -1193,6 +1460,82 @@ public: /* Add local contributions to system matrix and right-hand side */
 
 
 
+private:
+
+    /// @brief Sets the matrix to the precomputed sparsity pattern,
+    /// with all values equal to zero
+    void resetToPattern()
+    {
+        const index_t nnz = m_ptrnInner.size();
+        if ( m_matrix.isCompressed() && m_matrix.nonZeros() == nnz &&
+             std::equal(m_ptrnOuter.begin(), m_ptrnOuter.end(), m_matrix.outerIndexPtr()) )
+        {
+            // Structure is intact, only reset the values
+            m_matrix.coeffs().setZero();
+            return;
+        }
+
+        const index_t nr = m_matrix.rows(), nc = m_matrix.cols();
+        m_matrix.resize(nr, nc); // (!) clears the matrix
+        m_matrix.resizeNonZeros(nnz);
+        std::copy(m_ptrnOuter.begin(), m_ptrnOuter.end(), m_matrix.outerIndexPtr());
+        std::copy(m_ptrnInner.begin(), m_ptrnInner.end(), m_matrix.innerIndexPtr());
+        m_matrix.coeffs().setZero();
+    }
+
+    /// @brief Returns a reference to the matrix entry (ii,jj). If the
+    /// matrix is compressed, the entry is searched for in the
+    /// existing structure of column \a jj, without any insertion or
+    /// reallocation. Otherwise (or if the entry does not exist) it
+    /// falls back to coeffRef.
+    inline T & entry(const index_t ii, const index_t jj)
+    {
+        if ( m_matrix.isCompressed() )
+        {
+            const index_t * inner = m_matrix.innerIndexPtr();
+            const index_t * beg   = inner + m_matrix.outerIndexPtr()[jj];
+            const index_t * end   = inner + m_matrix.outerIndexPtr()[jj+1];
+            const index_t * p     = std::lower_bound(beg, end, ii);
+            if ( p != end && *p == ii )
+                return m_matrix.valuePtr()[p - inner];
+        }
+        return m_matrix.coeffRef(ii, jj);
+    }
+
+    /// @brief Returns a reference to the matrix entry (ii,jj), which
+    /// is entry \a k of the local matrix. Uses the precomputed
+    /// offset \a offs[k] if available, see elementOffsets().
+    inline T & entry(const index_t * offs, const index_t k,
+                     const index_t ii, const index_t jj)
+    {
+        return ( offs && offs[k] >= 0 ) ? m_matrix.valuePtr()[offs[k]] : entry(ii, jj);
+    }
+
+    /// @brief Returns the offsets into the matrix values of the
+    /// local matrix of the selected element for the block (r,c), or
+    /// NULL if no element is selected, the actives differ from the
+    /// ones of the pattern or the matrix structure is not the pattern
+    const index_t * elementOffsets(const gsMatrix<unsigned> & actives_i,
+                                   const gsMatrix<unsigned> & actives_j,
+                                   const size_t r, const size_t c) const
+    {
+        if ( m_ptrnElement < 0 || ! m_matrix.isCompressed() ||
+             m_matrix.nonZeros() != static_cast<index_t>(m_ptrnInner.size()) )
+            return NULL;
+
+        const index_t nb = m_col.size();
+        const index_t e  = m_ptrnElement;
+        const unsigned * ri = &m_ptrnRowActs.front() + m_ptrnActStart[e*nb+r];
+        const unsigned * ci = &m_ptrnColActs.front() + m_ptrnActStart[e*nb+c];
+        if ( m_ptrnActStart[e*nb+r+1] - m_ptrnActStart[e*nb+r] != actives_i.rows() ||
+             m_ptrnActStart[e*nb+c+1] - m_ptrnActStart[e*nb+c] != actives_j.rows() ||
+             ! std::equal(ri, ri + actives_i.rows(), actives_i.data()) ||
+             ! std::equal(ci, ci + actives_j.rows(), actives_j.data()) )
+            return NULL;
+
+        return &m_ptrnOffs.front() + m_ptrnOffStart[(e*nb+r)*nb+c];
+    }
+
 };  // class gsSparseSystem
 
 
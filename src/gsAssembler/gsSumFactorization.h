@@ -0,0 +1,228 @@
+/** @file gsSumFactorization.h
+
+    @brief Sum factorization of element integrals on tensor-product bases
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <gsTensor/gsTensorBasis.h>
+
+namespace gismo
+{
+
+/**
+    @brief Computes element matrices of the form
+    \f[ \sum_q c_q\, \partial^{\alpha} B_i(x_q)\, \partial^{\beta} B_j(x_q) \f]
+    for a tensor-product basis and a tensor-product quadrature rule
+    by sum factorization.
+
+    The univariate factors of the basis functions are evaluated on the
+    univariate quadrature nodes only, and the quadrature sum is
+    contracted one direction at a time. For degree \em p in \em d
+    dimensions this costs \f$O(p^{2d+1})\f$ operations per element,
+    instead of \f$O(p^{3d})\f$ for the direct evaluation.
+
+    The coefficients \f$c_q\f$ are given at the tensor-product
+    quadrature nodes (first direction running fastest), and the
+    local indices follow the ordering of gsTensorBasis::active_into.
+
+    \ingroup Assembler
+*/
+template <class T>
+class gsSumFactorization
+{
+public:
+
+    gsSumFactorization() : m_dim(0)
+    { }
+
+    /// \brief Prepares the data for \a basis and the quadrature
+    /// \a rule. Returns false if \a basis is not a tensor-product
+    /// basis (eg. rational or hierarchical) or \a rule is not a
+    /// tensor-product rule, in which case sum factorization is not
+    /// applicable.
+    bool initialize(const gsBasis<T> & basis, const gsQuadRule<T> & rule)
+    {
+        m_dim = 0;
+        m_comp.clear();
+        switch ( basis.dim() )
+        {
+        case 2:
+            getComponents<2>(basis);
+            break;
+        case 3:
+            getComponents<3>(basis);
+            break;
+        case 4:
+            getComponents<4>(basis);
+            break;
+        default:
+            break;
+        }
+
+        // The nodes of the element are addressed by their index in
+        // the tensor rule, which requires the number of nodes per
+        // direction
+        m_numNodes = rule.numNodesPerDir();
+        if ( m_numNodes.size() != m_dim )
+            m_comp.clear();
+
+        if ( m_comp.empty() )
+        {
+            m_dim = 0;
+            return false;
+        }
+
+        return true;
+    }
+
+    /// Returns true if initialize() was successful
+    bool isActive() const { return ! m_comp.empty(); }
+
+    /// \brief Evaluates the univariate factors of the basis at the
+    /// tensor-product nodes \a quNodes of the current element
+    void evaluate(const gsMatrix<T> & quNodes)
+    {
+        GISMO_ASSERT( isActive(), "Sum factorization is not initialized");
+        index_t stride = 1;
+        m_numAct.resize(m_dim);
+        for (index_t k = 0; k != m_dim; ++k)
+        {
+            const index_t m = m_numNodes[k];
+            m_nodes.resize(1, m);
+            for (index_t i = 0; i != m; ++i)
+                m_nodes(0,i) = quNodes(k, i * stride);
+            m_comp[k]->evalAllDers_into(m_nodes, 1, m_ders[k]);
+            m_numAct[k] = m_ders[k][0].rows();
+            stride *= m;
+        }
+
+        // Local index of each entry of the contracted tensor
+        if ( m_idxAct.size() != m_dim || m_idxAct != m_numAct )
+        {
+            m_idxAct = m_numAct;
+            const index_t numAct = m_numAct.prod();
+            m_rowIdx.resize(numAct*numAct);
+            m_colIdx.resize(numAct*numAct);
+            for (index_t c = 0; c != numAct*numAct; ++c)
+            {
+                // at step k the new index is (i_k + n_k*j_k) + n_k^2 * old
+                index_t r = c, ii = 0, jj = 0;
+                for (index_t k = m_dim - 1; k >= 0; --k)
+                {
+                    const index_t n  = m_numAct[k];
+                    const index_t ij = r % (n*n);
+                    r /= n*n;
+                    ii = ii * n + ij % n;
+                    jj = jj * n + ij / n;
+                }
+                m_rowIdx[c] = ii;
+                m_colIdx[c] = jj;
+            }
+        }
+    }
+
+    /// Number of basis functions active on the current element
+    index_t numActive() const { return m_numAct.prod(); }
+
+    /**
+       \brief Adds to \a result the element matrix
+       \f[ \sum_q c_q\, \partial_{a} B_i(x_q)\, \partial_{b} B_j(x_q), \f]
+       where \a a (resp. \a b) is the direction of differentiation
+       of the test (resp. trial) function, or -1 for no derivative.
+
+       \param[in] coefs the coefficients \f$c_q\f$ at the quadrature nodes
+       \param[in] a derivative direction of the test functions (rows)
+       \param[in] b derivative direction of the trial functions (columns)
+       \param[in,out] result local matrix, must be allocated by the caller
+    */
+    void contract(const gsVector<T> & coefs, index_t a, index_t b,
+                  gsMatrix<T> & result)
+    {
+        GISMO_ASSERT( coefs.size() == m_numNodes.prod(), "Invalid coefficients");
+        GISMO_ASSERT( result.rows() == numActive() && result.cols() == numActive(),
+                      "Local matrix not allocated");
+
+        m_buf[0] = coefs;
+        index_t rest = coefs.size(), prev = 1, cur = 0;
+        for (index_t k = 0; k != m_dim; ++k)
+        {
+            const index_t n = m_numAct[k];
+            const index_t m = m_numNodes[k];
+            const gsMatrix<T> & Bi = m_ders[k][a == k ? 1 : 0];
+            const gsMatrix<T> & Bj = m_ders[k][b == k ? 1 : 0];
+
+            // Products of the univariate factors, (i + n*j) x m
+            m_weights.resize(n*n, m);
+            for (index_t j = 0; j != n; ++j)
+                m_weights.middleRows(j*n, n) =
+                    Bi.array().rowwise() * Bj.row(j).array();
+
+            // Contract direction k
+            rest /= m;
+            m_buf[1-cur].resize(rest, n*n*prev);
+            for (index_t p = 0; p != prev; ++p)
+            {
+                const gsAsConstMatrix<T> Q(m_buf[cur].col(p).data(), m, rest);
+                m_buf[1-cur].middleCols(p*n*n, n*n).noalias() =
+                    Q.transpose() * m_weights.transpose();
+            }
+            prev *= n*n;
+            cur   = 1 - cur;
+        }
+
+        const gsMatrix<T> & res = m_buf[cur];
+        for (index_t c = 0; c != res.cols(); ++c)
+            result(m_rowIdx[c], m_colIdx[c]) += res(0, c);
+    }
+
+private:
+
+    template<unsigned d>
+    void getComponents(const gsBasis<T> & basis)
+    {
+        const gsTensorBasis<d,T> * tb = dynamic_cast<const gsTensorBasis<d,T>*>(&basis);
+        if ( NULL == tb )
+            return;
+
+        m_dim = d;
+        m_comp.resize(d);
+        m_ders.resize(d);
+        for (unsigned k = 0; k != d; ++k)
+            m_comp[k] = &tb->component(k);
+    }
+
+private:
+
+    // Dimension of the parameter domain
+    index_t m_dim;
+
+    // Univariate component bases
+    std::vector<const gsBasis<T>*> m_comp;
+
+    // Number of quadrature nodes per direction
+    gsVector<index_t> m_numNodes;
+
+    // Number of active functions per direction on the element
+    gsVector<index_t> m_numAct;
+
+    // Values and first derivatives of the univariate factors
+    std::vector<std::vector<gsMatrix<T> > > m_ders;
+
+    // Local row/column index of each entry of the contracted tensor,
+    // computed for m_idxAct active functions per direction
+    std::vector<index_t> m_rowIdx, m_colIdx;
+    gsVector<index_t> m_idxAct;
+
+    // Temporaries
+    gsMatrix<T> m_nodes, m_weights, m_buf[2];
+};
+
+
+} // namespace gismo
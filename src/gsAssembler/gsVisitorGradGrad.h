@@ -102,22 +102,26 @@ public:
                          gsGeometryEvaluator<T> & geoEval,
                          gsVector<T> const      & quWeights)
     {
+        // Compute physical gradients at all nodes as a (Dim*NumNodes) x NumActive matrix.
+        // This batches the nodes of one element, not several elements
+        geoEval.transformAllGradients(basisData, basisPhGrads);
+
+        // Scale each Dim-block by the square root of the quadrature
+        // weight times the geometry measure, so that the local matrix
+        // is a single symmetric rank update
+        const index_t dim = basisPhGrads.rows() / quWeights.rows();
         for (index_t k = 0; k < quWeights.rows(); ++k) // loop over quadrature nodes
-        {
-            // Multiply quadrature weight by the geometry measure
-            const T weight = quWeights[k] * geoEval.measure(k);
-        
-            // Compute physical gradients at k as a Dim x NumActive matrix
-            geoEval.transformGradients(k, basisData, basisPhGrads);
+            basisPhGrads.middleRows(k*dim, dim) *=
+                math::sqrt( quWeights[k] * geoEval.measure(k) );
 
-            localMat.noalias() += weight * ( basisPhGrads.transpose() * basisPhGrads );
-        }
+        localMat.template selfadjointView<Lower>().rankUpdate(basisPhGrads.transpose());
+        localMat.template triangularView<StrictlyUpper>() = localMat.transpose();
     }
 
     //Inherited from gsVisitorMass
     //void localToGlobal( ... )
 
-private:
+protected:
 
     // Gradient values
     gsMatrix<T>  basisPhGrads;
@@ -87,17 +87,23 @@ public:
         gsMatrix<T> & bVals  = basisData[0];
         gsMatrix<T> & bGrads = basisData[1];
 
+        // Multiply weights by the geometry measure
+        weights.noalias() = quWeights.cwiseProduct( geoEval.measures() );
+
+        localRhs.noalias() = bVals * weights.asDiagonal() * rhsVals.transpose();
+
+        // Compute physical gradients at all nodes as a (Dim*NumNodes) x NumActive matrix.
+        // This batches the nodes of one element, not several elements
+        geoEval.transformAllGradients(bGrads, physGrad);
+
+        // Scale each Dim-block by the square root of its weight, so
+        // that the local matrix is a single symmetric rank update
+        const index_t dim = physGrad.rows() / quWeights.rows();
         for (index_t k = 0; k < quWeights.rows(); ++k) // loop over quadrature nodes
-        {
-            // Multiply weight by the geometry measure
-            const T weight = quWeights[k] * geoEval.measure(k);
-            
-            // Compute physical gradients at k as a Dim x NumActive matrix
-            geoEval.transformGradients(k, bGrads, physGrad);
-            
-            localRhs.noalias() += weight * ( bVals.col(k) * rhsVals.col(k).transpose() ) ;
-            localMat.noalias() += weight * (physGrad.transpose() * physGrad);
-        }
+            physGrad.middleRows(k*dim, dim) *= math::sqrt(weights[k]);
+
+        localMat.template selfadjointView<Lower>().rankUpdate(physGrad.transpose());
+        localMat.template triangularView<StrictlyUpper>() = localMat.transpose();
     }
 
     inline void localToGlobal(const int patchIndex,
@@ -119,6 +125,7 @@ protected:
     // Basis values
     std::vector<gsMatrix<T> > basisData;
     gsMatrix<T>        physGrad;
+    gsVector<T>        weights;
     gsMatrix<unsigned> actives;
     index_t numActive;
 
@@ -0,0 +1,145 @@
+/** @file gsVisitorTPgradGrad.h
+
+    @brief Stiffness (grad-grad) visitor using sum factorization on
+    tensor-product bases
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <gsAssembler/gsVisitorGradGrad.h>
+#include <gsAssembler/gsSumFactorization.h>
+
+namespace gismo
+{
+
+/** 
+    @brief The visitor computes element grad-grad integrals by sum
+    factorization.
+
+    The integrand \f$ \nabla u \cdot \nabla v \f$ is written as
+    \f$ \sum_{a,b} G_{ab}\, \partial_a \hat u\, \partial_b \hat v \f$
+    with parametric derivatives and the geometry factor
+    \f$ G = |\det J|\, J^{-1} J^{-T} \f$. Each of the \f$d(d+1)/2\f$
+    distinct terms is computed by gsSumFactorization. For bases
+    which are not of tensor-product type it falls back to
+    gsVisitorGradGrad.
+    
+    \ingroup Assembler
+*/
+template <class T>
+class gsVisitorTPgradGrad : public gsVisitorGradGrad<T>
+{
+public:
+    typedef gsVisitorGradGrad<T> Base;
+
+public:
+
+    gsVisitorTPgradGrad(const gsPde<T> & pde) : Base(pde)
+    { }
+
+    void initialize(const gsBasis<T> & basis,
+                    const index_t patchIndex,
+                    const gsOptionList & options, 
+                    gsQuadRule<T>    & rule,
+                    unsigned         & evFlags )
+    {
+        Base::initialize(basis, patchIndex, options, rule, evFlags);
+        m_sf.initialize(basis, rule);
+    }
+
+    // Evaluate on element.
+    inline void evaluate(gsBasis<T> const       & basis,
+                         gsGeometryEvaluator<T> & geoEval,
+                         gsMatrix<T>            & quNodes)
+    {
+        if ( ! m_sf.isActive() )
+        {
+            Base::evaluate(basis, geoEval, quNodes);
+            return;
+        }
+
+        // Compute the active basis functions
+        basis.active_into(quNodes.col(0) , actives);
+
+        // Evaluate the univariate factors on the element
+        m_sf.evaluate(quNodes);
+
+        // Compute geometry related values
+        geoEval.evaluateAt(quNodes);
+
+        // Initialize local matrix
+        localMat.setZero(actives.rows(), actives.rows());
+    }
+
+    inline void assemble(gsDomainIterator<T>    & element, 
+                         gsGeometryEvaluator<T> & geoEval,
+                         gsVector<T> const      & quWeights)
+    {
+        if ( ! m_sf.isActive() )
+        {
+            Base::assemble(element, geoEval, quWeights);
+            return;
+        }
+
+        const index_t d  = geoEval.parDim();
+        const index_t nq = quWeights.size();
+        const gsMatrix<T> & jacInvs = geoEval.gradTransforms();
+
+        // Geometry factors G_ab at all quadrature nodes
+        m_geoFactors.resize(d*d, nq);
+        for (index_t k = 0; k != nq; ++k)
+        {
+            const typename gsMatrix<T>::constColumns Jk = jacInvs.middleCols(k*d, d);
+            gsAsMatrix<T> Gk(m_geoFactors.col(k).data(), d, d);
+            Gk.noalias() = ( quWeights[k] * geoEval.measure(k) ) * (Jk.transpose() * Jk);
+        }
+
+        // Diagonal terms
+        for (index_t a = 0; a != d; ++a)
+        {
+            m_coefs = m_geoFactors.row(a + a*d).transpose();
+            m_sf.contract(m_coefs, a, a, localMat);
+        }
+
+        // Off-diagonal terms, G_ab = G_ba
+        if ( d > 1 )
+        {
+            m_offDiag.setZero(localMat.rows(), localMat.cols());
+            for (index_t a = 0; a != d; ++a)
+                for (index_t b = a + 1; b != d; ++b)
+                {
+                    m_coefs = m_geoFactors.row(a + b*d).transpose();
+                    m_sf.contract(m_coefs, a, b, m_offDiag);
+                }
+            localMat += m_offDiag;
+            localMat += m_offDiag.transpose();
+        }
+    }
+
+    //Inherited from gsVisitorMass
+    //void localToGlobal( ... )
+
+protected:
+
+    // Sum factorization data
+    gsSumFactorization<T> m_sf;
+
+    // Geometry factors and quadrature coefficients
+    gsMatrix<T> m_geoFactors;
+    gsVector<T> m_coefs;
+
+    // Off-diagonal part of the local matrix
+    gsMatrix<T> m_offDiag;
+
+    using Base::actives;
+    using Base::localMat;
+};
+
+
+} // namespace gismo
@@ -0,0 +1,111 @@
+/** @file gsVisitorTPmass.h
+
+    @brief Mass visitor using sum factorization on tensor-product bases
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <gsAssembler/gsVisitorMass.h>
+#include <gsAssembler/gsSumFactorization.h>
+
+namespace gismo
+{
+
+/** 
+    @brief The visitor computes element mass integrals by sum
+    factorization.
+
+    On tensor-product bases (eg. gsTensorBSplineBasis) only the
+    univariate factors of the basis are evaluated and the quadrature
+    sum is contracted direction-wise, see gsSumFactorization. For
+    other bases (eg. rational or hierarchical ones) it falls back to
+    gsVisitorMass.
+      
+    \ingroup Assembler
+*/
+template <class T>
+class gsVisitorTPmass : public gsVisitorMass<T>
+{
+public:
+    typedef gsVisitorMass<T> Base;
+
+public:
+
+    gsVisitorTPmass()
+    { }
+
+    gsVisitorTPmass(const gsPde<T> & pde) : Base(pde)
+    { }
+
+    void initialize(const gsBasis<T> & basis,
+                    const index_t patchIndex,
+                    const gsOptionList & options, 
+                    gsQuadRule<T>    & rule,
+                    unsigned         & evFlags )
+    {
+        Base::initialize(basis, patchIndex, options, rule, evFlags);
+        m_sf.initialize(basis, rule);
+    }
+
+    // Evaluate on element.
+    inline void evaluate(gsBasis<T> const       & basis,
+                         gsGeometryEvaluator<T> & geoEval,
+                         gsMatrix<T>            & quNodes)
+    {
+        if ( ! m_sf.isActive() )
+        {
+            Base::evaluate(basis, geoEval, quNodes);
+            return;
+        }
+
+        // Compute the active basis functions
+        basis.active_into(quNodes.col(0) , actives);
+
+        // Evaluate the univariate factors on the element
+        m_sf.evaluate(quNodes);
+
+        // Compute geometry related values
+        geoEval.evaluateAt(quNodes);
+
+        // Initialize local matrix
+        localMat.setZero(actives.rows(), actives.rows());
+    }
+
+    inline void assemble(gsDomainIterator<T>    & element, 
+                         gsGeometryEvaluator<T> & geoEval,
+                         gsVector<T> const      & quWeights)
+    {
+        if ( ! m_sf.isActive() )
+        {
+            Base::assemble(element, geoEval, quWeights);
+            return;
+        }
+
+        // Multiply quadrature weights by the geometry measure
+        m_coefs.noalias() = quWeights.cwiseProduct( geoEval.measures() );
+        m_sf.contract(m_coefs, -1, -1, localMat);
+    }
+
+    //Inherited from gsVisitorMass
+    //void localToGlobal( ... )
+
+protected:
+
+    // Sum factorization data
+    gsSumFactorization<T> m_sf;
+
+    // Quadrature coefficients
+    gsVector<T> m_coefs;
+
+    using Base::actives;
+    using Base::localMat;
+};
+
+
+} // namespace gismo
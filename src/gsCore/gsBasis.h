@@ -210,6 +210,24 @@ public:
                                const gsMatrix<T> & coefs, 
                                gsMatrix<T>& result) const;
 
+    /** \brief Evaluate the function described by \a coefs on the
+     * tensor grid given by the coordinate vectors \a cwise, see
+     * gsFunction::evalOnGrid_into().
+     *
+     * The default implementation flattens the grid and calls
+     * evalFunc_into(). Tensor-product bases contract the coefficients
+     * with the univariate collocation matrices, direction by
+     * direction.
+     *
+     * \param cwise   coordinates of the grid, one vector per direction
+     * \param coefs   coefficient matrix describing the geometry in this basis, \em n columns
+     * \param[out] result  a matrix of size <em>n x N</em> with one function value as a column vector
+     *              per grid point (the first coordinate running fastest)
+     */
+    virtual void evalFuncOnGrid_into(const std::vector< gsVector<T> > & cwise,
+                                     const gsMatrix<T> & coefs,
+                                     gsMatrix<T>& result) const;
+
 
     /** @brief Evaluate the derivatives of the function described by \a coefs at points \a u.
      * 
@@ -16,6 +16,7 @@
 #include <gsCore/gsBasisFun.h>
 #include <gsCore/gsDomainIterator.h>
 #include <gsCore/gsBoundary.h>
+#include <gsUtils/gsPointGrid.h>
 
 namespace gismo
 {
@@ -58,6 +59,17 @@ void gsBasis<T>::evalFunc_into(const gsMatrix<T> &u,
     linearCombination_into( coefs, actives, B, result );
 }
 
+// Evaluates a linear combination of basis functions on a grid (default implementation)
+template<class T>
+void gsBasis<T>::evalFuncOnGrid_into(const std::vector< gsVector<T> > & cwise,
+                                     const gsMatrix<T> & coefs,
+                                     gsMatrix<T>& result) const
+{
+    gsMatrix<T> u;
+    gsPointGrid(cwise, u);
+    this->evalFunc_into(u, coefs, result);
+}
+
 
 // Evaluates the Jacobian of the function given by coefs (default implementation)
 // For each point, result contains a geomDim x parDim matrix block containing the Jacobian matrix
@@ -98,6 +98,21 @@ public:
      */
     virtual bool next() = 0;
 
+    /** @brief Proceeds \a increment elements forward.
+     *
+     * Equivalent to calling next() \a increment times. For \a
+     * increment equal to zero the iterator stays at the current
+     * element. Derived classes may provide a faster implementation
+     * which skips the per-element updates of the intermediate
+     * elements.
+     */
+    virtual bool next(index_t increment)
+    {
+        for (index_t i = 0; i < increment && m_isGood; ++i)
+            next();
+        return m_isGood;
+    }
+
     /// Resets the iterator so that it points to the first element
     virtual void reset()
     {
@@ -122,6 +122,31 @@ public:
                                      const index_t comp, 
                                      gsMatrix<T>& result) const;
 
+    /** \brief Evaluate the function on the tensor grid given by the
+     * coordinate vectors \a cwise into \a result.
+     *
+     * <em>cwise[i]</em> contains the coordinates of the grid in
+     * direction \em i. The columns of \a result are the values at the
+     * points of gsPointGrid(cwise), ie. the first coordinate runs
+     * fastest.
+     *
+     * By default the grid is flattened and eval_into() is
+     * called. Geometries on tensor-product bases evaluate the
+     * univariate bases once per direction, see
+     * gsBasis::evalFuncOnGrid_into().
+     */
+    virtual void evalOnGrid_into(const std::vector< gsVector<T> > & cwise,
+                                 gsMatrix<T>& result) const;
+
+    /// Evaluate the function on the tensor grid given by the
+    /// coordinate vectors \a cwise, see evalOnGrid_into()
+    gsMatrix<T> evalOnGrid(const std::vector< gsVector<T> > & cwise) const
+    {
+        gsMatrix<T> result;
+        this->evalOnGrid_into(cwise, result);
+        return result;
+    }
+
     /** \brief Evaluate derivatives of the function
      * \f$f:\mathbb{R}^n\rightarrow\mathbb{R}^m\f$
      * at points \a u into \a result.
@@ -13,6 +13,7 @@
 
 #include <gsCore/gsLinearAlgebra.h>
 #include <gsCore/gsFuncData.h>
+#include <gsUtils/gsPointGrid.h>
 #pragma once
 
 namespace gismo
@@ -231,6 +232,15 @@ int gsFunction<T>::targetDim() const
 { GISMO_NO_IMPLEMENTATION }
 */
 
+template <class T>
+void gsFunction<T>::evalOnGrid_into(const std::vector< gsVector<T> > & cwise,
+                                    gsMatrix<T>& result) const
+{
+    gsMatrix<T> pts;
+    gsPointGrid(cwise, pts);
+    this->eval_into(pts, result);
+}
+
 template <class T>
 void gsFunction<T>::eval_component_into(const gsMatrix<T>& u, 
                                         const index_t comp,
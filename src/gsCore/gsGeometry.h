@@ -144,6 +144,7 @@ public:
             delete m_basis;
             m_basis = o.basis().clone() ;
             m_id = o.m_id;
+            m_locator.reset();
         }
         return *this;
     }
@@ -165,6 +166,7 @@ public:
         m_coefs.swap(other.m_coefs); other.m_coefs.clear();
         delete m_basis; 
         m_basis = other.m_basis; other.m_basis = NULL;
+        m_locator.reset(); other.m_locator.reset();
         return *this;
     }
 #endif
@@ -194,6 +196,10 @@ public:
     void eval_into(const gsMatrix<T>& u, gsMatrix<T>& result) const
     { this->basis().evalFunc_into(u, m_coefs, result); }
 
+    // Look at gsFunction class for documentation
+    void evalOnGrid_into(const std::vector< gsVector<T> > & cwise, gsMatrix<T>& result) const
+    { this->basis().evalFuncOnGrid_into(cwise, m_coefs, result); }
+
     /** \brief Evaluate derivatives of the function
      * \f$f:\mathbb{R}^d\rightarrow\mathbb{R}^n\f$
      * at points \a u into \a result.
@@ -578,8 +584,11 @@ public:
     gsGeometrySlice<T> getIsoParametricSlice(index_t dir_fixed, T par) const;
 
     /// Takes the physical \a points and computes the corresponding
-    /// parameter values.  If the point cannot be inverted (eg. is not
-    /// part of the geometry) the corresponding parameter values will be undefined
+    /// parameter values, using gsPointLocator.  If a point cannot be
+    /// inverted (eg. is not part of the geometry) the corresponding
+    /// parameter values are those of a (local) closest point, for
+    /// non-finite points they are NaN. The locator is built on the
+    /// first call and kept until the coefficients change.
     virtual void invertPoints(const gsMatrix<T> & points, gsMatrix<T> & result,
                               const T accuracy = 1e-6);
 
@@ -596,6 +605,8 @@ protected:
         std::swap(m_basis, other.m_basis);
         m_coefs.swap(other.m_coefs);
         std::swap(m_id, other.m_id);
+        m_locator.reset();
+        other.m_locator.reset();
     }
 
 protected:
@@ -611,6 +622,10 @@ protected:
     /// of a multi-patch object)
     size_t m_id;
 
+    /// The point locator of invertPoints(), built on demand. It
+    /// refers to this object, therefore it is not copied.
+    memory::shared_ptr< gsPointLocator<T> > m_locator;
+
 }; // class gsGeometry
 
 /// Print (as string) operator to be used by all derived classes
@@ -18,6 +18,7 @@
 #include <gsCore/gsFuncData.h>
 
 #include <gsCore/gsGeometrySlice.h>
+#include <gsCore/gsPointLocator.h>
 
 namespace gismo
 {
@@ -88,15 +89,14 @@ void gsGeometry<T>::invertPoints(const gsMatrix<T> & points,
                                  gsMatrix<T> & result, 
                                  const T accuracy)
 {
-    result.resize(parDim(), points.cols() );
-    gsVector<T> arg;
-    for ( index_t i = 0; i!= points.cols(); ++i)
-    {         
-        arg = parameterCenter();
-        // int iter = 
-        this->newtonRaphson(points.col(i), arg, true, accuracy, 100);
-        result.col(i) = arg;
-    }
+    // Building the locator is much more expensive than a lookup,
+    // keep it for subsequent calls
+    if ( ! m_locator || ! m_locator->upToDate() )
+        m_locator.reset( new gsPointLocator<T>(*this) );
+    m_locator->setAccuracy(accuracy);
+    gsVector<index_t> patches;
+    gsVector<T> dist;
+    m_locator->locate(points, patches, result, dist);
 }
 
 
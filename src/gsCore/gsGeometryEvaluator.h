@@ -115,6 +115,64 @@ public:
     **/
     virtual void evaluateAt(const gsMatrix<T>& u) = 0;
 
+    /// \brief The quantities computed by evaluateAt(), see saveData()
+    struct Data
+    {
+        Data() : flags(0), numPts(0) { }
+
+        unsigned    flags;
+        index_t     numPts;
+        gsMatrix<T> values, jacobians, jacInvs, secDers;
+        gsVector<T> measures;
+
+        /// Returns the memory occupied by the stored quantities, in bytes
+        std::size_t bytes() const
+        {
+            return sizeof(T) * ( values.size() + jacobians.size() + jacInvs.size()
+                                 + secDers.size() + measures.size() );
+        }
+    };
+
+    /// \brief Stores the quantities computed by the last call of
+    /// evaluateAt() in \a data
+    void saveData(Data & data) const
+    {
+        data.flags     = m_flags;
+        data.numPts    = m_numPts;
+        data.values    = m_values;
+        data.jacobians = m_jacobians;
+        data.jacInvs   = m_jacInvs;
+        data.secDers   = m_2ndDers;
+        data.measures  = m_measures;
+    }
+
+    /// \brief Restores quantities previously stored by saveData(),
+    /// as if evaluateAt() was called at the same points again. The
+    /// data must stem from an evaluator of the same geometry.
+    void loadData(const Data & data)
+    {
+        GISMO_ASSERT( (data.flags & m_flags) == m_flags, "Stored data lacks requested quantities");
+        m_numPts    = data.numPts;
+        m_values    = data.values;
+        m_jacobians = data.jacobians;
+        m_jacInvs   = data.jacInvs;
+        m_2ndDers   = data.secDers;
+        m_measures  = data.measures;
+    }
+
+    /// \brief Exchanges the quantities of the last evaluation with
+    /// the ones stored in \a data, without copying them. The flags
+    /// of \a data are not changed.
+    void swapData(Data & data)
+    {
+        std::swap(m_numPts, data.numPts);
+        m_values   .swap(data.values);
+        m_jacobians.swap(data.jacobians);
+        m_jacInvs  .swap(data.jacInvs);
+        m_2ndDers  .swap(data.secDers);
+        m_measures .swap(data.measures);
+    }
+
     /// Get the physical coordinates (i.e., the image of the
     /// evaluation points in the physical space).
     const gsMatrix<T>& values() const
@@ -398,6 +456,35 @@ public:
     /// See the other transformGradients() for documentation.
     virtual void transformGradients(index_t k, const typename gsMatrix<T>::Block allGrads, gsMatrix<T>& trfGradsK) const = 0;
 
+    /**
+      \brief Transforms the parametric gradients at all evaluation
+      points to gradients on the physical domain at once.
+
+      The input \em allGrads has the same format as in
+      transformGradients(). The result is a gsMatrix of size
+      <em>(GeoDim * K)</em> x <em>n</em>, where the <em>k</em>-th
+      block of \em GeoDim rows is equal to the matrix \em trfGradsK
+      computed by transformGradients(k, allGrads, trfGradsK).
+
+      The blocks are stored contiguously, therefore element integrals
+      such as the stiffness matrix can be computed by one
+      matrix-matrix product instead of one rank update per point.
+
+      This implementation calls transformGradients() for every point.
+    */
+    virtual void transformAllGradients(const gsMatrix<T>& allGrads, gsMatrix<T>& result) const
+    {
+        const index_t geoDim = m_geo.geoDim();
+        const index_t numPts = allGrads.cols();
+        gsMatrix<T> trfGradsK;
+        result.resize(geoDim * numPts, allGrads.rows() / static_cast<index_t>(m_parDim));
+        for (index_t k = 0; k < numPts; ++k)
+        {
+            transformGradients(k, allGrads, trfGradsK);
+            result.middleRows(k*geoDim, geoDim) = trfGradsK;
+        }
+    }
+
     /**
     \brief Transforms paramatric 1st and 2nd derivatives to Laplacians on the physical domain.
 
@@ -655,6 +742,23 @@ public:
           // */
     }
 
+    // Documentation at gsGeometryEvaluator::transformAllGradients
+    void transformAllGradients(const gsMatrix<T>& allGrads, gsMatrix<T>& result) const
+    {
+        GISMO_ASSERT(this->m_flags & NEED_GRAD_TRANSFORM, "J^-1 not computed");
+        GISMO_ASSERT(allGrads.rows() % ParDim == 0, "Invalid size of gradient matrix");
+
+        const index_t numGrads = allGrads.rows() / ParDim;
+        const index_t numPts   = allGrads.cols();
+        result.resize(GeoDim * numPts, numGrads);
+        for (index_t k = 0; k < numPts; ++k)
+        {
+            const gsAsConstMatrix<T,ParDim> grads_k(allGrads.col(k).data(), ParDim, numGrads);
+            result.template middleRows<GeoDim>(k*GeoDim).noalias() =
+                m_jacInvs.template block<GeoDim,ParDim>(0, k*ParDim) * grads_k;
+        }
+    }
+
     void transformLaplaceHgrad(index_t k,
                                const gsMatrix<T> & allgrads,
                                const gsMatrix<T> & allHessians,
@@ -733,8 +837,9 @@ protected:
     using gsGeometryEvaluator<T>::m_normal;
 */
 
-    std::vector<gsMatrix<T> > m_basisVals;
-    gsMatrix<unsigned>    m_active;
+    // Values and derivatives of the geometry, in the format of
+    // gsBasis::evalAllDersFunc_into
+    std::vector<gsMatrix<T> > m_geoDers;
 private:
     int m_maxDeriv;
 
@@ -386,11 +386,10 @@ gsGenericGeometryEvaluator<T,ParDim,codim>::evaluateAt(const gsMatrix<T>& u)
     GISMO_ASSERT( m_maxDeriv != -1, "Error in evaluation flags. -1 not supported yet.");
 
     m_numPts = u.cols();
-    m_geo.basis().evalAllDers_into(u, m_maxDeriv, m_basisVals);
 
-    // todo: If we assume all points (u) lie on the same element we may
-    // store the actives only once
-    m_geo.basis().active_into(u, m_active);
+    // Tensor-product bases contract the coefficients with the
+    // univariate values, without forming the basis values
+    m_geo.basis().evalAllDersFunc_into(u, m_geo.coefs(), m_maxDeriv, m_geoDers);
 
     if (this->m_flags & NEED_VALUE)
         computeValues();
@@ -418,69 +417,28 @@ gsGenericGeometryEvaluator<T,ParDim,codim>::evaluateAt(const gsMatrix<T>& u)
 template <class T, int ParDim, int codim>
 void gsGenericGeometryEvaluator<T,ParDim,codim>::computeValues()
 {
-    const gsMatrix<T> & coefs = m_geo.coefs();
-    const gsMatrix<T> & bVals = m_basisVals.front();
-
-    m_values.resize(coefs.cols(), m_numPts);
-
-    for (index_t j=0; j < m_numPts; ++j) // for all evaluation points
-    {
-        m_values.col(j) =  coefs.row( m_active(0,j) ) * bVals(0,j);
-
-        for ( index_t i=1; i< m_active.rows() ; i++ )   // for all non-zero basis functions
-            m_values.col(j)  +=   coefs.row( m_active(i,j) ) * bVals(i,j);
-    }
+    m_values.swap( m_geoDers.front() );
 }
 
 template <class T, int ParDim, int codim>
 void gsGenericGeometryEvaluator<T,ParDim,codim>::computeJacobians()
 {
-    const index_t numActive = m_active.rows();
-    const gsMatrix<T> & coefs = m_geo.coefs();
-    const gsMatrix<T> & bVals = m_basisVals[1];
+    // Row c*ParDim+k of m_geoDers[1] holds the derivative of
+    // component c w.r.t. the k-th variable
+    const gsMatrix<T> & ders = m_geoDers[1];
 
-    m_jacobians.setZero(GeoDim, m_numPts * ParDim);
+    m_jacobians.resize(GeoDim, m_numPts * ParDim);
 
     for (index_t j = 0; j < m_numPts; ++j)
-        for (index_t i = 0; i < numActive; ++i) // for all active basis functions
-        {
-            m_jacobians.template block<GeoDim,ParDim>(0,j*ParDim).transpose().noalias() +=
-                    bVals.template block<ParDim,1>(i*ParDim, j) *
-                    coefs.template block<1,GeoDim>(m_active(i,j),0) ;
-
-            // to check: which is faster ? the above or this..
-            // m_jacobians.template block<GeoDim,ParDim>(0,j*ParDim).noalias() +=
-            //     (bVals.template block<ParDim,1>(i*ParDim, j)
-            //      * coefs.template block<1,GeoDim>(m_active(i,j),0) ).transpose();
-        }
+        m_jacobians.template block<GeoDim,ParDim>(0,j*ParDim) =
+            gsAsConstMatrix<T,ParDim,GeoDim>(ders.col(j).data(), ParDim, GeoDim).transpose();
 }
 
 
 template <class T, int ParDim, int codim>
 void gsGenericGeometryEvaluator<T,ParDim,codim>::compute2ndDerivs()
 {
-    const index_t numActive = m_active.rows();
-    const gsMatrix<T> & coefs = m_geo.coefs();
-    const gsMatrix<T> & bVals = m_basisVals[2];
-    // Number of differnt 2ed derivativs combinations
-    const index_t numDeriv = ParDim + (ParDim*(ParDim - 1))/2;
-
-    m_2ndDers.setZero(GeoDim*numDeriv, m_numPts);
-
-    gsMatrix<T> reshape; // to be removed later
-
-    for (index_t j = 0; j < m_numPts; ++j)
-    {
-        for (index_t i = 0; i < numActive; ++i) // for all active basis functions
-        {
-            reshape.noalias() =
-                    bVals.template block<numDeriv,1>(i*numDeriv, j)
-                    * coefs.template block<1,GeoDim>(m_active(i,j),0);
-
-            reshape.resize(GeoDim*numDeriv,1);
-            m_2ndDers.template block<GeoDim*numDeriv,1>(0,j).noalias() += reshape;
-        }
-    }
+    m_2ndDers.swap( m_geoDers[2] );
 }
 
 
@@ -98,6 +98,8 @@ using Eigen::Dynamic ;//=-1
 
 using Eigen::Lower;//=1
 using Eigen::Upper;//=2
+using Eigen::StrictlyLower;//=5
+using Eigen::StrictlyUpper;//=6
 
 // Values for matrix align options
 using Eigen::RowMajor;//=0
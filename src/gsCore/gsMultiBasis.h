@@ -308,6 +308,29 @@ public:
         }
     }
 
+    /**
+     * @brief Refine every basis uniformly and compute the transfer
+     * matrix which maps the coarse free degrees of freedom to the
+     * fine ones.
+     *
+     * The degrees of freedom are numbered as by getMapper() with the
+     * given Dirichlet and interface strategies, therefore the
+     * transfer matrices of successive refinements define a grid
+     * hierarchy for multigrid methods (see gsMultiGridOp).
+     *
+     * @param[out] transfer the transfer matrix (fine x coarse)
+     * @param[in] bc the boundary conditions
+     * @param[in] ds the strategy for the Dirichlet degrees of freedom
+     * @param[in] is the strategy for the interfaces
+     * @param[in] numKnots number of knots inserted on each knot span
+     * @param[in] mul multiplicity of the inserted knots
+     */
+    void uniformRefine_withTransfer(gsSparseMatrix<T,RowMajor> & transfer,
+                                    const gsBoundaryConditions<T> & bc,
+                                    dirichlet::strategy ds,
+                                    iFace::strategy is,
+                                    int numKnots = 1, int mul = 1);
+
     /// @brief Refine the component \a comp of every basis uniformly
     /// by inserting \a numKnots new knots on each knot span
     void uniformRefineComponent(int comp, int numKnots = 1, int mul=1)
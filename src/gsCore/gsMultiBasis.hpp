@@ -196,6 +196,48 @@ void gsMultiBasis<T>::getMapper(bool conforming,
         mapper.finalize();
 }
     
+template<class T>
+void gsMultiBasis<T>::uniformRefine_withTransfer(gsSparseMatrix<T,RowMajor> & transfer,
+                                                 const gsBoundaryConditions<T> & bc,
+                                                 dirichlet::strategy ds,
+                                                 iFace::strategy is,
+                                                 int numKnots, int mul)
+{
+    const gsDofMapper coarseMapper = getMapper(ds, is, bc, 0);
+
+    std::vector<gsSparseMatrix<T,RowMajor> > localTransfer(m_bases.size());
+    for (size_t k = 0; k < m_bases.size(); ++k)
+        m_bases[k]->uniformRefine_withTransfer(localTransfer[k], numKnots, mul);
+
+    const gsDofMapper fineMapper = getMapper(ds, is, bc, 0);
+
+    // A fine dof shared by several patches has the same row in each
+    // local transfer matrix, hence it is taken from the first patch
+    gsSparseEntries<T> entries;
+    std::vector<bool> done(fineMapper.freeSize(), false);
+    for (size_t k = 0; k < m_bases.size(); ++k)
+    {
+        const gsSparseMatrix<T,RowMajor> & loc = localTransfer[k];
+        for (index_t i = 0; i < loc.outerSize(); ++i)
+        {
+            if ( ! fineMapper.is_free(i, k) )
+                continue;
+            const index_t ii = fineMapper.index(i, k);
+            if ( done[ii] )
+                continue;
+            done[ii] = true;
+
+            for (typename gsSparseMatrix<T,RowMajor>::InnerIterator it(loc, i); it; ++it)
+                if ( coarseMapper.is_free(it.col(), k) )
+                    entries.add(ii, coarseMapper.index(it.col(), k), it.value());
+        }
+    }
+
+    transfer.resize(fineMapper.freeSize(), coarseMapper.freeSize());
+    transfer.setFrom(entries);
+    transfer.makeCompressed();
+}
+
 template<class T>
 void gsMultiBasis<T>::matchInterface(const boundaryInterface & bi, gsDofMapper & mapper) const
 {
@@ -18,6 +18,8 @@
 
 #include <gsCore/gsMultiBasis.h>
 
+#include <gsUtils/gsSpatialGrid.h>
+
 namespace gismo
 {
 
@@ -232,6 +234,10 @@ public:
     /// \param cornersOnly When set to true an interface is accepted
     /// if the patch corners match, even if the parameterization does
     /// not agree
+    ///
+    /// The candidate sides are located with a gsSpatialGrid of their
+    /// reference points, therefore the cost is nearly linear in the
+    /// number of patches.
     bool computeTopology( T tol = 1e-4, bool cornersOnly = false);
 
     /// \brief Attempt to close gaps between the interfaces. Assumes
@@ -278,6 +284,19 @@ private:
 private:
     // implementation functions
 
+    // Evaluates the reference points (corners and side centers) of
+    // all patches to refPoints and builds the index of the sides with
+    // tolerance tol. Column k of the index is side k % (2d) + 1 of
+    // patch k / (2d).
+    void buildSideIndex(T tol, bool cornersOnly, std::vector<gsMatrix<T> > & refPoints,
+                        gsSpatialGrid<T> & grid) const;
+
+    // Joins the sides (given by their column in grid) whose corners
+    // match up to tol to interfaces. The sides which remain are
+    // appended to unmatched.
+    void matchSides(const gsSpatialGrid<T> & grid, const std::vector<gsMatrix<T> > & refPoints,
+                    T tol, std::vector<index_t> & unmatched);
+
     // match the vertices in ci1 starting from start to the end with the vertices
     // in ci2 that are still non matched
     // cc1 and cc2 are the physical coordinates of the vertices
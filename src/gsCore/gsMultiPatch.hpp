@@ -265,9 +265,29 @@ bool gsMultiPatch<T>::computeTopology( T tol, bool cornersOnly )
 {
     gsBoxTopology::clearTopology();
 
+    // The index refers to the current geometry only, it is not kept
+    std::vector<gsMatrix<T> > refPoints;
+    gsSpatialGrid<T> grid;
+    buildSideIndex(tol, cornersOnly, refPoints, grid);
+
+    std::vector<index_t> unmatched;
+    matchSides(grid, refPoints, tol, unmatched);
+
+    const index_t nSides = 2 * m_dim;
+    for (size_t k = 0; k != unmatched.size(); ++k) // not an interface
+        gsBoxTopology::addBoundary( patchSide(unmatched[k] / nSides,
+                                              unmatched[k] % nSides + 1) );
+
+    return true;
+}
+
+template<class T>
+void gsMultiPatch<T>::buildSideIndex( T tol, bool cornersOnly,
+                                      std::vector<gsMatrix<T> > & refPoints,
+                                      gsSpatialGrid<T> & grid ) const
+{
     const size_t   np    = m_patches.size();
     const index_t  nCorP = 1 << m_dim;     // corners per patch
-    const index_t  nCorS = 1 << (m_dim-1); // corners per side
 
     gsMatrix<T> supp, 
     // Parametric coordinates of the reference points. These points
@@ -282,10 +302,7 @@ bool gsMultiPatch<T>::computeTopology( T tol, bool cornersOnly )
     gsVector<bool> boxPar(m_dim);
 
     // each matrix contains the physical coordinates of the reference points
-    std::vector<gsMatrix<T> > pCorners(np); 
-
-    std::vector<patchSide> pSide; // list of all candidate patchSides to compare
-    pSide.reserve(np * 2 * m_dim);
+    refPoints.resize(np);
 
     for (size_t p=0; p<np; ++p)
     {
@@ -316,12 +333,42 @@ bool gsMultiPatch<T>::computeTopology( T tol, bool cornersOnly )
         }
 
         // Evaluate the patch on the reference points
-        m_patches[p]->eval_into(coor,pCorners[p]);
+        m_patches[p]->eval_into(coor,refPoints[p]);
+    }
 
-        // Add all the patchSides of this patch to the candidate list
-        for (boxSide bs=boxSide::getFirst(m_dim); bs<boxSide::getEnd(m_dim); ++bs)
-            pSide.push_back(patchSide(p,bs));
+    // One physical point per side, which coincides for matching
+    // sides: the side center, or the barycenter of the side corners
+    // if only corners are compared. The sides are numbered patch by
+    // patch.
+    const index_t nSides = 2 * m_dim;
+    const index_t ns     = np * nSides;
+    gsMatrix<T> sidePt(np ? refPoints.front().rows() : 0, ns);
+    std::vector<boxCorner> cId;
+    for (index_t k = 0; k != ns; ++k)
+    {
+        const gsMatrix<T> & pc = refPoints[k / nSides];
+        const boxSide side(k % nSides + 1);
+        if (cornersOnly)
+        {
+            side.getContainedCorners(m_dim,cId);
+            sidePt.col(k).setZero();
+            for (size_t c = 0; c != cId.size(); ++c)
+                sidePt.col(k) += pc.col(cId[c]-1);
+            sidePt.col(k) /= static_cast<T>(cId.size());
+        }
+        else
+            sidePt.col(k) = pc.col(nCorP+side-1);
     }
+    grid.build(sidePt, tol);
+}
+
+template<class T>
+void gsMultiPatch<T>::matchSides(const gsSpatialGrid<T> & grid,
+                                 const std::vector<gsMatrix<T> > & refPoints, T tol,
+                                 std::vector<index_t> & unmatched)
+{
+    const index_t nCorS  = 1 << (m_dim-1); // corners per side
+    const index_t nSides = 2 * m_dim;
 
     gsVector<index_t>      dirMap(m_dim);
     gsVector<bool>         matched(nCorS), dirOr(m_dim);
@@ -329,44 +376,47 @@ bool gsMultiPatch<T>::computeTopology( T tol, bool cornersOnly )
     cId1.reserve(nCorS);
     cId2.reserve(nCorS);
 
-    while ( pSide.size() != 0 )
+    // Matching sides are searched among the sides with a coinciding
+    // reference point only. The sides are visited from the last one,
+    // as in the former quadratic search.
+    const index_t ns = grid.size();
+    std::vector<bool> done(ns, false); // side is matched
+    std::vector<index_t> cand;
+    for (index_t sk = ns - 1; sk >= 0; --sk)
     {
-        bool done = false;
-        const patchSide side = pSide.back();
-        pSide.pop_back();
-        for (size_t other=0; other<pSide.size(); ++other)
+        if ( done[sk] )
+            continue;
+        done[sk] = true;
+
+        const patchSide side(sk / nSides, sk % nSides + 1);
+        side.getContainedCorners(m_dim,cId1);
+        grid.query(grid.point(sk), cand);
+
+        bool found = false;
+        for (size_t c = 0; c != cand.size(); ++c)
         {
-            side        .getContainedCorners(m_dim,cId1);
-            pSide[other].getContainedCorners(m_dim,cId2);
+            if ( done[cand[c]] )
+                continue;
+            const patchSide other(cand[c] / nSides, cand[c] % nSides + 1);
+            other.getContainedCorners(m_dim,cId2);
             matched.setConstant(false);
-            
-            // Check whether the side center matches
-            if (!cornersOnly)
-                if ( ( pCorners[side.patch        ].col(nCorP+side-1        ) -
-                       pCorners[pSide[other].patch].col(nCorP+pSide[other]-1)
-                         ).norm() >= tol )
-                    continue;
-            
+
             // Check whether the vertices match and compute direction map and orientation
-            if ( matchVerticesOnSide( pCorners[side.patch]        , cId1, 0, 
-                                      pCorners[pSide[other].patch], cId2, 
+            if ( matchVerticesOnSide( refPoints[side.patch] , cId1, 0, 
+                                      refPoints[other.patch], cId2, 
                                       matched, dirMap, dirOr, tol ) )
             {
-                dirMap(side.direction()) = pSide[other].direction();
-                dirOr (side.direction()) = !( side.parameter() == pSide[other].parameter() );
-                gsBoxTopology::addInterface( boundaryInterface(side, pSide[other], dirMap, dirOr));
-                // done with pSide[other], remove it from candidate list
-                std::swap( pSide[other], pSide.back() );
-                pSide.pop_back();
-                done=true;
-                break;//for (size_t other=0..)
+                dirMap(side.direction()) = other.direction();
+                dirOr (side.direction()) = !( side.parameter() == other.parameter() );
+                gsBoxTopology::addInterface( boundaryInterface(side, other, dirMap, dirOr));
+                done[cand[c]] = true;
+                found = true;
+                break;
             }
         }
-        if (!done) // not an interface ?
-            gsBoxTopology::addBoundary( side );
+        if (!found)
+            unmatched.push_back(sk);
     }
-
-    return true;
 }
 
 
@@ -480,26 +530,37 @@ void gsMultiPatch<T>::closeGaps(T tol)
     // mapped to unique global indices
     mapper.finalize();
 
-    gsMatrix<T> meanVal;
-    std::vector<std::pair<index_t,index_t> > dof; 
+    // Average the control points of every coupled dof. The sums are
+    // accumulated in one pass over the patch-local dofs
     const index_t start = mapper.freeSize() - mapper.coupledSize();
     const index_t end   = mapper.freeSize();
+    gsMatrix<T>       meanVal(end - start, geoDim());
+    gsVector<index_t> count  (end - start);
+    meanVal.setZero();
+    count  .setZero();
 
-    for (index_t i = start; i!= end; ++i) // For all coupled DoFs
-    {
-        // Get the preimages of this global dof (as pairs (patch,index) )
-        mapper.preImage(i, dof);
-
-        // Compute the mean value
-        meanVal = m_patches[dof.front().first]->coef(dof.front().second);
-        for (size_t k = 1; k!=dof.size(); ++k)
-            meanVal += m_patches[dof[k].first]->coef(dof[k].second);
-        meanVal.array() /= dof.size();
-        
-        // Set involved control points equal to their average value
-        for (size_t k = 0; k!=dof.size(); ++k)
-            m_patches[dof[k].first]->coef(dof[k].second) = meanVal;
-    }
+    for (index_t p = 0; p!= sz; ++p)
+        for (index_t i = 0; i!= patchSizes[p]; ++i)
+        {
+            const index_t gl = mapper.index(i, p);
+            if ( gl >= start && gl < end ) // coupled dof
+            {
+                meanVal.row(gl-start) += m_patches[p]->coef(i);
+                ++count[gl-start];
+            }
+        }
+
+    for (index_t k = 0; k!= end - start; ++k)
+        meanVal.row(k) /= static_cast<T>(count[k]);
+
+    // Set involved control points equal to their average value
+    for (index_t p = 0; p!= sz; ++p)
+        for (index_t i = 0; i!= patchSizes[p]; ++i)
+        {
+            const index_t gl = mapper.index(i, p);
+            if ( gl >= start && gl < end )
+                m_patches[p]->coef(i) = meanVal.row(gl-start);
+        }
 }
 
 
@@ -0,0 +1,182 @@
+/** @file gsPointLocator.h
+
+    @brief Provides the computation of the parameters of physical
+    points on geometries and multipatches.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <gsCore/gsLinearAlgebra.h>
+#include <gsIO/gsOptionList.h>
+
+namespace gismo
+{
+
+/**
+   @brief Finds the patch and the parameters of physical points on a
+   geometry or a multipatch (point inversion).
+
+   On construction, every element of every patch is enclosed by the
+   bounding box of the control points of the basis functions which
+   are active on it. By the convex hull property the box contains the
+   image of the element. The boxes are organized in a bounding volume
+   hierarchy (BVH). Moreover, the patches are sampled at a few points
+   per element.
+
+   For every point, the nearest sample is found by a branch-and-bound
+   search in the hierarchy, and Newton's method (Gauss-Newton if the
+   geometry is a curve or a surface in higher dimension) is started
+   from the parameters of this sample. If the iteration does not reach
+   the point, it is restarted from the nearest sample of every other
+   element whose box contains the point. The parameters are clamped
+   to the parameter domain of the patch.
+
+   Points which are not on the geometry are projected to it, ie. the
+   result is a (local) closest point. The distances returned by
+   locate() tell whether a point was reached.
+
+   The points are treated in parallel, with the number of threads of
+   the OpenMP runtime.
+
+   \code
+   gsPointLocator<> loc(mp);
+   gsMatrix<> params;
+   gsVector<index_t> patches;
+   gsVector<> dist;
+   loc.locate(points, patches, params, dist);
+   \endcode
+
+   \ingroup Core
+*/
+template<class T>
+class gsPointLocator
+{
+public:
+
+    /// Point locator on all patches of \a mp
+    explicit gsPointLocator(const gsMultiPatch<T> & mp,
+                            const gsOptionList & opt = defaultOptions());
+
+    /// Point locator on the geometry \a geo
+    explicit gsPointLocator(const gsGeometry<T> & geo,
+                            const gsOptionList & opt = defaultOptions());
+
+    /// \brief Returns the options of the locator:
+    /// Accuracy (distance for accepting a point, default 1e-6),
+    /// MaxIterations (Newton iterations per starting point, default 20),
+    /// SamplesPerElement (samples per element and direction, default 3).
+    static gsOptionList defaultOptions();
+
+public:
+
+    /**
+       \brief Computes the parameters of the columns of \a points
+
+       \param[in] points physical points (one per column)
+       \param[out] patches the patch of every point
+       \param[out] params the parameters of every point in its patch
+       \param[out] distances the distance of every point to the image
+       of its parameters. It is at most Accuracy for the points which
+       were reached.
+
+       Points with non-finite coordinates (NaN or infinity) cannot be
+       located: their patch is -1, their parameters are NaN and their
+       distance is infinity.
+    */
+    void locate(const gsMatrix<T> & points, gsVector<index_t> & patches,
+                gsMatrix<T> & params, gsVector<T> & distances) const;
+
+    /// Sets the distance for accepting a point (option Accuracy)
+    void setAccuracy(const T accuracy) { m_accuracy = accuracy; }
+
+    /// \brief Returns true if the coefficients of the patches are
+    /// the ones the locator was built with. Otherwise the locator has
+    /// to be constructed again.
+    bool upToDate() const;
+
+    /// Number of patches
+    index_t nPatches() const { return m_patches.size(); }
+
+    /// Number of elements (boxes) in the hierarchy
+    index_t nElements() const { return m_elPatch.size(); }
+
+private:
+
+    void build(const gsOptionList & opt);
+
+    void buildTree(index_t node, index_t first, index_t last);
+
+    // Nearest sample to \a pt, returns its index
+    index_t nearestSample(const T * pt) const;
+
+    // Indices of the elements whose box contains pt
+    void containingElements(const T * pt, std::vector<index_t> & result) const;
+
+    // Nearest sample of element \a el to pt
+    index_t nearestSampleOf(index_t el, const T * pt) const;
+
+    // Newton iteration on patch \a p starting at \a u, returns the
+    // distance of \a pt to the image of the resulting \a u
+    T newton(index_t p, const gsVector<T> & pt, gsVector<T> & u) const;
+
+    // Squared distance of \a pt to the box stored at \a box
+    T boxDistance2(const T * box, const T * pt) const;
+
+private:
+
+    struct centerLess;
+
+    struct node
+    {
+        index_t child;       ///< first child (second is child+1), -1 for leaves
+        index_t first, last; ///< range of elements (in m_elOrder) of a leaf
+    };
+
+    /// The patches
+    std::vector<const gsGeometry<T> *> m_patches;
+
+    /// Parameter domains of the patches
+    std::vector<gsMatrix<T> > m_support;
+
+    /// Coefficients of the patches at construction, see upToDate()
+    std::vector<gsMatrix<T> > m_coefs;
+
+    /// Dimensions of parameters and of points
+    index_t m_parDim, m_geoDim;
+
+    /// Options
+    T       m_accuracy;
+    index_t m_maxIter;
+
+    /// Patch of every element
+    std::vector<index_t> m_elPatch;
+
+    /// Element boxes (lower, upper corner), 2*m_geoDim entries per element
+    std::vector<T> m_elBox;
+
+    /// Samples of element el are the columns m_elSample[el] to
+    /// m_elSample[el+1]-1 of m_samplePar and m_samplePts
+    std::vector<index_t> m_elSample;
+
+    /// Parameters and images of the samples
+    gsMatrix<T> m_samplePar, m_samplePts;
+
+    /// Nodes of the hierarchy (the root is the first node) and their boxes
+    std::vector<node> m_nodes;
+    std::vector<T>    m_nodeBox;
+
+    /// The elements, ordered such that every leaf is a range
+    std::vector<index_t> m_elOrder;
+};
+
+} // namespace gismo
+
+#ifndef GISMO_BUILD_LIB
+#include GISMO_HPP_HEADER(gsPointLocator.hpp)
+#endif
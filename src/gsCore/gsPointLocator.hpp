@@ -0,0 +1,437 @@
+/** @file gsPointLocator.hpp
+
+    @brief Provides the computation of the parameters of physical
+    points on geometries and multipatches.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <gsCore/gsPointLocator.h>
+#include <gsCore/gsMultiPatch.h>
+#include <gsCore/gsDomainIterator.h>
+#include <gsMpi/gsOpenMP.h>
+#include <gsUtils/gsCombinatorics.h>
+
+namespace gismo
+{
+
+// Orders elements by the centers of their boxes in one direction
+template<class T>
+struct gsPointLocator<T>::centerLess
+{
+    centerLess(const std::vector<T> & box, index_t dim, index_t axis)
+    : m_box(box), m_dim(dim), m_axis(axis) { }
+
+    bool operator()(const index_t a, const index_t b) const
+    {
+        return m_box[2*m_dim*a + m_axis] + m_box[2*m_dim*a + m_dim + m_axis] <
+               m_box[2*m_dim*b + m_axis] + m_box[2*m_dim*b + m_dim + m_axis];
+    }
+
+    const std::vector<T> & m_box;
+    index_t m_dim, m_axis;
+};
+
+template<class T>
+gsPointLocator<T>::gsPointLocator(const gsMultiPatch<T> & mp, const gsOptionList & opt)
+{
+    m_patches.reserve(mp.nPatches());
+    for (size_t p = 0; p != mp.nPatches(); ++p)
+        m_patches.push_back( &mp.patch(p) );
+    build(opt);
+}
+
+template<class T>
+gsPointLocator<T>::gsPointLocator(const gsGeometry<T> & geo, const gsOptionList & opt)
+{
+    m_patches.push_back(&geo);
+    build(opt);
+}
+
+template<class T>
+gsOptionList gsPointLocator<T>::defaultOptions()
+{
+    gsOptionList opt;
+    opt.addReal("Accuracy"         , "Distance for accepting a point", 1e-6);
+    opt.addInt ("MaxIterations"    , "Maximum number of Newton iterations per starting point", 20);
+    opt.addInt ("SamplesPerElement", "Number of samples per element and direction", 3);
+    return opt;
+}
+
+template<class T>
+void gsPointLocator<T>::build(const gsOptionList & opt)
+{
+    GISMO_ENSURE( ! m_patches.empty(), "No patches given");
+    m_accuracy = opt.askReal("Accuracy"     , 1e-6);
+    m_maxIter  = opt.askInt ("MaxIterations", 20  );
+    const index_t ns = opt.askInt("SamplesPerElement", 3);
+    GISMO_ENSURE( ns > 0, "At least one sample per element is needed");
+
+    m_parDim = m_patches.front()->parDim();
+    m_geoDim = m_patches.front()->geoDim();
+    const index_t g = m_geoDim;
+
+    // Samples on the reference element [0,1]^d
+    gsVector<index_t> nv;
+    nv.setConstant(m_parDim, ns);
+    const index_t nsEl = nv.prod();
+    gsMatrix<T> ref(m_parDim, nsEl);
+    gsVector<index_t> cur;
+    cur.setZero(m_parDim);
+    index_t c = 0;
+    do
+    {
+        ref.col(c++) = ( cur.template cast<T>().array() + 0.5 ) / static_cast<T>(ns);
+    }
+    while ( nextLexicographic(cur, nv) );
+
+    m_support.resize(m_patches.size());
+    m_coefs  .resize(m_patches.size());
+    m_elSample.assign(1, 0);
+    std::vector<gsMatrix<T> > par(m_patches.size()), pts(m_patches.size());
+    gsMatrix<unsigned> act;
+    for (size_t p = 0; p != m_patches.size(); ++p)
+    {
+        const gsGeometry<T> & geo = *m_patches[p];
+        GISMO_ENSURE( geo.parDim() == m_parDim && geo.geoDim() == g,
+                      "The patches must have the same dimensions");
+        m_support[p] = geo.support();
+        m_coefs  [p] = geo.coefs();
+        const gsMatrix<T> & coefs = geo.coefs();
+
+        const typename gsBasis<T>::domainIter it = geo.basis().makeDomainIterator();
+        std::vector<T> samples;
+        for (; it->good(); it->next())
+        {
+            // Bounding box of the control points of the active functions
+            geo.basis().active_into(it->centerPoint(), act);
+            const size_t el = m_elPatch.size();
+            m_elPatch.push_back(p);
+            m_elBox.resize(m_elBox.size() + 2*g);
+            gsAsVector<T> lo(&m_elBox[2*g*el], g), up(&m_elBox[2*g*el+g], g);
+            lo = up = coefs.row(act(0,0)).transpose();
+            for (index_t k = 1; k < act.rows(); ++k)
+            {
+                lo = lo.cwiseMin(coefs.row(act(k,0)).transpose());
+                up = up.cwiseMax(coefs.row(act(k,0)).transpose());
+            }
+
+            const gsVector<T> & a = it->lowerCorner();
+            const gsVector<T> h   = it->upperCorner() - a;
+            for (index_t s = 0; s != nsEl; ++s)
+                for (index_t i = 0; i != m_parDim; ++i)
+                    samples.push_back( a[i] + h[i] * ref(i,s) );
+            m_elSample.push_back(m_elSample.back() + nsEl);
+        }
+
+        par[p] = gsAsConstMatrix<T>(samples, m_parDim, samples.size() / m_parDim);
+        geo.eval_into(par[p], pts[p]);
+    }
+
+    const index_t nSamples = m_elSample.back();
+    m_samplePar.resize(m_parDim, nSamples);
+    m_samplePts.resize(g       , nSamples);
+    for (size_t p = 0, s = 0; p != m_patches.size(); s += par[p].cols(), ++p)
+    {
+        m_samplePar.middleCols(s, par[p].cols()) = par[p];
+        m_samplePts.middleCols(s, pts[p].cols()) = pts[p];
+    }
+
+    // Enlarge the boxes by the samples, in case the basis lacks the
+    // convex hull property
+    for (index_t el = 0; el != nElements(); ++el)
+    {
+        gsAsVector<T> lo(&m_elBox[2*g*el], g), up(&m_elBox[2*g*el+g], g);
+        for (index_t s = m_elSample[el]; s != m_elSample[el+1]; ++s)
+        {
+            lo = lo.cwiseMin(m_samplePts.col(s));
+            up = up.cwiseMax(m_samplePts.col(s));
+        }
+    }
+
+    // Bounding volume hierarchy
+    m_elOrder.resize(nElements());
+    for (index_t el = 0; el != nElements(); ++el)
+        m_elOrder[el] = el;
+    m_nodes.resize(1);
+    m_nodeBox.resize(2*g);
+    buildTree(0, 0, nElements());
+}
+
+template<class T>
+bool gsPointLocator<T>::upToDate() const
+{
+    for (size_t p = 0; p != m_patches.size(); ++p)
+    {
+        const gsMatrix<T> & coefs = m_patches[p]->coefs();
+        if ( coefs.rows() != m_coefs[p].rows() || coefs.cols() != m_coefs[p].cols() ||
+             coefs != m_coefs[p] )
+            return false;
+    }
+    return true;
+}
+
+template<class T>
+void gsPointLocator<T>::buildTree(index_t n, index_t first, index_t last)
+{
+    const index_t g = m_geoDim;
+    const index_t leafSize = 4;
+
+    // Box of the node
+    gsAsVector<T> lo(&m_nodeBox[2*g*n], g), up(&m_nodeBox[2*g*n+g], g);
+    lo = gsAsConstVector<T>(&m_elBox[2*g*m_elOrder[first]  ], g);
+    up = gsAsConstVector<T>(&m_elBox[2*g*m_elOrder[first]+g], g);
+    for (index_t k = first + 1; k < last; ++k)
+    {
+        lo = lo.cwiseMin(gsAsConstVector<T>(&m_elBox[2*g*m_elOrder[k]  ], g));
+        up = up.cwiseMax(gsAsConstVector<T>(&m_elBox[2*g*m_elOrder[k]+g], g));
+    }
+
+    m_nodes[n].first = first;
+    m_nodes[n].last  = last;
+    if ( last - first <= leafSize )
+    {
+        m_nodes[n].child = -1;
+        return;
+    }
+
+    // Split at the median of the longest side
+    index_t axis = 0;
+    for (index_t i = 1; i != g; ++i)
+        if ( up[i] - lo[i] > up[axis] - lo[axis] )
+            axis = i;
+    const index_t mid = (first + last) / 2;
+    std::nth_element(m_elOrder.begin() + first, m_elOrder.begin() + mid,
+                     m_elOrder.begin() + last, centerLess(m_elBox, g, axis));
+
+    const index_t child = m_nodes.size();
+    m_nodes[n].child = child;
+    m_nodes.resize(child + 2);
+    m_nodeBox.resize(m_nodeBox.size() + 4*g);
+    buildTree(child  , first, mid );
+    buildTree(child+1, mid  , last);
+}
+
+template<class T>
+T gsPointLocator<T>::boxDistance2(const T * box, const T * pt) const
+{
+    T result = 0;
+    for (index_t i = 0; i != m_geoDim; ++i)
+    {
+        const T d = math::max( box[i] - pt[i], pt[i] - box[m_geoDim + i] );
+        if ( d > 0 )
+            result += d * d;
+    }
+    return result;
+}
+
+template<class T>
+index_t gsPointLocator<T>::nearestSample(const T * pt) const
+{
+    const gsAsConstVector<T> x(pt, m_geoDim);
+    const index_t g = m_geoDim;
+    index_t best  = -1;
+    T       bestD = std::numeric_limits<T>::max();
+
+    std::vector<index_t> stack(1, 0);
+    while ( ! stack.empty() )
+    {
+        const node & nd = m_nodes[stack.back()];
+        stack.pop_back();
+
+        if ( -1 == nd.child )
+        {
+            for (index_t k = nd.first; k != nd.last; ++k)
+            {
+                const index_t el = m_elOrder[k];
+                if ( boxDistance2(&m_elBox[2*g*el], pt) >= bestD )
+                    continue;
+                for (index_t s = m_elSample[el]; s != m_elSample[el+1]; ++s)
+                {
+                    const T d = (m_samplePts.col(s) - x).squaredNorm();
+                    if ( d < bestD )
+                    {
+                        bestD = d;
+                        best  = s;
+                    }
+                }
+            }
+            continue;
+        }
+
+        // Visit the nearer child first
+        const T d0 = boxDistance2(&m_nodeBox[2*g* nd.child   ], pt);
+        const T d1 = boxDistance2(&m_nodeBox[2*g*(nd.child+1)], pt);
+        if ( d0 < d1 )
+        {
+            if ( d1 < bestD ) stack.push_back(nd.child+1);
+            if ( d0 < bestD ) stack.push_back(nd.child  );
+        }
+        else
+        {
+            if ( d0 < bestD ) stack.push_back(nd.child  );
+            if ( d1 < bestD ) stack.push_back(nd.child+1);
+        }
+    }
+    return best;
+}
+
+template<class T>
+void gsPointLocator<T>::containingElements(const T * pt, std::vector<index_t> & result) const
+{
+    const index_t g = m_geoDim;
+    const T tol2 = m_accuracy * m_accuracy;
+    result.clear();
+
+    std::vector<index_t> stack(1, 0);
+    while ( ! stack.empty() )
+    {
+        const index_t n = stack.back();
+        stack.pop_back();
+        if ( boxDistance2(&m_nodeBox[2*g*n], pt) > tol2 )
+            continue;
+
+        const node & nd = m_nodes[n];
+        if ( -1 == nd.child )
+        {
+            for (index_t k = nd.first; k != nd.last; ++k)
+                if ( boxDistance2(&m_elBox[2*g*m_elOrder[k]], pt) <= tol2 )
+                    result.push_back(m_elOrder[k]);
+        }
+        else
+        {
+            stack.push_back(nd.child  );
+            stack.push_back(nd.child+1);
+        }
+    }
+}
+
+template<class T>
+index_t gsPointLocator<T>::nearestSampleOf(index_t el, const T * pt) const
+{
+    const gsAsConstVector<T> x(pt, m_geoDim);
+    index_t best  = m_elSample[el];
+    T       bestD = (m_samplePts.col(best) - x).squaredNorm();
+    for (index_t s = best + 1; s != m_elSample[el+1]; ++s)
+    {
+        const T d = (m_samplePts.col(s) - x).squaredNorm();
+        if ( d < bestD )
+        {
+            bestD = d;
+            best  = s;
+        }
+    }
+    return best;
+}
+
+template<class T>
+T gsPointLocator<T>::newton(index_t p, const gsVector<T> & pt, gsVector<T> & u) const
+{
+    const gsGeometry<T> & geo  = *m_patches[p];
+    const gsMatrix<T>   & supp = m_support[p];
+    const T stepTol = m_accuracy * (supp.col(1) - supp.col(0)).maxCoeff();
+    gsMatrix<T> res, jac, delta;
+    bool stationary = false;
+
+    for (index_t iter = 0; ; ++iter)
+    {
+        // clamp u to the parameter domain
+        u = u.cwiseMax( supp.col(0) ).cwiseMin( supp.col(1) );
+
+        geo.eval_into(u, res);
+        res = pt - res;
+        const T dist = res.norm();
+        if ( dist <= m_accuracy || stationary || iter == m_maxIter )
+            return dist;
+
+        geo.jacobian_into(u, jac);
+        if ( m_parDim == m_geoDim )
+            delta = jac.partialPivLu().solve(res);
+        else // least squares (closest point)
+            delta = jac.colPivHouseholderQr().solve(res);
+
+        u += delta;
+        stationary = ( delta.norm() <= stepTol );
+    }
+}
+
+template<class T>
+void gsPointLocator<T>::locate(const gsMatrix<T> & points, gsVector<index_t> & patches,
+                               gsMatrix<T> & params, gsVector<T> & distances) const
+{
+    GISMO_ENSURE( points.rows() == m_geoDim, "The points have wrong dimension");
+    const index_t n = points.cols();
+    patches  .resize(n);
+    params   .resize(m_parDim, n);
+    distances.resize(n);
+
+#   pragma omp parallel
+    {
+        gsVector<T> pt, u;
+        std::vector<index_t> cand;
+        std::vector<std::pair<T,index_t> > seeds;
+
+#       pragma omp for schedule(dynamic, 64)
+        for (index_t i = 0; i < n; ++i)
+        {
+            pt = points.col(i);
+
+            // Start at the nearest sample. There is none if the
+            // point has non-finite coordinates.
+            index_t s = pt.allFinite() ? nearestSample(pt.data()) : -1;
+            if ( s < 0 )
+            {
+                patches[i]   = -1;
+                params.col(i).setConstant( std::numeric_limits<T>::quiet_NaN() );
+                distances[i] = std::numeric_limits<T>::infinity();
+                continue;
+            }
+            index_t el = std::upper_bound(m_elSample.begin(), m_elSample.end(), s)
+                - m_elSample.begin() - 1;
+            u = m_samplePar.col(s);
+            T dist = newton(m_elPatch[el], pt, u);
+            patches[i]    = m_elPatch[el];
+            params.col(i) = u;
+
+            // Restart at the elements whose box contains the point,
+            // nearest first
+            if ( dist > m_accuracy )
+            {
+                containingElements(pt.data(), cand);
+                seeds.clear();
+                for (size_t k = 0; k != cand.size(); ++k)
+                {
+                    if ( cand[k] == el )
+                        continue;
+                    s = nearestSampleOf(cand[k], pt.data());
+                    seeds.push_back( std::make_pair( (m_samplePts.col(s) - pt).squaredNorm(), s) );
+                }
+                std::sort(seeds.begin(), seeds.end());
+
+                for (size_t k = 0; k != seeds.size() && dist > m_accuracy; ++k)
+                {
+                    s  = seeds[k].second;
+                    el = std::upper_bound(m_elSample.begin(), m_elSample.end(), s)
+                        - m_elSample.begin() - 1;
+                    u  = m_samplePar.col(s);
+                    const T d = newton(m_elPatch[el], pt, u);
+                    if ( d < dist )
+                    {
+                        dist          = d;
+                        patches[i]    = m_elPatch[el];
+                        params.col(i) = u;
+                    }
+                }
+            }
+            distances[i] = dist;
+        }
+    }
+}
+
+} // namespace gismo
@@ -0,0 +1,9 @@
+#include <gsCore/gsTemplateTools.h>
+
+#include <gsCore/gsPointLocator.h>
+#include <gsCore/gsPointLocator.hpp>
+
+namespace gismo
+{
+    CLASS_TEMPLATE_INST gsPointLocator<real_t>;
+}
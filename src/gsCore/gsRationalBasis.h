@@ -137,6 +137,8 @@ public:
     int size(int const& k) const{ return m_src->size(k); }
 
     int numElements() const { return m_src->numElements(); }
+
+    int elementIndex(const gsVector<T> & u ) const { return m_src->elementIndex(u); }
     
     void active_into(const gsMatrix<T> & u, gsMatrix<unsigned>& result) const 
     { m_src->active_into(u, result); }
@@ -242,6 +244,12 @@ public:
 
     void evalFunc_into(const gsMatrix<T> & u, const gsMatrix<T> & coefs, gsMatrix<T>& result) const;
 
+    void evalFuncOnGrid_into(const std::vector< gsVector<T> > & cwise,
+                             const gsMatrix<T> & coefs, gsMatrix<T>& result) const;
+
+    void evalAllDersFunc_into(const gsMatrix<T> & u, const gsMatrix<T> & coefs,
+                              const unsigned n, std::vector< gsMatrix<T> >& result) const;
+
     //void evalAllDers_into(const gsMatrix<T> & u, int n, 
     //                      std::vector<gsMatrix<T> >& result) const;
     
@@ -393,6 +401,94 @@ void gsRationalBasis<SrcT>::evalFunc_into(const gsMatrix<T> & u, const gsMatrix<
     //for ( index_t j=0; j < u.cols(); j++ ) // for all points (columns of u)
     //    result.col(j) /= denom(0,j);
 }
+
+template<class SrcT>
+void gsRationalBasis<SrcT>::evalFuncOnGrid_into(const std::vector< gsVector<T> > & cwise,
+                                                const gsMatrix<T> & coefs, gsMatrix<T>& result) const
+{
+    assert( coefs.rows() == m_weights.rows() ) ;
+    const index_t n = coefs.cols();
+
+    // Projective coefficients, the weights in the last column
+    gsMatrix<T> tmp(coefs.rows(), n + 1);
+    tmp.leftCols(n) = m_weights.asDiagonal() * coefs;
+    tmp.col(n)      = m_weights;
+
+    // Evaluate the numerator and the denominator at once
+    gsMatrix<T> val;
+    m_src->evalFuncOnGrid_into(cwise, tmp, val);
+
+    // Divide numerator by denominator
+    result = val.topRows(n);
+    result.array().rowwise() /= val.row(n).array();
+}
+
+template<class SrcT>
+void gsRationalBasis<SrcT>::evalAllDersFunc_into(const gsMatrix<T> & u,
+                                                 const gsMatrix<T> & coefs,
+                                                 const unsigned n,
+                                                 std::vector< gsMatrix<T> >& result) const
+{
+    if ( n > 2 )
+    {
+        Base::evalAllDersFunc_into(u, coefs, n, result);
+        return;
+    }
+
+    assert( coefs.rows() == m_weights.rows() ) ;
+    const index_t nc = coefs.cols();
+    const index_t pd = m_src->dim();
+    const index_t s2 = pd + (pd*(pd-1))/2;
+
+    // Derivatives of the numerator and the denominator at once, the
+    // weights in the last column of the projective coefficients
+    gsMatrix<T> tmp(coefs.rows(), nc + 1);
+    tmp.leftCols(nc) = m_weights.asDiagonal() * coefs;
+    tmp.col(nc)      = m_weights;
+    std::vector< gsMatrix<T> > ev;
+    m_src->evalAllDersFunc_into(u, tmp, n, ev);
+
+    // Quotient rule
+    result.resize(n+1);
+    result[0] = ev[0].topRows(nc);
+    result[0].array().rowwise() /= ev[0].row(nc).array();
+    if ( n > 0 )
+    {
+        const gsMatrix<T> & val = result[0];
+        result[1].resize(nc*pd, u.cols());
+        for (index_t j = 0; j != u.cols(); ++j)
+        {
+            const T w = ev[0](nc,j);
+            for (index_t c = 0; c != nc; ++c)
+                for (index_t k = 0; k != pd; ++k)
+                    result[1](c*pd+k,j) = ( ev[1](c*pd+k,j) - val(c,j) * ev[1](nc*pd+k,j) ) / w;
+        }
+    }
+    if ( n > 1 )
+    {
+        const gsMatrix<T> & val = result[0];
+        const gsMatrix<T> & der = result[1];
+        result[2].resize(nc*s2, u.cols());
+        for (index_t j = 0; j != u.cols(); ++j)
+        {
+            const T w = ev[0](nc,j);
+            for (index_t c = 0; c != nc; ++c)
+            {
+                // pure derivatives, then mixed ones in lexicographic order
+                index_t m = pd;
+                for (index_t k = 0; k != pd; ++k)
+                {
+                    result[2](c*s2+k,j) = ( ev[2](c*s2+k,j) - val(c,j) * ev[2](nc*s2+k,j)
+                        - 2 * der(c*pd+k,j) * ev[1](nc*pd+k,j) ) / w;
+                    for (index_t l = k+1; l < pd; ++l, ++m)
+                        result[2](c*s2+m,j) = ( ev[2](c*s2+m,j) - val(c,j) * ev[2](nc*s2+m,j)
+                            - der(c*pd+k,j) * ev[1](nc*pd+l,j)
+                            - der(c*pd+l,j) * ev[1](nc*pd+k,j) ) / w;
+                }
+            }
+        }
+    }
+}
     
 
 /* TODO
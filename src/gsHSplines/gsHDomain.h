@@ -88,6 +88,9 @@ private:
 
 private:
 
+    /// Memory of the nodes of the tree
+    gsKdNodePool<d,T> m_pool;
+
     /// Pointer to the root node of the tree
     node * m_root;
 
@@ -112,31 +115,20 @@ public:
         m_maxPath = 0;
     }
     
-    gsHDomain(point const & upp)
+    gsHDomain(point const & upp) : m_root(NULL)
     {
         init(upp);
     }
 
-/*
-    /// Constructor using a given node 
-    gsHDomain(const node & root_node, unsigned index_level_ , unsigned max_ins_level_ )
-    {
-        m_root          = new node(root_node) ;
-        m_root->parent  = NULL                ;
-        m_index_level = index_level_        ;
-        max_ins_level = max_ins_level_      ;
-    }
-*/
-
     /// Copy constructor (makes a deep copy)
     gsHDomain( const gsHDomain & o) :
+        m_pool(o.m_pool),
+        m_root(o.m_root ? m_pool.at(o.m_root->id) : NULL),
         m_upperIndex(o.m_upperIndex),
         m_indexLevel(o.m_indexLevel),
         m_maxInsLevel(o.m_maxInsLevel),
         m_maxPath(o.m_maxPath)
-    {
-        m_root = new node(*o.m_root);
-    }
+    { }
 
     /// Assignment operator (makes a deep copy)
     gsHDomain& operator=( const gsHDomain & o)
@@ -144,7 +136,8 @@ public:
         if ( this == &o )
             return *this;
         
-        m_root = new node(*o.m_root);
+        m_pool = o.m_pool;
+        m_root = o.m_root ? m_pool.at(o.m_root->id) : NULL;
 
         m_upperIndex  = o.m_upperIndex;
         m_indexLevel  = o.m_indexLevel;
@@ -160,18 +153,20 @@ public:
         m_indexLevel = index_level;
         m_maxInsLevel = 0;
 
-        if ( m_root )
-            delete m_root;
+        m_pool.clear();
 
         for (unsigned i=0; i<d; ++i) 
             m_upperIndex[i] = (upp[i]<< m_indexLevel);
 
-        m_root = new node(m_upperIndex);
+        // Initial box, expressed in the index level
+        m_root = m_pool.create();
+        m_root->axis = -1;
+        m_root->setBox( box(point::Zero(), m_upperIndex) );
         m_maxPath = 1;
     }
 
     /// Destructor deletes the whole tree
-    ~gsHDomain() { delete m_root; }
+    ~gsHDomain() { }
 
     /// Clones the object
     gsHDomain * clone() const;
@@ -235,6 +230,24 @@ public:
     void insertBox (point const & lower, point const & upper, int lvl)
     { insertBox(lower, upper, m_root, lvl); }
 
+    /** \brief Inserts several boxes in one traversal of the tree.
+
+    Each box is defined by <em>2d+1</em> entries of \a boxes: the
+    level in which the box is inserted, followed by the lower and
+    the upper corner given by unique knot indices of this level (the
+    format of gsHTensorBasis::refineElements()). The boxes of the
+    same level whose union is a box are merged before the
+    insertion. The resulting domain is the same as when inserting
+    the boxes one by one with insertBox().
+
+    \param boxes the boxes to be inserted
+    \param changed if not NULL, boxes which cover all the cells whose
+    level was increased are appended to \a changed, in the same
+    format, with corners given in the index level
+    */
+    void insertBoxes(std::vector<unsigned> const & boxes,
+                     std::vector<unsigned> * changed = NULL);
+
     /** \brief Sinks the box defined by points \em lower and \em upper
     to one level higher.
 
@@ -243,8 +256,11 @@ public:
     \param lower the lower left corner of the box
     \param upper the upper right corner of the box
     \param lvl the level in which \a lower and \a upper are defined
+    \param changed if not NULL, boxes which cover all the cells whose
+    level was increased are appended (see insertBoxes())
     */
-    void sinkBox (point const & lower, point const & upper, int lvl);
+    void sinkBox (point const & lower, point const & upper, int lvl,
+                  std::vector<unsigned> * changed = NULL);
 
     /// Returns the internal coordinates of point \a point_idx of level \a lvl
     void internalIndex (point const & point_idx, int lvl, point & internal_idx)
@@ -429,6 +445,10 @@ public:
         return const_literator(m_root, m_indexLevel);
     }
 
+    /// Merges the sibling leaves which have the same level and
+    /// stores the tree in breadth-first order
+    /// \warning The nodes are moved, therefore leaf iterators and
+    /// gsHDomainIterator objects of this tree become invalid
     void makeCompressed();
     
     /// Returns the number of nodes in the tree
@@ -565,6 +585,14 @@ private:
     /// Returns true if the box is degenerate (has zero volume)
     static bool isDegenerate(box const & someBox);
 
+    /// Merges the boxes of the same level whose union is a box. The
+    /// boxes are given as in insertBoxes()
+    static void mergeBoxes(std::vector<unsigned> & boxes);
+
+    /// Appends the box of the leaf \a leafNode to \a boxes, in the
+    /// format of insertBoxes()
+    static void appendLeafBox(node const * leafNode, std::vector<unsigned> & boxes);
+
     /// Adds \a nlevels new index levels in the tree
     void setIndexLevel(int nlevels) const
     {
@@ -700,6 +728,30 @@ private:
         }
     };
 
+    /// Orders boxes given as in insertBoxes() by level, then by their
+    /// coordinates in the directions other than \a dir, then by
+    /// their lower coordinate in direction \a dir
+    struct boxOrder
+    {
+        boxOrder(std::vector<unsigned> const & boxes, unsigned dir)
+        : m_boxes(boxes), m_dir(dir) { }
+
+        bool operator()(unsigned a, unsigned b) const
+        {
+            const unsigned * ba = &m_boxes[a];
+            const unsigned * bb = &m_boxes[b];
+            if ( ba[0] != bb[0] )
+                return ba[0] < bb[0];
+            for ( unsigned j = 1; j != 2*d+1; ++j )
+                if ( j != m_dir + 1 && j != m_dir + d + 1 && ba[j] != bb[j] )
+                    return ba[j] < bb[j];
+            return ba[m_dir+1] < bb[m_dir+1];
+        }
+
+        std::vector<unsigned> const & m_boxes;
+        unsigned m_dir;
+    };
+
     /// Counts number of nodes in the tree
     struct printLeaves_visitor
     {
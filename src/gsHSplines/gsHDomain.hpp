@@ -241,7 +241,7 @@ gsHDomain<d,T>::insertBox ( point const & k1, point const & k2,
             }
             else if ( haveOverlap(*curNode->box, iBox) )
             {
-                curNode->nextMidSplit();
+                curNode->nextMidSplit(m_pool);
                 stack.push_back(curNode);
             }
         }
@@ -256,8 +256,8 @@ gsHDomain<d,T>::insertBox ( point const & k1, point const & k2,
                 continue;
 
             // Split the leaf (if possible)
-            //node * newLeaf = curNode->adaptiveSplit(iBox);
-            node * newLeaf = curNode->adaptiveAlignedSplit(iBox, m_indexLevel);
+            //node * newLeaf = curNode->adaptiveSplit(m_pool, iBox);
+            node * newLeaf = curNode->adaptiveAlignedSplit(m_pool, iBox, m_indexLevel);
             
             // If curNode is still a leaf, its domain is almost
             // contained in iBox
@@ -294,9 +294,179 @@ gsHDomain<d,T>::insertBox ( point const & k1, point const & k2,
         m_maxInsLevel = lvl;
 }
 
+template<unsigned d, class T > void
+gsHDomain<d,T>::insertBoxes(std::vector<unsigned> const & boxes,
+                            std::vector<unsigned> * changed)
+{
+    const unsigned bs = 2*d+1;
+    GISMO_ASSERT( 0 == boxes.size() % bs,
+                  "The points did not define boxes properly.");
+
+    // Represent the boxes in the index level
+    std::vector<unsigned> iBoxes;
+    iBoxes.reserve( boxes.size() );
+    box iBox;
+    for ( size_t i = 0; i < boxes.size(); i += bs )
+    {
+        const unsigned lvl = boxes[i];
+        GISMO_ENSURE( lvl <= m_indexLevel, "Max index level reached..");
+
+        for ( unsigned j = 0; j < d; ++j )
+        {
+            iBox.first [j] = boxes[i+1+j  ];
+            iBox.second[j] = boxes[i+1+d+j];
+        }
+        if( isDegenerate(iBox) )
+            continue;
+
+        local2globalIndex( iBox.first , lvl, iBox.first );
+        local2globalIndex( iBox.second, lvl, iBox.second);
+
+        // Ensure that the box is within the valid limits
+        if ( ( iBox.first.array() >= m_upperIndex.array() ).any() )
+        {
+            gsWarn<<" Invalid box coordinate "<< iBox.first.transpose() 
+                  <<" at level" <<lvl<<".\n";
+            continue;
+        }
+
+        iBoxes.push_back(lvl);
+        iBoxes.insert(iBoxes.end(), iBox.first .data(), iBox.first .data() + d);
+        iBoxes.insert(iBoxes.end(), iBox.second.data(), iBox.second.data() + d);
+
+        // Update maximum inserted level
+        if ( lvl > m_maxInsLevel)
+            m_maxInsLevel = lvl;
+    }
+
+    mergeBoxes(iBoxes);
+
+    // Stack of nodes, together with the positions (in iBoxes) of the
+    // boxes which overlap them
+    typedef std::pair<node*, std::vector<unsigned> > entry;
+    std::vector<entry> stack;
+    stack.reserve( 2 * (m_maxPath + d) );
+    stack.push_back( entry(m_root, std::vector<unsigned>()) );
+    for ( unsigned i = 0; i < iBoxes.size(); i += bs )
+        stack.back().second.push_back(i);
+
+    std::vector<unsigned> cur, left, right;
+    while ( ! stack.empty() )
+    {
+        node * curNode = stack.back().first;
+        cur.swap(stack.back().second);
+        stack.pop_back();
+
+        if ( curNode->isLeaf() ) // reached a leaf
+        {
+            // Keep the boxes whose level is higher than the level of the leaf
+            size_t n = 0;
+            for ( size_t k = 0; k != cur.size(); ++k )
+                if ( static_cast<int>(iBoxes[cur[k]]) > curNode->level )
+                    cur[n++] = cur[k];
+            cur.resize(n);
+            if ( cur.empty() )
+                continue;
+
+            // Split the leaf (if possible) according to one of the boxes
+            const unsigned * b = &iBoxes[cur.front()];
+            for ( unsigned j = 0; j < d; ++j )
+            {
+                iBox.first [j] = b[1+j  ];
+                iBox.second[j] = b[1+d+j];
+            }
+            
+            // If curNode is still a leaf, its domain is almost
+            // contained in the box
+            if ( ! curNode->adaptiveAlignedSplit(m_pool, iBox, m_indexLevel) )
+            {
+                ++curNode->level;
+                if ( changed )
+                    appendLeafBox(curNode, *changed);
+            }
+
+            // Treat the node again (either a leaf of higher level or
+            // a split-node)
+            stack.push_back( entry(curNode, std::vector<unsigned>()) );
+            stack.back().second.swap(cur);
+        }
+        else // distribute the boxes to the children
+        {
+            left .clear();
+            right.clear();
+            for ( size_t k = 0; k != cur.size(); ++k )
+            {
+                const unsigned * b = &iBoxes[cur[k]];
+                if ( b[1+curNode->axis] < curNode->pos )
+                    left .push_back(cur[k]);
+                if ( b[1+d+curNode->axis] > curNode->pos )
+                    right.push_back(cur[k]);
+            }
+            if ( ! left.empty() )
+            {
+                stack.push_back( entry(curNode->left , std::vector<unsigned>()) );
+                stack.back().second.swap(left);
+            }
+            if ( ! right.empty() )
+            {
+                stack.push_back( entry(curNode->right, std::vector<unsigned>()) );
+                stack.back().second.swap(right);
+            }
+        }
+    }
+}
+
+template<unsigned d, class T > void
+gsHDomain<d,T>::mergeBoxes(std::vector<unsigned> & boxes)
+{
+    const unsigned bs = 2*d+1;
+    std::vector<unsigned> order, merged;
+    merged.reserve( boxes.size() );
+
+    // In every direction, join the boxes which have the same extent
+    // in the other directions and touch or overlap in this direction
+    for ( unsigned dir = 0; dir < d; ++dir )
+    {
+        order.resize( boxes.size() / bs );
+        for ( size_t i = 0; i != order.size(); ++i )
+            order[i] = i * bs;
+        std::sort(order.begin(), order.end(), boxOrder(boxes, dir) );
+
+        merged.clear();
+        for ( size_t i = 0; i != order.size(); ++i )
+        {
+            const unsigned * b = &boxes[order[i]];
+            if ( ! merged.empty() )
+            {
+                unsigned * last = &merged[merged.size() - bs];
+                bool sameSlab = ( last[0] == b[0] ) && ( b[1+dir] <= last[1+d+dir] );
+                for ( unsigned j = 0; sameSlab && j < d; ++j )
+                    sameSlab = ( j == dir ) ||
+                        ( last[1+j] == b[1+j] && last[1+d+j] == b[1+d+j] );
+                if ( sameSlab )
+                {
+                    last[1+d+dir] = math::max(last[1+d+dir], b[1+d+dir]);
+                    continue;
+                }
+            }
+            merged.insert(merged.end(), b, b + bs);
+        }
+        boxes.swap(merged);
+    }
+}
+
+template<unsigned d, class T > void
+gsHDomain<d,T>::appendLeafBox(node const * leafNode, std::vector<unsigned> & boxes)
+{
+    boxes.push_back(leafNode->level);
+    boxes.insert(boxes.end(), leafNode->box->first .data(), leafNode->box->first .data() + d);
+    boxes.insert(boxes.end(), leafNode->box->second.data(), leafNode->box->second.data() + d);
+}
+
 template<unsigned d, class T > void
 gsHDomain<d,T>::sinkBox ( point const & k1, 
-                          point const & k2, int lvl)
+                          point const & k2, int lvl,
+                          std::vector<unsigned> * changed)
 {
     GISMO_ENSURE( m_maxInsLevel+1 <= m_indexLevel, 
                   "Max index level might be reached..");
@@ -332,7 +502,7 @@ gsHDomain<d,T>::sinkBox ( point const & k1,
         {
             // Since we reached a leaf, it should overlap with iBox.
             // Split the leaf (if possible)
-            node * newLeaf = curNode->adaptiveAlignedSplit(iBox, m_indexLevel);
+            node * newLeaf = curNode->adaptiveAlignedSplit(m_pool, iBox, m_indexLevel);
             
             // If curNode is still a leaf, its domain is almost
             // contained in iBox
@@ -341,6 +511,8 @@ gsHDomain<d,T>::sinkBox ( point const & k1,
                 // Increase level
                 if ( ++curNode->level > static_cast<int>(m_maxInsLevel) )
                     m_maxInsLevel = curNode->level;
+                if ( changed )
+                    appendLeafBox(curNode, *changed);
             }
             else // treat new child
             {
@@ -400,12 +572,15 @@ gsHDomain<d,T>::makeCompressed()
         if (curNode->left->level == curNode->right->level) 
         {
             // Merge left and right
-            curNode->merge();
+            curNode->merge(m_pool);
             if ( !curNode->isRoot() &&
                   curNode->parent->isTerminal() )
                 tstack.push(curNode->parent );
         }
     }
+
+    // Store the nodes contiguously, in breadth-first order
+    m_root = m_pool.relayout(m_root);
     
     // Store the max path length
     m_maxPath = minMaxPath().second;
@@ -55,7 +55,7 @@ public:
 
     gsHDomainBoundaryIterator(const gsHTensorBasis<d, T> & hbs, 
                               const boxSide & s )
-        : gsDomainIterator<T>(hbs)
+        : gsDomainIterator<T>(hbs, s)
     {
         // Initialize mesh data
         m_meshStart.resize(d);
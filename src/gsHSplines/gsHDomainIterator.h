@@ -70,12 +70,14 @@ public:
         m_quadrature.setNodes( gsVector<int>::Ones(d) );
 
         m_leaf = hbs.tree().beginLeafIterator();
+        m_elIndex = 0;
         updateLeaf();
     }
 
     // ---> Documentation in gsDomainIterator.h
     bool next()
     {
+        ++m_elIndex;
         this->m_isGood = nextLexicographic(m_curElement, m_meshStart, m_meshEnd);
 
         if (this->m_isGood) // new element in m_leaf
@@ -85,6 +87,46 @@ public:
 
         return this->m_isGood;
     }
+
+    // ---> Documentation in gsDomainIterator.h
+    // Leaves which are passed over are skipped by their number of
+    // elements, the target element of a leaf is reached in O(d).
+    // Hence the cost is at most linear in the increment, and does
+    // not involve the update of the intermediate elements.
+    bool next(index_t increment)
+    {
+        if ( 0 == increment || ! this->m_isGood ) return this->m_isGood;
+        m_elIndex += increment;
+
+        // Lexicographic position of the target element in the leaf
+        index_t pos = 0, numEl = 1;
+        for (unsigned i = 0; i < d; ++i)
+        {
+            pos   += numEl * (m_curElement[i] - m_meshStart[i]);
+            numEl *= m_meshEnd[i] - m_meshStart[i];
+        }
+        pos += increment;
+
+        if ( pos >= numEl )
+        {
+            pos -= numEl;
+            while ( m_leaf.next() && pos >= (numEl = leafSize()) )
+                pos -= numEl;
+            this->m_isGood = m_leaf.good();
+            if ( ! this->m_isGood )
+                return false;
+            updateLeafMesh();
+        }
+
+        for (unsigned i = 0; i < d; ++i)
+        {
+            const index_t n = m_meshEnd[i] - m_meshStart[i];
+            m_curElement[i] = m_meshStart[i] + pos % n;
+            pos /= n;
+        }
+        updateElement();
+        return true;
+    }
     
     /// Resets the iterator so that it can be used for another
     /// iteration through all boundary elements.
@@ -92,6 +134,8 @@ public:
     {
         const gsHTensorBasis<d, T>* hbs =  dynamic_cast<const gsHTensorBasis<d, T> *>(m_basis);
         m_leaf = hbs->tree().beginLeafIterator();
+        m_elIndex = 0;
+        this->m_isGood = true;
         updateLeaf();
     }
     
@@ -117,15 +161,21 @@ public:
     // element
     void getActiveFunctions(gsMatrix<unsigned>& act)
     {
-        this->m_basis->active_into(center, act);
+        static_cast<const gsHTensorBasis<d,T>*>(m_basis)
+            ->elementActive_into(m_elIndex, act);
     }
     
     const gsMatrix<unsigned>& computeActiveFunctions()
     {
-        this->m_basis->active_into(center, this->activeFuncs);
+        getActiveFunctions(this->activeFuncs);
         return this->activeFuncs;
     }
 
+    /// Returns the number of the current element, counting from zero
+    /// in the order of the iteration. It identifies the element in
+    /// gsHTensorBasis::elementActive_into.
+    index_t elementIndex() const { return m_elIndex; }
+
     const gsVector<T>& lowerCorner() const { return m_lower; }
 
     const gsVector<T>& upperCorner() const { return m_upper; }
@@ -150,10 +200,28 @@ private:
         return this->m_isGood;
     }
 
-    /// Computes lower, upper and center point of the current element, maps the reference
-    /// quadrature nodes and weights to the current element, and computes the
-    /// active functions.
+    /// Sets the grid of the current leaf and moves to its first
+    /// element
     void updateLeaf()
+    {
+        updateLeafMesh();
+
+        // We are at a new element, so update cell data
+        updateElement();
+    }
+
+    /// Returns the number of elements of the current leaf
+    index_t leafSize() const
+    {
+        index_t result = 1;
+        for (unsigned dim = 0; dim < d; ++dim)
+            result *= m_leaf.upperCorner()(dim) - m_leaf.lowerCorner()(dim);
+        return result;
+    }
+
+    /// Computes the grid lines of the current leaf, the current
+    /// element is set to the first one of the leaf
+    void updateLeafMesh()
     {
         const point & lower = m_leaf.lowerCorner();
         const point & upper = m_leaf.upperCorner();
@@ -184,9 +252,6 @@ private:
             // for n breaks, we have n - 1 elements (spans)
             m_meshEnd(dim) =  m_breaks[dim].end() - 1;
         }
-
-        // We are at a new element, so update cell data
-        updateElement();
     }
 
     /// Computes lower, upper and center point of the current element, maps the reference
@@ -225,6 +290,9 @@ private:
     // The current leaf node of the tree
     leafIterator m_leaf;
 
+    // Number of the current element
+    index_t m_elIndex;
+
     // Coordinates of the grid cell boundaries
     // \todo remove this member
     std::vector< std::vector<T> > m_breaks;
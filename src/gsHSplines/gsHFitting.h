@@ -93,6 +93,11 @@ public:
      * bigger than the threshold are refined /
      * If it is equal to -1 the m_ref percentage is used 
      * 0 = global refinement
+     *
+     * Every iteration assembles and solves the system and computes
+     * the errors in parallel (see gsFitting::assembleSystem). After
+     * every refinement the points are sorted again by the refined
+     * elements (see gsFitting::binPoints()).
      */
     void iterativeRefine(int iterations, T tolerance, T err_threshold = -1);
 
@@ -201,6 +206,8 @@ bool gsHFitting<d, T>::nextIteration(T tolerance, T err_threshold)
 	    
             gsHTensorBasis<d, T>* basis = static_cast<gsHTensorBasis<d,T> *> (this->m_basis);
             basis->refineElements(boxes);
+            // The points are sorted again by the refined elements
+            this->binPoints();
 	    
             gsInfo << "inserted " << boxes.size() / (2 * d + 1) << " boxes.\n";
         }
@@ -229,12 +229,16 @@ public:
     }
     
     /// Copy constructor
-    gsHTensorBasis( const gsHTensorBasis & o) : gsBasis<T>(o)
+    gsHTensorBasis( const gsHTensorBasis & o) : gsBasis<T>(o), m_localUpdate(false)
     {
         m_xmatrix_offset = o.m_xmatrix_offset;
         m_deg            = o.m_deg;
         m_tree           = o.m_tree;
         m_xmatrix        = o.m_xmatrix;
+        m_elActOffset    = o.m_elActOffset;
+        m_elActive       = o.m_elActive;
+        m_elCell         = o.m_elCell;
+        m_elNumber       = o.m_elNumber;
 
         m_bases.resize( o.m_bases.size() );
         cloneAll(o.m_bases.begin(), o.m_bases.end(), m_bases.begin());
@@ -307,6 +311,32 @@ public:
     /// level \em k (i.e., those taken from \f$ B^k \f$) start.
     std::vector<unsigned> m_xmatrix_offset;
 
+    /// \brief Active functions of the elements of the hierarchical
+    /// mesh, in the order visited by gsHDomainIterator
+    ///
+    /// The active functions of element \em e are the entries
+    /// <em>m_elActOffset[e]</em>,..,<em>m_elActOffset[e+1]-1</em> of
+    /// m_elActive. The table is updated by computeElementActives()
+    /// on every change of the basis, after a local refinement only
+    /// around the modified cells.
+    std::vector<unsigned> m_elActOffset;
+    std::vector<unsigned> m_elActive;
+
+    /// \brief For each level, the flat indices of the cells of the
+    /// level which are elements of the hierarchical mesh (increasing),
+    /// and the numbers of these elements
+    std::vector< std::vector<size_t> >   m_elCell;
+    std::vector< std::vector<unsigned> > m_elNumber;
+
+    /// \brief If true, the next update_structure() recomputes only
+    /// the functions whose support meets the boxes m_changedBoxes
+    bool m_localUpdate;
+
+    /// \brief Boxes covering the cells of the tree whose level
+    /// changed since the last update_structure() (see
+    /// gsHDomain::insertBoxes() for the format)
+    std::vector<unsigned> m_changedBoxes;
+
     //------------------------------------
  
 public:
@@ -439,9 +469,35 @@ public:
         os<<"\n";
     }
     
-    // Look at gsBasis.h for the documentation of this function
+    /// \brief Returns the indices of the basis functions that are
+    /// nonzero at the domain points \a u. See gsBasis::active_into.
+    ///
+    /// The active functions are looked up in a table of the active
+    /// functions per element (see elementActive_into), consecutive
+    /// points lying in the same element share the lookup.
     void active_into(const gsMatrix<T> & u, gsMatrix<unsigned>& result) const;
 
+    /// \brief Returns the indices of the basis functions that are
+    /// nonzero on the element \a el of the hierarchical mesh, where the
+    /// elements are numbered in the order visited by gsHDomainIterator
+    /// (see gsHDomainIterator::elementIndex()).
+    ///
+    /// The table of the active functions of all elements is computed
+    /// when the basis changes, the lookup does not modify the basis
+    /// and can be called concurrently.
+    void elementActive_into(index_t el, gsMatrix<unsigned>& result) const
+    {
+        GISMO_ASSERT( el >= 0 && static_cast<size_t>(el) + 1 < m_elActOffset.size(),
+                      "Invalid element index "<< el );
+        result = gsAsConstVector<unsigned>(&m_elActive[m_elActOffset[el]],
+                                           m_elActOffset[el+1] - m_elActOffset[el]);
+    }
+
+    /// \brief Returns the index of the element of the hierarchical
+    /// mesh containing the point \a u, numbered as in
+    /// elementActive_into.
+    int elementIndex(const gsVector<T> & u ) const;
+
 
     // Look at gsBasis.h for the documentation of this function
     gsMatrix<unsigned> allBoundary( ) const;
@@ -766,6 +822,34 @@ public:
         return numEl;
     }
 
+protected:
+
+    /// Computes the table of the active functions per element, called
+    /// by update_structure() and makeCompressed(). If \a oldXmatrix is
+    /// given, only the elements in the supports of the functions
+    /// overlapping the cells \a changedBoxes are computed, the lists of
+    /// the other elements are copied from the previous table, where
+    /// the active functions were \a oldXmatrix.
+    void computeElementActives(const std::vector<CMatrix> * oldXmatrix = NULL,
+                               const std::vector<unsigned> * changedBoxes = NULL);
+
+    /// Returns the element (see elementActive_into) which contains
+    /// the point \a pt and sets \a lower and \a upper to its
+    /// corners. Requires the table of computeElementActives().
+    unsigned findElement(const gsMatrix<T> & pt, gsVector<T,d> & lower,
+                         gsVector<T,d> & upper) const;
+
+    /// Discards the table of the active functions per element
+    void clearElementActives()
+    {
+        m_elActOffset.clear();
+        m_elActive   .clear();
+        m_elCell     .clear();
+        m_elNumber   .clear();
+    }
+
+public:
+
     /// @brief transformes a sortedVector \a indexes of flat tensor index
     /// of the bspline basis of \a level to hierachical indexes in place. If a flat
     /// tensor index is not found, it will transform to -1.
@@ -819,6 +903,13 @@ protected:
     /// be called after any modifications.
     virtual void update_structure(); // to do: rename as updateCharMatrices
     
+    /// @brief Returns in \a result the (sorted) flat tensor indices of
+    /// the functions of \a level whose support overlaps one of the
+    /// boxes \a boxes, given as in gsHDomain::insertBoxes() with
+    /// corners in the index level of the tree
+    void functionsOverlapping(int level, std::vector<unsigned> const & boxes,
+                              std::vector<unsigned> & result) const;
+
     /// @brief Makes sure that there are \a numLevels grids computed
     /// in the hierarachy
     void needLevel(int maxLevel) const;
@@ -842,10 +933,14 @@ private:
     /// \brief Returns the basis functions of \a level which have support on \a
     /// box, represented as an index box
     void functionOverlap(const point & boxLow, const point & boxUpp, 
-                         const int level, point & actLow, point & actUpp);
+                         const int level, point & actLow, point & actUpp) const;
 
     // \brief Sets all functions of \a level to active or passive- one by one
     void set_activ1(int level);
+
+    // \brief Updates the functions of \a level whose support
+    // overlaps m_changedBoxes to active or passive
+    void update_activ1(int level);
     
     // \brief Computes the set of active basis functions in the basis
     void setActive();
@@ -343,12 +343,9 @@ void gsHTensorBasis<d,T>::refine(gsMatrix<T> const & boxes, int refExt)
             }
         }
 
-        // ...and refine
+        // ...and refine (updates the basis)
         this->refineElements( refVector );
     }
-
-    // Update the basis
-    update_structure();
 }
 
 template<unsigned d, class T>
@@ -400,12 +397,13 @@ void gsHTensorBasis<d,T>::refine(gsMatrix<T> const & boxes)
         //GISMO_UNUSED(tb);
 
         // Sink box
-        m_tree.sinkBox(k1, k2, fLevel);
+        m_tree.sinkBox(k1, k2, fLevel, &m_changedBoxes);
         // Make sure we have enough levels
         needLevel( m_tree.getMaxInsLevel() );
     }
 
-    // Update the basis
+    // Update the basis, only around the modified cells
+    m_localUpdate = true;
     update_structure();
 }
 
@@ -421,21 +419,14 @@ void gsHTensorBasis<d,T>::refine(gsMatrix<T> const & boxes)
 template<unsigned d, class T>
 void gsHTensorBasis<d,T>::refineElements(std::vector<unsigned> const & boxes)
 {
-    gsVector<unsigned int, d> i1;
-    gsVector<unsigned int, d> i2;
-
     GISMO_ASSERT( (boxes.size()%(2*d + 1))==0,
                   "The points did not define boxes properly. The boxes were not added to the basis.");
-    for( unsigned int i = 0; i < (boxes.size())/(2*d+1); i++)
-    {
-        for( unsigned j = 0; j < d; j++ )
-        {
-            i1[j] = boxes[(i*(2*d+1))+j+1];
-            i2[j] = boxes[(i*(2*d+1))+d+j+1];
-        }
-        insert_box(i1,i2,boxes[i*(2*d+1)]);
-    }
 
+    // Insert all boxes in one pass
+    m_tree.insertBoxes(boxes, &m_changedBoxes);
+
+    // Update the basis, only around the modified cells
+    m_localUpdate = true;
     update_structure();
 }
 
@@ -602,9 +593,67 @@ void gsHTensorBasis<d,T>::set_activ1(int level)
 
 }
 
+template<unsigned d, class T>
+void gsHTensorBasis<d,T>::functionsOverlapping(int level, std::vector<unsigned> const & boxes,
+                                               std::vector<unsigned> & result) const
+{
+    const unsigned shift = m_tree.getIndexLevel() - level;
+    const unsigned bs = 2*d+1;
+
+    result.clear();
+    point low, upp, actLow, actUpp;
+    for ( size_t k = 0; k < boxes.size(); k += bs )
+    {
+        // The box in the indices of the level, rounded outwards
+        for(unsigned i = 0; i != d; ++i)
+        {
+            low[i] =   boxes[k+1+i] >> shift;
+            upp[i] = ( boxes[k+1+d+i] + (1u << shift) - 1 ) >> shift;
+        }
+        functionOverlap(low, upp, level, actLow, actUpp);
+        low = actLow;
+        do
+        {
+            result.push_back( m_bases[level]->index(low) );
+        }
+        while( nextCubePoint(low, actLow, actUpp) );
+    }
+    std::sort(result.begin(), result.end());
+    result.erase( std::unique(result.begin(), result.end()), result.end() );
+}
+
+template<unsigned d, class T>
+void gsHTensorBasis<d,T>::update_activ1(int level)
+{
+    const tensorBasis & tb = *m_bases[level];
+
+    // Functions whose support overlaps a modified cell
+    std::vector<unsigned> cand;
+    functionsOverlapping(level, m_changedBoxes, cand);
+
+    // The other functions keep their status
+    CMatrix & cmat = m_xmatrix[level];
+    std::vector<unsigned> keep;
+    keep.reserve( cmat.size() );
+    std::set_difference(cmat.begin(), cmat.end(), cand.begin(), cand.end(),
+                        std::back_inserter(keep) );
+
+    gsMatrix<unsigned,d,2> elSupp;
+    std::vector<unsigned>::iterator active = cand.begin();
+    for ( std::vector<unsigned>::const_iterator it = cand.begin(); it != cand.end(); ++it )
+    {
+        tb.elementSupport_into(*it, elSupp);
+        if ( m_tree.query3(elSupp.col(0), elSupp.col(1), level) == level) //if active
+            *active++ = *it;
+    }
+
+    cmat.resize( keep.size() + (active - cand.begin()) );
+    std::merge(keep.begin(), keep.end(), cand.begin(), active, cmat.begin() );
+}
+
 template<unsigned d, class T>
 void gsHTensorBasis<d,T>::functionOverlap(const point & boxLow, const point & boxUpp, 
-                                          const int level, point & actLow, point & actUpp)
+                                          const int level, point & actLow, point & actUpp) const
 {
     const tensorBasis & tb = *m_bases[level];
     for(unsigned i = 0; i != d; ++i)
@@ -757,6 +806,9 @@ void gsHTensorBasis<d,T>::makeCompressed()
         m_xmatrix.erase( m_xmatrix.begin() );
         m_xmatrix_offset.erase( m_xmatrix_offset.begin() );
     }
+
+    // The levels of the elements have changed
+    computeElementActives();
     // Note/to do: cleaning up empty levels at the end as well.
 }
 
@@ -838,15 +890,31 @@ void gsHTensorBasis<d,T>::update_structure() // to do: rename as updateHook
     // Make sure we have computed enough levels
     needLevel( m_tree.getMaxInsLevel() );
 
-    // Setup the characteristic matrices
-    m_xmatrix.clear();
-    m_xmatrix.resize( m_bases.size() );
-
     // Compress the tree
     m_tree.makeCompressed();
 
-    for(std::size_t i = 0; i != m_xmatrix.size(); i ++)
-        set_activ1(i);
+    // Setup the characteristic matrices
+    const bool localUpdate = m_localUpdate && ! m_xmatrix.empty();
+    std::vector<CMatrix> oldXmatrix;
+    if ( localUpdate )
+    {
+        // Only the functions whose support overlaps the modified
+        // cells can change
+        oldXmatrix = m_xmatrix;
+        m_xmatrix.resize( m_bases.size() );
+        for(std::size_t i = 0; i != m_xmatrix.size(); i ++)
+            update_activ1(i);
+    }
+    else
+    {
+        m_xmatrix.clear();
+        m_xmatrix.resize( m_bases.size() );
+        for(std::size_t i = 0; i != m_xmatrix.size(); i ++)
+            set_activ1(i);
+    }
+    m_localUpdate = false;
+    std::vector<unsigned> changedBoxes;
+    changedBoxes.swap(m_changedBoxes);
 
     // Store all indices of active basis functions to m_matrix
     //setActive();
@@ -860,6 +928,13 @@ void gsHTensorBasis<d,T>::update_structure() // to do: rename as updateHook
         m_xmatrix_offset.push_back(
             m_xmatrix_offset.back() + m_xmatrix[i].size() );
     }
+
+    // The table of the active functions per element, it is built
+    // here so that the (possibly concurrent) queries only read it
+    if ( localUpdate )
+        computeElementActives(&oldXmatrix, &changedBoxes);
+    else
+        computeElementActives();
 }
 
 template<unsigned d, class T>
@@ -902,6 +977,7 @@ void gsHTensorBasis<d,T>::initialize_class(gsBasis<T> const&  tbasis)
         upp[i] = m_bases[0]->knots(i).uSize()-1;
 
     m_tree.init(upp);
+    m_localUpdate = false;
 
     // Produce a couple of tensor-product spaces by dyadic refinement
     m_bases.reserve(3);
@@ -919,65 +995,251 @@ void gsHTensorBasis<d,T>::initialize_class(gsBasis<T> const&  tbasis)
 template<unsigned d, class T>
 void gsHTensorBasis<d,T>::active_into(const gsMatrix<T> & u, gsMatrix<unsigned>& result) const
 {
-    point low, upp, cur;
-    const int maxLevel = m_tree.getMaxInsLevel();
-
-    std::vector<std::vector<unsigned> > temp_output;//collects the outputs
-    temp_output.resize( u.cols() );
+    // Element of every point
+    std::vector<unsigned> elements( u.cols() );
     std::size_t sz = 0;
 
-    //gsMatrix<unsigned> activesLvl;
+    // The current element and its parameter box
+    index_t el = -1;
+    gsVector<T,d> lower, upper;
 
     for(index_t p = 0; p < u.cols(); p++) //for all input points
     {
         const gsMatrix<T> & currPoint = u.col(p);
+
+        bool inside = (el != -1);
+        for(unsigned i = 0; inside && i != d; ++i)
+            inside = ( lower[i] <= currPoint(i,0) && currPoint(i,0) < upper[i] );
+
+        if ( ! inside )
+            el = findElement(currPoint, lower, upper);
+
+        elements[p] = el;
+
+        // update result size
+        const std::size_t numAct = m_elActOffset[el+1] - m_elActOffset[el];
+        if ( numAct > sz )
+            sz = numAct;
+    }
+
+    result.resize(sz, u.cols() );
+    for(index_t i = 0; i < result.cols(); i++)
+    {
+        const unsigned e  = elements[i];
+        const index_t  na = m_elActOffset[e+1] - m_elActOffset[e];
+        result.col(i).topRows(na)
+            = gsAsConstVector<unsigned>(&m_elActive[m_elActOffset[e]], na);
+        result.col(i).bottomRows(sz-na).setZero();
+    }
+}
+
+template<unsigned d, class T>
+int gsHTensorBasis<d,T>::elementIndex(const gsVector<T> & u) const
+{
+    GISMO_ASSERT( u.rows() == d, "Wrong vector dimension");
+    gsVector<T,d> lower, upper;
+    return findElement(u, lower, upper);
+}
+
+template<unsigned d, class T>
+unsigned gsHTensorBasis<d,T>::findElement(const gsMatrix<T> & pt,
+                                          gsVector<T,d> & lower,
+                                          gsVector<T,d> & upper) const
+{
+    point low, cell;
+    const int maxLevel = m_tree.getMaxInsLevel();
+
+    for(unsigned i = 0; i != d; ++i)
+        low[i] = m_bases[maxLevel]->knots(i).uFind( pt(i,0) ).uIndex();
+
+    // Identify the level of the point
+    const int lvl = m_tree.levelOf(low, maxLevel);
+
+    // Flat index of the cell of level lvl containing the point
+    size_t key = 0, stride = 1;
+    for(unsigned i = 0; i != d; ++i)
+    {
+        const gsKnotVector<T> & kv = m_bases[lvl]->knots(i);
+        cell[i]  = low[i] >> (maxLevel - lvl);
+        key     += cell[i] * stride;
+        stride  *= kv.numElements();
+        lower[i] = kv.uValue(cell[i]    );
+        upper[i] = kv.uValue(cell[i] + 1);
+    }
+
+    const std::vector<size_t> & cells = m_elCell[lvl];
+    const std::size_t pos =
+        std::lower_bound(cells.begin(), cells.end(), key) - cells.begin();
+    GISMO_ASSERT( pos != cells.size() && cells[pos] == key,
+                  "Element of point "<< pt.transpose() <<" not found.");
+    return m_elNumber[lvl][pos];
+}
+
+template<unsigned d, class T>
+void gsHTensorBasis<d,T>::computeElementActives(const std::vector<CMatrix> * oldXmatrix,
+                                                const std::vector<unsigned> * changedBoxes)
+{
+    // The previous table, if it can be reused
+    std::vector<unsigned> oldActOffset, oldActive;
+    std::vector< std::vector<size_t> >   oldCell;
+    std::vector< std::vector<unsigned> > oldNumber;
+    const bool local = oldXmatrix && ! m_elActOffset.empty();
+    if ( local )
+    {
+        oldActOffset.swap(m_elActOffset);
+        oldActive   .swap(m_elActive   );
+        oldCell     .swap(m_elCell     );
+        oldNumber   .swap(m_elNumber   );
+    }
+    clearElementActives();
+
+    // The elements of level 0 which contain a cell in the support of
+    // a function that may have changed (see update_activ1()), only
+    // the elements inside them can have different active functions
+    std::vector<bool> touched;
+    std::vector<unsigned> remap;
+    gsVector<size_t,d> stride0;
+    if ( local )
+    {
+        size_t numEl0 = 1;
         for(unsigned i = 0; i != d; ++i)
-            low[i] = m_bases[maxLevel]->knots(i).uFind( currPoint(i,0) ).uIndex();
+        {
+            stride0[i] = numEl0;
+            numEl0    *= m_bases[0]->knots(i).numElements();
+        }
+        touched.resize(numEl0, false);
 
-        // Identify the level of the point
-        const int lvl = m_tree.levelOf(low, maxLevel);
+        std::vector<unsigned> cand;
+        gsMatrix<unsigned,d,2> elSupp;
+        point low, upp;
+        for(size_t lvl = 0; lvl != m_xmatrix.size(); ++lvl)
+        {
+            functionsOverlapping(lvl, *changedBoxes, cand);
+            for (std::vector<unsigned>::const_iterator it = cand.begin(); it != cand.end(); ++it)
+            {
+                // The support in elements of level 0, the upper
+                // corner is excluded
+                m_bases[lvl]->elementSupport_into(*it, elSupp);
+                for(unsigned i = 0; i != d; ++i)
+                {
+                    low[i] =   elSupp(i,0) >> lvl;
+                    upp[i] = ((elSupp(i,1) - 1) >> lvl);
+                }
+                point cur = low;
+                do
+                {
+                    size_t key = 0;
+                    for(unsigned i = 0; i != d; ++i)
+                        key += cur[i] * stride0[i];
+                    touched[key] = true;
+                }
+                while( nextCubePoint(cur, low, upp) );
+            }
+        }
 
-        for(int i = 0; i <= lvl; i++)
+        // The new indices of the functions of the previous table, the
+        // functions of the copied lists are still active
+        const std::vector<CMatrix> & oldX = *oldXmatrix;
+        for(size_t lvl = 0; lvl != oldX.size(); ++lvl)
         {
-            /*
-              m_bases[i]->active_into(currPoint, activesLvl);
-              
-              std::set_intersection(m_xmatrix[i].begin(), m_xmatrix[i].end(),
-              activesLvl.data(), activesLvl.data() + activesLvl.size(),
-              std::back_inserter( temp_output[p] ) );
-              +++ Renumbering to H-basis indexing
-            // */                                 
-
-            // /*
-            m_bases[i]->active_cwise(currPoint, low, upp);
-            cur = low;
-            do
+            const CMatrix & cmat = m_xmatrix[lvl];
+            CMatrix::const_iterator it = cmat.begin();
+            for (CMatrix::const_iterator o = oldX[lvl].begin(); o != oldX[lvl].end(); ++o)
             {
-                CMatrix::const_iterator it =
-                    m_xmatrix[i].find_it_or_fail( m_bases[i]->index(cur) );
+                it = std::lower_bound(it, cmat.end(), *o);
+                remap.push_back( m_xmatrix_offset[lvl] + (it - cmat.begin()) );
+            }
+        }
+    }
 
-                if( it != m_xmatrix[i].end() )// if index is found
+    point low, upp, cur, cell;
+    gsMatrix<T> center(d, 1);
+
+    m_elCell  .assign( m_bases.size(), std::vector<size_t>()   );
+    m_elNumber.assign( m_bases.size(), std::vector<unsigned>() );
+    m_elActOffset.reserve( oldActOffset.size() );
+    m_elActive   .reserve( oldActive   .size() );
+    m_elActOffset.push_back(0);
+
+    unsigned el = 0;
+    for (typename hdomain_type::literator leaf = m_tree.beginLeafIterator();
+         leaf.good(); leaf.next() )
+    {
+        const int   lvl   = leaf.level();
+        const point lower = leaf.lowerCorner();
+        point       last  = leaf.upperCorner();
+        last.array() -= 1;
+
+        // Cells of the leaf, in the order of gsHDomainIterator
+        cell = lower;
+        do
+        {
+            size_t key = 0, stride = 1, key0 = 0;
+            for(unsigned i = 0; i != d; ++i)
+            {
+                const gsKnotVector<T> & kv = m_bases[lvl]->knots(i);
+                center(i,0) = ( kv.uValue(cell[i]) + kv.uValue(cell[i] + 1) ) / 2;
+                key      += cell[i] * stride;
+                stride   *= kv.numElements();
+                if ( local )
+                    key0 += (cell[i] >> lvl) * stride0[i];
+            }
+            m_elCell  [lvl].push_back(key);
+            m_elNumber[lvl].push_back(el++);
+
+            // Untouched elements are in the previous table
+            if ( local && ! touched[key0] && static_cast<size_t>(lvl) < oldCell.size() )
+            {
+                const std::vector<size_t> & cells = oldCell[lvl];
+                const size_t pos =
+                    std::lower_bound(cells.begin(), cells.end(), key) - cells.begin();
+                if ( pos != cells.size() && cells[pos] == key )
                 {
-                    temp_output[p].push_back(
-                        this->m_xmatrix_offset[i] + (it - m_xmatrix[i].begin() )
-                        );
+                    const unsigned oel = oldNumber[lvl][pos];
+                    for (unsigned k = oldActOffset[oel]; k != oldActOffset[oel+1]; ++k)
+                        m_elActive.push_back( remap[ oldActive[k] ] );
+                    m_elActOffset.push_back( m_elActive.size() );
+                    continue;
                 }
             }
-            while( nextCubePoint(cur,low,upp) );
-            //*/
-        }
 
-        // update result size
-        if ( temp_output[p].size() > sz )
-            sz = temp_output[p].size();
+            // Active functions of all levels up to lvl
+            for(int i = 0; i <= lvl; i++)
+            {
+                m_bases[i]->active_cwise(center, low, upp);
+                cur = low;
+                do
+                {
+                    CMatrix::const_iterator it =
+                        m_xmatrix[i].find_it_or_fail( m_bases[i]->index(cur) );
+
+                    if( it != m_xmatrix[i].end() )// if index is found
+                    {
+                        m_elActive.push_back(
+                            this->m_xmatrix_offset[i] + (it - m_xmatrix[i].begin() )
+                            );
+                    }
+                }
+                while( nextCubePoint(cur,low,upp) );
+            }
+            m_elActOffset.push_back( m_elActive.size() );
+        }
+        while( nextCubePoint(cell, lower, last) );
     }
 
-    result.resize(sz, u.cols() );
-    for(index_t i = 0; i < result.cols(); i++)
+    // Sort the cells of every level for the lookup
+    std::vector< std::pair<size_t,unsigned> > tmp;
+    for (size_t lvl = 0; lvl != m_elCell.size(); ++lvl)
     {
-        result.col(i).topRows(temp_output[i].size())
-            = gsAsConstVector<unsigned>(temp_output[i]);
-        result.col(i).bottomRows(sz-temp_output[i].size()).setZero();
+        tmp.resize( m_elCell[lvl].size() );
+        for (size_t k = 0; k != tmp.size(); ++k)
+            tmp[k] = std::make_pair(m_elCell[lvl][k], m_elNumber[lvl][k]);
+        std::sort(tmp.begin(), tmp.end());
+        for (size_t k = 0; k != tmp.size(); ++k)
+        {
+            m_elCell  [lvl][k] = tmp[k].first;
+            m_elNumber[lvl][k] = tmp[k].second;
+        }
     }
 }
 
@@ -31,6 +31,8 @@ struct gsAabb
 public:
     typedef gsVector<Z,d> point;
 
+    gsAabb() { }
+
     gsAabb(const point & l, const point & u)
     {
         first  = l;
@@ -51,6 +53,8 @@ public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
 
+template<unsigned d, class Z> class gsKdNodePool;
+
 /**
     @brief Struct representing a kd-tree node
 
@@ -58,6 +62,9 @@ public:
     - Split nodes
     - Leaf nodes
 
+    The nodes are allocated by a gsKdNodePool, which owns the memory
+    of the whole tree. The box of a leaf is stored inside the node.
+
     Template parameters
     \param d is the dimension
     \param Z is the box-coordinate index type
@@ -70,6 +77,7 @@ struct kdnode
     // Defines the type of the box
     typedef          gsAabb<d,Z> kdBox;
     typedef typename kdBox::point point;
+    typedef gsKdNodePool<d,Z> pool;
 
     /// axis in which the children of this node split the domain
     /// special value -1 denotes a leaf node
@@ -82,7 +90,8 @@ struct kdnode
     /// special value -1 denotes unknown level (in case of a split node)
     int level ;
 
-    /// The box held in this leaf node (if leaf)
+    /// The box held in this leaf node (if leaf), points to
+    /// kdnode::boxData or is NULL for split nodes
     /// box->first is the lower left corner of the box
     /// box->second is the upper right corner of the box
     kdBox * box;
@@ -96,71 +105,22 @@ struct kdnode
     /// Pointer to the right child of this split node (if it is one)
     kdnode * right; 
 
+    /// Position of the node in the pool which allocated it
+    unsigned id;
+
+    /// Storage of the box of a leaf node
+    kdBox boxData;
+
     /// Constructor (empty node)
     kdnode() : axis(-2) ,level(0), box(0), 
-               parent(0), left(0), right(0)
+               parent(0), left(0), right(0), id(0)
     { }
 
-    /// Constructor (root node)
-    kdnode(point const & upp) : axis(-1) , level(0),
-                                parent(0), left(0) , right(0)
-    { 
-        // Initial box, upp is expected to be indexed in finest level
-        box = new kdBox( point::Zero(), upp);
-    }
-
-    /// Constructor (leaf node)
-    kdnode(kdBox const & bb) 
-        : axis(-1) , level(0),
-          parent(0), left(0) , right(0)
-    { 
-        // ..
-    }
-    
-    /// Recursively copies the whole subtree under \a o, and sets it's
-    /// parent to \a parentNode
-    kdnode(const kdnode & o, kdnode * parentNode = NULL) : 
-        axis(o.axis), level(o.level)
+    /// Makes this node a leaf with box \a bb
+    void setBox(kdBox const & bb)
     {
-        parent = parentNode;
-        if ( axis == -1 )
-        {
-            GISMO_ASSERT( (o.left == 0) && (o.right == 0), 
-                          "Problem: leaf with children." );
-            box  = new kdBox(*o.box);
-            left = right = NULL;
-        }
-        else
-        {
-            GISMO_ASSERT( o.box == 0, 
-                          "Problem: split node with box." );
-            pos   = o.pos;
-            left  = new kdnode(*o.left , this);
-            right = new kdnode(*o.right, this);
-            box   = NULL;
-        }
-    }
-
-    /// Recursively deletes the whole subtree under this node
-    ~kdnode()
-    {
-        // to do: non-reccursive
-
-        if ( isLeaf() ) 
-        {
-            // No throw in destructor
-            //GISMO_ASSERT( (left == 0) && (right == 0), 
-            //              "Problem: leaf with children." );
-                delete box;
-        }
-        else
-        {
-            // No throw in destructor
-            //GISMO_ASSERT( box == 0, 
-            //              "Problem: split node with box." );
-            delete left;
-            delete right;
-        }
+        boxData = bb;
+        box     = &boxData;
     }
 
     // Box Accessors
@@ -207,15 +167,15 @@ struct kdnode
     }
 
     // Splits the node (ie. two children are added)
-    inline void split()
+    inline void split(pool & mem)
     {
         GISMO_ASSERT( (left == 0) && (right == 0),
                       "Can only split leaf nodes.");
         GISMO_ASSERT( axis > -1, "Split axis not prescribed.");
 
         // Make new left and right children
-        left          = new kdnode;
-        right         = new kdnode;
+        left          = mem.create();
+        right         = mem.create();
         // Set axis to -1 (since they are leaves)
         left ->axis   =
         right->axis   = -1;
@@ -226,9 +186,9 @@ struct kdnode
         left ->level  = 
         right->level  = level;
         // Set box
-        left ->box    = box;    
-        right->box    = new kdBox(*box);
-        // Detach box from parent (is now at left child)
+        left ->setBox(*box);
+        right->setBox(*box);
+        // Detach box from parent (is now at the children)
         box = NULL;
         // Resize properly the box coordinates
         left ->box->second[axis] = 
@@ -236,49 +196,48 @@ struct kdnode
     }
 
     // Merges terminal node (ie. two children are joined)
-    inline void merge()
+    inline void merge(pool & mem)
     {
         GISMO_ASSERT( (left->isLeaf()) && (right->isLeaf()),
                       "Can only merge terminal nodes.");
 
         // Recover box
-        box = left->box;
-        left->box = NULL;
+        setBox(*left->box);
         box->second[axis] = right->box->second[axis];
         axis  = - 1;
         level = left->level;
 
         // Delete children
-        delete  left;
+        mem.destroy(left);
         left  = NULL;
-        delete right;
+        mem.destroy(right);
         right = NULL;
     }
 
 
     // Splits the node (ie. two children are added)
-    void split(int splitAxis, Z splitPos)
+    void split(pool & mem, int splitAxis, Z splitPos)
     {
         GISMO_ASSERT( box->second[splitAxis] != splitPos, "Degenerate split");
         GISMO_ASSERT( box->first [splitAxis] != splitPos, "Degenerate split");
         axis = splitAxis;
         pos  = splitPos;
-        split();
+        split(mem);
     }
 
     /// Splits the node in the middle (ie. two children are added)
     // to do: remove
-    void nextMidSplit()
+    void nextMidSplit(pool & mem)
     {        
         axis = ( parent == 0 ? 0 : (parent->axis+1)%d );        
         pos  = box->first [axis] + 
             (box->second[axis] - box->first[axis])/2 ;
-        split(); // Can be degenerate
+        split(mem); // Can be degenerate
     }
 
     /// Splits the node in the middle (ie. two children are added)
     /// If non-degenerate split is impossible, then this is a no-op
-    void anyMidSplit(int index_level)
+    void anyMidSplit(pool & mem, int index_level)
     {        
         const unsigned h = 1 << (index_level - level) ;
         const unsigned mask = ~(h - 1);
@@ -288,7 +247,7 @@ struct kdnode
                 (box->first [i] + (box->second[i] - box->first[i])/2) & mask ;
             if ( c != box->first [i] ) // avoid degenerate split
             {
-                split(i, c);
+                split(mem, i, c);
                 return;
             }
         }
@@ -300,7 +259,7 @@ struct kdnode
     /// then this is a no-op.
     /// Splitting is done on a coordinate of the current \a level (aligned)
     /// returns the child that intersects \a insBox or NULL (if no split)
-    kdnode * adaptiveAlignedSplit(kdBox const & insBox, int index_level)
+    kdnode * adaptiveAlignedSplit(pool & mem, kdBox const & insBox, int index_level)
     {
         const unsigned h = 1 << (index_level - level) ;
         //const unsigned mask = ~(h - 1);
@@ -317,13 +276,13 @@ struct kdnode
             if ( c1 > box->first[i] )
             {
                 // right child intersects insBox
-                split(i, c1 );
+                split(mem, i, c1 );
                 return right;
             }
             else if ( c2 < box->second[i]  )
             {
                 // left child intersects insBox
-                split(i, c2 );
+                split(mem, i, c2 );
                 return left;
             }
         }
@@ -334,7 +293,7 @@ struct kdnode
     /// according to \a insBox.  If non-degenerate split is impossible,
     /// then this is a no-op
     // to do: remove
-    kdnode * adaptiveSplit(kdBox const & insBox)
+    kdnode * adaptiveSplit(pool & mem, kdBox const & insBox)
     {
         // assumption: insBox intersects box
         for ( unsigned i = 0; i < d; ++i )
@@ -345,14 +304,14 @@ struct kdnode
             {
                 axis = i;
                 pos  = insBox.first[i];
-                split();
+                split(mem);
                 return right;
             }
             else if ( insBox.second[i] < box->second[i] )
             {
                 axis = i;
                 pos  = insBox.second[i];
-                split();
+                split(mem);
                 return left ;
             }
         }
@@ -376,6 +335,202 @@ struct kdnode
         return os;
     }
 
+    // see http://eigen.tuxfamily.org/dox-devel/group__TopicStructHavingEigenMembers.html
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+/**
+    @brief Memory arena holding the nodes of a kd-tree
+
+    The nodes are stored in blocks of fixed size, which are never
+    moved by create() or destroy(), therefore the node pointers remain
+    valid as long as the node exists. The exception is relayout(),
+    which copies the tree to new blocks: all pointers to the nodes of
+    the pool are invalidated by it. The nodes of the tree are linked
+    by pointers, the position of a node in the pool is kdnode::id.
+    Deleted nodes are re-used by subsequent allocations.
+
+    Copying a pool copies the blocks and re-maps the links, without
+    traversing the tree. The function relayout() stores a tree in
+    breadth-first order, so that the nodes close to the root (which
+    are visited by every query) are contiguous in memory.
+
+    Template parameters
+    \param d is the dimension
+    \param Z is the box-coordinate index type
+
+    \ingroup HSplines
+*/
+template<unsigned d, class Z = unsigned>
+class gsKdNodePool
+{
+public:
+    typedef kdnode<d,Z> node;
+
+    enum { blockShift = 7, blockSize = 1 << blockShift };
+
+public:
+
+    gsKdNodePool() : m_size(0)
+    { }
+
+    /// Copies the nodes of \a o, the links are re-mapped to the
+    /// nodes of the copy
+    gsKdNodePool(const gsKdNodePool & o) : m_size(0)
+    {
+        copyFrom(o);
+    }
+
+    gsKdNodePool & operator=(const gsKdNodePool & o)
+    {
+        if ( this != &o )
+        {
+            clear();
+            copyFrom(o);
+        }
+        return *this;
+    }
+
+    ~gsKdNodePool() { clear(); }
+
+    /// Deletes all nodes
+    void clear()
+    {
+        for (size_t i = 0; i != m_blocks.size(); ++i)
+            delete[] m_blocks[i];
+        m_blocks.clear();
+        m_free.clear();
+        m_size = 0;
+    }
+
+    /// Returns a new empty node
+    node * create()
+    {
+        unsigned id;
+        if ( m_free.empty() )
+        {
+            if ( m_size == m_blocks.size() * blockSize )
+                m_blocks.push_back( new node[blockSize] );
+            id = m_size++;
+        }
+        else
+        {
+            id = m_free.back();
+            m_free.pop_back();
+        }
+        // Reset the fields, the box data are unused as long as box
+        // is NULL
+        node * result = at(id);
+        result->axis   = -2;
+        result->pos    = 0;
+        result->level  = 0;
+        result->box    = NULL;
+        result->parent = result->left = result->right = NULL;
+        result->id     = id;
+        return result;
+    }
+
+    /// Releases the node \a n (not its children)
+    void destroy(node * n)
+    {
+        n->axis = -2;
+        n->box  = NULL;
+        n->parent = n->left = n->right = NULL;
+        m_free.push_back(n->id);
+    }
+
+    /// Returns the node at position \a id of the pool
+    node * at(unsigned id) const
+    { return m_blocks[id >> blockShift] + (id & (blockSize - 1)); }
+
+    /// Returns the number of nodes in use
+    size_t size() const { return m_size - m_free.size(); }
+
+    /// Stores the tree starting at \a root in breadth-first order,
+    /// the unused nodes are released. Returns the new root.
+    /// \warning All pointers to nodes of this pool (eg. leaf
+    /// iterators) are invalidated, only the returned root is valid.
+    node * relayout(const node * root)
+    {
+        gsKdNodePool tmp;
+        node * newRoot = tmp.copyNode(*root);
+        newRoot->parent = NULL;
+
+        // Breadth-first traversal, queue[k] is copied to tmp.at(k)
+        std::vector<const node*> queue;
+        queue.reserve(size());
+        queue.push_back(root);
+        for (size_t k = 0; k != queue.size(); ++k)
+        {
+            const node * cur = queue[k];
+            if ( cur->isLeaf() )
+                continue;
+            node * parent = tmp.at(static_cast<unsigned>(k));
+            parent->left  = tmp.copyNode(*cur->left );
+            parent->right = tmp.copyNode(*cur->right);
+            parent->left ->parent =
+            parent->right->parent = parent;
+            queue.push_back(cur->left );
+            queue.push_back(cur->right);
+        }
+
+        swap(tmp);
+        return newRoot;
+    }
+
+    void swap(gsKdNodePool & o)
+    {
+        m_blocks.swap(o.m_blocks);
+        m_free  .swap(o.m_free  );
+        std::swap(m_size, o.m_size);
+    }
+
+private:
+
+    /// Allocates a node with the data of \a o (without links)
+    node * copyNode(const node & o)
+    {
+        node * result = create();
+        result->axis  = o.axis;
+        result->pos   = o.pos;
+        result->level = o.level;
+        if ( o.box )
+            result->setBox(*o.box);
+        return result;
+    }
+
+    void copyFrom(const gsKdNodePool & o)
+    {
+        m_blocks.resize(o.m_blocks.size());
+        for (size_t i = 0; i != m_blocks.size(); ++i)
+        {
+            m_blocks[i] = new node[blockSize];
+            std::copy(o.m_blocks[i], o.m_blocks[i] + blockSize, m_blocks[i]);
+        }
+        m_free = o.m_free;
+        m_size = o.m_size;
+
+        // Re-map the links to the nodes of this pool
+        for (unsigned id = 0; id != m_size; ++id)
+        {
+            node * n = at(id);
+            if ( n->box    ) n->box    = &n->boxData;
+            if ( n->parent ) n->parent = at(n->parent->id);
+            if ( n->left   ) n->left   = at(n->left  ->id);
+            if ( n->right  ) n->right  = at(n->right ->id);
+        }
+    }
+
+private:
+
+    /// Blocks of blockSize nodes
+    std::vector<node*> m_blocks;
+
+    /// Positions of released nodes
+    std::vector<unsigned> m_free;
+
+    /// Number of nodes allocated from the blocks
+    unsigned m_size;
 };
 
 
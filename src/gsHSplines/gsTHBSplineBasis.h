@@ -72,6 +72,57 @@ public:
     // indicates outer loop and next line describes holes
     typedef typename std::vector< std::vector< std::vector< std::vector< std::vector<T> > > > > TrimmingCurves;
 
+    /// Read-only view of the sparse representation of a truncated
+    /// basis function, as a column of a sparse matrix (see getCoefs())
+    typedef Eigen::Map<const typename gsSparseMatrix<T>::Base> CoefsView;
+
+    /// \brief Iterator over the truncated basis functions:
+    /// it->first is the index of the function, it->second its
+    /// representation (see getCoefs())
+    class truncatedIterator
+    {
+    public:
+        typedef std::pair<unsigned, CoefsView> value_type;
+
+        // Keeps the value alive for operator->
+        class pointer
+        {
+        public:
+            explicit pointer(const value_type & v) : m_value(v) { }
+            const value_type * operator->() const { return &m_value; }
+        private:
+            value_type m_value;
+        };
+
+        truncatedIterator(const gsTHBSplineBasis & basis, unsigned i)
+        : m_basis(&basis), m_index(i)
+        { skip(); }
+
+        value_type operator*() const
+        { return value_type(m_index, m_basis->getCoefs(m_index)); }
+
+        pointer operator->() const { return pointer(**this); }
+
+        truncatedIterator & operator++() { ++m_index; skip(); return *this; }
+
+        bool operator==(const truncatedIterator & other) const
+        { return m_index == other.m_index; }
+
+        bool operator!=(const truncatedIterator & other) const
+        { return m_index != other.m_index; }
+
+    private:
+        void skip()
+        {
+            const unsigned n = m_basis->size();
+            while ( m_index < n && ! m_basis->isTruncated(m_index) )
+                ++m_index;
+        }
+
+        const gsTHBSplineBasis * m_basis;
+        unsigned m_index;
+    };
+
 public:
 
     gsTHBSplineBasis()
@@ -134,210 +185,6 @@ public:
                              const gsMatrix<T> & u,
                           gsMatrix<T>& result) const;
 
-    // look at eval_into
-    void fastEval_into(const gsMatrix<T>& u,
-                       gsMatrix<T>& result) const
-    {
-        gsMatrix<unsigned> indices;
-        this->active_into(u, indices);
-
-        result.setZero(indices.rows(), u.cols());
-
-        const unsigned maxLvl = this->m_tree.getMaxInsLevel() + 1;
-        std::vector< gsMatrix<T> > tmpResults(maxLvl, gsMatrix<T>());
-        std::vector< gsMatrix<unsigned> > tmpActive(maxLvl, gsMatrix<unsigned>());
-        gsVector<int> processed(maxLvl);
-
-        for (int pt = 0; pt != u.cols(); pt++)
-        {
-            processed.setZero();
-
-            for (int ind = 0; ind != indices.rows(); ind++)
-            {
-                unsigned index = indices(ind, pt);
-                if (ind != 0 && index == 0)
-                    break;
-
-                unsigned lvl = getPresLevelOfBasisFun(index);
-
-                if (processed(lvl) == 0)
-                {
-                    this->m_bases[lvl]->eval_into(u.col(pt), tmpResults[lvl]);
-                    this->m_bases[lvl]->active_into(u.col(pt), tmpActive[lvl]);
-                    processed(lvl) = 1;
-                }
-
-                if (m_is_truncated[index] == -1)
-                {
-                    unsigned flatTenIndx = this->flatTensorIndexOf(index, lvl);
-                    int localIndex = -1;
-                    for (int row = 0; row != tmpActive[lvl].rows(); ++row)
-                    {
-                        if (tmpActive[lvl](row, 0) == flatTenIndx)
-                        {
-                            localIndex = row;
-                            break;
-                        }
-                    }
-                    result(ind, pt) = tmpResults[lvl](localIndex, 0);
-                }
-                else // basis function is truncated
-                {
-                    const gsMatrix<T>& basis = tmpResults[lvl];
-                    const gsMatrix<unsigned>& active = tmpActive[lvl];
-
-
-                    const gsSparseVector<T>& coefs = getCoefs(index);
-                    T tmp = coefs(active(0, 0)) * basis(0, 0);
-                    for (int i = 1; i < active.rows(); i++)
-                    {
-                        tmp += coefs(active(i, 0)) * basis(i, 0);
-                    }
-                    result(ind, pt) = tmp;
-                }
-            }
-        }
-    }
-
-    // look at deriv_into
-    void fastDeriv_into(const gsMatrix<T>& u,
-                        gsMatrix<T>& result) const
-    {
-        gsMatrix<unsigned> indices;
-        this->active_into(u, indices);
-
-        result.setZero(indices.rows() * d, u.cols());
-
-        const unsigned maxLvl = this->m_tree.getMaxInsLevel() + 1;
-        std::vector< gsMatrix<T> > tmpDeriv( maxLvl, gsMatrix<T>());
-        std::vector< gsMatrix<unsigned> > tmpActive(maxLvl, gsMatrix<unsigned>());
-        gsVector<int> processed(maxLvl);
-
-        for (int pt = 0; pt != u.cols(); pt++)
-        {
-            processed.setZero();
-
-            for (int ind = 0; ind != indices.rows(); ind++)
-            {
-                unsigned index = indices(ind, pt);
-                if (ind != 0 && index == 0)
-                    break;
-
-                unsigned lvl = getPresLevelOfBasisFun(index);
-
-                if (processed(lvl) == 0)
-                {
-                    this->m_bases[lvl]->deriv_into(u.col(pt), tmpDeriv[lvl]);
-                    this->m_bases[lvl]->active_into(u.col(pt), tmpActive[lvl]);
-                    processed(lvl) = 1;
-                }
-
-                if (m_is_truncated[index] == -1)
-                {
-                    unsigned flatTenIndx = this->flatTensorIndexOf(index, lvl);
-                    int localIndex = -1;
-                    for (int row = 0; row != tmpActive[lvl].rows(); ++row)
-                    {
-                        if (tmpActive[lvl](row, 0) == flatTenIndx)
-                        {
-                            localIndex = row;
-                            break;
-                        }
-                    }
-
-                    result.block(ind * d, pt, d, 1) =
-                            tmpDeriv[lvl].block(localIndex * d, 0, d, 1);
-                }
-                else // basis function is truncated
-                {
-                    const gsMatrix<T>& basis = tmpDeriv[lvl];
-                    const gsMatrix<unsigned>& active = tmpActive[lvl];
-                    const gsSparseVector<T>& coefs = getCoefs(index);
-
-                    for (unsigned dim = 0; dim != d; dim++) // for all deric
-                    {
-                        for (index_t i = 0; i != active.rows(); ++i)
-                        {
-                            result(ind * d + dim, pt) +=
-                                    coefs(active(i, 0)) * basis(i * d + dim, 0);
-                        }
-                    }
-                }
-            }
-        }
-    }
-
-    // look at deriv2_into
-    void fastDeriv2_into(const gsMatrix<T>& u,
-                         gsMatrix<T>& result) const
-    {
-        gsMatrix<unsigned> indices;
-        this->active_into(u, indices);
-        const unsigned numDers = (d * (d + 1)) / 2;
-
-        result.setZero(indices.rows() * numDers, u.cols());
-
-        const unsigned maxLvl = this->m_tree.getMaxInsLevel() + 1;
-        std::vector< gsMatrix<T> > tmpDeriv2(maxLvl, gsMatrix<T>());
-        std::vector< gsMatrix<unsigned> > tmpActive(maxLvl, gsMatrix<unsigned>());
-        gsVector<int> processed(maxLvl);
-
-        for (int pt = 0; pt != u.cols(); pt++)
-        {
-            processed.setZero();
-
-            for (int ind = 0; ind != indices.rows(); ind++)
-            {
-
-                unsigned index = indices(ind, pt);
-                if (ind != 0 && index == 0)
-                    break;
-
-                unsigned lvl = getPresLevelOfBasisFun(index);
-
-                if (processed(lvl) == 0)
-                {
-                    this->m_bases[lvl]->deriv2_into(u.col(pt), tmpDeriv2[lvl]);
-                    this->m_bases[lvl]->active_into(u.col(pt), tmpActive[lvl]);
-                    processed(lvl) = 1;
-                }
-
-                if (m_is_truncated[index] == -1)
-                {
-                    unsigned flatTenIndx = this->flatTensorIndexOf(index, lvl);
-                    int localIndx = -1;
-                    for (int row = 0; row != tmpActive[lvl].rows(); ++row)
-                    {
-                        if (tmpActive[lvl](row, 0) == flatTenIndx)
-                        {
-                            localIndx = row;
-                            break;
-                        }
-                    }
-
-                    result.block(ind * numDers, pt, numDers, 1) =
-                            tmpDeriv2[lvl].block(localIndx * numDers, 0, numDers, 1);
-                }
-                else // basis function is truncated
-                {
-                    const gsMatrix<T>& basis = tmpDeriv2[lvl];
-                    const gsMatrix<unsigned>& active = tmpActive[lvl];
-                    const gsSparseVector<T>& coefs = getCoefs(index);
-
-                    for (unsigned der = 0; der != numDers; der++)
-                    {
-                        for (index_t i = 0; i != active.rows(); ++i)
-                        {
-                            result(ind * numDers + der, pt) +=
-                                    coefs(active(i, 0)) *
-                                    basis(i * numDers + der, 0);
-                        }
-                    }
-                }
-            }
-        }
-    }
-
     // Look at gsBasis class for documentation
     void eval_into(const gsMatrix<T> & u, gsMatrix<T>& result) const;
 
@@ -352,7 +199,7 @@ public:
 
     /// \brief Returns the number of truncated basis functions
     unsigned numTruncated() const
-    { return m_presentation.size(); }
+    { return (m_is_truncated.array() != -1).count(); }
 
     bool isTruncated(unsigned i) const
     {
@@ -360,25 +207,30 @@ public:
     }
 
     /// \brief Returns an iterator to the representation of the first truncated basis function
-    typename std::map<unsigned, gsSparseVector<T> >::const_iterator truncatedBegin() const
-    { return m_presentation.begin(); }
+    truncatedIterator truncatedBegin() const
+    { return truncatedIterator(*this, 0); }
 
     /// \brief Returns an iterator past the last truncated basis function
-    typename std::map<unsigned, gsSparseVector<T> >::const_iterator truncatedEnd() const
-    { return m_presentation.end(); }
-
-    /// Returns sparse representation of the i-th basis function.
-    const gsSparseVector<T>& getCoefs(unsigned i) const
+    truncatedIterator truncatedEnd() const
+    { return truncatedIterator(*this, this->size()); }
+
+    /// Returns sparse representation of the i-th basis function in
+    /// terms of the B-splines of level getPresLevelOfBasisFun(i). The
+    /// view refers to the storage of the basis, it is invalidated by
+    /// a refinement.
+    CoefsView getCoefs(unsigned i) const
     {
         if (this->m_is_truncated[i] == -1)
         {
             GISMO_ERROR("This basis function has no sparse representation. "
                         "It is not truncated.");
         }
-        else
-        {
-            return this->m_presentation.find(i)->second;
-        }
+
+        // Column i of the (compressed) matrix of all representations
+        return CoefsView(this->m_bases[m_is_truncated[i]]->size(), 1,
+                         m_presOffset[i+1] - m_presOffset[i], &m_presOffset[i],
+                         m_presIndex.empty() ? NULL : &m_presIndex.front(),
+                         m_presCoefs.empty() ? NULL : &m_presCoefs.front());
     }
 
 
@@ -403,6 +255,72 @@ private:
     /// @brief Computes and saves representation of all basis functions.
     void representBasis(); // rename: precompute coeffs
 
+    /// @brief Updates the representations after a change of the
+    /// hierarchical mesh, recomputing only the functions whose support
+    /// overlaps the modified cells \a changedBoxes (see
+    /// gsHDomain::insertBoxes()). The tensor-product levels must be
+    /// unchanged.
+    ///
+    /// The other arguments are the characteristic matrices and the
+    /// storage of the representations before the change.
+    void updateRepresentation(const std::vector<unsigned> & changedBoxes,
+                              const std::vector<CMatrix> & oldXmatrix,
+                              const std::vector<unsigned> & oldXmatrixOffset,
+                              const gsVector<int> & oldTruncated,
+                              const std::vector<index_t> & oldPresOffset,
+                              const std::vector<index_t> & oldPresIndex,
+                              const std::vector<T> & oldPresCoefs);
+
+    /// @brief Computes the representation of the j-th basis function
+    /// and appends it to the storage. The representations of the
+    /// functions 0,..,j-1 must have been stored before.
+    void _appendRepresentation(const unsigned j);
+
+    /// @brief Evaluates the values (\a n = 0), first (\a n = 1) or
+    /// second (\a n = 2) derivatives of the active basis functions
+    /// at the points \a u.
+    ///
+    /// The tensor-product basis of every level is evaluated once for
+    /// all points. The values of a truncated function are obtained
+    /// by applying its representation to the values of the active
+    /// tensor-product functions of its level, see _addTruncated().
+    void _evalDers_into(const int n, const gsMatrix<T> & u,
+                        gsMatrix<T>& result) const;
+
+    /// Evaluates the derivatives of order \a n (at most 2) of the
+    /// truncated basis function \a i at the points \a u, from its
+    /// stored representation.
+    void _evalTruncatedSingle_into(const unsigned i, const int n,
+                                   const gsMatrix<T> & u,
+                                   gsMatrix<T>& result) const;
+
+    /// Adds to \a res the values \a vals of the \a nAct active
+    /// tensor-product functions \a act (increasing) of the level of
+    /// the truncated function \a i, multiplied by the coefficients of
+    /// the representation of \a i. Every function has \a numVals
+    /// consecutive values.
+    void _addTruncated(const unsigned i, const unsigned * act, const index_t nAct,
+                       const T * vals, const index_t numVals, T * res) const
+    {
+        const index_t * cInd    = m_presIndex.data() + m_presOffset[i];
+        const index_t * cIndEnd = m_presIndex.data() + m_presOffset[i+1];
+        const T       * cVal    = m_presCoefs.data() + m_presOffset[i];
+
+        // Both index lists are increasing
+        const index_t * it = cInd;
+        for (index_t r = 0; r != nAct && it != cIndEnd; ++r)
+        {
+            const index_t a = static_cast<index_t>(act[r]);
+            it = std::lower_bound(it, cIndEnd, a);
+            if ( it != cIndEnd && *it == a )
+            {
+                const T c = cVal[it - cInd];
+                for (index_t k = 0; k != numVals; ++k)
+                    res[k] += c * vals[r * numVals + k];
+            }
+        }
+    }
+
 
     /// Computes representation of j-th basis function on pres_level and
     /// saves it.
@@ -598,11 +516,7 @@ private:
      * @brief Initialize the characteristic and coefficient
      * matrices and the internal bspline representations.
     **/
-    void update_structure() 
-    {
-        gsHTensorBasis<d,T>::update_structure(); 
-        representBasis();
-    }
+    void update_structure();
 
     /**
       @brief Returns a representation of \a thbCoefs as tensor-product
@@ -709,12 +623,16 @@ private:
     gsVector<int> m_is_truncated;
 
 
-    // m_presentation[j] is presentation of the j-th basis function in terms of
-    // B-Splines at level m_is_truncated[j]
+    // Presentations of the basis functions in terms of B-Splines at
+    // level m_is_truncated[j], stored contiguously for all functions:
+    // the entries m_presOffset[j],..,m_presOffset[j+1]-1 of
+    // m_presIndex (tensor indices, increasing) and m_presCoefs
+    // (coefficients) belong to the j-th basis function.
     //
-    // if m_is_truncated[j] is equal to -1, then there is no entry
-    // m_presentation[j]
-    std::map<unsigned, gsSparseVector<T> > m_presentation;
+    // if m_is_truncated[j] is equal to -1, the range is empty
+    std::vector<index_t> m_presOffset;
+    std::vector<index_t> m_presIndex;
+    std::vector<T>       m_presCoefs;
 
     using gsHTensorBasis<d,T>::m_bases;
     using gsHTensorBasis<d,T>::m_xmatrix;
@@ -53,39 +53,143 @@ void gsTHBSplineBasis<d,T>::representBasis()
 {
     // Cleanup previous basis
     this->m_is_truncated.resize(this->size());
-    m_presentation.clear();
+    m_presOffset.clear();
+    m_presOffset.reserve(this->size() + 1);
+    m_presOffset.push_back(0);
+    m_presIndex.clear();
+    m_presCoefs.clear();
 
     for (unsigned j = 0; j < static_cast<unsigned>(this->size()); ++j)
+        _appendRepresentation(j);
+}
+
+template<unsigned d, class T>
+void gsTHBSplineBasis<d,T>::_appendRepresentation(const unsigned j)
+{
+    unsigned level = static_cast<unsigned>(this->levelOf(j));
+    unsigned tensor_index = this->flatTensorIndexOf(j, level);
+
+    // element indices
+    gsMatrix<unsigned, d, 2> element_ind(d, 2);
+    this->m_bases[level]->elementSupport_into(tensor_index, element_ind);
+
+    // I tried with block, I can not trick the compiler to use references
+    gsVector<unsigned, d> low = element_ind.col(0); //block<d, 1>(0, 0);
+    gsVector<unsigned, d> high = element_ind.col(1); //block<d, 1>(0, 1);gsMatrix<unsigned> element_ind =
+
+    // Finds coarsest level that function, with supports given with
+    // support indices of the coarsest level (low & high), has presentation
+    // based only on B-Splines (and not THB-Splines).
+    // this is not the same as query 3
+    unsigned clevel = this->m_tree.query4(low, high, level);
+
+    if (level != clevel) // we must compute its presentation
     {
-        unsigned level = static_cast<unsigned>(this->levelOf(j));
-        unsigned tensor_index = this->flatTensorIndexOf(j, level);
+        this->m_tree.computeFinestIndex(low, level, low);
+        this->m_tree.computeFinestIndex(high, level, high);
 
-        // element indices
-        gsMatrix<unsigned, d, 2> element_ind(d, 2);
-        this->m_bases[level]->elementSupport_into(tensor_index, element_ind);
+        this->m_is_truncated[j] = clevel;
+        _representBasisFunction(j, clevel, low, high);
+    }
+    else
+    {
+        this->m_is_truncated[j] = -1;
+    }
 
-        // I tried with block, I can not trick the compiler to use references
-        gsVector<unsigned, d> low = element_ind.col(0); //block<d, 1>(0, 0);
-        gsVector<unsigned, d> high = element_ind.col(1); //block<d, 1>(0, 1);gsMatrix<unsigned> element_ind =
+    m_presOffset.push_back(m_presIndex.size());
+}
 
-        // Finds coarsest level that function, with supports given with
-        // support indices of the coarsest level (low & high), has presentation
-        // based only on B-Splines (and not THB-Splines).
-        // this is not the same as query 3
-        unsigned clevel = this->m_tree.query4(low, high, level);
+template<unsigned d, class T>
+void gsTHBSplineBasis<d,T>::update_structure()
+{
+    // Keep the previous structure, for reusing the representations
+    // which are not affected by the change
+    const std::vector<CMatrix> oldXmatrix = m_xmatrix;
+    std::vector<unsigned> oldXmatrixOffset;
+    oldXmatrixOffset.swap(m_xmatrix_offset);
+    std::vector<index_t> oldPresOffset, oldPresIndex;
+    std::vector<T> oldPresCoefs;
+    oldPresOffset.swap(m_presOffset);
+    oldPresIndex .swap(m_presIndex );
+    oldPresCoefs .swap(m_presCoefs );
+    const gsVector<int> oldTruncated = m_is_truncated;
+    std::vector<index_t> oldLevelSize(oldXmatrix.size());
+    for (size_t l = 0; l != oldXmatrix.size(); ++l)
+        oldLevelSize[l] = m_bases[l]->size();
+
+    // The cells modified by a refinement, if known
+    const bool localUpdate = this->m_localUpdate;
+    const std::vector<unsigned> changedBoxes = this->m_changedBoxes;
+
+    gsHTensorBasis<d,T>::update_structure();
+
+    // The update is possible if the modified cells are known, the
+    // tensor-product levels are the same and the previous
+    // representation is complete. Otherwise all representations are
+    // computed from scratch.
+    bool incremental = localUpdate && ! oldXmatrixOffset.empty() &&
+        oldPresOffset.size() == oldXmatrixOffset.back() + 1 &&
+        oldXmatrix.size() <= m_bases.size();
+    for (size_t l = 0; incremental && l != oldXmatrix.size(); ++l)
+        incremental = ( oldLevelSize[l] == m_bases[l]->size() );
+
+    if ( incremental )
+        updateRepresentation(changedBoxes, oldXmatrix, oldXmatrixOffset, oldTruncated,
+                             oldPresOffset, oldPresIndex, oldPresCoefs);
+    else
+        representBasis();
+}
 
-        if (level != clevel) // we must compute its presentation
-        {
-            this->m_tree.computeFinestIndex(low, level, low);
-            this->m_tree.computeFinestIndex(high, level, high);
+template<unsigned d, class T>
+void gsTHBSplineBasis<d,T>::updateRepresentation(
+    const std::vector<unsigned> & changedBoxes,
+    const std::vector<CMatrix> & oldXmatrix,
+    const std::vector<unsigned> & oldXmatrixOffset,
+    const gsVector<int> & oldTruncated,
+    const std::vector<index_t> & oldPresOffset,
+    const std::vector<index_t> & oldPresIndex,
+    const std::vector<T> & oldPresCoefs)
+{
+    // The representation of a function depends only on the levels of
+    // the cells in its support, the functions whose support overlaps
+    // the modified cells are recomputed
+    std::vector< std::vector<unsigned> > changedFun( m_xmatrix.size() );
+    for (size_t lvl = 0; lvl != m_xmatrix.size(); ++lvl)
+        this->functionsOverlapping(lvl, changedBoxes, changedFun[lvl]);
+
+    const unsigned n = this->size();
+    this->m_is_truncated.resize(n);
+    m_presOffset.clear();
+    m_presOffset.reserve(n + 1);
+    m_presOffset.push_back(0);
+    m_presIndex.clear();
+    m_presIndex.reserve(oldPresIndex.size());
+    m_presCoefs.clear();
+    m_presCoefs.reserve(oldPresCoefs.size());
+
+    for (unsigned j = 0; j < n; ++j)
+    {
+        const unsigned lvl = this->levelOf(j);
+        const unsigned t   = this->flatTensorIndexOf(j, lvl);
 
-            this->m_is_truncated[j] = clevel;
-            _representBasisFunction(j, clevel, low, high);
-        }
-        else
+        if ( std::binary_search(changedFun[lvl].begin(), changedFun[lvl].end(), t) )
         {
-            this->m_is_truncated[j] = -1;
+            _appendRepresentation(j);
+            continue;
         }
+
+        // Unaffected functions were active before, copy the old representation
+        const unsigned oj = oldXmatrixOffset[lvl] +
+            ( std::lower_bound(oldXmatrix[lvl].begin(), oldXmatrix[lvl].end(), t)
+              - oldXmatrix[lvl].begin() );
+        this->m_is_truncated[j] = oldTruncated[oj];
+        m_presIndex.insert(m_presIndex.end(),
+                           oldPresIndex.begin() + oldPresOffset[oj],
+                           oldPresIndex.begin() + oldPresOffset[oj+1]);
+        m_presCoefs.insert(m_presCoefs.end(),
+                           oldPresCoefs.begin() + oldPresOffset[oj],
+                           oldPresCoefs.begin() + oldPresOffset[oj+1]);
+        m_presOffset.push_back(m_presIndex.size());
     }
 }
 
@@ -212,12 +316,7 @@ void gsTHBSplineBasis<d,T>::_saveNewBasisFunPresentation(
     gsVector<unsigned, d> last_point(d);
     bspline::getLastIndexLocal<d>(act_size_of_coefs, last_point);
 
-    this->m_presentation[j] =
-        gsSparseVector<T>(this->m_bases[pres_level]->size());
-
-    gsSparseVector<T>& presentation = this->m_presentation[j];
-    //presentation.reserve(coefs.rows()); // reserve memory ?
-
+    // The tensor indices are visited in increasing order
     do
     {
         // ten_index - (tensor) index of a bspline function with respect to
@@ -234,7 +333,10 @@ void gsTHBSplineBasis<d,T>::_saveNewBasisFunPresentation(
         unsigned coef_index = bspline::getIndex<d>(act_coefs_strides, position);
 
         if (coefs(coef_index) != 0)
-            presentation(ten_index) = coefs(coef_index);
+        {
+            m_presIndex.push_back(ten_index);
+            m_presCoefs.push_back(coefs(coef_index));
+        }
 
     } while(nextCubePoint<gsVector<unsigned, d> > (position, first_point,
                                                    last_point));
@@ -306,8 +408,14 @@ void gsTHBSplineBasis<d,T>::_truncate(
 
     gsVector<unsigned, d> first_point(position);
 
-    unsigned xmatrix_index = 0;
-    unsigned tensor_active_index = this->m_xmatrix[level][0];
+    // The tensor indices visited below are increasing, start at the
+    // first active function which is not before them
+    const CMatrix & cmat = this->m_xmatrix[level];
+    unsigned xmatrix_index =
+        std::lower_bound(cmat.begin(), cmat.end(), const_ten_index) - cmat.begin();
+    if (xmatrix_index == cmat.size())
+        return;
+    unsigned tensor_active_index = cmat[xmatrix_index];
 
     unsigned numb_of_point = size_of_coefs[0];
 
@@ -1021,18 +1129,7 @@ void gsTHBSplineBasis<d,T>::evalSingle_into(unsigned i,
         this->m_bases[level]->evalSingle_into(tensor_index, u, result);
     }
     else
-    {
-        
-        unsigned level = this->m_is_truncated[i];
-        
-        const gsSparseVector<T>& coefs = getCoefs(i);
-        
-        const gsTensorBSplineBasis<d, T>& base =
-            *this->m_bases[level];
-        
-        gsTensorDeboor<d, T, gsKnotVector<T>, gsSparseVector<T> >
-            (u, base, coefs, result);
-    }
+        _evalTruncatedSingle_into(i, 0, u, result);
 }
 
 template<unsigned d, class T>
@@ -1048,89 +1145,85 @@ void gsTHBSplineBasis<d,T>::deriv2Single_into(unsigned i,
         this->m_bases[level]->deriv2Single_into(fl_tensor_index, u, result);
     }
     else
-    {
-        const unsigned level = this->m_is_truncated[i];
-        const gsSparseVector<T>& coefs = this->getCoefs(i);
-        const gsTensorBSplineBasis<d, T> & base =
-            *this->m_bases[level];
-        
-        gsTensorDeriv2_into<d, T, gsKnotVector<T>,
-                            gsSparseVector<T> >(u, base, coefs, result);
-    }
+        _evalTruncatedSingle_into(i, 2, u, result);
 }
 
 template<unsigned d, class T>
 void gsTHBSplineBasis<d,T>::eval_into(const gsMatrix<T> & u, gsMatrix<T>& result) const
 {
-    gsMatrix<unsigned> indices;
-    gsMatrix<T> res(1, 1);
-    this->active_into(u, indices);
-
-    result.setZero(indices.rows(), u.cols());
-
-    for (index_t i = 0; i < indices.cols(); i++)
-    {
-        for (index_t j = 0; j < indices.rows(); j++)
-        {
-            const unsigned index = indices(j, i);
-            if (j != 0 && index == 0)
-                break;
-            
-            evalSingle_into(index, u.col(i), res);
-            result(j, i) = res.value();
-        }
-    }
+    _evalDers_into(0, u, result);
 }
 
 
 template<unsigned d, class T>
 void gsTHBSplineBasis<d,T>::deriv2_into(const gsMatrix<T>& u, gsMatrix<T>& result)const
 {
-    gsMatrix<unsigned> indices;
-    this->active_into(u, indices);
-
-    static const unsigned numDers = (d * (d + 1)) / 2;
-    gsMatrix<T> res(numDers, 1); // result of deriv2Single_into
-
-    result.setZero(indices.rows() * numDers, u.cols());
-
-    for (int i = 0; i < indices.cols(); i++)
-    {
-        for (int j = 0; j < indices.rows(); j++)
-        {
-            const unsigned index = indices(j, i);
-            if (j != 0 && index == 0)
-                break;
+    _evalDers_into(2, u, result);
+}
 
-            this->deriv2Single_into(index, u.col(i), res);
 
-            result.template block<numDers, 1>(j * numDers, i) = res;
-        }
-    }
+template<unsigned d, class T>
+void gsTHBSplineBasis<d,T>::deriv_into(const gsMatrix<T>& u, gsMatrix<T>& result) const
+{
+    _evalDers_into(1, u, result);
 }
 
 
 template<unsigned d, class T>
-void gsTHBSplineBasis<d,T>::deriv_into(const gsMatrix<T>& u, gsMatrix<T>& result) const
+void gsTHBSplineBasis<d,T>::_evalDers_into(const int n, const gsMatrix<T> & u,
+                                           gsMatrix<T>& result) const
 {
+    const index_t numDers = ( 0 == n ? 1 : ( 1 == n ? d : (d * (d + 1)) / 2 ) );
 
     gsMatrix<unsigned> indices;
     this->active_into(u, indices);
-    gsMatrix<T> res(d, 1);
 
-    result.setZero(indices.rows() * d, u.cols());
+    result.setZero(indices.rows() * numDers, u.cols());
+
+    // Values and active functions of the tensor-product bases, for
+    // all points, computed when a level is first needed
+    const size_t nLevels = this->m_bases.size();
+    std::vector< gsMatrix<T> >        lvlVals(nLevels);
+    std::vector< gsMatrix<unsigned> > lvlActive(nLevels);
+    std::vector<bool>                 computed(nLevels, false);
 
-    for (int i = 0; i < indices.cols(); i++)
+    for (index_t pt = 0; pt != u.cols(); ++pt)
     {
-        for (int j = 0; j < indices.rows(); j++)
+        for (index_t j = 0; j != indices.rows(); ++j)
         {
-
-            const unsigned index = indices(j, i);
+            const unsigned index = indices(j, pt);
             if (j != 0 && index == 0)
                 break;
 
-            this->derivSingle_into(index, u.col(i), res);
-            result.template block<d,1>(j * d, i) = res;
+            const unsigned lvl = getPresLevelOfBasisFun(index);
+            if ( ! computed[lvl] )
+            {
+                const gsTensorBSplineBasis<d,T> & base = *this->m_bases[lvl];
+                if ( 0 == n )
+                    base.eval_into(u, lvlVals[lvl]);
+                else if ( 1 == n )
+                    base.deriv_into(u, lvlVals[lvl]);
+                else
+                    base.deriv2_into(u, lvlVals[lvl]);
+                base.active_into(u, lvlActive[lvl]);
+                computed[lvl] = true;
+            }
+
+            // Active tensor-product functions at pt, in increasing order
+            const unsigned * act  = lvlActive[lvl].col(pt).data();
+            const index_t    nAct = lvlActive[lvl].rows();
+            const T        * vals = lvlVals[lvl].col(pt).data();
+            T              * res  = result.col(pt).data() + j * numDers;
+
+            if (m_is_truncated[index] == -1)
+            {
+                const unsigned flatTenIndx = this->flatTensorIndexOf(index, lvl);
+                const index_t  loc = std::lower_bound(act, act + nAct, flatTenIndx) - act;
+                for (index_t k = 0; k != numDers; ++k)
+                    res[k] = vals[loc * numDers + k];
+            }
+            else // basis function is truncated
+                _addTruncated(index, act, nAct, vals, numDers, res);
         }
     }
 }
@@ -1149,14 +1242,32 @@ void gsTHBSplineBasis<d,T>::derivSingle_into(unsigned i,
         this->m_bases[level]->derivSingle_into(fl_tensor_index, u, result);
     }
     else
-    {
-        unsigned level = this->m_is_truncated[i];
-        const gsSparseVector<T>& coefs = this->getCoefs(i);
-        const gsTensorBSplineBasis<d,T>& base =
-            *this->m_bases[level];
-        gsTensorDeriv_into<d, T, gsKnotVector<T>,
-                           gsSparseVector<T> >(u, base, coefs, result);
-    }
+        _evalTruncatedSingle_into(i, 1, u, result);
+}
+
+
+template<unsigned d, class T>
+void gsTHBSplineBasis<d,T>::_evalTruncatedSingle_into(const unsigned i, const int n,
+                                                      const gsMatrix<T> & u,
+                                                      gsMatrix<T>& result) const
+{
+    const index_t numDers = ( 0 == n ? 1 : ( 1 == n ? d : (d * (d + 1)) / 2 ) );
+    const gsTensorBSplineBasis<d,T> & base = *this->m_bases[m_is_truncated[i]];
+
+    gsMatrix<T> vals;
+    gsMatrix<unsigned> act;
+    if ( 0 == n )
+        base.eval_into(u, vals);
+    else if ( 1 == n )
+        base.deriv_into(u, vals);
+    else
+        base.deriv2_into(u, vals);
+    base.active_into(u, act);
+
+    result.setZero(numDers, u.cols());
+    for (index_t pt = 0; pt != u.cols(); ++pt)
+        _addTruncated(i, act.col(pt).data(), act.rows(), vals.col(pt).data(),
+                      numDers, result.col(pt).data());
 }
 
 
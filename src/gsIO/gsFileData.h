@@ -212,6 +212,10 @@ public:
     }
     
     /// Add the object to the Xml tree, same as <<
+    ///
+    /// The numeric arrays of the object are encoded as set by
+    /// xml::setDefaultEncoding() at the time of the call. Files with
+    /// base64-encoded arrays are read transparently.
     template<class Object>
     void add (const Object & obj)
     {
@@ -38,6 +38,9 @@ namespace gismo {
     The above creates a file with extension pvd. When opening this
     file with Paraview, the containts of all parts in the list are
     loaded.
+
+    The collection file only refers to the parts, which may be
+    written in any of the formats of paraview::format.
     
     \ingroup IO
 */
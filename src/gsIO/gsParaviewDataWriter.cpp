@@ -0,0 +1,130 @@
+/** @file gsParaviewDataWriter.cpp
+
+    @brief Provides a helper class for writing the data arrays of VTK
+    XML (Paraview) files in ascii, raw binary or zlib-compressed form.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <gsIO/gsParaviewDataWriter.h>
+#include <zlib/zlib.h>
+
+namespace gismo
+{
+
+namespace
+{
+// Format used by gsWriteParaview
+paraview::format s_defaultFormat = paraview::ascii;
+
+// Size of the uncompressed blocks of a compressed array
+const size_t s_blockSize = 32768;
+
+// Header entries of the appended arrays (header_type="UInt64")
+typedef unsigned long long headerInt;
+
+void appendHeader(std::string & out, const headerInt * h, size_t n)
+{
+    out.append(reinterpret_cast<const char*>(h), n * sizeof(headerInt));
+}
+
+bool isLittleEndian()
+{
+    const int one = 1;
+    return 1 == *reinterpret_cast<const char*>(&one);
+}
+
+} // anonymous namespace
+
+namespace paraview
+{
+
+void setDefaultFormat(format f) { s_defaultFormat = f; }
+
+format defaultFormat() { return s_defaultFormat; }
+
+} // namespace paraview
+
+void gsParaviewDataWriter::beginFile(const char * type)
+{
+    m_os <<"<?xml version=\"1.0\"?>\n";
+    m_os <<"<VTKFile type=\""<< type <<"\"";
+    if ( paraview::ascii == m_format )
+        m_os <<" version=\"0.1\"";
+    else
+        m_os <<" version=\"1.0\" header_type=\"UInt64\"";
+    m_os <<" byte_order=\""<< (isLittleEndian() ? "LittleEndian" : "BigEndian") <<"\"";
+    if ( paraview::compressed == m_format )
+        m_os <<" compressor=\"vtkZLibDataCompressor\"";
+    m_os <<">\n";
+}
+
+void gsParaviewDataWriter::endFile()
+{
+    if ( ! m_appended.empty() )
+    {
+        m_os <<"<AppendedData encoding=\"raw\">\n_";
+        m_os.write(m_appended.data(), m_appended.size());
+        m_os <<"\n</AppendedData>\n";
+        m_appended.clear();
+    }
+    m_os <<"</VTKFile>\n";
+}
+
+void gsParaviewDataWriter::beginArray(const char * type, index_t numComp,
+                                      const std::string & name,
+                                      const std::string & attr)
+{
+    m_os <<"<DataArray type=\""<< type <<"\"";
+    if ( ! name.empty() )
+        m_os <<" Name=\""<< name <<"\"";
+    m_os <<" NumberOfComponents=\""<< numComp <<"\"";
+    m_os << attr;
+    if ( paraview::ascii == m_format )
+        m_os <<" format=\"ascii\">\n";
+    else
+        m_os <<" format=\"appended\" offset=\""<< m_appended.size() <<"\"/>\n";
+}
+
+void gsParaviewDataWriter::appendData(const char * data, size_t nbytes)
+{
+    if ( paraview::binary == m_format )
+    {
+        const headerInt h = nbytes;
+        appendHeader(m_appended, &h, 1);
+        m_appended.append(data, nbytes);
+        return;
+    }
+
+    // Header: number of blocks, block size, size of the last block
+    // (zero if it is a full block), followed by the compressed size
+    // of every block
+    const size_t nBlocks = (nbytes + s_blockSize - 1) / s_blockSize;
+    std::vector<headerInt> header(3 + nBlocks);
+    header[0] = nBlocks;
+    header[1] = s_blockSize;
+    header[2] = nbytes % s_blockSize;
+
+    std::string blocks;
+    std::vector<Bytef> buf( compressBound(s_blockSize) );
+    for (size_t k = 0; k < nBlocks; ++k)
+    {
+        const size_t len = ( k + 1 == nBlocks ) ? nbytes - k * s_blockSize : s_blockSize;
+        uLongf clen = buf.size();
+        const int err = compress2(&buf[0], &clen,
+                                  reinterpret_cast<const Bytef*>(data + k * s_blockSize),
+                                  len, Z_BEST_SPEED);
+        GISMO_ENSURE( Z_OK == err, "Compression of VTK data array failed (zlib error "<< err <<").");
+        header[3 + k] = clen;
+        blocks.append(reinterpret_cast<const char*>(&buf[0]), clen);
+    }
+
+    appendHeader(m_appended, &header[0], header.size());
+    m_appended.append(blocks);
+}
+
+} // namespace gismo
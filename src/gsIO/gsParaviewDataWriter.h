@@ -0,0 +1,204 @@
+/** @file gsParaviewDataWriter.h
+
+    @brief Provides a helper class for writing the data arrays of VTK
+    XML (Paraview) files in ascii, raw binary or zlib-compressed form.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <gsCore/gsLinearAlgebra.h>
+#include <ostream>
+#include <sstream>
+
+namespace gismo
+{
+
+namespace paraview
+{
+
+/// \brief Encoding of the data arrays in the files written by
+/// gsWriteParaview and related functions
+///
+/// \ingroup IO
+enum format
+{
+    ascii      = 0, ///< Human readable text
+    binary     = 1, ///< Raw binary data, appended at the end of the file
+    compressed = 2  ///< As \a binary, compressed with zlib
+};
+
+/// \brief Sets the format used by all subsequent calls of
+/// gsWriteParaview which are not given a format (default:
+/// paraview::ascii)
+///
+/// The default is read once at the beginning of every such call, by
+/// the calling thread; the files of a multipatch object, which may be
+/// written by several threads, all receive that format. The default
+/// itself is not protected against concurrent access: threads which
+/// write files concurrently should pass the format to
+/// gsWriteParaview instead of changing the default.
+///
+/// \ingroup IO
+GISMO_EXPORT void setDefaultFormat(format f);
+
+/// \brief Returns the format used by gsWriteParaview if none is given
+///
+/// \ingroup IO
+GISMO_EXPORT format defaultFormat();
+
+} // namespace paraview
+
+/**
+   \brief Changes the format of the Paraview output for the lifetime
+   of the object, eg. for a single call of gsWriteParaview.
+
+   \code
+   {
+       gsParaviewScopedFormat fmt(paraview::compressed);
+       gsWriteParaview(field, "solution");
+   } // previous format is restored here
+   \endcode
+
+   The object changes the process-wide default, see
+   paraview::setDefaultFormat(); with concurrent writers, pass the
+   format to gsWriteParaview instead.
+
+   \ingroup IO
+*/
+class gsParaviewScopedFormat
+{
+public:
+    explicit gsParaviewScopedFormat(paraview::format f)
+    : m_previous(paraview::defaultFormat())
+    { paraview::setDefaultFormat(f); }
+
+    ~gsParaviewScopedFormat()
+    { paraview::setDefaultFormat(m_previous); }
+
+private:
+    paraview::format m_previous;
+
+private:
+    gsParaviewScopedFormat(const gsParaviewScopedFormat &);
+    gsParaviewScopedFormat & operator=(const gsParaviewScopedFormat &);
+};
+
+/**
+   \brief Writes the enclosing VTKFile element and the DataArray
+   elements of a VTK XML file.
+
+   In ascii format the values are written inside the DataArray
+   elements. In the binary formats the arrays are converted to the
+   requested type in one pass and kept as raw bytes, which are
+   written in the AppendedData section by endFile(). Compressed
+   arrays are split in blocks of 32KB which are compressed with zlib
+   (header type UInt64, vtkZLibDataCompressor).
+
+   Typical usage is
+   \code
+   std::ofstream file("out.vts");
+   gsParaviewDataWriter vtk(file);
+   vtk.beginFile("StructuredGrid");
+   file << "<StructuredGrid ...><Piece ...><Points>\n";
+   vtk.dataArray<float>(points, 3);  // points: 3 x N matrix
+   file << "</Points></Piece></StructuredGrid>\n";
+   vtk.endFile();
+   \endcode
+
+   \ingroup IO
+*/
+class GISMO_EXPORT gsParaviewDataWriter
+{
+public:
+
+    /// Constructor, the arrays are written to \a os in format \a f
+    explicit gsParaviewDataWriter(std::ostream & os,
+                                  paraview::format f = paraview::defaultFormat())
+    : m_os(os), m_format(f)
+    { }
+
+    /// Returns the format of the arrays
+    paraview::format format() const { return m_format; }
+
+    /// Writes the XML declaration and the opening VTKFile tag of a
+    /// file with data set type \a type (eg. "StructuredGrid")
+    void beginFile(const char * type);
+
+    /// Writes the appended data (if any) and closes the VTKFile tag
+    void endFile();
+
+    /**
+       \brief Writes a DataArray element with values of type \a S
+
+       The tuples of the array are the consecutive groups of \a
+       numComp entries of \a data in column-major order, eg. the
+       columns of a matrix having \a numComp rows.
+
+       \param data the values
+       \param numComp number of components of each tuple
+       \param name the name of the array (omitted if empty)
+       \param range if true, the minimum and the maximum of the
+       values are written as the attributes RangeMin and RangeMax
+    */
+    template<class S, class Derived>
+    void dataArray(const Eigen::DenseBase<Derived> & data, index_t numComp = 1,
+                   const std::string & name = std::string(), bool range = false)
+    {
+        GISMO_ASSERT( 0 == data.size() % numComp, "Incomplete tuples");
+        std::ostringstream attr;
+        if ( range && 0 != data.size() )
+        {
+            attr.copyfmt(m_os);
+            attr <<" RangeMin=\""<< static_cast<S>(data.minCoeff())
+                 <<"\" RangeMax=\""<< static_cast<S>(data.maxCoeff()) <<"\"";
+        }
+        beginArray(typeName(S()), numComp, name, attr.str());
+        if ( paraview::ascii == m_format )
+        {
+            for ( index_t j = 0; j < data.cols(); ++j)
+                for ( index_t i = 0; i < data.rows(); ++i)
+                    m_os << data(i,j) << " ";
+            m_os << "\n</DataArray>\n";
+        }
+        else
+        {
+            const Eigen::Matrix<S,Dynamic,Dynamic> buf = data.derived().template cast<S>();
+            appendData(reinterpret_cast<const char*>(buf.data()), buf.size() * sizeof(S));
+        }
+    }
+
+private:
+
+    /// Opens the DataArray tag, \a attr holds further attributes
+    void beginArray(const char * type, index_t numComp, const std::string & name,
+                    const std::string & attr);
+
+    /// Appends the array \a data of \a nbytes bytes to the appended data
+    void appendData(const char * data, size_t nbytes);
+
+    static const char * typeName(float)         { return "Float32"; }
+    static const char * typeName(double)        { return "Float64"; }
+    static const char * typeName(int)           { return "Int32"  ; }
+    static const char * typeName(unsigned char) { return "UInt8"  ; }
+
+private:
+
+    std::ostream & m_os;
+
+    paraview::format m_format;
+
+    /// Binary data of the arrays, written at the end of the file
+    std::string m_appended;
+
+private:
+    gsParaviewDataWriter(const gsParaviewDataWriter &);
+    gsParaviewDataWriter & operator=(const gsParaviewDataWriter &);
+};
+
+} // namespace gismo
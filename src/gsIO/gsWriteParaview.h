@@ -2,6 +2,10 @@
 
     @brief Provides declaration of functions writing Paraview files.
 
+    The data arrays are written in the format given by the \a fmt
+    argument (ascii, raw binary or zlib-compressed), by default the one
+    returned by paraview::defaultFormat(), see gsParaviewDataWriter.
+
     This file is part of the G+Smo library. 
 
     This Source Code Form is subject to the terms of the Mozilla Public
@@ -13,6 +17,7 @@
 
 #include <gsCore/gsForwardDeclarations.h>
 #include <gsCore/gsExport.h>
+#include <gsIO/gsParaviewDataWriter.h>
 
 #include <sstream>
 #include <fstream>
@@ -32,19 +37,23 @@ namespace gismo {
 /// \param npts number of points used for sampling each patch
 /// \param mesh if true, the parameter mesh is plotted as well
 /// \param ctrlNet if true, the control net is plotted as well
+/// \param fmt format of the data arrays, see gsParaviewDataWriter
 ///
 /// \ingroup IO
 template<class T>
 void gsWriteParaview(const gsGeometry<T> & Geo, std::string const & fn, 
-                     unsigned npts=NS, bool mesh = false, bool ctrlNet = false);
+                     unsigned npts=NS, bool mesh = false, bool ctrlNet = false,
+                     paraview::format fmt = paraview::defaultFormat());
 
 /// \brief Export a mesh to paraview file
 ///
 /// \param sl a gsMesh obect
 /// \param fn filename where paraview file is written
 /// \param pvd if true, a .pvd file is generated (for compatibility)
+/// \param fmt format of the data arrays, see gsParaviewDataWriter
 template <class T>
-void gsWriteParaview(gsMesh<T> const& sl, std::string const & fn, bool pvd = true);
+void gsWriteParaview(gsMesh<T> const& sl, std::string const & fn, bool pvd = true,
+                     paraview::format fmt = paraview::defaultFormat());
 
 /// \brief Export a vector of meshes, each mesh in its own file.
 ///
@@ -60,9 +69,15 @@ void gsWriteParaview(const std::vector<gsMesh<T> >& meshes, std::string const& f
 /// \param fn filename where paraview file is written
 /// \param npts number of points used for sampling each patch
 /// \param mesh if true, the parameter mesh is plotted as well
+/// \param fmt format of the data arrays, see gsParaviewDataWriter
+///
+/// Every patch is written to its own file, and \a fn.pvd collects
+/// them. The patches are written in parallel when OpenMP is enabled;
+/// the files are the same as in a serial run.
 template<class T>
 void gsWriteParaview(const gsField<T> & field, std::string const & fn, 
-                     unsigned npts=NS, bool mesh = false);
+                     unsigned npts=NS, bool mesh = false,
+                     paraview::format fmt = paraview::defaultFormat());
 
 /// \brief Export a multipatch Geometry (without scalar information) to paraview file
 ///
@@ -71,11 +86,13 @@ void gsWriteParaview(const gsField<T> & field, std::string const & fn,
 /// \param npts number of points used for sampling each patch
 /// \param mesh if true, the parameter mesh is plotted as well
 /// \param ctrlNet if true, the control net is plotted as well
+/// \param fmt format of the data arrays, see gsParaviewDataWriter
 template<class T>
 void gsWriteParaview(const gsMultiPatch<T> & Geo, std::string const & fn, 
-                     unsigned npts=NS, bool mesh = false, bool ctrlNet = false)
+                     unsigned npts=NS, bool mesh = false, bool ctrlNet = false,
+                     paraview::format fmt = paraview::defaultFormat())
 {
-    gsWriteParaview( Geo.patches(), fn, npts, mesh, ctrlNet);
+    gsWriteParaview( Geo.patches(), fn, npts, mesh, ctrlNet, fmt);
 }
 
 /// \brief Export a multipatch Geometry (without scalar information) to paraview file
@@ -85,15 +102,22 @@ void gsWriteParaview(const gsMultiPatch<T> & Geo, std::string const & fn,
 /// \param npts number of points used for sampling each geometry
 /// \param mesh if true, the parameter mesh is plotted as well
 /// \param ctrlNet if true, the control net is plotted as well
+/// \param fmt format of the data arrays, see gsParaviewDataWriter
+///
+/// Every geometry is written to its own file(s), and \a fn.pvd
+/// collects them. The geometries are written in parallel when OpenMP
+/// is enabled; the files are the same as in a serial run.
 template<class T>
 void gsWriteParaview( std::vector<gsGeometry<T> *> const & Geo, 
                       std::string const & fn, unsigned npts=NS,
-                      bool mesh = false, bool ctrlNet = false);
+                      bool mesh = false, bool ctrlNet = false,
+                      paraview::format fmt = paraview::defaultFormat());
 
 /// \brief Export a computational mesh to paraview file
 template<class T>
 void gsWriteParaview(const gsMultiBasis<T> & mb, const gsMultiPatch<T> & domain,
-                     std::string const & fn, unsigned npts);
+                     std::string const & fn, unsigned npts,
+                     paraview::format fmt = paraview::defaultFormat());
 
 /// \brief Export a composite Geometry to paraview file
 ///
@@ -187,11 +211,13 @@ void gsWriteParaviewPoints(gsMatrix<T> const& points, std::string const & fn);
 ///
 /// \param points matrix that contain 2D or 3D points, points are columns
 /// \param fn filename where paraview file is written
+/// \param fmt format of the data arrays, see gsParaviewDataWriter
 template<class T>
 void gsWriteParaviewTPgrid(gsMatrix<T> const& points,
                            gsMatrix<T> const& data,
                            const gsVector<index_t> & np,
-                           std::string const & fn);
+                           std::string const & fn,
+                           paraview::format fmt = paraview::defaultFormat());
 
 /// \brief Depicting edge graph of each volume of one gsSolid with a segmenting loop
 ///
@@ -16,12 +16,14 @@
 
 #include <gsIO/gsWriteParaview.h>
 #include <gsIO/gsParaviewCollection.h>
+#include <gsIO/gsParaviewDataWriter.h>
 #include <gsIO/gsIOUtils.h>
 
 #include <gsCore/gsGeometry.h>
 #include <gsCore/gsGeometrySlice.h>
 #include <gsCore/gsField.h>
 #include <gsCore/gsDebug.h>
+#include <gsMpi/gsOpenMP.h>
 
 #include <gsModeling/gsTrimSurface.h>
 #include <gsModeling/gsSolid.h>
@@ -36,7 +38,8 @@ namespace gismo
 // Export a 3D parametric mesh
 template<class T>
 void writeSingleBasisMesh3D(const gsMesh<T> & sl,
-                            std::string const & fn)
+                            std::string const & fn,
+                            paraview::format fmt = paraview::defaultFormat())
 {
     const unsigned numVer = sl.numVertices;
     const unsigned numEl  = numVer / 8;
@@ -48,69 +51,46 @@ void writeSingleBasisMesh3D(const gsMesh<T> & sl,
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
     
-    file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
+    gsParaviewDataWriter vtk(file, fmt);
+    vtk.beginFile("UnstructuredGrid");
     file <<"<UnstructuredGrid>\n";
     
     // Number of vertices and number of cells
     file <<"<Piece NumberOfPoints=\""<< numVer <<"\" NumberOfCells=\""<<numEl<<"\">\n";
     
     // Coordinates of vertices
-    file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" NumberOfComponents=\"3\" format=\"ascii\">\n";
-    for (typename std::vector< gsVertex<T>* >::const_iterator it=sl.vertex.begin(); it!=sl.vertex.end(); ++it)
+    gsMatrix<T> coords(3, numVer);
+    gsVector<T> vdata(numVer);
+    for (unsigned i = 0; i!= numVer; ++i)
     {
-        file << ((*it)->coords)[0] << " " << ((*it)->coords)[1] << " " << ((*it)->coords)[2] << " \n";
+        coords.col(i) = sl.vertex[i]->coords;
+        vdata[i]      = sl.vertex[i]->data;
     }
-    file << "\n";
-    file <<"</DataArray>\n";
+    file <<"<Points>\n";
+    vtk.dataArray<float>(coords, 3);
     file <<"</Points>\n";
 
     // Point data
     file <<"<PointData Scalars=\"CellVolume\">\n";
-    file <<"<DataArray type=\"Float32\" Name=\"CellVolume\" format=\"ascii\" NumberOfComponents=\"1\">\n";
-    for (typename std::vector< gsVertex<T>* >::const_iterator it=sl.vertex.begin(); it!=sl.vertex.end(); ++it)
-    {
-        file << (*it)->data <<" ";
-    }
-    file << "\n";
-    file <<"</DataArray>\n";
+    vtk.dataArray<float>(vdata, 1, "CellVolume");
     file <<"</PointData>\n";
 
     // Cells
     file <<"<Cells>\n";
 
     // Connectivity
-    file <<"<DataArray type=\"Int32\" Name=\"connectivity\" format=\"ascii\">\n";
-    for (unsigned i = 0; i!= numVer;++i)
-    {
-        file << i << " ";
-    }
-    file << "\n";
-    file <<"</DataArray>\n";
+    vtk.dataArray<int>(gsVector<int>::LinSpaced(numVer, 0, numVer-1), 1, "connectivity");
 
     // Offsets
-    file << "<DataArray type=\"Int32\" Name=\"offsets\" format=\"ascii\">\n";
-    for (unsigned i = 1; i<= numEl;++i)
-    {
-        file << 8*i << " ";
-    }
-    file << "\n";
-    file << "</DataArray>\n";
+    vtk.dataArray<int>(8 * gsVector<int>::LinSpaced(numEl, 1, numEl), 1, "offsets");
 
     // Type
-    file << "<DataArray type=\"Int32\" Name=\"types\" format=\"ascii\">\n";
-    for (unsigned i = 1; i<= numEl;++i)
-    {
-        file << "11 ";
-    }
-    file << "\n";
-    file << "</DataArray>\n";
+    vtk.dataArray<int>(gsVector<int>::Constant(numEl, 11), 1, "types");
 
     file <<"</Cells>\n";
     file << "</Piece>\n";
     file <<"</UnstructuredGrid>\n";
-    file <<"</VTKFile>\n";
+    vtk.endFile();
     file.close();
     
     //if( pvd ) // make a pvd file
@@ -121,7 +101,8 @@ void writeSingleBasisMesh3D(const gsMesh<T> & sl,
 // 
 template<class T>
 void writeSingleBasisMesh2D(const gsMesh<T> & sl,
-                            std::string const & fn)
+                            std::string const & fn,
+                            paraview::format fmt = paraview::defaultFormat())
 {
     const unsigned numVer = sl.numVertices;
     const unsigned numEl  = numVer / 4; //(1<<dim)
@@ -133,73 +114,51 @@ void writeSingleBasisMesh2D(const gsMesh<T> & sl,
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
     
-    file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
+    gsParaviewDataWriter vtk(file, fmt);
+    vtk.beginFile("UnstructuredGrid");
     file <<"<UnstructuredGrid>\n";
     
     // Number of vertices and number of cells
     file <<"<Piece NumberOfPoints=\""<< numVer <<"\" NumberOfCells=\""<<numEl<<"\">\n";
     
     // Coordinates of vertices
-    file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" NumberOfComponents=\"3\" format=\"ascii\">\n";
-    for (typename std::vector< gsVertex<T>* >::const_iterator it=sl.vertex.begin(); it!=sl.vertex.end(); it+=4)
+    gsMatrix<T> coords(3, numVer);
+    gsVector<T> vdata(numVer);
+    for (unsigned i = 0; i < numVer; i+=4)
     {
         // order is important!
-        file << ((*it)->coords)[0] << " " << ((*it)->coords)[1] << " " << ((*it)->coords)[2] << " \n";
-        file << ((*(it+1))->coords)[0] << " " << ((*(it+1))->coords)[1] << " " << ((*(it+1))->coords)[2] << " \n";
-        file << ((*(it+3))->coords)[0] << " " << ((*(it+3))->coords)[1] << " " << ((*(it+3))->coords)[2] << " \n";
-        file << ((*(it+2))->coords)[0] << " " << ((*(it+2))->coords)[1] << " " << ((*(it+2))->coords)[2] << " \n";
+        coords.col(i  ) = sl.vertex[i  ]->coords;
+        coords.col(i+1) = sl.vertex[i+1]->coords;
+        coords.col(i+2) = sl.vertex[i+3]->coords;
+        coords.col(i+3) = sl.vertex[i+2]->coords;
     }
-    file << "\n";
-    file <<"</DataArray>\n";
+    for (unsigned i = 0; i!= numVer; ++i)
+        vdata[i] = sl.vertex[i]->data;
+    file <<"<Points>\n";
+    vtk.dataArray<float>(coords, 3);
     file <<"</Points>\n";
 
     // Point data
     file <<"<PointData Scalars=\"CellArea\">\n";
-    file <<"<DataArray type=\"Float32\" Name=\"CellVolume\" format=\"ascii\" NumberOfComponents=\"1\">\n";
-    for (typename std::vector< gsVertex<T>* >::const_iterator it=sl.vertex.begin(); it!=sl.vertex.end(); ++it)
-    {
-        file << (*it)->data <<" ";
-    }
-    file << "\n";
-    file <<"</DataArray>\n";
+    vtk.dataArray<float>(vdata, 1, "CellVolume");
     file <<"</PointData>\n";
 
     // Cells
     file <<"<Cells>\n";
 
     // Connectivity
-    file <<"<DataArray type=\"Int32\" Name=\"connectivity\" format=\"ascii\">\n";
-    for (unsigned i = 0; i!= numVer;++i)
-    {
-        file << i << " ";
-    }
-    file << "\n";
-    file <<"</DataArray>\n";
+    vtk.dataArray<int>(gsVector<int>::LinSpaced(numVer, 0, numVer-1), 1, "connectivity");
 
-    // Offsets
-    file << "<DataArray type=\"Int32\" Name=\"offsets\" format=\"ascii\">\n";
-    for (unsigned i = 1; i<= numEl;++i)
-    {
-        file << 4*i << " "; //step: (1<<dim) 
-    }
-    file << "\n";
-    file << "</DataArray>\n";
+    // Offsets, step: (1<<dim)
+    vtk.dataArray<int>(4 * gsVector<int>::LinSpaced(numEl, 1, numEl), 1, "offsets");
 
-    // Type
-    file << "<DataArray type=\"Int32\" Name=\"types\" format=\"ascii\">\n";
-    for (unsigned i = 1; i<= numEl;++i)
-    {
-        file << "9 ";// 11: 3D, 9: 2D
-    }
-    file << "\n";
-    file << "</DataArray>\n";
+    // Type, 11: 3D, 9: 2D
+    vtk.dataArray<int>(gsVector<int>::Constant(numEl, 9), 1, "types");
 
     file <<"</Cells>\n";
     file << "</Piece>\n";
     file <<"</UnstructuredGrid>\n";
-    file <<"</VTKFile>\n";
+    vtk.endFile();
     file.close();
     
     //if( pvd ) // make a pvd file
@@ -210,21 +169,23 @@ void writeSingleBasisMesh2D(const gsMesh<T> & sl,
 /// Export a parametric mesh
 template<class T>
 void writeSingleBasisMesh(const gsBasis<T> & basis,
-                         std::string const & fn)
+                         std::string const & fn,
+                         paraview::format fmt = paraview::defaultFormat())
 {
     gsMesh<T> msh(basis, 0);
     if ( basis.dim() == 3)
-        writeSingleBasisMesh3D(msh,fn);
+        writeSingleBasisMesh3D(msh,fn,fmt);
     else if ( basis.dim() == 2)
-        writeSingleBasisMesh2D(msh,fn);
+        writeSingleBasisMesh2D(msh,fn,fmt);
     else
-        gsWriteParaview(msh, fn, false);
+        gsWriteParaview(msh, fn, false, fmt);
 }
 
 /// Export a computational mesh
 template<class T>
 void writeSingleCompMesh(const gsBasis<T> & basis, const gsGeometry<T> & Geo, 
-                         std::string const & fn, unsigned resolution = 8)
+                         std::string const & fn, unsigned resolution = 8,
+                         paraview::format fmt = paraview::defaultFormat())
 {
     gsMesh<T> msh(basis, resolution);
     Geo.evaluateMesh(msh);
@@ -234,13 +195,14 @@ void writeSingleCompMesh(const gsBasis<T> & basis, const gsGeometry<T> & Geo,
     // else if ( basis.dim() == 2)
     //     writeSingleBasisMesh2D(msh,fn);
     // else
-        gsWriteParaview(msh, fn, false);
+        gsWriteParaview(msh, fn, false, fmt);
 }
 
 /// Export a control net
 template<class T>
 void writeSingleControlNet(const gsGeometry<T> & Geo, 
-                           std::string const & fn)
+                           std::string const & fn,
+                           paraview::format fmt = paraview::defaultFormat())
 {
     const int d = Geo.parDim();
     gsMesh<T> msh;
@@ -258,14 +220,15 @@ void writeSingleControlNet(const gsGeometry<T> & Geo,
     }
 
 
-    gsWriteParaview(msh, fn, false);
+    gsWriteParaview(msh, fn, false, fmt);
 }
 
 template<class T>
 void gsWriteParaviewTPgrid(const gsMatrix<T> & eval_geo  ,
                            const gsMatrix<T> & eval_field,
                            const gsVector<index_t> & np,
-                           std::string const & fn)
+                           std::string const & fn,
+                           paraview::format fmt)
 {
     const int n = eval_geo.rows();
     GISMO_ASSERT(eval_geo.cols()==eval_field.cols()
@@ -278,43 +241,36 @@ void gsWriteParaviewTPgrid(const gsMatrix<T> & eval_geo  ,
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
 
-    file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"StructuredGrid\" version=\"0.1\">\n";
+    gsParaviewDataWriter vtk(file, fmt);
+    vtk.beginFile("StructuredGrid");
     file <<"<StructuredGrid WholeExtent=\"0 "<< np(0)-1<<" 0 "<<np(1)-1<<" 0 "
          << (np.size()>2 ? np(2)-1 : 0) <<"\">\n";
     file <<"<Piece Extent=\"0 "<< np(0)-1<<" 0 "<<np(1)-1<<" 0 "
          << (np.size()>2 ? np(2)-1 : 0) <<"\">\n";
     file <<"<PointData "<< ( eval_field.rows()==1 ?"Scalars":"Vectors")<<"=\"SolutionField\">\n";
-    file <<"<DataArray type=\"Float32\" Name=\"SolutionField\" format=\"ascii\" NumberOfComponents=\""<< ( eval_field.rows()==1 ? 1 : 3) <<"\">\n";
-    if ( eval_field.rows()==1 )
-        for ( index_t j=0; j<eval_field.cols(); ++j)
-            file<< eval_field.at(j) <<" ";
+    if ( eval_field.rows()==1 || eval_field.rows()==3 )
+        vtk.dataArray<float>(eval_field, eval_field.rows(), "SolutionField");
     else
     {
-        for ( index_t j=0; j<eval_field.cols(); ++j)
-        {
-            for ( index_t i=0; i!=eval_field.rows(); ++i)
-                file<< eval_field(i,j) <<" ";
-            for ( index_t i=eval_field.rows(); i<3; ++i)
-                file<<"0 ";
-        }
+        gsMatrix<T> field3 = gsMatrix<T>::Zero(3, eval_field.cols());
+        field3.topRows( math::min(3, static_cast<int>(eval_field.rows())) ) =
+            eval_field.topRows( math::min(3, static_cast<int>(eval_field.rows())) );
+        vtk.dataArray<float>(field3, 3, "SolutionField");
     }
-    file <<"</DataArray>\n";
     file <<"</PointData>\n";
     file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" NumberOfComponents=\"3\">\n";
-    for ( index_t j=0; j<eval_geo.cols(); ++j)
+    if ( 3 == n )
+        vtk.dataArray<float>(eval_geo, 3);
+    else
     {
-        for ( index_t i=0; i!=n; ++i)
-            file<< eval_geo(i,j) <<" ";
-        for ( index_t i=n; i<3; ++i)
-            file<<"0 ";
+        gsMatrix<T> geo3 = gsMatrix<T>::Zero(3, eval_geo.cols());
+        geo3.topRows( math::min(3, n) ) = eval_geo.topRows( math::min(3, n) );
+        vtk.dataArray<float>(geo3, 3);
     }
-    file <<"</DataArray>\n";
     file <<"</Points>\n";
     file <<"</Piece>\n";
     file <<"</StructuredGrid>\n";
-    file <<"</VTKFile>\n";
+    vtk.endFile();
 
     file.close();
 }
@@ -323,7 +279,8 @@ template<class T>
 void writeSinglePatchField(const gsFunction<T> & geometry,
                            const gsFunction<T> & parField,
                            const bool isParam,
-                           std::string const & fn, unsigned npts)
+                           std::string const & fn, unsigned npts,
+                           paraview::format fmt = paraview::defaultFormat())
 {
     const int n = geometry.targetDim();
     const int d = geometry.domainDim();
@@ -333,10 +290,11 @@ void writeSinglePatchField(const gsFunction<T> & geometry,
     gsVector<T> b = ab.col(1);
 
     gsVector<unsigned> np = uniformSampleCount(a, b, npts);
-    gsMatrix<T> pts = gsPointGrid(a, b, np);
+    std::vector< gsVector<T> > cwise;
+    uniformCwisePoints(a, b, np, cwise);
 
-    gsMatrix<T> eval_geo = geometry.eval(pts);//pts
-    gsMatrix<T>  eval_field = isParam ? parField.eval(pts) : parField.eval(eval_geo);
+    gsMatrix<T> eval_geo = geometry.evalOnGrid(cwise);//pts
+    gsMatrix<T>  eval_field = isParam ? parField.evalOnGrid(cwise) : parField.eval(eval_geo);
 
     if ( 3 - d > 0 )
     {
@@ -366,15 +324,16 @@ void writeSinglePatchField(const gsFunction<T> & geometry,
         eval_field.bottomRows( 3-d ).setZero();
     }
 
-    gsWriteParaviewTPgrid(eval_geo, eval_field, np.template cast<index_t>(), fn);
+    gsWriteParaviewTPgrid(eval_geo, eval_field, np.template cast<index_t>(), fn, fmt);
 }
 
 /// Write a file containing a solution field over a single geometry
 template<class T>
 void writeSinglePatchField(const gsField<T> & field, int patchNr, 
-                           std::string const & fn, unsigned npts)
+                           std::string const & fn, unsigned npts,
+                           paraview::format fmt = paraview::defaultFormat())
 {
-    writeSinglePatchField(field.patch(patchNr), field.function(patchNr), field.isParametric(), fn, npts);
+    writeSinglePatchField(field.patch(patchNr), field.function(patchNr), field.isParametric(), fn, npts, fmt);
 /*
     const int n = field.geoDim();
     const int d = field.parDim();
@@ -454,7 +413,8 @@ void writeSinglePatchField(const gsField<T> & field, int patchNr,
 template<class T>
 void writeSingleGeometry(gsFunction<T> const& func, 
                          gsMatrix<T> const& supp, 
-                         std::string const & fn, unsigned npts)
+                         std::string const & fn, unsigned npts,
+                         paraview::format fmt = paraview::defaultFormat())
 {
     const int n = func.targetDim();
     const int d = func.domainDim();
@@ -462,9 +422,10 @@ void writeSingleGeometry(gsFunction<T> const& func,
     gsVector<T> a = supp.col(0);
     gsVector<T> b = supp.col(1);
     gsVector<unsigned> np = uniformSampleCount(a,b, npts );
-    gsMatrix<T> pts = gsPointGrid(a,b,np) ;
+    std::vector< gsVector<T> > cwise;
+    uniformCwisePoints(a, b, np, cwise);
 
-    gsMatrix<T>  eval_func = func.eval  ( pts ) ;//pts
+    gsMatrix<T>  eval_func = func.evalOnGrid( cwise ) ;//pts
 
     if ( 3 - d > 0 )
     {
@@ -481,7 +442,7 @@ void writeSingleGeometry(gsFunction<T> const& func,
         {
             //std::swap( eval_geo.row(d),  eval_geo.row(0) );
             eval_func.row(d) = eval_func.row(0);
-            eval_func.topRows(d) = pts;
+            eval_func.topRows(d) = gsPointGrid<T>(cwise);
         }
     }
 
@@ -492,8 +453,8 @@ void writeSingleGeometry(gsFunction<T> const& func,
         std::cout<<"Problem opening "<<fn<<std::endl;
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
-    file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"StructuredGrid\" version=\"0.1\">\n";
+    gsParaviewDataWriter vtk(file, fmt);
+    vtk.beginFile("StructuredGrid");
     file <<"<StructuredGrid WholeExtent=\"0 "<<np(0)-1<<" 0 "<<np(1)-1<<" 0 "<<np(2)-1<<"\">\n";
     file <<"<Piece Extent=\"0 "<< np(0)-1<<" 0 "<<np(1)-1<<" 0 "<<np(2)-1<<"\">\n";
     // Add norm of the point as data
@@ -510,24 +471,17 @@ void writeSingleGeometry(gsFunction<T> const& func,
     {
         //gsWarn<< "4th dimension as scalar data.\n";
         file <<"<PointData "<< "Scalars=\"Coordinate4\">\n";
-        file <<"<DataArray type=\"Float32\" Name=\"Coordinate4\" format=\"ascii\" NumberOfComponents=\"1\">\n";
-        for ( index_t j=0; j!=eval_func.cols(); ++j)
-            file<< eval_func(3,j) <<" ";
-        file <<"</DataArray>\n";
+        vtk.dataArray<float>(eval_func.row(3), 1, "Coordinate4");
         file <<"</PointData>\n";
     }
     //---------
 
     file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" NumberOfComponents=\"3\">\n";
-    for ( index_t j=0; j<eval_func.cols(); ++j)
-        for ( index_t i=0; i!=3; ++i)
-            file<< eval_func(i,j) <<" ";
-    file <<"</DataArray>\n";
+    vtk.dataArray<float>(eval_func.topRows(3), 3);
     file <<"</Points>\n";
     file <<"</Piece>\n";
     file <<"</StructuredGrid>\n";
-    file <<"</VTKFile>\n";
+    vtk.endFile();
     file.close();
 }
 
@@ -535,7 +489,8 @@ void writeSingleGeometry(gsFunction<T> const& func,
 template<class T>
 void writeSingleCurve(gsFunction<T> const& func, 
                       gsMatrix<T> const& supp, 
-                      std::string const & fn, unsigned npts)
+                      std::string const & fn, unsigned npts,
+                      paraview::format fmt = paraview::defaultFormat())
 {
     const unsigned n = func.targetDim();
     const unsigned d = func.domainDim();
@@ -544,9 +499,10 @@ void writeSingleCurve(gsFunction<T> const& func,
     gsVector<T> a = supp.col(0);
     gsVector<T> b = supp.col(1);
     gsVector<unsigned> np = uniformSampleCount(a,b, npts );
-    gsMatrix<T> pts = gsPointGrid(a,b,np) ;
+    std::vector< gsVector<T> > cwise;
+    uniformCwisePoints(a, b, np, cwise);
 
-    gsMatrix<T>  eval_func = func.eval  ( pts ) ;//pts
+    gsMatrix<T>  eval_func = func.evalOnGrid( cwise ) ;//pts
 
     np.conservativeResize(3);
     np.bottomRows(2).setOnes();
@@ -560,7 +516,7 @@ void writeSingleCurve(gsFunction<T> const& func,
         {
             //std::swap( eval_geo.row(d),  eval_geo.row(0) );
             eval_func.row(d) = eval_func.row(0);
-            eval_func.topRows(d) = pts;
+            eval_func.topRows(d) = gsPointGrid<T>(cwise);
         }
     }
 
@@ -571,54 +527,43 @@ void writeSingleCurve(gsFunction<T> const& func,
         gsInfo<<"Problem opening "<<fn<<"\n";
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
-    file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"PolyData\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
+    gsParaviewDataWriter vtk(file, fmt);
+    vtk.beginFile("PolyData");
     file <<"<PolyData>\n";
     // Accounting
     file <<"<Piece NumberOfPoints=\""<< npts
          <<"\" NumberOfVerts=\"0\" NumberOfLines=\""<< npts-1
          <<"\" NumberOfStrips=\"0\" NumberOfPolys=\"0\">\n";
     file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" NumberOfComponents=\""<<eval_func.rows()<<"\">\n";
-    for ( index_t j=0; j<eval_func.cols(); ++j)
-        for ( index_t i=0; i<eval_func.rows(); ++i)
-            file<< eval_func(i,j) <<" ";
-    file <<"\n</DataArray>\n";
+    vtk.dataArray<float>(eval_func, eval_func.rows());
     file <<"</Points>\n";
     // Lines
     file <<"<Lines>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\"0\" RangeMax=\""<<npts-1<<"\">\n";
-    for (unsigned i=0; i< npts-1; ++i )
-    {
-        file << i << " " << i+1 << " ";
-    }
+    gsMatrix<int> conn(2, npts-1);
+    conn.row(0) = gsVector<int>::LinSpaced(npts-1, 0, npts-2).transpose();
+    conn.row(1) = conn.row(0).array() + 1;
+    vtk.dataArray<int>(conn, 1, "connectivity", true);
     // offsets
-    file <<"\n</DataArray>\n";
-    unsigned offset(0);
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\"0\" RangeMax=\""<<npts-1<<"\">\n";
-    for (unsigned i=0; i< npts-1; ++i )
-    {
-        offset +=2;
-        file << offset << " ";
-    }
-    file <<"\n</DataArray>\n";
+    vtk.dataArray<int>(2 * gsVector<int>::LinSpaced(npts-1, 1, npts-1), 1, "offsets", true);
     file <<"</Lines>\n";
     // Closing 
     file <<"</Piece>\n";
     file <<"</PolyData>\n";
-    file <<"</VTKFile>\n";
+    vtk.endFile();
     file.close();
 }
 
 template<class T>
-void writeSingleCurve(const gsGeometry<T> & Geo, std::string const & fn, unsigned npts)
+void writeSingleCurve(const gsGeometry<T> & Geo, std::string const & fn, unsigned npts,
+                      paraview::format fmt = paraview::defaultFormat())
 {
     gsMatrix<T> ab = Geo.parameterRange();
-    writeSingleCurve( Geo, ab, fn, npts);
+    writeSingleCurve( Geo, ab, fn, npts, fmt);
 }
 
 template<class T>
-void writeSingleGeometry(const gsGeometry<T> & Geo, std::string const & fn, unsigned npts)
+void writeSingleGeometry(const gsGeometry<T> & Geo, std::string const & fn, unsigned npts,
+                         paraview::format fmt = paraview::defaultFormat())
 {
     /*
       gsMesh<T> msh;
@@ -627,7 +572,7 @@ void writeSingleGeometry(const gsGeometry<T> & Geo, std::string const & fn, unsi
       return;
     //*/
     gsMatrix<T> ab = Geo.parameterRange();
-    writeSingleGeometry( Geo, ab, fn, npts);
+    writeSingleGeometry( Geo, ab, fn, npts, fmt);
 }
 
 template<class T>
@@ -644,7 +589,7 @@ void writeSingleTrimSurface(const gsTrimSurface<T> & surf,
 template<class T>
 void gsWriteParaview(const gsField<T> & field, 
                      std::string const & fn, 
-                     unsigned npts, bool mesh)
+                     unsigned npts, bool mesh, paraview::format fmt)
 {
     /*
     if (mesh && (!field.isParametrized()) )
@@ -654,26 +599,43 @@ void gsWriteParaview(const gsField<T> & field,
     }
     */
     
-    const unsigned n = field.nPatches();
-    gsParaviewCollection collection(fn);
-    std::string fileName;
+    const index_t n = field.nPatches();
 
-    for ( unsigned i=0; i < n; ++i )
+    // The patches are sampled and written in parallel, every thread
+    // holds the samples of one patch at a time
+    internal::gsParallelError error;
+#   pragma omp parallel for schedule(dynamic, 1)
+    for ( index_t i=0; i < n; ++i )
     {
-        const gsBasis<T> & dom = field.isParametrized() ? 
-            field.igaFunction(i).basis() : field.patch(i).basis();
-        
-        fileName = fn + util::to_string(i);
-        writeSinglePatchField( field, i, fileName, npts );
-        collection.addPart(fileName, ".vts");
-        if ( mesh ) 
+        try
         {
-            fileName+= "_mesh";
-            writeSingleCompMesh(dom, field.patch(i), fileName);
+            const gsBasis<T> & dom = field.isParametrized() ?
+                field.igaFunction(i).basis() : field.patch(i).basis();
+
+            // Functions such as gsFunctionExpr cannot be evaluated
+            // concurrently, every patch works on a copy
+            const memory::unique_ptr< gsFunction<T> > func( field.function(i).clone() );
 
-            collection.addPart(fileName, ".vtp");
+            std::string fileName = fn + util::to_string(i);
+            writeSinglePatchField( field.patch(i), *func, field.isParametric(), fileName, npts, fmt );
+            if ( mesh )
+            {
+                fileName+= "_mesh";
+                writeSingleCompMesh(dom, field.patch(i), fileName, 8, fmt);
+            }
         }
+        catch (...) { error.store(); }
+    }
+    error.rethrow();
 
+    // The parts are listed in patch order, as in serial mode
+    gsParaviewCollection collection(fn);
+    for ( index_t i=0; i < n; ++i )
+    {
+        const std::string fileName = fn + util::to_string(i);
+        collection.addPart(fileName, ".vts");
+        if ( mesh ) 
+            collection.addPart(fileName + "_mesh", ".vtp");
     }
     collection.save();
 }
@@ -682,7 +644,7 @@ void gsWriteParaview(const gsField<T> & field,
 /// Export a Geometry without scalar information
 template<class T>
 void gsWriteParaview(const gsGeometry<T> & Geo, std::string const & fn, 
-                     unsigned npts, bool mesh, bool ctrlNet)
+                     unsigned npts, bool mesh, bool ctrlNet, paraview::format fmt)
 {
     const bool curve = ( Geo.domainDim() == 1 );
 
@@ -690,26 +652,26 @@ void gsWriteParaview(const gsGeometry<T> & Geo, std::string const & fn,
 
     if ( curve )
     {
-        writeSingleCurve(Geo, fn, npts);
+        writeSingleCurve(Geo, fn, npts, fmt);
         collection.addPart(fn, ".vtp");
     }
     else
     {
-        writeSingleGeometry(Geo, fn, npts);
+        writeSingleGeometry(Geo, fn, npts, fmt);
         collection.addPart(fn, ".vts");
     }
 
     if ( mesh ) // Output the underlying mesh
     {
         const std::string fileName = fn + "_mesh";
-        writeSingleCompMesh(Geo.basis(), Geo, fileName, npts);
+        writeSingleCompMesh(Geo.basis(), Geo, fileName, npts, fmt);
         collection.addPart(fileName, ".vtp");
     }
 
     if ( ctrlNet ) // Output the control net
     {
         const std::string fileName = fn + "_cnet";
-        writeSingleControlNet(Geo, fileName);
+        writeSingleControlNet(Geo, fileName, fmt);
         collection.addPart(fileName, ".vtp");
     }
 
@@ -720,18 +682,28 @@ void gsWriteParaview(const gsGeometry<T> & Geo, std::string const & fn,
 // Export a multibasis mesh
 template<class T>
 void gsWriteParaview(const gsMultiBasis<T> & mb, const gsMultiPatch<T> & domain,
-                     std::string const & fn, unsigned npts)
+                     std::string const & fn, unsigned npts, paraview::format fmt)
 {
     // GISMO_ASSERT sizes
 
-    gsParaviewCollection collection(fn);
+    const index_t n = domain.nPatches();
 
-    for (unsigned i = 0; i!= domain.nPatches(); ++i)
+    internal::gsParallelError error;
+#   pragma omp parallel for schedule(dynamic, 1)
+    for (index_t i = 0; i < n; ++i)
     {
-        const std::string fileName = fn + util::to_string(i) + "_mesh";
-        writeSingleCompMesh(mb[i], domain.patch(i), fileName, npts);
-        collection.addPart(fileName, ".vtp");
+        try
+        {
+            const std::string fileName = fn + util::to_string(i) + "_mesh";
+            writeSingleCompMesh(mb[i], domain.patch(i), fileName, npts, fmt);
+        }
+        catch (...) { error.store(); }
     }
+    error.rethrow();
+
+    gsParaviewCollection collection(fn);
+    for (index_t i = 0; i != n; ++i)
+        collection.addPart(fn + util::to_string(i) + "_mesh", ".vtp");
 
     // Write out the collection file
     collection.save();
@@ -753,40 +725,45 @@ void gsWriteParaview(const gsGeometrySlice<T> & Geo,
 /// Export a multipatch Geometry without scalar information
 template<class T>
 void gsWriteParaview( std::vector<gsGeometry<T> *> const & Geo, std::string const & fn, 
-                      unsigned npts, bool mesh, bool ctrlNet)
+                      unsigned npts, bool mesh, bool ctrlNet, paraview::format fmt)
 {
-    const size_t n = Geo.size();
-
-    gsParaviewCollection collection(fn);
+    const index_t n = Geo.size();
 
-    for ( size_t i=0; i<n ; i++)
+    // The patches are sampled and written in parallel, every thread
+    // holds the samples of one patch at a time
+    internal::gsParallelError error;
+#   pragma omp parallel for schedule(dynamic, 1)
+    for ( index_t i=0; i<n ; i++)
     {
-        std::string fnBase = fn + util::to_string(i);
-        
-        if ( Geo.at(i)->domainDim() == 1 )
-        {
-            writeSingleCurve(*Geo[i], fnBase, npts);
-            collection.addPart(fnBase, ".vtp");
-        }
-        else
+        try
         {
-            writeSingleGeometry( *Geo[i], fnBase, npts ) ;
-            collection.addPart(fnBase, ".vts");
+            const std::string fnBase = fn + util::to_string(i);
+
+            if ( Geo.at(i)->domainDim() == 1 )
+                writeSingleCurve(*Geo[i], fnBase, npts, fmt);
+            else
+                writeSingleGeometry( *Geo[i], fnBase, npts, fmt ) ;
+
+            if ( mesh )
+                writeSingleCompMesh(Geo[i]->basis(), *Geo[i], fnBase + "_mesh", 8, fmt);
+
+            if ( ctrlNet ) // Output the control net
+                writeSingleControlNet(*Geo[i], fnBase + "_cnet", fmt);
         }
-        
+        catch (...) { error.store(); }
+    }
+    error.rethrow();
+
+    // The parts are listed in patch order, as in serial mode
+    gsParaviewCollection collection(fn);
+    for ( index_t i=0; i<n ; i++)
+    {
+        const std::string fnBase = fn + util::to_string(i);
+        collection.addPart(fnBase, Geo.at(i)->domainDim() == 1 ? ".vtp" : ".vts");
         if ( mesh ) 
-        {
-            const std::string fileName = fnBase + "_mesh";
-            writeSingleCompMesh(Geo[i]->basis(), *Geo[i], fileName);
-            collection.addPart(fileName, ".vtp");
-        }
-        
-        if ( ctrlNet ) // Output the control net
-        {
-            const std::string fileName = fnBase + "_cnet";
-            writeSingleControlNet(*Geo[i], fileName);
-            collection.addPart(fileName, ".vtp");
-        }
+            collection.addPart(fnBase + "_mesh", ".vtp");
+        if ( ctrlNet )
+            collection.addPart(fnBase + "_cnet", ".vtp");
     }
     collection.save();
 }
@@ -840,33 +817,25 @@ void gsWriteParaview_basisFnct(int i, gsBasis<T> const& basis, std::string const
         std::cout<<"Problem opening "<<fn<<std::endl;
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
-    file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"StructuredGrid\" version=\"0.1\">\n";
+    gsParaviewDataWriter vtk(file);
+    vtk.beginFile("StructuredGrid");
     file <<"<StructuredGrid WholeExtent=\"0 "<<np(0)-1<<" 0 "<<np(1)-1<<" 0 "<<np(2)-1<<"\">\n";
     file <<"<Piece Extent=\"0 "<< np(0)-1<<" 0 "<<np(1)-1<<" 0 "<<np(2)-1<<"\">\n";
     // Scalar information
     file <<"<PointData "<< "Scalars"<<"=\"SolutionField\">\n";
-    file <<"<DataArray type=\"Float32\" Name=\"SolutionField\" format=\"ascii\" NumberOfComponents=\""<<1<<"\">\n";
-    for ( index_t j=0; j<eval_geo.cols(); ++j)
-            file<< eval_geo(0,j) <<" ";
-    file <<"</DataArray>\n";
+    vtk.dataArray<float>(eval_geo.row(0), 1, "SolutionField");
     file <<"</PointData>\n";
     //
     file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" NumberOfComponents=\""<<3<<"\">\n";
-    for ( index_t j=0; j<eval_geo.cols(); ++j)
-    {
-        for ( int l=0; l!=d; ++l)
-            file<< pts(l,j) <<" ";
-        file<< eval_geo(0,j) <<" ";
-         for ( index_t l=d; l!=pts.rows(); ++l)
-             file<< pts(l,j) <<" ";
-    }
-    file <<"</DataArray>\n";
+    gsMatrix<T> coords(3, eval_geo.cols());
+    coords.topRows(d) = pts.topRows(d);
+    coords.row(d)     = eval_geo.row(0);
+    coords.bottomRows(2-d) = pts.bottomRows(2-d);
+    vtk.dataArray<float>(coords, 3);
     file <<"</Points>\n";
     file <<"</Piece>\n";
     file <<"</StructuredGrid>\n";
-    file <<"</VTKFile>\n";
+    vtk.endFile();
     file.close();
 }
 
@@ -881,10 +850,11 @@ void gsWriteParaview(gsFunction<T> const& func, gsMatrix<T> const& supp, std::st
     gsVector<T> a = supp.col(0);
     gsVector<T> b = supp.col(1);
     gsVector<unsigned> np = uniformSampleCount(a,b, npts );
-    gsMatrix<T> pts = gsPointGrid(a,b,np);
+    std::vector< gsVector<T> > cwise;
+    uniformCwisePoints(a, b, np, cwise);
 
     gsMatrix<T> ev;
-    func.eval_into(pts, ev);
+    func.evalOnGrid_into(cwise, ev);
 
     if ( 3 - d > 0 )
     {
@@ -899,33 +869,24 @@ void gsWriteParaview(gsFunction<T> const& func, gsMatrix<T> const& supp, std::st
         std::cout<<"Problem opening "<<fn<<std::endl;
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
-    file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"StructuredGrid\" version=\"0.1\">\n";
+    gsParaviewDataWriter vtk(file);
+    vtk.beginFile("StructuredGrid");
     file <<"<StructuredGrid WholeExtent=\"0 "<<np(0)-1<<" 0 "<<np(1)-1<<" 0 "<<np(2)-1<<"\">\n";
     file <<"<Piece Extent=\"0 "<< np(0)-1<<" 0 "<<np(1)-1<<" 0 "<<np(2)-1<<"\">\n";
     // Scalar information
     file <<"<PointData "<< "Scalars"<<"=\"SolutionField\">\n";
-    file <<"<DataArray type=\"Float32\" Name=\"SolutionField\" format=\"ascii\" NumberOfComponents=\""<<1<<"\">\n";
-    for ( index_t j=0; j<ev.cols(); ++j)
-            file<< ev(0,j) <<" ";
-    file <<"</DataArray>\n";
+    vtk.dataArray<float>(ev.row(0), 1, "SolutionField");
     file <<"</PointData>\n";
     //
     file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" NumberOfComponents=\""<<3<<"\">\n";
-    for ( index_t j=0; j<ev.cols(); ++j)
-    {
-        for ( int i=0; i< d; ++i)
-            file<< pts(i,j) <<" ";
-        file<< ev(0,j) <<" ";
-//         for ( index_t i=d; i< pts.rows(); ++i)
-//             file<< pts(i,j) <<" ";
-    }
-    file <<"</DataArray>\n";
+    gsMatrix<T> coords(d+1, ev.cols());
+    coords.topRows(d) = gsPointGrid<T>(cwise);
+    coords.row(d)     = ev.row(0);
+    vtk.dataArray<float>(coords, 3);
     file <<"</Points>\n";
     file <<"</Piece>\n";
     file <<"</StructuredGrid>\n";
-    file <<"</VTKFile>\n";
+    vtk.endFile();
     file.close();
 }
 
@@ -957,69 +918,71 @@ void gsWriteParaview(gsBasis<T> const& basis, std::string const & fn,
 }
 
 
-/// Export Point set to Paraview
+namespace internal
+{
+
+/// Writes a .vtp file with the points \a coords (columns) as a single
+/// poly-vertex cell and, if \a V is non-empty, the values \a V as
+/// point data
 template<class T>
-void gsWriteParaviewPoints(gsMatrix<T> const& X, gsMatrix<T> const& Y, std::string const & fn)
+void writeParaviewPointSet(gsMatrix<T> const& coords, gsMatrix<T> const& V,
+                           std::string const & fn,
+                           paraview::format fmt = paraview::defaultFormat())
 {
-    assert( X.cols() == Y.cols() );
-    assert( X.rows() == 1 && Y.rows() == 1 );
-    index_t np = X.cols();
+    const index_t np = coords.cols();
 
     std::string mfn(fn);
     mfn.append(".vtp");
     std::ofstream file(mfn.c_str());
-    if ( ! file.is_open() )
-        std::cout<<"Problem opening "<<fn<<std::endl;
+
+    if (!file.is_open())
+    {
+        gsWarn << "Problem opening " << fn << " Aborting..." << std::endl;
+        return;
+    }
+
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
-    file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"PolyData\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
+
+    gsParaviewDataWriter vtk(file, fmt);
+    vtk.beginFile("PolyData");
     file <<"<PolyData>\n";
     file <<"<Piece NumberOfPoints=\""<<np<<"\" NumberOfVerts=\"1\" NumberOfLines=\"0\" NumberOfStrips=\"0\" NumberOfPolys=\"0\">\n";
-    file <<"<PointData>\n";
-    file <<"</PointData>\n";
-    file <<"<CellData>\n";
-    file <<"</CellData>\n";
+    if ( 0 != V.size() )
+    {
+        file <<"<PointData "<< "Scalars=\"PointInfo\">\n";
+        vtk.dataArray<float>(V, 1, "PointInfo");
+        file <<"</PointData>\n";
+    }
     file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" Name=\"Points\" NumberOfComponents=\"3\" format=\"ascii\" RangeMin=\""<<X.minCoeff()<<"\" RangeMax=\""<<X.maxCoeff()<<"\">\n";
-    for (index_t i=0; i< np; ++i )
-        file << X(0,i) <<" "<<Y(0,i)<<" "<< 0.0 <<"\n";
-    file <<"\n</DataArray>\n";
+    vtk.dataArray<float>(coords, 3, "Points", true);
     file <<"</Points>\n";
     file <<"<Verts>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\""<<0<<"\" RangeMax=\""<<np-1<<"\">\n";
-    for (index_t i=0; i< np; ++i )
-        file << i<<" ";
-    file <<"\n</DataArray>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\""<<np<<"\" RangeMax=\""<<np<<"\">\n"<<np<<"\n";
-    file <<"</DataArray>\n";
+    vtk.dataArray<int>(gsVector<int>::LinSpaced(np, 0, np-1), 1, "connectivity", true);
+    vtk.dataArray<int>(gsVector<int>::Constant(1, np), 1, "offsets", true);
     file <<"</Verts>\n";
-    file <<"<Lines>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\"0\" RangeMax=\""<<np-1<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\""<<np<<"\" RangeMax=\""<<np<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"</Lines>\n";
-    file <<"<Strips>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\"0\" RangeMax=\""<<np-1<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\""<<np<<"\" RangeMax=\""<<np<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"</Strips>\n";
-    file <<"<Polys>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\"0\" RangeMax=\""<<np-1<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\""<<np<<"\" RangeMax=\""<<np<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"</Polys>\n";
     file <<"</Piece>\n";
     file <<"</PolyData>\n";
-    file <<"</VTKFile>\n";
+    vtk.endFile();
     file.close();
 
     makeCollection(fn, ".vtp"); // make also a pvd file
 }
 
+} // namespace internal
+
+/// Export Point set to Paraview
+template<class T>
+void gsWriteParaviewPoints(gsMatrix<T> const& X, gsMatrix<T> const& Y, std::string const & fn)
+{
+    GISMO_ASSERT(X.cols() == Y.cols(), "X and Y must have the same size of columns!");
+    GISMO_ASSERT(X.rows() == 1 && Y.rows() == 1, "X and Y must be row matrices!");
+
+    gsMatrix<T> coords(3, X.cols());
+    coords << X, Y, gsMatrix<T>::Zero(1, X.cols());
+    internal::writeParaviewPointSet(coords, gsMatrix<T>(), fn);
+}
+
 template<class T>
 void gsWriteParaviewPoints(gsMatrix<T> const& X,
                            gsMatrix<T> const& Y,
@@ -1030,75 +993,10 @@ void gsWriteParaviewPoints(gsMatrix<T> const& X,
                  "X, Y and Z must have the same size of columns!");
     GISMO_ASSERT(X.rows() == 1 && Y.rows() == 1 && Z.cols(),
                  "X, Y and Z must be row matrices!");
-    index_t np = X.cols();
-
-    std::string mfn(fn);
-    mfn.append(".vtp");
-    std::ofstream file(mfn.c_str());
-
-    if (!file.is_open())
-    {
-        gsWarn << "Problem opening " << fn << " Aborting..." << std::endl;
-        return;
-    }
-
-    file << std::fixed; // no exponents
-    file << std::setprecision (PLOT_PRECISION);
-
-    file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"PolyData\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
-    file <<"<PolyData>\n";
-    file <<"<Piece NumberOfPoints=\""<<np<<"\" NumberOfVerts=\"1\" NumberOfLines=\"0\" NumberOfStrips=\"0\" NumberOfPolys=\"0\">\n";
-    file <<"<PointData>\n"; //empty
-    file <<"</PointData>\n";
-    file <<"<CellData>\n";
-    file <<"</CellData>\n";
-    file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" Name=\"Points\" NumberOfComponents=\"3\" format=\"ascii\" RangeMin=\""<<X.minCoeff()<<"\" RangeMax=\""<<X.maxCoeff()<<"\">\n";
-
-    for (index_t i = 0; i < np; ++i)
-    {
-        file << X(0, i) << " " << Y(0, i) << " " << Z(0, i) << "\n";
-    }
-
-    file <<"\n</DataArray>\n";
-    file <<"</Points>\n";
-    file <<"<Verts>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\""<<0<<"\" RangeMax=\""<<np-1<<"\">\n";
 
-    for (index_t i=0; i< np; ++i )
-    {
-        file << i << " ";
-    }
-
-    file <<"\n</DataArray>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\""<<np<<"\" RangeMax=\""<<np<<"\">\n"<<np<<"\n";
-    file <<"</DataArray>\n";
-    file <<"</Verts>\n";
-    file <<"<Lines>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\"0\" RangeMax=\""<<np-1<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\""<<np<<"\" RangeMax=\""<<np<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"</Lines>\n";
-    file <<"<Strips>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\"0\" RangeMax=\""<<np-1<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\""<<np<<"\" RangeMax=\""<<np<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"</Strips>\n";
-    file <<"<Polys>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\"0\" RangeMax=\""<<np-1<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\""<<np<<"\" RangeMax=\""<<np<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"</Polys>\n";
-    file <<"</Piece>\n";
-    file <<"</PolyData>\n";
-    file <<"</VTKFile>\n";
-    file.close();
-
-    makeCollection(fn, ".vtp"); // make also a pvd file
+    gsMatrix<T> coords(3, X.cols());
+    coords << X, Y, Z;
+    internal::writeParaviewPointSet(coords, gsMatrix<T>(), fn);
 }
 
 template<class T>
@@ -1112,81 +1010,10 @@ void gsWriteParaviewPoints(gsMatrix<T> const& X,
                  "X, Y and Z must have the same size of columns!");
     GISMO_ASSERT(X.rows() == 1 && Y.rows() == 1 && Z.cols(),
                  "X, Y and Z must be row matrices!");
-    index_t np = X.cols();
-
-    std::string mfn(fn);
-    mfn.append(".vtp");
-    std::ofstream file(mfn.c_str());
-
-    if (!file.is_open())
-    {
-        gsWarn << "Problem opening " << fn << " Aborting..." << std::endl;
-        return;
-    }
-
-    file << std::fixed; // no exponents
-    file << std::setprecision (PLOT_PRECISION);
-
-    file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"PolyData\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
-    file <<"<PolyData>\n";
-    file <<"<Piece NumberOfPoints=\""<<np<<"\" NumberOfVerts=\"1\" NumberOfLines=\"0\" NumberOfStrips=\"0\" NumberOfPolys=\"0\">\n";
-    //---------
-    file <<"<PointData "<< "Scalars=\"PointInfo\">\n";
-    file <<"<DataArray type=\"Float32\" Name=\"PointInfo\" format=\"ascii\" NumberOfComponents=\"1\">\n";
-    for ( index_t j=0; j<np; ++j)
-        file<< V(0,j) <<" ";
-    file <<"</DataArray>\n";
-    file <<"</PointData>\n";
-    //---------
-    file <<"<CellData>\n";
-    file <<"</CellData>\n";
-    file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" Name=\"Points\" NumberOfComponents=\"3\" format=\"ascii\" RangeMin=\""<<X.minCoeff()<<"\" RangeMax=\""<<X.maxCoeff()<<"\">\n";
-
-    for (index_t i = 0; i < np; ++i)
-    {
-        file << X(0, i) << " " << Y(0, i) << " " << Z(0, i) << "\n";
-    }
-
-    file <<"\n</DataArray>\n";
-    file <<"</Points>\n";
-    file <<"<Verts>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\""<<0<<"\" RangeMax=\""<<np-1<<"\">\n";
-
-    for (index_t i=0; i< np; ++i )
-    {
-        file << i << " ";
-    }
-
-    file <<"\n</DataArray>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\""<<np<<"\" RangeMax=\""<<np<<"\">\n"<<np<<"\n";
-    file <<"</DataArray>\n";
-    file <<"</Verts>\n";
-    file <<"<Lines>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\"0\" RangeMax=\""<<np-1<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\""<<np<<"\" RangeMax=\""<<np<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"</Lines>\n";
-    file <<"<Strips>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\"0\" RangeMax=\""<<np-1<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\""<<np<<"\" RangeMax=\""<<np<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"</Strips>\n";
-    file <<"<Polys>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\" RangeMin=\"0\" RangeMax=\""<<np-1<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\" RangeMin=\""<<np<<"\" RangeMax=\""<<np<<"\">\n";
-    file <<"</DataArray>\n";
-    file <<"</Polys>\n";
-    file <<"</Piece>\n";
-    file <<"</PolyData>\n";
-    file <<"</VTKFile>\n";
-    file.close();
 
-    makeCollection(fn, ".vtp"); // make also a pvd file
+    gsMatrix<T> coords(3, X.cols());
+    coords << X, Y, Z;
+    internal::writeParaviewPointSet(coords, V, fn);
 }
 
 template<class T>
@@ -1239,8 +1066,8 @@ void gsWriteParaview(gsSolid<T> const& sl, std::string const & fn, unsigned numP
         std::cout<<"Problem opening "<<fn<<std::endl;
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
-    file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"PolyData\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
+    gsParaviewDataWriter vtk(file);
+    vtk.beginFile("PolyData");
     file <<"<PolyData>\n";
 
 
@@ -1293,51 +1120,30 @@ void gsWriteParaview(gsSolid<T> const& sl, std::string const & fn, unsigned numP
 
                 /// Coordinates of vertices
                 file <<"<Points>\n";
-                file <<"<DataArray type=\"Float32\" NumberOfComponents=\"3\" format=\"ascii\">\n";
-                // translate the volume towards the *translate* vector
-                for (index_t iCol = 0;iCol!=curvePoints.cols();iCol++)
+                // translate the volume towards the *translate* vector, and
+                // translate every second vertex along the vector (faceThick,0,0)
+                const index_t nCol = curvePoints.cols();
+                gsMatrix<T> coords(3, 2*nCol);
+                for (index_t iCol = 0;iCol!=nCol;iCol++)
                 {
-                    file << curvePoints(0,iCol) + translate(0) << " " << curvePoints(1,iCol) + translate(1) << " " << curvePoints(2,iCol) + translate(2) << " \n";
-                    // translate the vertex about along the vector (faceThick,0,0)
-                    file << curvePoints(0,iCol) + faceThick + translate(0) << " " << curvePoints(1,iCol) + faceThick + translate(1)
-                         << " " << curvePoints(2,iCol) +faceThick + translate(2) << " \n";
-                };
-                file << "\n";
-                file <<"</DataArray>\n";
+                    coords.col(2*iCol  ) = curvePoints.col(iCol).topRows(3) + translate;
+                    coords.col(2*iCol+1) = (coords.col(2*iCol).array() + faceThick).matrix();
+                }
+                vtk.dataArray<float>(coords, 3);
                 file <<"</Points>\n";
 
                 /// Scalar field attached to each degenerate face on the "edge"
                 file << "<CellData Scalars=\"cell_scalars\">\n";
-                file << "<DataArray type=\"Int32\" Name=\"cell_scalars\" format=\"ascii\">\n";
-                /// limit: for now, assign all scalars to 0
-                for (index_t iCol = 0;iCol!=curvePoints.cols()-1;iCol++)
-                {
-                    file << color << " ";
-                }
-                file << "\n";
-                file << "</DataArray>\n";
+                vtk.dataArray<int>(gsVector<int>::Constant(nCol-1, color), 1, "cell_scalars");
                 file << "</CellData>\n";
 
                 /// Which vertices belong to which faces
                 file << "<Polys>\n";
-                file << "<DataArray type=\"Int32\" Name=\"connectivity\" format=\"ascii\">\n";
-                for (index_t iCol = 0;iCol<=curvePoints.cols()-2;iCol++)
-                {
-                    //file << iCol << " " << iCol+1 << " "<< iCol+1 << " " << iCol << " ";
-                    file << 2*iCol << " " << 2*iCol+1 << " "<< 2*iCol+3 << " " << 2*iCol+2 << " ";
-                }
-                //file << curvePoints.cols()-1 << " " << 0 << " "<< 0 << " "<< curvePoints.cols()-1 << " ";
-                file << "\n";
-                file << "</DataArray>\n";
-                file << "<DataArray type=\"Int32\" Name=\"offsets\" format=\"ascii\">\n";
-                unsigned offsets(0);
-                for (index_t iCol = 0;iCol!=curvePoints.cols()-1;iCol++)
-                {
-                    offsets +=4;
-                    file << offsets << " ";
-                }
-                file << "\n";
-                file << "</DataArray>\n";
+                gsMatrix<int> conn(4, nCol-1);
+                for (index_t iCol = 0;iCol<=nCol-2;iCol++)
+                    conn.col(iCol) << 2*iCol, 2*iCol+1, 2*iCol+3, 2*iCol+2;
+                vtk.dataArray<int>(conn, 1, "connectivity");
+                vtk.dataArray<int>(4 * gsVector<int>::LinSpaced(nCol-1, 1, nCol-1), 1, "offsets");
                 file << "</Polys>\n";
 
                 file << "</Piece>\n";
@@ -1351,7 +1157,7 @@ void gsWriteParaview(gsSolid<T> const& sl, std::string const & fn, unsigned numP
 
     ///////////////////////////////
     file <<"</PolyData>\n";
-    file <<"</VTKFile>\n";
+    vtk.endFile();
     file.close();
 
     makeCollection(fn, ".vtp"); // make also a pvd file
@@ -1382,7 +1188,8 @@ void gsWriteParaviewSolid(gsSolid<T> const& sl,
 
 /// Visualizing a mesh
 template <class T>
-void gsWriteParaview(gsMesh<T> const& sl, std::string const & fn, bool pvd)
+void gsWriteParaview(gsMesh<T> const& sl, std::string const & fn, bool pvd,
+                     paraview::format fmt)
 {
     std::string mfn(fn);
     mfn.append(".vtp");
@@ -1392,8 +1199,8 @@ void gsWriteParaview(gsMesh<T> const& sl, std::string const & fn, bool pvd)
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
     
-    file <<"<?xml version=\"1.0\"?>\n";
-    file <<"<VTKFile type=\"PolyData\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
+    gsParaviewDataWriter vtk(file, fmt);
+    vtk.beginFile("PolyData");
     file <<"<PolyData>\n";
     
     /// Number of vertices and number of faces
@@ -1402,92 +1209,45 @@ void gsWriteParaview(gsMesh<T> const& sl, std::string const & fn, bool pvd)
     
     /// Coordinates of vertices
     file <<"<Points>\n";
-    file <<"<DataArray type=\"Float32\" NumberOfComponents=\"3\" format=\"ascii\">\n";
-    for (typename std::vector< gsVertex<T>* >::const_iterator it=sl.vertex.begin(); it!=sl.vertex.end(); ++it)
-    {
-        file << ((*it)->coords)[0] << " ";
-        file << ((*it)->coords)[1] << " ";
-        file << ((*it)->coords)[2] << " \n";
-    }
-    
-    file << "\n";
-    file <<"</DataArray>\n";
+    gsMatrix<T> coords(3, sl.vertex.size());
+    for (size_t i = 0; i!= sl.vertex.size(); ++i)
+        coords.col(i) = sl.vertex[i]->coords;
+    vtk.dataArray<float>(coords, 3);
     file <<"</Points>\n";
 
-    // Scalar field attached to each face
-    // file << "<PointData Scalars=\"point_scalars\">\n";
-    // file << "<DataArray type=\"Int32\" Name=\"point_scalars\" format=\"ascii\">\n";
-    // for (typename std::vector< gsVertex<T>* >::const_iterator it=sl.vertex.begin(); 
-    //      it!=sl.vertex.end(); ++it)
-    // {
-    //     file << 0 << " ";
-    // }
-    // file << "\n";
-    // file << "</DataArray>\n";
-    // file << "</PointData>\n";
-    
     // Write out edges
     file << "<Lines>\n";
-    file << "<DataArray type=\"Int32\" Name=\"connectivity\" format=\"ascii\">\n";
+    gsMatrix<int> econn(2, sl.edge.size());
+    index_t k = 0;
     for (typename std::vector< gsEdge<T> >::const_iterator it=sl.edge.begin();
-         it!=sl.edge.end(); ++it)
+         it!=sl.edge.end(); ++it, ++k)
     {
-            file << it->source->getId() << " " << it->target->getId() << "\n";
+        econn(0,k) = it->source->getId();
+        econn(1,k) = it->target->getId();
     }
-    file << "</DataArray>\n";
-    file << "<DataArray type=\"Int32\" Name=\"offsets\" format=\"ascii\">\n";
-    int count=0;
-    for (typename std::vector< gsEdge<T> >::const_iterator it=sl.edge.begin();
-         it!=sl.edge.end(); ++it)
-    {
-        count+=2;
-        file << count << " ";
-    }
-    file << "\n";
-    file << "</DataArray>\n";
+    vtk.dataArray<int>(econn, 1, "connectivity");
+    vtk.dataArray<int>(2 * gsVector<int>::LinSpaced(econn.cols(), 1, econn.cols()), 1, "offsets");
     file << "</Lines>\n";
     
-    // Scalar field attached to each face (* if edges exists, this has a problem)
-    // file << "<CellData Scalars=\"cell_scalars\">\n";
-    // file << "<DataArray type=\"Int32\" Name=\"cell_scalars\" format=\"ascii\">\n";
-    // for (typename std::vector< gsFace<T>* >::const_iterator it=sl.face.begin();
-    //      it!=sl.face.end(); ++it)
-    // {
-    //     file << 1 << " ";
-    // }
-    // file << "\n";
-    // file << "</DataArray>\n";
-    // file << "</CellData>\n";
-    
     /// Which vertices belong to which faces
     file << "<Polys>\n";
-    file << "<DataArray type=\"Int32\" Name=\"connectivity\" format=\"ascii\">\n";
+    std::vector<int> fconn, foffsets;
+    foffsets.reserve(sl.face.size());
     for (typename std::vector< gsFace<T>* >::const_iterator it=sl.face.begin();
          it!=sl.face.end(); ++it)
     {
         for (typename std::vector< gsVertex<T>* >::const_iterator vit= (*it)->vertices.begin();
              vit!=(*it)->vertices.end(); ++vit)
-        {
-            file << (*vit)->getId() << " ";
-        }
-        file << "\n";
+            fconn.push_back( (*vit)->getId() );
+        foffsets.push_back( fconn.size() );
     }
-    file << "</DataArray>\n";
-    file << "<DataArray type=\"Int32\" Name=\"offsets\" format=\"ascii\">\n";
-    count=0;
-    for (typename std::vector< gsFace<T>* >::const_iterator it=sl.face.begin();
-         it!=sl.face.end(); ++it)
-    {
-        count += (*it)->vertices.size();
-        file << count << " ";
-    }
-    file << "\n";
-    file << "</DataArray>\n";
+    vtk.dataArray<int>(gsAsConstVector<int>(fconn), 1, "connectivity");
+    vtk.dataArray<int>(gsAsConstVector<int>(foffsets), 1, "offsets");
     file << "</Polys>\n";
 
     file << "</Piece>\n";
     file <<"</PolyData>\n";
-    file <<"</VTKFile>\n";
+    vtk.endFile();
     file.close();
     
     if( pvd ) // make also a pvd file
@@ -1621,8 +1381,8 @@ void gsWriteParaviewTrimmedCurve(const gsTrimSurface<T>& surf,
     file << std::fixed; // no exponents
     file << std::setprecision (PLOT_PRECISION);
 
-    file << "<?xml version=\"1.0\"?>\n";
-    file << "<VTKFile type=\"StructuredGrid\" version=\"0.1\">\n";
+    gsParaviewDataWriter vtk(file);
+    vtk.beginFile("StructuredGrid");
     file << "<StructuredGrid WholeExtent=\"0 "<< np(0) - 1 <<
             " 0 " << np(1) - 1 << " 0 " << np(2) - 1 << "\">\n";
 
@@ -1630,23 +1390,11 @@ void gsWriteParaviewTrimmedCurve(const gsTrimSurface<T>& surf,
          << np(2) - 1 << "\">\n";
 
     file << "<Points>\n";
-    file << "<DataArray type=\"Float32\" NumberOfComponents=\"" << points.rows()
-         << "\">\n";
-
-    for (index_t j = 0; j < points.cols(); ++j)
-    {
-        for (index_t i = 0; i < points.rows(); ++i)
-        {
-            file << points(i, j) << " ";
-        }
-        file << "\n";
-    }
-
-    file << "</DataArray>\n";
+    vtk.dataArray<float>(points, points.rows());
     file << "</Points>\n";
     file << "</Piece>\n";
     file << "</StructuredGrid>\n";
-    file << "</VTKFile>\n";
+    vtk.endFile();
     file.close();
 
 }
@@ -24,8 +24,172 @@
 
 namespace gismo {
 
+namespace
+{
+// Encoding of the numeric arrays written to XML
+xml::encoding s_defaultEncoding = xml::ascii;
+
+const char s_base64Chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Maps a base64 character to its 6-bit value, or -1 for invalid characters
+struct base64Table
+{
+    signed char v[256];
+    base64Table()
+    {
+        std::fill(v, v + 256, -1);
+        for (int i = 0; i != 64; ++i)
+            v[static_cast<unsigned char>(s_base64Chars[i])] = static_cast<signed char>(i);
+    }
+};
+
+// ASCII whitespace, which may separate (eg. wrap) base64 data
+inline bool isXmlSpace(const char c)
+{ return ' ' == c || ('\t' <= c && c <= '\r'); }
+
+} // anonymous namespace
+
+namespace xml
+{
+
+void setDefaultEncoding(encoding e) { s_defaultEncoding = e; }
+
+encoding defaultEncoding() { return s_defaultEncoding; }
+
+} // namespace xml
+
 namespace internal {
 
+/* Helpers for base64-encoded arrays */
+
+std::string encodeBase64(const char * data, size_t n)
+{
+    const unsigned char * in = reinterpret_cast<const unsigned char*>(data);
+    std::string out( 4 * ((n + 2) / 3), '=' );
+    char * o = &out[0];
+    size_t i = 0;
+    for (; i + 2 < n; i += 3, o += 4)
+    {
+        const unsigned w = (in[i] << 16) | (in[i+1] << 8) | in[i+2];
+        o[0] = s_base64Chars[ w >> 18       ];
+        o[1] = s_base64Chars[(w >> 12) & 63 ];
+        o[2] = s_base64Chars[(w >>  6) & 63 ];
+        o[3] = s_base64Chars[ w        & 63 ];
+    }
+    if ( i < n ) // last one or two bytes, padded with '='
+    {
+        const unsigned w = (in[i] << 16) | (i + 1 < n ? in[i+1] << 8 : 0);
+        o[0] = s_base64Chars[ w >> 18       ];
+        o[1] = s_base64Chars[(w >> 12) & 63 ];
+        if ( i + 1 < n )
+            o[2] = s_base64Chars[(w >> 6) & 63 ];
+    }
+    return out;
+}
+
+size_t base64Length(const char * text, size_t len)
+{
+    size_t n = 0;
+    for (size_t i = 0; i != len; ++i)
+        if ( !isXmlSpace(text[i]) )
+            ++n;
+    return n;
+}
+
+const char * base64Skip(const char * text, size_t len, size_t n)
+{
+    const char * end = text + len;
+    for (; text != end && (n > 0 || isXmlSpace(*text)); ++text)
+        if ( !isXmlSpace(*text) )
+            --n;
+    GISMO_ENSURE( 0 == n, "Invalid base64 data.");
+    return text;
+}
+
+size_t base64DecodedSize(const char * text, size_t len)
+{
+    size_t n = 0, pad = 0;
+    for (size_t i = 0; i != len; ++i)
+    {
+        if ( isXmlSpace(text[i]) )
+            continue;
+        if ( '=' == text[i] )
+            ++pad;
+        else
+        {
+            GISMO_ENSURE( 0 == pad, "Invalid base64 data.");
+            ++n;
+        }
+    }
+    GISMO_ENSURE( 0 == (n + pad) % 4 && pad < 3, "Invalid base64 data.");
+    return (n * 3) / 4;
+}
+
+void decodeBase64(const char * text, size_t len, char * out)
+{
+    static const base64Table table;
+    const unsigned char * in = reinterpret_cast<const unsigned char*>(text);
+    unsigned w = 0;
+    int bits = 0;
+    for (size_t i = 0; i != len; ++i)
+    {
+        if ( isXmlSpace(text[i]) )
+            continue;
+        if ( '=' == text[i] ) // padding
+            break;
+        const int c = table.v[in[i]];
+        GISMO_ENSURE( c >= 0, "Invalid character in base64 data.");
+        w = (w << 6) | c;
+        bits += 6;
+        if ( bits >= 8 )
+        {
+            bits -= 8;
+            *out++ = static_cast<char>( (w >> bits) & 255 );
+        }
+    }
+}
+
+size_t xmlScalarBytes(const std::string & scalar)
+{
+    if ( scalar == "float32" || scalar == "int32" )
+        return 4;
+    if ( scalar == "float64" || scalar == "int64" )
+        return 8;
+    if ( scalar == "float80" )
+        return 10;
+    if ( scalar == "float128" )
+        return 16;
+    return 0;
+}
+
+bool isBase64(const gsXmlNode * node)
+{
+    const gsXmlAttribute * at = node->first_attribute("format");
+    return at && !strcmp(at->value(), "base64");
+}
+
+const gsXmlNode * base64Value(const gsXmlNode * node)
+{
+    const gsXmlAttribute * at = node->first_attribute("version");
+    GISMO_ENSURE( at && !strcmp(at->value(), "1"), "Unknown version of the base64 data in tag "
+                  << node->name() <<": "<< (at ? at->value() : "none") );
+    const gsXmlNode * child = node->first_node("base64");
+    GISMO_ENSURE( child, "No base64 data found in tag "<< node->name() );
+    return child;
+}
+
+gsXmlNode * makeBase64Node(const std::string & name, const std::string & text,
+                           gsXmlTree & data)
+{
+    // The text is kept out of the value of the node, readers which
+    // ignore the format attribute see an empty array
+    gsXmlNode * node = makeNode(name, data);
+    node->append_attribute( makeAttribute("format", "base64", data) );
+    node->append_attribute( makeAttribute("version", "1", data) );
+    node->append_node( makeNode("base64", text, data) );
+    return node;
+}
 
 /* Helpers to allocate XML data  */
     
@@ -16,6 +16,9 @@
 #include <gsCore/gsForwardDeclarations.h>
 #include <gsCore/gsExport.h>
 
+#include <cstring>
+#include <algorithm>
+
 // Default memory sizes
 // #define RAPIDXML_STATIC_POOL_SIZE  ( 64*1024 )
 // #define RAPIDXML_DYNAMIC_POOL_SIZE ( 64*1024 )
@@ -175,8 +178,99 @@ typename util::enable_if<!std::numeric_limits<T>::is_integer, bool>::type
 gsGetValue(std::istream & is, T & var)
 { return gsGetReal<T>(is,var); }
 
+namespace xml
+{
+
+/// \brief Encoding of the numeric arrays (coefficients, weights,
+/// knot vectors, matrices) in the XML files written by gsFileData
+///
+/// \ingroup IO
+enum encoding
+{
+    ascii  = 0, ///< Decimal numbers separated by spaces
+    base64 = 1  ///< Binary values encoded in base64, see below
+};
+
+/// \brief Sets the encoding of the numeric arrays in the XML files
+/// written after this call (default: xml::ascii)
+///
+/// In xml::base64 encoding the values of the built-in floating point
+/// types are stored bit-exactly in little endian byte order, on big
+/// endian hosts the bytes are swapped when writing and reading. Other
+/// number types (eg. mpfr::mpreal, mpq_class) are written as text
+/// with as many digits as needed for an exact round trip.
+///
+/// An encoded array is marked by the attributes format="base64" and
+/// version="1", its text is the value of a child element
+/// \<base64\>. Readers which do not know the encoding find no
+/// numbers in the element itself and fail as for an empty array,
+/// instead of parsing the base64 text as numbers.
+///
+/// \ingroup IO
+GISMO_EXPORT void setDefaultEncoding(encoding e);
+
+/// \brief Returns the encoding of the numeric arrays in the XML files
+///
+/// \ingroup IO
+GISMO_EXPORT encoding defaultEncoding();
+
+} // namespace xml
+
 namespace internal {
 
+/// Binary representation of a scalar type in base64-encoded XML
+/// arrays. The name is written in the attribute "scalar", \a bytes is
+/// the number of significant bytes of a value. Types without a
+/// binary representation have a null name.
+template<class T>
+struct gsXmlScalar
+{
+    static const char * name() { return NULL; }
+    enum { bytes = 0 };
+};
+
+template<> struct gsXmlScalar<float>
+{
+    static const char * name() { return "float32"; }
+    enum { bytes = 4 };
+};
+
+template<> struct gsXmlScalar<double>
+{
+    static const char * name() { return "float64"; }
+    enum { bytes = 8 };
+};
+
+// The x87 extended precision format is stored in its 10 significant bytes
+template<> struct gsXmlScalar<long double>
+{
+    static const char * name()
+    {
+        return 53 == std::numeric_limits<long double>::digits ? "float64" :
+            ( 64 == std::numeric_limits<long double>::digits ? "float80" : "float128" );
+    }
+    enum { bytes = 53 == std::numeric_limits<long double>::digits ? 8 :
+           ( 64 == std::numeric_limits<long double>::digits ? 10 : 16 ) };
+};
+
+template<> struct gsXmlScalar<int>
+{
+    static const char * name() { return 4 == sizeof(int) ? "int32" : "int64"; }
+    enum { bytes = sizeof(int) };
+};
+
+template<> struct gsXmlScalar<long>
+{
+    static const char * name() { return 4 == sizeof(long) ? "int32" : "int64"; }
+    enum { bytes = sizeof(long) };
+};
+
+template<> struct gsXmlScalar<long long>
+{
+    static const char * name() { return "int64"; }
+    enum { bytes = sizeof(long long) };
+};
+
 typedef rapidxml::xml_node<char>        gsXmlNode;
 typedef rapidxml::xml_attribute<char>   gsXmlAttribute;
 typedef rapidxml::xml_document<char>    gsXmlTree;
@@ -316,6 +410,58 @@ GISMO_EXPORT void appendBoxTopology(const gsBoxTopology& topology,
                                     gsXmlNode* node,
                                     gsXmlTree& data);
 
+/// Returns the base64 encoding of the \a n bytes at \a data
+GISMO_EXPORT std::string encodeBase64(const char * data, size_t n);
+
+/// Returns the number of bytes encoded in the base64 text \a text
+/// of length \a len. ASCII whitespace in the text is ignored.
+GISMO_EXPORT size_t base64DecodedSize(const char * text, size_t len);
+
+/// Decodes the base64 text \a text of length \a len to \a out,
+/// which must hold base64DecodedSize(text,len) bytes. ASCII
+/// whitespace (eg. line breaks) in the text is skipped.
+GISMO_EXPORT void decodeBase64(const char * text, size_t len, char * out);
+
+/// Returns the number of characters of the base64 text \a text of
+/// length \a len, without whitespace
+GISMO_EXPORT size_t base64Length(const char * text, size_t len);
+
+/// Returns the position in \a text after its first \a n base64
+/// characters and the whitespace which follows them
+GISMO_EXPORT const char * base64Skip(const char * text, size_t len, size_t n);
+
+/// Returns the number of bytes of a value of the scalar type named
+/// \a scalar (see gsXmlScalar), or zero for an unknown type
+GISMO_EXPORT size_t xmlScalarBytes(const std::string & scalar);
+
+/// Returns true if the value of \a node is base64-encoded
+GISMO_EXPORT bool isBase64(const gsXmlNode * node);
+
+/// Returns the element holding the base64 text of the encoded node
+/// \a node; throws if the version of the encoding is unknown
+GISMO_EXPORT const gsXmlNode * base64Value(const gsXmlNode * node);
+
+/// Allocates a node \a name marked as base64-encoded, with a child
+/// element holding the base64 text \a text
+GISMO_EXPORT gsXmlNode * makeBase64Node(const std::string & name,
+                                        const std::string & text,
+                                        gsXmlTree & data);
+
+/// Returns true if the host stores numbers in little endian byte order
+inline bool littleEndianHost()
+{
+    const unsigned one = 1;
+    return 1 == *reinterpret_cast<const unsigned char*>(&one);
+}
+
+/// Reverses the byte order of the \a n values of \a b bytes each at
+/// \a buf
+inline void swapXmlBytes(char * buf, size_t n, size_t b)
+{
+    for (char * v = buf; v != buf + n * b; v += b)
+        std::reverse(v, v + b);
+}
+
 /// Helper to allocate XML node with gsMatrix value
 template<class T>
 gsXmlNode * makeNode( const std::string & name, 
@@ -349,6 +495,137 @@ template<class T>
 gsXmlNode * putSparseMatrixToXml ( gsSparseMatrix<T> const & mat, 
                                    gsXmlTree & data, std::string name = "SparseMatrix");
 
+/// Number of significant digits for writing values of type T as
+/// text which are read back exactly
+template<class T>
+inline int exactDigits() { return std::numeric_limits<T>::digits10 + 3; }
+
+#ifdef GISMO_WITH_MPFR
+template<>
+inline int exactDigits<mpfr::mpreal>()
+{ return std::numeric_limits<mpfr::mpreal>::digits10() + 3; }
+#endif
+
+/// Returns true if arrays of values of type T are written in base64
+template<class T>
+inline bool useBase64()
+{ return xml::base64 == xml::defaultEncoding() && NULL != gsXmlScalar<T>::name(); }
+
+/// Returns the precision for writing values of type T as text
+template<class T>
+inline int textPrecision()
+{ return xml::base64 == xml::defaultEncoding() ? exactDigits<T>() : FILE_PRECISION; }
+
+/// Returns the base64 encoding of the \a n values at \a v
+template<class T>
+std::string encodeXmlValues(const T * v, size_t n)
+{
+    const size_t b = gsXmlScalar<T>::bytes;
+    const bool   le = littleEndianHost();
+    if ( sizeof(T) == b && le )
+        return encodeBase64(reinterpret_cast<const char*>(v), n * b);
+
+    // Keep the significant bytes only, the padding is at the most
+    // significant end
+    const size_t off = le ? 0 : sizeof(T) - b;
+    std::vector<char> buf(n * b);
+    for (size_t i = 0; i != n; ++i)
+        memcpy(&buf[i * b], reinterpret_cast<const char*>(v + i) + off, b);
+    if ( !le )
+        swapXmlBytes(buf.data(), n, b);
+    return encodeBase64(buf.data(), buf.size());
+}
+
+/// Allocates a node \a name with value the base64 encoding of the \a n
+/// values at \a v
+template<class T>
+gsXmlNode * makeBase64Node(const std::string & name, const T * v, size_t n,
+                           gsXmlTree & data)
+{
+    gsXmlNode * node = makeBase64Node(name, encodeXmlValues(v, n), data);
+    node->append_attribute( makeAttribute("scalar", gsXmlScalar<T>::name(), data) );
+    return node;
+}
+
+/// Converts \a n values of type S stored at \a buf to \a out
+template<class S, class T>
+void castXmlValues(const char * buf, T * out, size_t n)
+{
+    S tmp;
+    for (size_t i = 0; i != n; ++i)
+    {
+        memcpy(&tmp, buf + i * sizeof(S), sizeof(S));
+        out[i] = static_cast<T>(tmp);
+    }
+}
+
+/// Returns the number of values in the base64 text \a text of
+/// length \a len with values of scalar type \a scalar
+inline size_t countXmlValues(const char * text, size_t len, const std::string & scalar)
+{
+    const size_t b = xmlScalarBytes(scalar);
+    GISMO_ENSURE( 0 != b, "Unknown scalar type \""<< scalar <<"\" in XML data.");
+    return base64DecodedSize(text, len) / b;
+}
+
+/**
+   \brief Decodes the base64 text \a text of length \a len, holding
+   \a n values of type \a scalar, to \a out
+
+   Values of the same type as T are copied bytewise, float32 and
+   float64 values are converted to T, integer values via long long.
+   The values are stored in little endian byte order, see
+   xml::setDefaultEncoding().
+*/
+template<class T>
+void decodeXmlValues(const char * text, size_t len, const std::string & scalar,
+                     T * out, size_t n)
+{
+    const size_t b = xmlScalarBytes(scalar);
+    GISMO_ENSURE( 0 != b, "Unknown scalar type \""<< scalar <<"\" in XML data.");
+    GISMO_ENSURE( base64DecodedSize(text, len) == n * b,
+                  "Size of the base64 data does not match, expected "<< n <<" values.");
+
+    const char * own = gsXmlScalar<T>::name();
+    const bool   le  = littleEndianHost();
+    if ( own && scalar == own && sizeof(T) == b && le )
+    {
+        decodeBase64(text, len, reinterpret_cast<char*>(out));
+        return;
+    }
+
+    std::vector<char> buf(n * b);
+    decodeBase64(text, len, buf.data());
+    if ( !le )
+        swapXmlBytes(buf.data(), n, b);
+
+    if ( own && scalar == own ) // possibly stored with its significant bytes only
+    {
+        const size_t off = le ? 0 : sizeof(T) - b;
+        for (size_t i = 0; i != n; ++i)
+        {
+            memset(out + i, 0, sizeof(T));
+            memcpy(reinterpret_cast<char*>(out + i) + off, &buf[i * b], b);
+        }
+    }
+    else if ( scalar == "float64" )
+        castXmlValues<double>(buf.data(), out, n);
+    else if ( scalar == "float32" )
+        castXmlValues<float>(buf.data(), out, n);
+    else if ( scalar == "int32" || scalar == "int64" )
+    {
+        std::vector<long long> tmp(n);
+        if ( 4 == b )
+            castXmlValues<int>(buf.data(), tmp.data(), n);
+        else
+            castXmlValues<long long>(buf.data(), tmp.data(), n);
+        for (size_t i = 0; i != n; ++i)
+            out[i] = static_cast<T>(tmp[i]);
+    }
+    else
+        GISMO_ERROR("Cannot read values of type \""<< scalar <<"\".");
+}
+
 }// end namespace internal
 
 }// end namespace gismo
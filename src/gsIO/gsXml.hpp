@@ -85,9 +85,20 @@ void getMatrixFromXml ( gsXmlNode * node, unsigned const & rows,
                         unsigned const & cols, gsMatrix<T> & result ) 
 {
     //gsWarn<<"Reading "<< node->name() <<" matrix of size "<<rows<<"x"<<cols<<"Geometry..\n";
+    result.resize(rows,cols);
+
+    if ( isBase64(node) ) // values in column-major order
+    {
+        const gsXmlAttribute * at = node->first_attribute("scalar");
+        GISMO_ENSURE( at, "Scalar type of base64 data not found in tag "<< node->name() );
+        const gsXmlNode * val = base64Value(node);
+        decodeXmlValues(val->value(), val->value_size(), at->value(),
+                        result.data(), result.size());
+        return;
+    }
+
     std::istringstream str;
     str.str( node->value() );
-    result.resize(rows,cols);
  
     for (unsigned i=0; i<rows; ++i)
         for (unsigned j=0; j<cols; ++j)
@@ -106,6 +117,43 @@ void getSparseEntriesFromXml ( gsXmlNode * node,
 {
     result.clear();
 
+    if ( isBase64(node) ) // row indices, column indices and values
+    {
+        const gsXmlAttribute * at = node->first_attribute("scalar");
+        const gsXmlAttribute * ai = node->first_attribute("index");
+        GISMO_ENSURE( at && ai, "Types of base64 data not found in tag "<< node->name() );
+        const size_t bi = xmlScalarBytes(ai->value()), bs = xmlScalarBytes(at->value());
+        GISMO_ENSURE( bi && bs, "Unknown scalar type in tag "<< node->name() );
+
+        // The arrays are found by their lengths rather than by a
+        // separator, since the data may contain whitespace anywhere.
+        // A base64 text of b bytes has 4*ceil(b/3) characters.
+        const gsXmlNode * val = base64Value(node);
+        const size_t len = val->value_size();
+        const size_t numChars = base64Length(val->value(), len);
+        size_t nz = 3 * numChars / (4 * (2 * bi + bs)); // upper bound
+        while ( nz > 0 && 8 * ((nz*bi + 2) / 3) + 4 * ((nz*bs + 2) / 3) > numChars )
+            --nz;
+        const size_t ci = 4 * ((nz*bi + 2) / 3);
+        GISMO_ENSURE( 2 * ci + 4 * ((nz*bs + 2) / 3) == numChars,
+                      "Invalid sparse matrix data in tag "<< node->name() );
+
+        const char * seg[4];
+        seg[0] = val->value();
+        seg[3] = seg[0] + len;
+        seg[1] = base64Skip(seg[0], seg[3] - seg[0], ci);
+        seg[2] = base64Skip(seg[1], seg[3] - seg[1], ci);
+        std::vector<index_t> rows(nz), cols(nz);
+        std::vector<T> vals(nz);
+        decodeXmlValues(seg[0], seg[1] - seg[0], ai->value(), rows.data(), nz);
+        decodeXmlValues(seg[1], seg[2] - seg[1], ai->value(), cols.data(), nz);
+        decodeXmlValues(seg[2], seg[3] - seg[2], at->value(), vals.data(), nz);
+        result.reserve(nz);
+        for (size_t k = 0; k != nz; ++k)
+            result.add(rows[k], cols[k], vals[k]);
+        return;
+    }
+
     std::istringstream str;
     str.str( node->value() );
     index_t r,c;
@@ -119,8 +167,11 @@ void getSparseEntriesFromXml ( gsXmlNode * node,
 template<class T>
 gsXmlNode * putMatrixToXml ( gsMatrix<T> const & mat, gsXmlTree & data, std::string name) 
 {
+    if ( useBase64<T>() ) // values in column-major order
+        return makeBase64Node(name, mat.data(), mat.size(), data);
+
     std::ostringstream str;
-    str << std::setprecision(FILE_PRECISION);
+    str << std::setprecision(textPrecision<T>());
     // Write the matrix entries
     for (index_t i=0; i< mat.rows(); ++i)
     {
@@ -139,10 +190,34 @@ gsXmlNode * putSparseMatrixToXml ( gsSparseMatrix<T> const & mat,
                                    gsXmlTree & data, std::string name)
 {
     typedef typename gsSparseMatrix<T>::InnerIterator cIter;
+    const index_t nCol = mat.cols();
+
+    if ( useBase64<T>() )
+    {
+        // Row indices, column indices and values, separated by a space
+        std::vector<index_t> rows, cols;
+        std::vector<T> vals;
+        rows.reserve(mat.nonZeros());
+        cols.reserve(mat.nonZeros());
+        vals.reserve(mat.nonZeros());
+        for (index_t j=0; j != nCol; ++j)
+            for ( cIter it(mat,j); it; ++it )
+            {
+                rows.push_back(it.index());
+                cols.push_back(j);
+                vals.push_back(it.value());
+            }
+        const std::string str = encodeXmlValues(rows.data(), rows.size()) + " "
+            + encodeXmlValues(cols.data(), cols.size()) + " "
+            + encodeXmlValues(vals.data(), vals.size());
+        gsXmlNode* new_node = makeBase64Node(name, str, data);
+        new_node->append_attribute( makeAttribute("scalar", gsXmlScalar<T>::name(), data) );
+        new_node->append_attribute( makeAttribute("index", gsXmlScalar<index_t>::name(), data) );
+        return new_node;
+    }
 
     std::ostringstream str;
-    str << std::setprecision(FILE_PRECISION);
-    const index_t nCol = mat.cols();
+    str << std::setprecision(textPrecision<T>());
 
     for (index_t j=0; j != nCol; ++j) // for all columns
         for ( cIter it(mat,j); it; ++it ) // for all non-zeros in column
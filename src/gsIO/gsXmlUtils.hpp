@@ -74,10 +74,9 @@ public:
 
         int n  = atoi ( node->first_attribute("vertices")->value() ) ;
         int nVol  = atoi ( node->first_attribute("volumes")->value() ) ;
-        T x,y, z;
         gsXmlNode * tmp = node->first_node("Vertex");
-        std::istringstream str;
-        str.str( tmp->value() );
+        gsMatrix<T> coords;
+        getMatrixFromXml<T>(tmp, n, 3, coords);
 
         int nf;
         int vertID;
@@ -89,10 +88,7 @@ public:
         for (int i=0; i<n; ++i)
         {
             ntest++;
-            gsGetReal(str, x);
-            gsGetReal(str, y);
-            gsGetReal(str, z);
-            m->addHeVertex(x,y,z);
+            m->addHeVertex(coords(i,0), coords(i,1), coords(i,2));
         }
         GISMO_ASSERT( ntest==n, 
                       "Number of vertices does not match the Solid tag." );
@@ -49,10 +49,18 @@ public:
 
 public:
 
-    /// Computes the least squares fit for a gsBasis
+    /// \brief Computes the least squares fit for a gsBasis
+    ///
+    /// If \a lambda is zero, the basis is a tensor-product basis
+    /// (eg. gsTensorBSplineBasis) and the parameters form a tensor
+    /// grid (first coordinate running fastest, as produced by
+    /// gsPointGrid), the normal equations are the Kronecker product
+    /// of univariate ones. They are then solved by a gsKroneckerOp,
+    /// without assembling the full system.
     void compute(T lambda = 0);
 
-    /// Computes the euclidean error for each point
+    /// Computes the euclidean error for each point. The result is
+    /// evaluated at the points in parallel.
     void computeErrors();
 
     /// Computes the maximum norm error for each point
@@ -92,9 +100,32 @@ public:
     /// with parameter lambda.
     void applySmoothing(T lambda, gsSparseMatrix<T> & A_mat);
     
-    /// Assembles system for the least square fit.
+    /// \brief Assembles system for the least square fit.
+    ///
+    /// The points are visited in the order of sortPoints(), in
+    /// batches of whole elements which are distributed over the
+    /// OpenMP threads. In every batch the basis is evaluated at once
+    /// and the points of every element contribute a dense block
+    /// product. The contributions of the batches are summed up in a
+    /// fixed order, so the result does not depend on the number of
+    /// threads.
     void assembleSystem(gsSparseMatrix<T>& A_mat, gsMatrix<T>& B);
 
+    /// \brief Sorts the points by the element of the basis which
+    /// contains their parameters.
+    ///
+    /// The points of every element are ordered along a Z-order
+    /// (Morton) curve of their parameters. The sorting is computed
+    /// once, on the first assembly. Call this function if the
+    /// parameter values have been modified.
+    void sortPoints();
+
+    /// \brief Sorts the points again by the elements of the
+    /// current basis, eg. after a refinement of the basis.
+    ///
+    /// The points of a refined element keep their order, so the
+    /// Z-order of sortPoints() is reused.
+    void binPoints();
 
 public:
 
@@ -104,7 +135,7 @@ public:
     /// Returns the basis of the approximation
     const gsBasis<T> & getBasis() const {return *m_basis;}
 
-    void setBasis(gsBasis<T> & basis) {m_basis=&basis;}
+    void setBasis(gsBasis<T> & basis) {m_basis=&basis; m_batches.clear();}
 
     /// returns the parameter values
     gsMatrix<T> & getreturnParamValues() {return m_param_values;}
@@ -136,9 +167,62 @@ protected:
     /// Minimum point-wise error
     T m_min_error;
 
+    /// The points (row indices of m_points) sorted by sortPoints()
+    std::vector<index_t> m_order;
+
+    /// The batches of points of assembleSystem(): the points
+    /// m_order[m_batches[b]],..,m_order[m_batches[b+1]-1] form batch
+    /// \em b. Empty if the points are not binned for the basis.
+    std::vector<index_t> m_batches;
+
+protected:
+
+    /// Solves the normal equations and sets the result
+    void solveSystem(gsSparseMatrix<T> & A_mat, const gsMatrix<T> & B);
+
+    /// Computes in \a order the Z-order of the parameters \a params
+    /// (one per column), see sortPoints()
+    static void mortonOrder(const gsMatrix<T> & params, std::vector<index_t> & order);
+
+    /// Sorts \a order (stable) by the element of \a basis containing
+    /// the parameters \a params and computes the offsets \a batches
+    /// of the batches of assembleOrdered(). A batch consists of whole
+    /// elements, unless an element contains too many points. If \a
+    /// basis does not implement gsBasis::elementIndex(), \a order is
+    /// kept.
+    static void binOrdered(const gsBasis<T> & basis, const gsMatrix<T> & params,
+                           std::vector<index_t> & order,
+                           std::vector<index_t> & batches);
+
+    /// Appends to \a A_entries and adds to \a B the normal
+    /// equations of the parameters \a params (columns) and the points
+    /// \a points (rows), visited in the given \a order and \a
+    /// batches (see binOrdered() and assembleSystem())
+    static void assembleOrdered(const gsBasis<T> & basis,
+                                const gsMatrix<T> & params,
+                                const gsMatrix<T> & points,
+                                const std::vector<index_t> & order,
+                                const std::vector<index_t> & batches,
+                                gsSparseEntries<T> & A_entries, gsMatrix<T> & B);
+
+    /// Evaluates \a geo at the parameters \a params in parallel,
+    /// visiting them in the given \a order (or consecutively if \a
+    /// order is empty)
+    static void evalOrdered(const gsGeometry<T> & geo, const gsMatrix<T> & params,
+                            const std::vector<index_t> & order, gsMatrix<T> & values);
+
 private:
     //void applySmoothing(T lambda, gsMatrix<T> & A_mat);
 
+    /// Computes the fit by Kronecker solvers if the basis is a
+    /// d-variate tensor-product basis and the parameters form a
+    /// tensor grid, returns false otherwise
+    template<unsigned d>
+    bool computeTensor();
+
+    /// Evaluates the result at all parameter values in parallel
+    void evalResult(gsMatrix<T> & values) const;
+
 }; // class gsFitting
 
 
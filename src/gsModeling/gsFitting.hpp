@@ -16,6 +16,10 @@
 #include <gsCore/gsGeometry.h>
 #include <gsCore/gsLinearAlgebra.h>
 #include <gsTensor/gsTensorDomainIterator.h>
+#include <gsTensor/gsTensorBasis.h>
+#include <gsSolver/gsKroneckerOp.h>
+#include <gsSolver/gsMatrixOp.h>
+#include <gsMpi/gsOpenMP.h>
 
 
 namespace gismo
@@ -46,6 +50,12 @@ void gsFitting<T>::compute(T lambda)
     // Wipe out previous result
     if ( m_result )
         delete m_result;
+    m_result = NULL;
+
+    // Tensor-structured data: the system is a Kronecker product
+    if ( 0 == lambda && ( computeTensor<2>() || computeTensor<3>() ||
+                          computeTensor<4>() ) )
+        return;
 
     const int num_basis=m_basis->size();
     const int dimension=m_points.cols();
@@ -78,6 +88,12 @@ void gsFitting<T>::compute(T lambda)
     if(lambda > 0)
       applySmoothing(lambda, A_mat);
 
+    solveSystem(A_mat, m_B);
+}
+
+template<class T>
+void gsFitting<T>::solveSystem(gsSparseMatrix<T> & A_mat, const gsMatrix<T> & m_B)
+{
     //Solving the system of linear equations A*x=b (works directly for a right side which has a dimension with higher than 1)
 
     //gsDebugVar( A_mat.nonZerosPerCol().maxCoeff() );
@@ -103,37 +119,287 @@ void gsFitting<T>::compute(T lambda)
 }
 
 
+template<class T>
+template<unsigned d>
+bool gsFitting<T>::computeTensor()
+{
+    const gsTensorBasis<d,T> * tb = dynamic_cast<const gsTensorBasis<d,T> *>(m_basis);
+    if ( NULL == tb || d != m_param_values.rows() )
+        return false;
+
+    // Detect a tensor grid of parameters, the first coordinate
+    // running fastest
+    const index_t N = m_param_values.cols();
+    std::vector<gsMatrix<T> > grid(d);
+    gsVector<index_t> stride(d+1);
+    stride[0] = 1;
+    for (unsigned k = 0; k != d; ++k)
+    {
+        // First point where a coordinate after k changes
+        index_t next = N;
+        for (index_t i = 1; i < N && N == next; ++i)
+            for (unsigned j = k + 1; j < d; ++j)
+                if ( m_param_values(j,i) != m_param_values(j,0) )
+                {
+                    next = i;
+                    break;
+                }
+        if ( 0 != next % stride[k] )
+            return false;
+        stride[k+1] = next;
+
+        const index_t n = next / stride[k];
+        grid[k].resize(1, n);
+        for (index_t i = 0; i != n; ++i)
+            grid[k](0,i) = m_param_values(k, i * stride[k]);
+    }
+    if ( N != stride[d] )
+        return false;
+    for (index_t i = 0; i != N; ++i)
+        for (unsigned k = 0; k != d; ++k)
+            if ( m_param_values(k,i) != grid[k]( 0, (i / stride[k]) % grid[k].cols() ) )
+                return false;
+
+    // Univariate collocation matrices B_k and normal equations B_k^T B_k
+    typedef typename gsLinearOperator<T>::Ptr OpPtr;
+    typedef typename gsSparseSolver<T>::LU    Solver;
+    std::vector<OpPtr> trans(d), solvers(d);
+    gsSparseMatrix<T> B;
+    for (unsigned k = 0; k != d; ++k)
+    {
+        tb->component(k).collocationMatrix(grid[k], B);
+        memory::shared_ptr<gsSparseMatrix<T> > Bt =
+            memory::make_shared( new gsSparseMatrix<T>( B.transpose() ) );
+        trans[k] = makeMatrixOp(Bt);
+
+        gsSparseMatrix<T> A = (*Bt) * B;
+        A.makeCompressed();
+        typename gsSolverOp<Solver>::Ptr lu = makeSparseLUSolver(A);
+        if ( lu->solver().info() != Eigen::Success )
+            return false;
+        solvers[k] = lu;
+    }
+
+    gsMatrix<T> rhs, x;
+    gsKroneckerOp<T>::apply(trans, m_points, rhs);
+    gsKroneckerOp<T>::apply(solvers, rhs, x);
+    m_result = m_basis->makeGeometry( give(x) );
+    return true;
+}
+
+template <class T>
+void gsFitting<T>::sortPoints()
+{
+    mortonOrder(m_param_values, m_order);
+    binOrdered(*m_basis, m_param_values, m_order, m_batches);
+}
+
+template <class T>
+void gsFitting<T>::binPoints()
+{
+    if ( static_cast<index_t>(m_order.size()) != m_param_values.cols() )
+        sortPoints();
+    else
+        binOrdered(*m_basis, m_param_values, m_order, m_batches);
+}
+
+template <class T>
+void gsFitting<T>::mortonOrder(const gsMatrix<T> & params,
+                               std::vector<index_t> & order)
+{
+    const index_t N  = params.cols();
+    const index_t pd = params.rows();
+    order.resize(N);
+    if ( 0 == N )
+        return;
+
+    // Bits per coordinate, the keys have 64 bits
+    const index_t bits = math::min(static_cast<index_t>(21), 64 / pd);
+    const T scale = static_cast<T>( (1ULL << bits) - 1 );
+    const gsVector<T> lower  = params.rowwise().minCoeff();
+    const gsVector<T> extent = params.rowwise().maxCoeff() - lower;
+
+    std::vector<std::pair<unsigned long long, index_t> > keys(N);
+#   pragma omp parallel for schedule(static)
+    for (index_t i = 0; i < N; ++i)
+    {
+        // Interleave the bits of the quantized coordinates
+        unsigned long long key = 0;
+        for (index_t k = 0; k != pd; ++k)
+        {
+            const unsigned long long q = ( extent[k] > 0 ?
+                static_cast<unsigned long long>( scale * (params(k,i) - lower[k]) / extent[k] ) : 0 );
+            for (index_t b = 0; b != bits; ++b)
+                key |= ( (q >> b) & 1ULL ) << (b * pd + k);
+        }
+        keys[i] = std::make_pair(key, i);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    for (index_t i = 0; i != N; ++i)
+        order[i] = keys[i].second;
+}
+
+template <class T>
+void gsFitting<T>::binOrdered(const gsBasis<T> & basis,
+                              const gsMatrix<T> & params,
+                              std::vector<index_t> & order,
+                              std::vector<index_t> & batches)
+{
+    const index_t N = order.size();
+
+    // gsBasis::elementIndex throws for bases which do not implement
+    // it. The first point is located outside of the parallel region,
+    // and for such bases the points keep their order and are only
+    // split into batches.
+    bool located = ( N > 0 );
+    if ( located )
+    {
+        try { basis.elementIndex(params.col(order[0])); }
+        catch (std::exception &) { located = false; }
+    }
+
+    // Pairs (element, position in order), sorting them keeps the
+    // order within every element
+    std::vector<std::pair<int, index_t> > keys(N);
+    internal::gsParallelError error;
+#   pragma omp parallel if ( located )
+    {
+        gsVector<T> u;
+#       pragma omp for schedule(static)
+        for (index_t i = 0; i < N; ++i)
+        {
+            try
+            {
+                u = params.col(order[i]);
+                keys[i] = std::make_pair(located ? basis.elementIndex(u) : 0, i);
+            }
+            catch (...) { error.store(); }
+        }
+    }
+    error.rethrow();
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<index_t> sorted(N);
+    for (index_t i = 0; i != N; ++i)
+        sorted[i] = order[keys[i].second];
+    order.swap(sorted);
+
+    // Batches of whole elements with at most maxBatch points, larger
+    // elements are split
+    const index_t maxBatch = 1024;
+    batches.assign(1, 0);
+    for (index_t i = 0, j; i < N; i = j)
+    {
+        for (j = i + 1; j < N && keys[j].first == keys[i].first; ++j) ;
+
+        if ( i != batches.back() && j - batches.back() > maxBatch )
+            batches.push_back(i);
+        while ( j - batches.back() > maxBatch )
+            batches.push_back(batches.back() + maxBatch);
+    }
+    if ( N != batches.back() )
+        batches.push_back(N);
+}
+
 template <class T>
 void gsFitting<T>::assembleSystem(gsSparseMatrix<T>& A_mat,
 				  gsMatrix<T>& m_B)
 {
-    const int num_points = m_points.rows();    
+    if ( m_batches.empty() )
+        binPoints();
 
-    //for computing the value of the basis function
-    gsMatrix<T> value;
-    gsMatrix<unsigned> actives;
+    gsSparseEntries<T> entries;
+    assembleOrdered(*m_basis, m_param_values, m_points, m_order, m_batches, entries, m_B);
 
+    gsSparseMatrix<T> S(A_mat.rows(), A_mat.cols());
+    S.setFrom(entries);
+    A_mat += S;
+}
 
-    for(index_t k = 0; k < num_points; k++)
-    {
-        const gsMatrix<T>& curr_point = m_param_values.col(k);
+template <class T>
+void gsFitting<T>::assembleOrdered(const gsBasis<T> & basis,
+                                   const gsMatrix<T> & params,
+                                   const gsMatrix<T> & points,
+                                   const std::vector<index_t> & order,
+                                   const std::vector<index_t> & batches,
+                                   gsSparseEntries<T> & A_entries,
+                                   gsMatrix<T> & m_B)
+{
+    GISMO_ASSERT( ! batches.empty() && batches.back() == points.rows(),
+                  "The points are not binned");
+    const index_t nBatches = batches.size() - 1;
 
-        //computing the values of the basis functions at the current point
-        m_basis->eval_into(curr_point, value);
+    // Contributions of every batch to the matrix and to the
+    // right-hand side (row, coordinate, value), summed up in the
+    // order of the batches
+    std::vector<gsSparseEntries<T> > entries(nBatches);
+    std::vector<gsSparseEntries<T> > rhs    (nBatches);
 
-        // which functions have been computed i.e. which are active
-        m_basis->active_into(curr_point, actives);
-        
-	const index_t numActive = actives.rows();
+#   pragma omp parallel
+    {
+        gsMatrix<T> par, pts, value, blockA, blockB;
+        gsMatrix<unsigned> actives;
 
-        for (index_t i = 0; i != numActive; ++i)
+#       pragma omp for schedule(dynamic)
+        for (index_t c = 0; c < nBatches; ++c)
         {
-            const int ii = actives(i, 0);
-            m_B.row(ii) += value(i, 0) * m_points.row(k);
-            for (index_t j = 0; j != numActive; ++j)
-                A_mat(ii, actives(j, 0)) += value(i, 0) * value(j, 0);
+            gsSparseEntries<T> & locA = entries[c];
+            gsSparseEntries<T> & locB = rhs    [c];
+            const index_t first = batches[c];
+            const index_t n     = batches[c+1] - first;
+
+            par.resize(params.rows(), n);
+            pts.resize(n, points.cols());
+            for (index_t k = 0; k != n; ++k)
+            {
+                par.col(k) = params.col(order[first + k]);
+                pts.row(k) = points.row(order[first + k]);
+            }
+
+            //computing the values of the basis functions at the points
+            basis.eval_into(par, value);
+
+            // which functions have been computed i.e. which are active
+            basis.active_into(par, actives);
+            const index_t numActive = actives.rows();
+
+            // Runs of points with the same active functions, ie. the
+            // elements of the batch
+            for (index_t k0 = 0, k1; k0 < n; k0 = k1)
+            {
+                for (k1 = k0 + 1; k1 < n && actives.col(k1) == actives.col(k0); ++k1) ;
+
+                const index_t m = k1 - k0;
+                blockA.noalias() = value.middleCols(k0, m) * value.middleCols(k0, m).transpose();
+                blockB.noalias() = value.middleCols(k0, m) * pts.middleRows(k0, m);
+
+                for (index_t i = 0; i != numActive; ++i)
+                {
+                    // zero padding of the actives, or vanishing function
+                    if ( 0 == blockA(i, i) )
+                        continue;
+
+                    const index_t ii = actives(i, k0);
+                    for (index_t j = 0; j != blockB.cols(); ++j)
+                        locB.add(ii, j, blockB(i, j));
+                    for (index_t j = 0; j != numActive; ++j)
+                        if ( 0 != blockA(j, j) )
+                            locA.add(ii, actives(j, k0), blockA(i, j));
+                }
+            }
         }
     }
+
+    // Sum up the contributions of the batches
+    for (index_t c = 0; c < nBatches; ++c)
+    {
+        A_entries.insert(A_entries.end(), entries[c].begin(), entries[c].end());
+        gsSparseEntries<T>().swap(entries[c]);
+        for (typename gsSparseEntries<T>::const_iterator it = rhs[c].begin();
+             it != rhs[c].end(); ++it)
+            m_B(it->row(), it->col()) += it->value();
+    }
 }
 
 
@@ -150,6 +416,7 @@ void gsFitting<T>::applySmoothing(T lambda, gsSparseMatrix<T> & A_mat)
     gsMatrix<T> quNodes, der2, localA;
     gsVector<T> quWeights;
     gsMatrix<unsigned> actives;
+    gsSparseEntries<T> entries;
 
     typename gsBasis<T>::domainIter domIt = m_basis->makeDomainIterator();
 
@@ -206,53 +473,94 @@ void gsFitting<T>::applySmoothing(T lambda, gsSparseMatrix<T> & A_mat)
         {
             const int ii = actives(i,0);
             for (index_t j=0; j!=numActive; ++j)
-                A_mat( ii, actives(j,0) ) += localA(i,j);
+                entries.add( ii, actives(j,0), localA(i,j) );
         }
     }
+
+    gsSparseMatrix<T> S(A_mat.rows(), A_mat.cols());
+    S.setFrom(entries);
+    A_mat += S;
 }
 
 template<class T>
-void gsFitting<T>::computeErrors()
+void gsFitting<T>::evalResult(gsMatrix<T> & values) const
 {
-    m_pointErrors.clear();
+    // Evaluate in the order of the points, if available, for
+    // locality in the basis
+    if ( static_cast<index_t>(m_order.size()) == m_param_values.cols() )
+        evalOrdered(*m_result, m_param_values, m_order, values);
+    else
+        evalOrdered(*m_result, m_param_values, std::vector<index_t>(), values);
+}
 
-    gsMatrix<T> val_i;
-    //m_result->eval_into(m_param_values.col(0), val_i);
-    m_result->eval_into(m_param_values, val_i);
-    m_pointErrors.push_back( (m_points.row(0) - val_i.col(0).transpose()).norm() );
-    m_max_error = m_min_error = m_pointErrors.back();
-    
-    for (index_t i = 1; i < m_points.rows(); i++)
+template<class T>
+void gsFitting<T>::evalOrdered(const gsGeometry<T> & geo,
+                               const gsMatrix<T> & params,
+                               const std::vector<index_t> & order,
+                               gsMatrix<T> & values)
+{
+    const index_t num_points = params.cols();
+    values.resize(geo.targetDim(), num_points);
+
+    const bool sorted = ! order.empty();
+    const index_t chunk   = 1024;
+    const index_t nChunks = (num_points + chunk - 1) / chunk;
+
+#   pragma omp parallel
     {
-        //m_result->eval_into(m_param_values.col(i), val_i);
+        gsMatrix<T> par, val;
+
+#       pragma omp for schedule(static)
+        for (index_t c = 0; c < nChunks; ++c)
+        {
+            const index_t first = c * chunk;
+            const index_t n     = math::min(chunk, num_points - first);
 
-        const T err = (m_points.row(i) - val_i.col(i).transpose()).norm() ;
+            par.resize(params.rows(), n);
+            for (index_t k = 0; k != n; ++k)
+                par.col(k) = params.col(sorted ? order[first + k] : first + k);
 
-        m_pointErrors.push_back(err);
+            geo.eval_into(par, val);
 
-        if ( err > m_max_error ) m_max_error = err;
-        if ( err < m_min_error ) m_min_error = err;
+            for (index_t k = 0; k != n; ++k)
+                values.col(sorted ? order[first + k] : first + k) = val.col(k);
+        }
     }
 }
 
+template<class T>
+void gsFitting<T>::computeErrors()
+{
+    gsMatrix<T> val_i;
+    evalResult(val_i);
+
+    const index_t num_points = m_points.rows();
+    m_pointErrors.resize(num_points);
+
+#   pragma omp parallel for schedule(static)
+    for (index_t i = 0; i < num_points; i++)
+        m_pointErrors[i] = (m_points.row(i) - val_i.col(i).transpose()).norm();
+
+    m_max_error = *std::max_element(m_pointErrors.begin(), m_pointErrors.end());
+    m_min_error = *std::min_element(m_pointErrors.begin(), m_pointErrors.end());
+}
+
 
 template<class T>
 void gsFitting<T>::computeMaxNormErrors()
 {
-    m_pointErrors.clear();
-
     gsMatrix<T> values;
-    m_result->eval_into(m_param_values, values);
+    evalResult(values);
 
-    for (index_t i = 0; i != m_points.rows(); i++)
-    {
-        const T err = (m_points.row(i) - values.col(i).transpose()).cwiseAbs().maxCoeff();
+    const index_t num_points = m_points.rows();
+    m_pointErrors.resize(num_points);
 
-        m_pointErrors.push_back(err);
+#   pragma omp parallel for schedule(static)
+    for (index_t i = 0; i < num_points; i++)
+        m_pointErrors[i] = (m_points.row(i) - values.col(i).transpose()).cwiseAbs().maxCoeff();
 
-        if ( i == 0 || m_max_error < err ) m_max_error = err;
-        if ( i == 0 || err < m_min_error ) m_min_error = err;
-    }
+    m_max_error = *std::max_element(m_pointErrors.begin(), m_pointErrors.end());
+    m_min_error = *std::min_element(m_pointErrors.begin(), m_pointErrors.end());
 }
 
 
@@ -261,7 +569,7 @@ template<class T>
 void gsFitting<T>::computeApproxError(T& error, int type) const
 {
     gsMatrix<T> results;
-    m_result->eval_into(m_param_values, results);
+    evalResult(results);
     error = 0;
 
     //computing the approximation error = sum_i ||x(u_i)-p_i||^2
@@ -289,7 +597,7 @@ void gsFitting<T>::get_Error(std::vector<T>& errors, int type) const
 { 
     errors.clear();
     gsMatrix<T> results;
-    m_result->eval_into(m_param_values,results);
+    evalResult(results);
     results.transposeInPlace();
 
     for (index_t row = 0; row != m_points.rows(); row++)
@@ -0,0 +1,197 @@
+/** @file gsStreamFitting.h
+
+    @brief Provides least squares fitting of point clouds which are
+    read in chunks (out of core).
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <gsCore/gsLinearAlgebra.h>
+#include <gsModeling/gsFitting.h>
+#include <fstream>
+
+namespace gismo
+{
+
+/**
+   @brief Source of parametrized points, delivered in chunks.
+
+   Derive from this class to feed gsStreamFitting from any source,
+   eg. a scanner or a database.
+
+   \ingroup Modeling
+*/
+template<class T = real_t>
+class gsPointStream
+{
+public:
+
+    virtual ~gsPointStream() { }
+
+    /// \brief Reads the next chunk of points. The parameters are
+    /// stored in the columns of \a params and the points in the
+    /// columns of \a points. Returns false if there are no more
+    /// points.
+    virtual bool next(gsMatrix<T> & params, gsMatrix<T> & points) = 0;
+
+    /// Restarts the stream at the first point
+    virtual void rewind() = 0;
+};
+
+/**
+   @brief Reads parametrized points from a binary file.
+
+   The file consists of records of \a parDim parameters followed by
+   the \a geoDim coordinates of the point, every value being stored
+   as a raw \a T in the byte order of the machine. Such files are
+   written by write().
+
+   \ingroup Modeling
+*/
+template<class T = real_t>
+class gsFilePointStream : public gsPointStream<T>
+{
+public:
+
+    /// Opens the file \a filename, of which \a chunkSize points are
+    /// read at once
+    gsFilePointStream(const std::string & filename, index_t parDim,
+                      index_t geoDim, index_t chunkSize = 65536);
+
+    bool next(gsMatrix<T> & params, gsMatrix<T> & points);
+
+    void rewind();
+
+    /// \brief Writes the parameters \a params and the points \a
+    /// points (one per column) to the file \a filename, or appends
+    /// them if \a append is true
+    static void write(const std::string & filename, const gsMatrix<T> & params,
+                      const gsMatrix<T> & points, bool append = false);
+
+private:
+
+    std::ifstream m_file;
+
+    index_t m_parDim, m_geoDim, m_chunkSize;
+
+    /// One column per record
+    gsMatrix<T> m_buffer;
+};
+
+/**
+   @brief Least squares fitting of point clouds which do not fit into
+   memory.
+
+   The points are added chunk by chunk, by addPoints(), and their
+   contribution to the normal equations is accumulated (see
+   gsFitting::assembleSystem); the points are not kept. The
+   contributions are kept as triplets which are summed up into the
+   sparse matrix when their number exceeds the number of non-zeros
+   of the matrix (or a fixed minimum). The memory is therefore
+   proportional to the size of the basis, independently of the number
+   of points.
+
+   The errors are computed by a second pass over the points, see
+   computeErrors(). Only their extremal values and their root mean
+   square are kept.
+
+   The class reuses the assembly and the solvers of gsFitting, but
+   does not derive publicly from it, since the functions of gsFitting
+   which work on a stored point cloud do not apply.
+
+   \code
+   gsFilePointStream<> stream("scan.bin", 2, 3);
+   gsStreamFitting<> fit(basis);
+   fit.addPoints(stream);
+   fit.compute();
+   fit.computeErrors(stream);
+   \endcode
+
+   \ingroup Modeling
+*/
+template<class T = real_t>
+class gsStreamFitting : private gsFitting<T>
+{
+public:
+
+    /// Fitting in the space spanned by \a basis
+    explicit gsStreamFitting(gsBasis<T> & basis);
+
+public:
+
+    /// Discards the accumulated points, eg. after refining the basis
+    void reset();
+
+    /// \brief Adds the parameters \a params and the points \a points
+    /// (one per column) to the system
+    void addPoints(const gsMatrix<T> & params, const gsMatrix<T> & points);
+
+    /// Adds all points of \a stream to the system, starting at its
+    /// first point
+    void addPoints(gsPointStream<T> & stream);
+
+    /// \brief Computes the least squares fit of the points added so
+    /// far. More points can be added afterwards.
+    void compute(T lambda = 0);
+
+    /// \brief Computes the errors of the fit at all points of \a
+    /// stream, starting at its first point
+    void computeErrors(gsPointStream<T> & stream);
+
+    /// Number of points added to the system
+    index_t numPoints() const { return m_numPoints; }
+
+    /// \brief Root mean square of the errors computed by
+    /// computeErrors()
+    T rmsError() const { return m_numErrors ? math::sqrt(m_sumSqError / m_numErrors) : 0; }
+
+    /// Returns the minimum error computed by computeErrors()
+    using gsFitting<T>::minPointError;
+
+    /// Returns the maximum error computed by computeErrors()
+    using gsFitting<T>::maxPointError;
+
+    /// Returns the fit computed by compute()
+    using gsFitting<T>::result;
+
+    /// Returns the basis of the fit
+    using gsFitting<T>::getBasis;
+
+private:
+
+    /// Sums the pending triplets into the matrix
+    void flush();
+
+protected:
+
+    using gsFitting<T>::m_basis;
+    using gsFitting<T>::m_result;
+    using gsFitting<T>::m_pointErrors;
+    using gsFitting<T>::m_max_error;
+    using gsFitting<T>::m_min_error;
+
+    /// The accumulated normal equations
+    gsSparseMatrix<T> m_A;
+    gsMatrix<T>       m_B;
+
+    /// Contributions not yet summed into m_A
+    gsSparseEntries<T> m_entries;
+
+    index_t m_numPoints;
+
+    /// Sum of the squared errors and number of errors
+    T       m_sumSqError;
+    index_t m_numErrors;
+};
+
+} // namespace gismo
+
+#ifndef GISMO_BUILD_LIB
+#include GISMO_HPP_HEADER(gsStreamFitting.hpp)
+#endif
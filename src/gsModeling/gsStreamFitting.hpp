@@ -0,0 +1,186 @@
+/** @file gsStreamFitting.hpp
+
+    @brief Provides implementation of least squares fitting of point
+    clouds which are read in chunks.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <gsModeling/gsStreamFitting.h>
+#include <gsCore/gsGeometry.h>
+#include <gsCore/gsBasis.h>
+
+namespace gismo
+{
+
+template<class T>
+gsFilePointStream<T>::gsFilePointStream(const std::string & filename,
+                                        index_t parDim, index_t geoDim,
+                                        index_t chunkSize)
+: m_file(filename.c_str(), std::ios::in | std::ios::binary),
+  m_parDim(parDim), m_geoDim(geoDim), m_chunkSize(chunkSize)
+{
+    GISMO_ENSURE( m_file.is_open(), "Cannot open file "<< filename );
+    GISMO_ENSURE( chunkSize > 0, "The chunk size must be positive");
+}
+
+template<class T>
+bool gsFilePointStream<T>::next(gsMatrix<T> & params, gsMatrix<T> & points)
+{
+    const index_t rec = m_parDim + m_geoDim;
+    m_buffer.resize(rec, m_chunkSize);
+    m_file.read( reinterpret_cast<char*>(m_buffer.data()),
+                 m_buffer.size() * sizeof(T) );
+    const std::streamsize bytes = m_file.gcount();
+    GISMO_ENSURE( 0 == bytes % static_cast<std::streamsize>(rec * sizeof(T)),
+                  "The file ends with an incomplete record");
+    const index_t n = bytes / (rec * sizeof(T));
+    if ( 0 == n )
+        return false;
+
+    params = m_buffer.topLeftCorner   (m_parDim, n);
+    points = m_buffer.bottomLeftCorner(m_geoDim, n);
+    return true;
+}
+
+template<class T>
+void gsFilePointStream<T>::rewind()
+{
+    m_file.clear();
+    m_file.seekg(0, std::ios::beg);
+}
+
+template<class T>
+void gsFilePointStream<T>::write(const std::string & filename,
+                                 const gsMatrix<T> & params,
+                                 const gsMatrix<T> & points, bool append)
+{
+    GISMO_ENSURE( params.cols() == points.cols(),
+                  "Number of parameters and points do not match");
+    std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary |
+                       (append ? std::ios::app : std::ios::trunc) );
+    GISMO_ENSURE( file.is_open(), "Cannot open file "<< filename );
+
+    gsMatrix<T> rec(params.rows() + points.rows(), params.cols());
+    rec.topRows   (params.rows()) = params;
+    rec.bottomRows(points.rows()) = points;
+    file.write( reinterpret_cast<const char*>(rec.data()), rec.size() * sizeof(T) );
+}
+
+template<class T>
+gsStreamFitting<T>::gsStreamFitting(gsBasis<T> & basis)
+: gsFitting<T>(gsMatrix<T>(), gsMatrix<T>(), basis)
+{
+    m_max_error = m_min_error = 0;
+    reset();
+}
+
+template<class T>
+void gsStreamFitting<T>::reset()
+{
+    m_A.resize(m_basis->size(), m_basis->size());
+    m_B.resize(0, 0);
+    gsSparseEntries<T>().swap(m_entries);
+    m_numPoints  = 0;
+    m_sumSqError = 0;
+    m_numErrors  = 0;
+}
+
+template<class T>
+void gsStreamFitting<T>::addPoints(const gsMatrix<T> & params,
+                                   const gsMatrix<T> & points)
+{
+    GISMO_ENSURE( params.cols() == points.cols(),
+                  "Number of parameters and points do not match");
+    GISMO_ENSURE( params.rows() == m_basis->dim(),
+                  "Parameters do not match the basis");
+    if ( 0 == m_B.size() )
+        m_B.setZero(m_basis->size(), points.rows());
+    GISMO_ENSURE( points.rows() == m_B.cols(), "Wrong dimension of the points");
+
+    std::vector<index_t> order, batches;
+    this->mortonOrder(params, order);
+    this->binOrdered(*m_basis, params, order, batches);
+    this->assembleOrdered(*m_basis, params, points.transpose(), order, batches,
+                          m_entries, m_B);
+    m_numPoints += params.cols();
+
+    // Sum up the triplets when they outnumber the non-zeros of the
+    // matrix, which keeps the cost of the sums linear in the number
+    // of points
+    const std::size_t minPending = 1 << 22;
+    if ( m_entries.size() > math::max(minPending, static_cast<std::size_t>(m_A.nonZeros())) )
+        flush();
+}
+
+template<class T>
+void gsStreamFitting<T>::addPoints(gsPointStream<T> & stream)
+{
+    gsMatrix<T> params, points;
+    stream.rewind();
+    while ( stream.next(params, points) )
+        addPoints(params, points);
+}
+
+template<class T>
+void gsStreamFitting<T>::flush()
+{
+    gsSparseMatrix<T> S(m_A.rows(), m_A.cols());
+    S.setFrom(m_entries);
+    m_A += S;
+    gsSparseEntries<T>().swap(m_entries);
+}
+
+template<class T>
+void gsStreamFitting<T>::compute(T lambda)
+{
+    GISMO_ENSURE( m_numPoints > 0, "No points were added");
+
+    // Wipe out previous result
+    if ( m_result )
+        delete m_result;
+    m_result = NULL;
+
+    flush();
+    gsSparseMatrix<T> A_mat = m_A;
+    if ( lambda > 0 )
+        this->applySmoothing(lambda, A_mat);
+
+    this->solveSystem(A_mat, m_B);
+}
+
+template<class T>
+void gsStreamFitting<T>::computeErrors(gsPointStream<T> & stream)
+{
+    GISMO_ENSURE( m_result, "No fit has been computed");
+    m_pointErrors.clear();
+    m_sumSqError = 0;
+    m_numErrors  = 0;
+
+    gsMatrix<T> params, points, values;
+    std::vector<index_t> order;
+    stream.rewind();
+    while ( stream.next(params, points) )
+    {
+        this->mortonOrder(params, order);
+        this->evalOrdered(*m_result, params, order, values);
+
+        for (index_t i = 0; i != points.cols(); ++i)
+        {
+            const T err2 = (points.col(i) - values.col(i)).squaredNorm();
+            const T err  = math::sqrt(err2);
+            if ( 0 == m_numErrors || m_max_error < err ) m_max_error = err;
+            if ( 0 == m_numErrors || err < m_min_error ) m_min_error = err;
+            m_sumSqError += err2;
+            ++m_numErrors;
+        }
+    }
+}
+
+} // namespace gismo
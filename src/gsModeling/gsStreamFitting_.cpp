@@ -0,0 +1,12 @@
+#include <gsCore/gsTemplateTools.h>
+
+#include <gsModeling/gsStreamFitting.h>
+#include <gsModeling/gsStreamFitting.hpp>
+
+namespace gismo
+{
+
+CLASS_TEMPLATE_INST gsFilePointStream<real_t>;
+CLASS_TEMPLATE_INST gsStreamFitting<real_t>;
+
+} // namespace gismo
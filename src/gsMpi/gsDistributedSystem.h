@@ -0,0 +1,228 @@
+/** @file gsDistributedSystem.h
+
+    @brief Assembly of multipatch systems distributed over MPI
+    processes, and the distributed sparse matrix of such systems.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <gsMpi/gsMpi.h>
+#include <gsSolver/gsLinearOperator.h>
+#include <gsAssembler/gsAssembler.h>
+
+namespace gismo
+{
+
+/**
+   @brief A square sparse matrix whose rows are distributed over the
+   processes of a communicator.
+
+   Every process stores the rows of the degrees of freedom (dofs) it
+   owns. The vectors are distributed the same way: the local part of
+   a vector consists of the entries of the owned dofs, in increasing
+   global order. The columns of the local matrix are the owned dofs
+   followed by the ghost dofs, ie. the dofs owned by other processes
+   which are coupled to an owned one. The values of the ghosts are
+   exchanged in every application of the matrix.
+
+   The matrix is a gsLinearOperator whose rows() and cols() are the
+   number of owned dofs, and which sums up the reductions of the
+   iterative solvers over the processes (see sumReduce()). Hence it is
+   solved by gsConjugateGradient, gsGMRes or gsMinimalResidual, every
+   process passing its local part of the right-hand side.
+
+   \ingroup Mpi
+*/
+template<class T = real_t>
+class gsDistributedMatrix : public gsLinearOperator<T>
+{
+public:
+
+    /// Shared pointer for gsDistributedMatrix
+    typedef memory::shared_ptr<gsDistributedMatrix> Ptr;
+
+    /// Unique pointer for gsDistributedMatrix
+    typedef memory::unique_ptr<gsDistributedMatrix> uPtr;
+
+    /// The local rows
+    typedef gsSparseMatrix<T, RowMajor> LocalMatrix;
+
+    /**
+       @brief Constructs the matrix from the entries of the owned rows.
+
+       \param comm the communicator of the processes sharing the matrix
+       \param owner the owning process of every (global) dof
+       \param entries the entries of the owned rows, with global row
+       and column indices. Repeated entries are summed up.
+    */
+    gsDistributedMatrix(const gsMpiComm & comm,
+                        const std::vector<int> & owner,
+                        const gsSparseEntries<T> & entries);
+
+    /// Make function returning a smart pointer
+    static uPtr make(const gsMpiComm & comm, const std::vector<int> & owner,
+                     const gsSparseEntries<T> & entries)
+    { return memory::make_unique( new gsDistributedMatrix(comm, owner, entries) ); }
+
+    void apply(const gsMatrix<T> & input, gsMatrix<T> & x) const;
+
+    index_t rows() const { return m_local.rows(); }
+
+    index_t cols() const { return m_local.rows(); }
+
+    void sumReduce(T * values, index_t n) const { m_comm.sum(values, n); }
+
+    /// \brief Returns the local rows. Column \a j is the owned dof
+    /// \a j if \a j < rows(), otherwise the ghost dof \a j - rows()
+    const LocalMatrix & localMatrix() const { return m_local; }
+
+    /// Returns the global indices of the owned dofs, in increasing order
+    const std::vector<index_t> & ownedDofs() const { return m_owned; }
+
+    /// Returns the global indices of the ghost dofs, see localMatrix()
+    const std::vector<index_t> & ghostDofs() const { return m_ghosts; }
+
+    /// Returns the communicator
+    const gsMpiComm & comm() const { return m_comm; }
+
+private:
+
+    gsMpiComm m_comm;
+
+    LocalMatrix m_local;
+
+    std::vector<index_t> m_owned, m_ghosts;
+
+    /// Owned entries (local indices) sent to the other processes in
+    /// every application, grouped by process
+    gsVector<index_t> m_sendIdx;
+
+    /// Counts and offsets of the exchange of the ghost values, per
+    /// process. The ghosts are grouped by owner, in increasing
+    /// order. (Mutable since MPI takes non-const pointers.)
+    mutable gsVector<int> m_sendCnt, m_sendDsp, m_recvCnt, m_recvDsp;
+
+    /// Buffers of apply(), the input being extended by the ghosts
+    mutable gsVector<T> m_sendBuf, m_ext;
+};
+
+/**
+   @brief Assembles a multipatch system distributed over the
+   processes of a communicator.
+
+   The patches are partitioned into contiguous blocks with about the
+   same number of elements, one block per process (see
+   partitionPatches()). Every process runs the assembler on its own
+   patches only (see gsAssembler::restrictToPatches()), which results
+   in partial sums of the rows of the dofs on the boundaries of the
+   blocks. A dof is owned by the process of the first patch which
+   contains it; the partial rows are sent to their owners and summed
+   up, such that every process ends up with the complete rows of its
+   dofs, as a gsDistributedMatrix.
+
+   The domain, the bases and the dof mappers are replicated on all
+   processes, ie. the memory needed for them grows with the size of
+   the whole system, while the matrix entries and the work of the
+   assembly are distributed.
+
+   \code
+   gsMpiComm comm = gsMpi::init(argc, argv).worldComm();
+   gsPoissonAssembler<> assembler(mp, mb, bc, f);
+   gsDistributedSystem<> dist(assembler, comm);
+   dist.assemble();
+   gsMatrix<> x;
+   gsConjugateGradient cg(dist.matrix());
+   cg.solve(dist.rhs(), x);
+   gsMatrix<> solVector;
+   dist.gatherSolution(x, solVector); // on all processes
+   gsField<> sol = assembler.constructSolution(solVector);
+   \endcode
+
+   With a single process (eg. without MPI) the system is the one of
+   the assembler.
+
+   \ingroup Mpi
+*/
+template<class T = real_t>
+class gsDistributedSystem
+{
+public:
+
+    /// \brief Distributed assembly by \a assembler, which must be
+    /// initialized, over the processes of \a comm
+    gsDistributedSystem(gsAssembler<T> & assembler, const gsMpiComm & comm);
+
+    /// \brief Returns the first patch of every part of a partition of
+    /// the patches of \a mb into \a numParts contiguous blocks with
+    /// about the same number of elements. Part \a r consists of the
+    /// patches result[r] to result[r+1]-1; it may be empty.
+    static std::vector<index_t> partitionPatches(const gsMultiBasis<T> & mb,
+                                                 index_t numParts);
+
+public:
+
+    /// \brief Assembles the local parts of the matrix and of the
+    /// right-hand side. If the assembler has no sparsity pattern yet,
+    /// the one of the own patches is computed and kept until
+    /// gsAssembler::refresh()
+    void assemble();
+
+    /// Returns the distributed matrix
+    typename gsDistributedMatrix<T>::Ptr matrix() const { return m_matrix; }
+
+    /// Returns the local part of the right-hand side
+    const gsMatrix<T> & rhs() const { return m_rhs; }
+
+    /// Returns the global indices of the owned dofs, in increasing order
+    const std::vector<index_t> & ownedDofs() const { return m_matrix->ownedDofs(); }
+
+    /// Returns the owning process of every dof
+    const std::vector<int> & owners() const { return m_owner; }
+
+    /// Returns the patches of the process
+    const std::vector<bool> & localPatches() const { return m_patches; }
+
+    /// \brief Assembles the global vector \a global from the local
+    /// parts \a local of all processes
+    void gatherSolution(const gsMatrix<T> & local, gsMatrix<T> & global) const;
+
+    /// \brief Extracts the local part \a local of the global vector
+    /// \a global
+    void localPart(const gsMatrix<T> & global, gsMatrix<T> & local) const;
+
+private:
+
+    // Computes the owner of every dof
+    void computeOwners();
+
+private:
+
+    gsAssembler<T> & m_assembler;
+
+    gsMpiComm m_comm;
+
+    /// The patches assembled by the process
+    std::vector<bool> m_patches;
+
+    /// The first patch of every process
+    std::vector<index_t> m_first;
+
+    /// The owning process of every dof
+    std::vector<int> m_owner;
+
+    typename gsDistributedMatrix<T>::Ptr m_matrix;
+
+    gsMatrix<T> m_rhs;
+};
+
+} // namespace gismo
+
+#ifndef GISMO_BUILD_LIB
+#include GISMO_HPP_HEADER(gsDistributedSystem.hpp)
+#endif
@@ -0,0 +1,356 @@
+/** @file gsDistributedSystem.hpp
+
+    @brief Provides implementation of the distributed assembly of
+    multipatch systems.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <gsMpi/gsDistributedSystem.h>
+#include <gsCore/gsMultiBasis.h>
+
+namespace gismo
+{
+
+template<class T>
+gsDistributedMatrix<T>::gsDistributedMatrix(const gsMpiComm & comm,
+                                            const std::vector<int> & owner,
+                                            const gsSparseEntries<T> & entries)
+: m_comm(comm)
+{
+    const int rank  = m_comm.rank();
+    const int nproc = m_comm.size();
+
+    // Owned dofs, in increasing order
+    for (size_t i = 0; i != owner.size(); ++i)
+        if ( owner[i] == rank )
+            m_owned.push_back(i);
+    const index_t nOwned = m_owned.size();
+
+    // Ghost dofs, sorted by owner and index
+    std::vector<std::pair<int,index_t> > ghosts;
+    for (typename gsSparseEntries<T>::const_iterator it = entries.begin();
+         it != entries.end(); ++it)
+    {
+        GISMO_ASSERT( owner[it->row()] == rank, "Entry not in an owned row");
+        if ( owner[it->col()] != rank )
+            ghosts.push_back( std::make_pair(owner[it->col()], it->col()) );
+    }
+    std::sort(ghosts.begin(), ghosts.end());
+    ghosts.erase( std::unique(ghosts.begin(), ghosts.end()), ghosts.end() );
+
+    m_ghosts.resize(ghosts.size());
+    gsVector<index_t> ghostIdx(ghosts.size());
+    m_recvCnt.setZero(nproc);
+    for (size_t k = 0; k != ghosts.size(); ++k)
+    {
+        m_ghosts[k] = ghostIdx[k] = ghosts[k].second;
+        ++m_recvCnt[ghosts[k].first];
+    }
+
+    // Local rows, with the columns numbered as owned dofs followed
+    // by ghosts
+    gsSparseEntries<T> local;
+    local.reserve(entries.size());
+    for (typename gsSparseEntries<T>::const_iterator it = entries.begin();
+         it != entries.end(); ++it)
+    {
+        const index_t i = std::lower_bound(m_owned.begin(), m_owned.end(), it->row())
+            - m_owned.begin();
+        const int q = owner[it->col()];
+        const index_t j = ( q == rank ?
+            std::lower_bound(m_owned.begin(), m_owned.end(), it->col()) - m_owned.begin() :
+            nOwned + ( std::lower_bound(ghosts.begin(), ghosts.end(),
+                                        std::make_pair(q, it->col())) - ghosts.begin() ) );
+        local.add(i, j, it->value());
+    }
+    m_local.resize(nOwned, nOwned + m_ghosts.size());
+    m_local.setFrom(local);
+    m_local.makeCompressed();
+
+    // Send the indices of the ghosts to their owners, who send the
+    // values in apply()
+    m_sendCnt.resize(nproc);
+    m_comm.alltoall(m_recvCnt.data(), m_sendCnt.data(), 1);
+
+    m_sendDsp.resize(nproc);
+    m_recvDsp.resize(nproc);
+    m_sendDsp[0] = m_recvDsp[0] = 0;
+    for (int r = 1; r < nproc; ++r)
+    {
+        m_sendDsp[r] = m_sendDsp[r-1] + m_sendCnt[r-1];
+        m_recvDsp[r] = m_recvDsp[r-1] + m_recvCnt[r-1];
+    }
+
+    m_sendIdx.resize(m_sendCnt.sum());
+    m_comm.alltoallv(ghostIdx.data() , m_recvCnt.data(), m_recvDsp.data(),
+                     m_sendIdx.data(), m_sendCnt.data(), m_sendDsp.data());
+
+    for (index_t k = 0; k != m_sendIdx.size(); ++k)
+    {
+        GISMO_ASSERT( owner[m_sendIdx[k]] == rank, "Request for a foreign dof");
+        m_sendIdx[k] = std::lower_bound(m_owned.begin(), m_owned.end(), m_sendIdx[k])
+            - m_owned.begin();
+    }
+}
+
+template<class T>
+void gsDistributedMatrix<T>::apply(const gsMatrix<T> & input, gsMatrix<T> & x) const
+{
+    GISMO_ASSERT( input.rows() == rows(), "Wrong size of the input");
+    const index_t n = rows();
+    x.resize(n, input.cols());
+    m_sendBuf.resize(m_sendIdx.size());
+    m_ext.resize(m_local.cols());
+
+    for (index_t c = 0; c != input.cols(); ++c)
+    {
+        for (index_t k = 0; k != m_sendIdx.size(); ++k)
+            m_sendBuf[k] = input(m_sendIdx[k], c);
+
+        m_ext.head(n) = input.col(c);
+        m_comm.alltoallv(m_sendBuf.data(), m_sendCnt.data(), m_sendDsp.data(),
+                         m_ext.data() + n, m_recvCnt.data(), m_recvDsp.data());
+
+        x.col(c).noalias() = m_local * m_ext;
+    }
+}
+
+template<class T>
+gsDistributedSystem<T>::gsDistributedSystem(gsAssembler<T> & assembler,
+                                            const gsMpiComm & comm)
+: m_assembler(assembler), m_comm(comm)
+{
+    const gsMultiBasis<T> & mb = m_assembler.multiBasis(0);
+    const int rank = m_comm.rank();
+
+    m_first = partitionPatches(mb, m_comm.size());
+    m_patches.assign(mb.nBases(), false);
+    for (index_t k = m_first[rank]; k < m_first[rank+1]; ++k)
+        m_patches[k] = true;
+}
+
+template<class T>
+std::vector<index_t>
+gsDistributedSystem<T>::partitionPatches(const gsMultiBasis<T> & mb,
+                                         index_t numParts)
+{
+    GISMO_ASSERT( numParts > 0, "Invalid number of parts");
+    const index_t np = mb.nBases();
+
+    // Number of elements of the patches before patch k
+    std::vector<size_t> cum(np + 1, 0);
+    for (index_t k = 0; k != np; ++k)
+        cum[k+1] = cum[k] + mb[k].numElements();
+
+    // Part r starts at the patch boundary closest to r/numParts of
+    // the elements
+    std::vector<index_t> result(numParts + 1);
+    result[0]        = 0;
+    result[numParts] = np;
+    for (index_t r = 1; r < numParts; ++r)
+    {
+        const T target = static_cast<T>(cum.back()) * r / numParts;
+        index_t k = std::lower_bound(cum.begin(), cum.end(), target) - cum.begin();
+        if ( k > 0 && target - cum[k-1] < cum[k] - target )
+            --k;
+        result[r] = math::max(result[r-1], k);
+    }
+    return result;
+}
+
+template<class T>
+void gsDistributedSystem<T>::computeOwners()
+{
+    const gsSparseSystem<T> & sys = m_assembler.system();
+    GISMO_ENSURE( sys.matrix().rows() == sys.matrix().cols(),
+                  "Distributed systems must be square");
+
+    // Process of every patch
+    const index_t np = m_patches.size();
+    std::vector<int> proc(np);
+    for (size_t r = 0; r + 1 != m_first.size(); ++r)
+        for (index_t k = m_first[r]; k != m_first[r+1]; ++k)
+            proc[k] = r;
+
+    // A dof is owned by the process of the first patch containing it
+    m_owner.assign(sys.matrix().cols(), -1);
+    unsigned ii;
+    for (index_t c = 0; c != sys.numColBlocks(); ++c)
+    {
+        const gsDofMapper     & mapper = sys.colMapper(c);
+        const gsMultiBasis<T> & mb     = m_assembler.multiBasis(sys.colBasis(c));
+        for (index_t k = 0; k != np; ++k)
+            for (index_t i = 0; i != mb[k].size(); ++i)
+                if ( mapper.is_free(i, k) )
+                {
+                    sys.mapToGlobalColIndex(i, k, ii, c);
+                    if ( -1 == m_owner[ii] )
+                        m_owner[ii] = proc[k];
+                }
+    }
+    GISMO_ASSERT( std::find(m_owner.begin(), m_owner.end(), -1) == m_owner.end(),
+                  "Some dofs are not on any patch");
+}
+
+template<class T>
+void gsDistributedSystem<T>::assemble()
+{
+    const int nproc = m_comm.size();
+    computeOwners();
+
+    // Contributions of the own patches. The sparsity pattern is
+    // restricted to these patches as well, otherwise the matrix would
+    // be allocated for all dofs
+    m_assembler.restrictToPatches(m_patches);
+    if ( ! m_assembler.system().hasPattern() )
+        m_assembler.computePattern();
+    m_assembler.assemble();
+    m_assembler.restrictToPatches(std::vector<bool>());
+
+    const gsSparseMatrix<T> & A = m_assembler.matrix();
+    const gsMatrix<T>       & b = m_assembler.rhs();
+    const index_t nRhs = b.cols();
+
+    // Send the (partial) rows to their owners, including the own ones
+    gsVector<int> sendCnt, sendDsp(nproc), recvCnt(nproc), recvDsp(nproc);
+    sendCnt.setZero(nproc);
+    for (index_t j = 0; j < A.outerSize(); ++j)
+        for (typename gsSparseMatrix<T>::InnerIterator it(A, j); it; ++it)
+            if ( 0 != it.value() )
+                ++sendCnt[m_owner[it.row()]];
+
+    m_comm.alltoall(sendCnt.data(), recvCnt.data(), 1);
+    sendDsp[0] = recvDsp[0] = 0;
+    for (int r = 1; r < nproc; ++r)
+    {
+        sendDsp[r] = sendDsp[r-1] + sendCnt[r-1];
+        recvDsp[r] = recvDsp[r-1] + recvCnt[r-1];
+    }
+
+    gsVector<index_t> sendRow(sendCnt.sum()), sendCol(sendCnt.sum());
+    gsVector<T>       sendVal(sendCnt.sum());
+    gsVector<int>     pos = sendDsp;
+    for (index_t j = 0; j < A.outerSize(); ++j)
+        for (typename gsSparseMatrix<T>::InnerIterator it(A, j); it; ++it)
+            if ( 0 != it.value() )
+            {
+                const int k = pos[m_owner[it.row()]]++;
+                sendRow[k] = it.row();
+                sendCol[k] = it.col();
+                sendVal[k] = it.value();
+            }
+
+    gsVector<index_t> recvRow(recvCnt.sum()), recvCol(recvCnt.sum());
+    gsVector<T>       recvVal(recvCnt.sum());
+    m_comm.alltoallv(sendRow.data(), sendCnt.data(), sendDsp.data(),
+                     recvRow.data(), recvCnt.data(), recvDsp.data());
+    m_comm.alltoallv(sendCol.data(), sendCnt.data(), sendDsp.data(),
+                     recvCol.data(), recvCnt.data(), recvDsp.data());
+    m_comm.alltoallv(sendVal.data(), sendCnt.data(), sendDsp.data(),
+                     recvVal.data(), recvCnt.data(), recvDsp.data());
+
+    gsSparseEntries<T> entries;
+    entries.reserve(recvVal.size());
+    for (index_t k = 0; k != recvVal.size(); ++k)
+        entries.add(recvRow[k], recvCol[k], recvVal[k]);
+    m_matrix = memory::make_shared( new gsDistributedMatrix<T>(m_comm, m_owner, entries) );
+
+    // Same for the non-zero rows of the right-hand side
+    sendCnt.setZero();
+    for (index_t i = 0; i != b.rows(); ++i)
+        if ( ! b.row(i).isZero(0) )
+            ++sendCnt[m_owner[i]];
+
+    m_comm.alltoall(sendCnt.data(), recvCnt.data(), 1);
+    for (int r = 1; r < nproc; ++r)
+    {
+        sendDsp[r] = sendDsp[r-1] + sendCnt[r-1];
+        recvDsp[r] = recvDsp[r-1] + recvCnt[r-1];
+    }
+
+    sendRow.resize(sendCnt.sum());
+    sendVal.resize(sendCnt.sum() * nRhs);
+    pos = sendDsp;
+    for (index_t i = 0; i != b.rows(); ++i)
+        if ( ! b.row(i).isZero(0) )
+        {
+            const int k = pos[m_owner[i]]++;
+            sendRow[k] = i;
+            for (index_t c = 0; c != nRhs; ++c)
+                sendVal[k * nRhs + c] = b(i, c);
+        }
+
+    recvRow.resize(recvCnt.sum());
+    recvVal.resize(recvCnt.sum() * nRhs);
+    m_comm.alltoallv(sendRow.data(), sendCnt.data(), sendDsp.data(),
+                     recvRow.data(), recvCnt.data(), recvDsp.data());
+    sendCnt *= nRhs; sendDsp *= nRhs;
+    recvCnt *= nRhs; recvDsp *= nRhs;
+    m_comm.alltoallv(sendVal.data(), sendCnt.data(), sendDsp.data(),
+                     recvVal.data(), recvCnt.data(), recvDsp.data());
+
+    const std::vector<index_t> & owned = m_matrix->ownedDofs();
+    m_rhs.setZero(owned.size(), nRhs);
+    for (index_t k = 0; k != recvRow.size(); ++k)
+    {
+        const index_t i = std::lower_bound(owned.begin(), owned.end(), recvRow[k])
+            - owned.begin();
+        for (index_t c = 0; c != nRhs; ++c)
+            m_rhs(i, c) += recvVal[k * nRhs + c];
+    }
+}
+
+template<class T>
+void gsDistributedSystem<T>::gatherSolution(const gsMatrix<T> & local,
+                                            gsMatrix<T> & global) const
+{
+    GISMO_ASSERT( static_cast<size_t>(local.rows()) == ownedDofs().size(),
+                  "The local vector does not match the owned dofs");
+    const int     nproc = m_comm.size();
+    const index_t N     = m_owner.size();
+
+    gsVector<int> cnt, dsp(nproc);
+    cnt.setZero(nproc);
+    for (index_t i = 0; i != N; ++i)
+        ++cnt[m_owner[i]];
+    dsp[0] = 0;
+    for (int r = 1; r < nproc; ++r)
+        dsp[r] = dsp[r-1] + cnt[r-1];
+
+    // The dofs in the order of the gathered vector
+    std::vector<index_t> order(N);
+    gsVector<int> pos = dsp;
+    for (index_t i = 0; i != N; ++i)
+        order[pos[m_owner[i]]++] = i;
+
+    global.resize(N, local.cols());
+    gsVector<T> col, buf(N);
+    for (index_t c = 0; c != local.cols(); ++c)
+    {
+        col = local.col(c);
+        m_comm.allgatherv(col.data(), col.size(), buf.data(), cnt.data(), dsp.data());
+        for (index_t k = 0; k != N; ++k)
+            global(order[k], c) = buf[k];
+    }
+}
+
+template<class T>
+void gsDistributedSystem<T>::localPart(const gsMatrix<T> & global,
+                                       gsMatrix<T> & local) const
+{
+    const std::vector<index_t> & owned = ownedDofs();
+    GISMO_ASSERT( static_cast<size_t>(global.rows()) == m_owner.size(),
+                  "The vector does not match the system");
+    local.resize(owned.size(), global.cols());
+    for (size_t i = 0; i != owned.size(); ++i)
+        local.row(i) = global.row(owned[i]);
+}
+
+} // namespace gismo
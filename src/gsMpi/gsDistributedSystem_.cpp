@@ -0,0 +1,13 @@
+#include <gsCore/gsTemplateTools.h>
+
+#include <gsMpi/gsDistributedSystem.h>
+#include <gsMpi/gsDistributedSystem.hpp>
+
+namespace gismo
+{
+
+CLASS_TEMPLATE_INST gsDistributedMatrix<real_t>;
+
+CLASS_TEMPLATE_INST gsDistributedSystem<real_t>;
+
+} // namespace gismo
@@ -289,6 +289,48 @@ public:
         return 0;
     }
 
+    /**
+     * @brief Sends a block of \a len elements to every task and
+     * receives one from every task.
+     *
+     * The jth block of \a send is sent to task j, which stores it in
+     * the ith block of \a recv, i being the rank of the sender.
+     *
+     * @param[in] send The send buffer, of size P*len.
+     * @param[out] recv The receive buffer, of size P*len.
+     * @param[in] len The number of elements sent to each task.
+     */
+    template<typename T>
+    static int alltoall (T* send, T* recv, int len)
+    {
+        std::copy(send, send+len, recv);
+        return 0;
+    }
+
+    /**
+     * @brief Sends blocks of variable length to every task and
+     * receives one from every task.
+     *
+     * @param[in] send The send buffer.
+     * @param[in] sendlen An array with size equal to the number of processes containing the
+     *                    number of elements to send to process i at position i.
+     * @param[in] sdispl An array with size equal to the number of processes. The data for
+     *                   process i is read starting at send+sdispl[i].
+     * @param[out] recv The receive buffer.
+     * @param[in] recvlen An array with size equal to the number of processes containing the
+     *                    number of elements to receive from process i at position i.
+     * @param[in] rdispl An array with size equal to the number of processes. Data received
+     *                   from process i is written starting at recv+rdispl[i].
+     */
+    template<typename T>
+    static int alltoallv (T* send, int* sendlen, int* sdispl,
+                          T* recv, int* recvlen, int* rdispl)
+    {
+        GISMO_UNUSED(recvlen);
+        std::copy(send+*sdispl, send+*sdispl+*sendlen, recv+*rdispl);
+        return 0;
+    }
+
     /**
      * @brief Compute something over all processes
      * for each component of an array and return the result
@@ -593,6 +635,25 @@ public:
                               m_comm);
     }
 
+    /// @copydoc gsSerialComm::alltoall()
+    template<typename T>
+    int alltoall (T* send, T* recv, int len) const
+    {
+        return MPI_Alltoall(send,len,MPITraits<T>::getType(),
+                            recv,len,MPITraits<T>::getType(),
+                            m_comm);
+    }
+
+    /// @copydoc gsSerialComm::alltoallv()
+    template<typename T>
+    int alltoallv (T* send, int* sendlen, int* sdispl,
+                   T* recv, int* recvlen, int* rdispl) const
+    {
+        return MPI_Alltoallv(send,sendlen,sdispl,MPITraits<T>::getType(),
+                             recv,recvlen,rdispl,MPITraits<T>::getType(),
+                             m_comm);
+    }
+
 #ifndef MPI_IN_PLACE
  #define MPI_IN_PLACE inout
  #define MASK_MPI_IN_PLACE
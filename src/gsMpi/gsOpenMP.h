@@ -0,0 +1,124 @@
+/** @file gsOpenMP.h
+
+    @brief Provides declarations for using OpenMP within G+Smo.
+
+    If G+Smo is compiled without OpenMP support, trivial
+    implementations of the OpenMP runtime functions which are used in
+    the library are provided, so that the same code can be compiled
+    in both cases.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <exception>
+#include <stdexcept>
+#include <string>
+
+#ifdef _OPENMP
+#include <omp.h>
+#else
+
+namespace gismo
+{
+
+/// Returns the id of the calling thread (serial fallback)
+inline int  omp_get_thread_num()  { return 0; }
+
+/// Returns the number of threads in the current team (serial fallback)
+inline int  omp_get_num_threads() { return 1; }
+
+/// Returns the maximum number of threads (serial fallback)
+inline int  omp_get_max_threads() { return 1; }
+
+/// Sets the number of threads (serial fallback, does nothing)
+inline void omp_set_num_threads(int) { }
+
+/// Returns true if called inside a parallel region (serial fallback)
+inline int  omp_in_parallel()     { return 0; }
+
+} // namespace gismo
+
+#endif
+
+namespace gismo
+{
+
+namespace internal
+{
+
+/// Keeps the first exception thrown in the body of a parallel loop,
+/// which must not leave the parallel region, and throws it again
+/// after the loop. Without C++11 only its message is kept, and a
+/// std::runtime_error is thrown.
+class gsParallelError
+{
+public:
+
+#if __cplusplus >= 201103 || (defined(_MSC_VER) && _MSC_VER >= 1600)
+
+    /// Stores the exception being handled, to be called in a catch block
+    void store()
+    {
+        const std::exception_ptr error = std::current_exception();
+#       pragma omp critical (gsParallelError)
+        {
+            if ( !m_error )
+                m_error = error;
+        }
+    }
+
+    void rethrow() const
+    {
+        if ( m_error )
+            std::rethrow_exception(m_error);
+    }
+
+private:
+
+    std::exception_ptr m_error;
+
+#else
+
+    gsParallelError() : m_failed(false) { }
+
+    /// Stores the message of the exception being handled, to be
+    /// called in a catch block
+    void store()
+    {
+        std::string what;
+        try { throw; }
+        catch (std::exception & e) { what = e.what(); }
+        catch (...) { what = "Unknown error in a parallel region"; }
+#       pragma omp critical (gsParallelError)
+        {
+            if ( !m_failed )
+            {
+                m_failed = true;
+                m_what   = what;
+            }
+        }
+    }
+
+    void rethrow() const
+    {
+        if ( m_failed )
+            throw std::runtime_error(m_what);
+    }
+
+private:
+
+    bool        m_failed;
+    std::string m_what;
+
+#endif
+};
+
+} // namespace internal
+
+} // namespace gismo
@@ -48,6 +48,19 @@ public:
 
         typename gsKnotVector<T>::knotContainer knotValues;
 
+        if ( internal::isBase64(node) )
+        {
+            const gsXmlAttribute * at = node->first_attribute("scalar");
+            GISMO_ENSURE( at, "Scalar type of base64 knot values not found.");
+            const gsXmlNode * val = internal::base64Value(node);
+            knotValues.resize( internal::countXmlValues(val->value(),
+                                   val->value_size(), at->value()) );
+            internal::decodeXmlValues(val->value(), val->value_size(), at->value(),
+                                      knotValues.data(), knotValues.size());
+            result = gsKnotVector<T>(give(knotValues), p);
+            return;
+        }
+
         std::istringstream str;
         str.str( node->value() );
         for (T knot; gsGetReal(str, knot);)
@@ -60,16 +73,23 @@ public:
     {
         // Write the knot values (for now WITH multiplicities)
         std::ostringstream str;
-        str << std::setprecision(REAL_DIG+1);
-
-        for ( typename gsKnotVector<T>::iterator it = obj.begin();
-              it != obj.end(); ++it )
+        gsXmlNode * tmp;
+        if ( internal::useBase64<T>() )
+            tmp = internal::makeBase64Node("KnotVector", obj.data(), obj.size(), data);
+        else
         {
-            str << *it <<" ";
-        }
+            str << std::setprecision( xml::base64 == xml::defaultEncoding() ?
+                                      internal::exactDigits<T>() : REAL_DIG+1 );
 
-        // Make a new XML KnotVector node
-        gsXmlNode * tmp = internal::makeNode("KnotVector", str.str(), data);
+            for ( typename gsKnotVector<T>::iterator it = obj.begin();
+                  it != obj.end(); ++it )
+            {
+                str << *it <<" ";
+            }
+
+            // Make a new XML KnotVector node
+            tmp = internal::makeNode("KnotVector", str.str(), data);
+        }
         // Append the degree attribure
         str.str(std::string());// clean the ostream
         str<< obj.m_deg;
@@ -36,15 +36,14 @@ bool gsConjugateGradient::initIteration( const gsConjugateGradient::VectorType&
     m_tmp.resize(n,m);
     m_update.resize(n,m);
 
-    m_mat->apply(x,m_tmp);                                              // apply the system matrix
-    m_res = rhs - m_tmp;                                                // initial residual
-
-    m_error = m_res.norm() / m_rhs_norm;
+    m_mat->apply(x,m_res);                                              // apply the system matrix
+    m_error = math::sqrt( residualSquaredNorm(rhs, m_res) )             // initial residual
+              / m_rhs_norm;
     if (m_error < m_tol)
         return true;
 
     m_precond->apply(m_res,m_update);                                   // initial search direction
-    m_abs_new = m_res.col(0).dot(m_update.col(0));                      // the square of the absolute value of r scaled by invM
+    m_abs_new = dot(m_res, m_update);                                   // the square of the absolute value of r scaled by invM
 
     return false;
 }
@@ -54,14 +53,13 @@ bool gsConjugateGradient::step( gsConjugateGradient::VectorType& x )
 {
     m_mat->apply(m_update,m_tmp);                                      // apply system matrix
 
-    real_t alpha = m_abs_new / m_update.col(0).dot(m_tmp.col(0));      // the amount we travel on dir
+    real_t alpha = m_abs_new / dot(m_update, m_tmp);                   // the amount we travel on dir
     if (m_calcEigenvals)
         m_delta.back()+=(1./alpha);
 
-    x += alpha * m_update;                                             // update solution
-    m_res -= alpha * m_tmp;                                            // update residual
-
-    m_error = m_res.norm() / m_rhs_norm;
+    m_error = math::sqrt( updateAndSquaredNorm(alpha, m_update, x,          // update solution
+                                               m_tmp, m_res) )              // and residual
+              / m_rhs_norm;
     if (m_error < m_tol)
         return true;
 
@@ -69,9 +67,9 @@ bool gsConjugateGradient::step( gsConjugateGradient::VectorType& x )
 
     real_t abs_old = m_abs_new;
 
-    m_abs_new = m_res.col(0).dot(m_tmp.col(0));                        // update the absolute value of r
+    m_abs_new = dot(m_res, m_tmp);                                     // update the absolute value of r
     real_t beta = m_abs_new / abs_old;                                 // calculate the Gram-Schmidt value used to create the new search direction
-    m_update = m_tmp + beta * m_update;                                // update search direction
+    Kernels::xpby(m_tmp, beta, m_update);                              // update search direction
 
     if (m_calcEigenvals)
     {
@@ -26,7 +26,7 @@ bool gsGMRes::initIteration( const VectorType& rhs, VectorType& x )
     m_mat->apply(x,tmp);
     tmp = rhs - tmp;
     m_precond->apply(tmp, residual);
-    beta = residual.norm(); // This is  ||r||
+    beta = norm(residual); // This is  ||r||
 
     m_error = beta/m_rhs_norm;
     if(m_error < m_tol)
@@ -96,10 +96,10 @@ bool gsGMRes::step( VectorType& x )
 
     for (index_t i = 0; i< k+1; ++i)
     {
-        h_tmp(i,0) = (w.transpose()*v[i]).value(); //Typo h_l,k
-        w = w - h_tmp(i,0)*v[i];
+        h_tmp(i,0) = dot(w, v[i]); //Typo h_l,k
+        Kernels::axpy(-h_tmp(i,0), v[i], w);
     }
-    h_tmp(k+1,0) = w.norm();
+    h_tmp(k+1,0) = norm(w);
 
     if (math::abs(h_tmp(k+1,0)) < 1e-16) //If exact solution
         return true;
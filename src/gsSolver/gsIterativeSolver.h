@@ -29,6 +29,9 @@ public:
     typedef gsMatrix<T>    VectorType;
 
     typedef typename gsLinearOperator<T>::Ptr LinOpPtr;
+
+    /// Threaded vector kernels used in the iterations
+    typedef gsSolverKernels<T> Kernels;
     
     /// @brief Contructor using a linear operator to be solved for and
     ///  a preconditioner
@@ -173,7 +176,7 @@ public:
         
         m_num_iter = 0;
         
-        m_rhs_norm = rhs.norm();
+        m_rhs_norm = norm(rhs);
 
         if (0 == m_rhs_norm) // special case of zero rhs
         {
@@ -233,6 +236,47 @@ public:
         return os.str();
     }
 
+protected:
+
+    /// @name Reductions
+    /// The dot products and norms of the iterations, summed up over
+    /// the processes if the operator is distributed (see
+    /// gsLinearOperator::sumReduce())
+    /// @{
+
+    /// Returns the dot product of \a a and \a b
+    T dot(const VectorType & a, const VectorType & b) const
+    {
+        T result = Kernels::dot(a, b);
+        m_mat->sumReduce(&result, 1);
+        return result;
+    }
+
+    /// Returns the Euclidean norm of \a a
+    T norm(const VectorType & a) const
+    { return math::sqrt( dot(a, a) ); }
+
+    /// Returns the squared norm of \a rhs - \a Ax, which is
+    /// overwritten by the residual, see gsSolverKernels
+    T residualSquaredNorm(const VectorType & rhs, VectorType & Ax) const
+    {
+        T result = Kernels::residualSquaredNorm(rhs, Ax);
+        m_mat->sumReduce(&result, 1);
+        return result;
+    }
+
+    /// Updates \a x and \a r, returns the squared norm of the updated
+    /// \a r, see gsSolverKernels
+    T updateAndSquaredNorm(T alpha, const VectorType & p, VectorType & x,
+                           const VectorType & Ap, VectorType & r) const
+    {
+        T result = Kernels::updateAndSquaredNorm(alpha, p, x, Ap, r);
+        m_mat->sumReduce(&result, 1);
+        return result;
+    }
+
+    /// @}
+
 protected:
     const LinOpPtr m_mat;             ///< The matrix/operator to be solved for
     LinOpPtr       m_precond;         ///< The preconditioner
@@ -0,0 +1,264 @@
+/** @file gsKroneckerOp.h
+
+    @brief Kronecker products of linear operators and solvers for
+    tensor-product systems.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#pragma once
+
+#include <gsSolver/gsLinearOperator.h>
+#include <gsTensor/gsTensorTools.h>
+
+namespace gismo
+{
+
+namespace internal
+{
+
+/// Linear operators as factors of gsApplyKroneckerProduct
+template<class T>
+struct gsKroneckerFactor< memory::shared_ptr< gsLinearOperator<T> > >
+{
+    typedef memory::shared_ptr< gsLinearOperator<T> > Factor;
+
+    static index_t rows(const Factor & f) { return f->rows(); }
+    static index_t cols(const Factor & f) { return f->cols(); }
+
+    static void apply(const Factor & f, const gsMatrix<T> & in, gsMatrix<T> & out)
+    { f->apply(in, out); }
+};
+
+} // namespace internal
+
+/**
+   @brief The Kronecker product \f$ A_{d-1} \otimes \cdots \otimes A_0 \f$
+   of linear operators, applied without forming the product.
+
+   The entries of the vectors are numbered as the functions of a
+   tensor-product basis (gsTensorBasis), ie. the first index runs
+   fastest, and the operator \f$ A_k \f$ acts on the index in
+   direction \a k. The product is applied direction by direction,
+   every factor being applied once to all fibers of the tensor in its
+   direction. Its cost is \f$ \sum_k (N/n_k) c_k \f$ where \f$ c_k \f$
+   is the cost of one application of \f$ A_k \f$, eg.
+   \f$ O(N^{1+1/d}) \f$ for dense factors.
+
+   Since the inverse of a Kronecker product is the Kronecker product
+   of the inverses, a tensor-product system (eg. the mass or the
+   collocation matrix of a tensor-product B-spline basis on its
+   parameter domain) is solved by a gsKroneckerOp of solvers, see
+   makeKroneckerSolver() and makeTensorMassSolver(). Such an operator
+   can also serve as a preconditioner, eg. for gsConjugateGradient.
+
+   The operator can be applied to several columns at once.
+
+   \ingroup Solver
+*/
+template<class T = real_t>
+class gsKroneckerOp : public gsLinearOperator<T>
+{
+public:
+
+    /// Shared pointer for gsKroneckerOp
+    typedef memory::shared_ptr<gsKroneckerOp> Ptr;
+
+    /// Unique pointer for gsKroneckerOp
+    typedef memory::unique_ptr<gsKroneckerOp> uPtr;
+
+    /// Shared pointer for gsLinearOperator
+    typedef typename gsLinearOperator<T>::Ptr BasePtr;
+
+    /// Constructor taking the factors, ops[k] acting in direction k
+    explicit gsKroneckerOp(const std::vector<BasePtr> & ops)
+    : m_ops(ops)
+    {
+        GISMO_ASSERT( ! m_ops.empty(), "At least one factor is needed");
+    }
+
+    /// Constructor for two factors, op0 acting in the first direction
+    gsKroneckerOp(const BasePtr & op0, const BasePtr & op1)
+    : m_ops(2)
+    {
+        m_ops[0] = op0;
+        m_ops[1] = op1;
+    }
+
+    /// Constructor for three factors, op0 acting in the first direction
+    gsKroneckerOp(const BasePtr & op0, const BasePtr & op1, const BasePtr & op2)
+    : m_ops(3)
+    {
+        m_ops[0] = op0;
+        m_ops[1] = op1;
+        m_ops[2] = op2;
+    }
+
+    /// Make function returning a smart pointer
+    static uPtr make(const std::vector<BasePtr> & ops)
+    { return memory::make_unique( new gsKroneckerOp(ops) ); }
+
+    /// Make function returning a smart pointer
+    static uPtr make(const BasePtr & op0, const BasePtr & op1)
+    { return memory::make_unique( new gsKroneckerOp(op0, op1) ); }
+
+    /// Make function returning a smart pointer
+    static uPtr make(const BasePtr & op0, const BasePtr & op1, const BasePtr & op2)
+    { return memory::make_unique( new gsKroneckerOp(op0, op1, op2) ); }
+
+    void apply(const gsMatrix<T> & input, gsMatrix<T> & x) const
+    { apply(m_ops, input, x); }
+
+    /// Applies the Kronecker product of \a ops to (every column of)
+    /// \a input and stores the result in \a x, see
+    /// gsApplyKroneckerProduct()
+    static void apply(const std::vector<BasePtr> & ops,
+                      const gsMatrix<T> & input, gsMatrix<T> & x)
+    { gsApplyKroneckerProduct(ops, input, x); }
+
+    index_t rows() const
+    {
+        index_t result = 1;
+        for (size_t k = 0; k != m_ops.size(); ++k)
+            result *= m_ops[k]->rows();
+        return result;
+    }
+
+    index_t cols() const
+    {
+        index_t result = 1;
+        for (size_t k = 0; k != m_ops.size(); ++k)
+            result *= m_ops[k]->cols();
+        return result;
+    }
+
+    /// Returns the factors
+    const std::vector<BasePtr> & parts() const { return m_ops; }
+
+private:
+
+    std::vector<BasePtr> m_ops;
+};
+
+/**
+   @brief Inverse of the Kronecker sum
+   \f$ \sum_k M_{d-1} \otimes \cdots \otimes K_k \otimes \cdots \otimes M_0 \f$
+   by fast diagonalization.
+
+   For symmetric matrices \f$ K_k \f$ and symmetric positive definite
+   \f$ M_k \f$, the generalized eigenproblems
+   \f$ K_k U_k = M_k U_k \Lambda_k \f$ with
+   \f$ U_k^T M_k U_k = I \f$ give the inverse
+   \f$ (U_{d-1} \otimes \cdots \otimes U_0) D^{-1}
+   (U_{d-1} \otimes \cdots \otimes U_0)^T \f$, \f$ D \f$ being the
+   diagonal matrix of the sums of the eigenvalues. With the univariate
+   stiffness and mass matrices of a tensor-product basis, this is the
+   inverse of the stiffness matrix of the Laplacian on the parameter
+   domain, which is a good preconditioner for the stiffness matrix of
+   a patch. The vectors are numbered as for gsKroneckerOp.
+
+   Only the univariate eigenproblems are solved (as dense matrices),
+   one application costs \f$ O(N^{1+1/d}) \f$ operations.
+
+   \ingroup Solver
+*/
+template<class T = real_t>
+class gsFastDiagonalizationOp : public gsLinearOperator<T>
+{
+public:
+
+    /// Shared pointer for gsFastDiagonalizationOp
+    typedef memory::shared_ptr<gsFastDiagonalizationOp> Ptr;
+
+    /// Unique pointer for gsFastDiagonalizationOp
+    typedef memory::unique_ptr<gsFastDiagonalizationOp> uPtr;
+
+    /// @brief Constructor taking the factors, stiff[k] and mass[k]
+    /// acting in direction k. The operator is multiplied by
+    /// \a scaling, ie. it inverts the Kronecker sum times 1/scaling
+    gsFastDiagonalizationOp(const std::vector< gsMatrix<T> > & stiff,
+                            const std::vector< gsMatrix<T> > & mass,
+                            T scaling = 1);
+
+    /// Make function returning a smart pointer
+    static uPtr make(const std::vector< gsMatrix<T> > & stiff,
+                     const std::vector< gsMatrix<T> > & mass,
+                     T scaling = 1)
+    { return memory::make_unique( new gsFastDiagonalizationOp(stiff, mass, scaling) ); }
+
+    void apply(const gsMatrix<T> & input, gsMatrix<T> & x) const;
+
+    index_t rows() const { return m_diag.size(); }
+
+    index_t cols() const { return m_diag.size(); }
+
+    /// @brief Returns the diagonal of the Kronecker sum given by
+    /// \a stiff and \a mass, see gsFastDiagonalizationOp()
+    static void kroneckerSumDiagonal(const std::vector< gsMatrix<T> > & stiff,
+                                     const std::vector< gsMatrix<T> > & mass,
+                                     gsVector<T> & result);
+
+private:
+
+    /// The eigenvectors and their transposes, as gsKroneckerOp factors
+    std::vector<typename gsLinearOperator<T>::Ptr> m_U, m_Ut;
+
+    /// Inverse of the sums of the eigenvalues, times the scaling
+    gsVector<T> m_diag;
+};
+
+/**
+   @brief Returns the inverse of the Kronecker product of the square
+   matrices \a mats as a gsKroneckerOp of sparse LU solvers.
+
+   mats[k] acts in direction \a k, see gsKroneckerOp. Only the small
+   matrices are factorized; the cost of a solve is linear in the
+   number of unknowns for banded factors.
+
+   \ingroup Solver
+*/
+template<class T>
+typename gsKroneckerOp<T>::uPtr
+makeKroneckerSolver(const std::vector< gsSparseMatrix<T> > & mats);
+
+/**
+   @brief Returns the inverse of the mass matrix of the tensor-product
+   basis \a basis on its parameter domain, as a gsKroneckerOp of
+   solvers for the univariate mass matrices.
+
+   \a basis must be a gsTensorBasis (eg. gsTensorBSplineBasis) of
+   dimension at most four. On a patch with (nearly) constant Jacobian
+   determinant, the operator is a good preconditioner for the mass
+   matrix of the patch.
+
+   \ingroup Solver
+*/
+template<class T>
+typename gsKroneckerOp<T>::uPtr makeTensorMassSolver(const gsBasis<T> & basis);
+
+/**
+   @brief Computes the mass matrix of the univariate basis \a basis
+   by Gauss quadrature.
+
+   \ingroup Solver
+*/
+template<class T>
+void univariateMassMatrix(const gsBasis<T> & basis, gsSparseMatrix<T> & result);
+
+/**
+   @brief Computes the stiffness matrix \f$ \int B_i' B_j' \f$ of
+   the univariate basis \a basis by Gauss quadrature.
+
+   \ingroup Solver
+*/
+template<class T>
+void univariateStiffnessMatrix(const gsBasis<T> & basis, gsSparseMatrix<T> & result);
+
+} // namespace gismo
+
+#ifndef GISMO_BUILD_LIB
+#include GISMO_HPP_HEADER(gsKroneckerOp.hpp)
+#endif
@@ -0,0 +1,187 @@
+/** @file gsKroneckerOp.hpp
+
+    @brief Kronecker products of linear operators and solvers for
+    tensor-product systems.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#pragma once
+
+#include <gsSolver/gsKroneckerOp.h>
+#include <gsSolver/gsMatrixOp.h>
+#include <gsTensor/gsTensorBasis.h>
+#include <gsCore/gsDomainIterator.h>
+#include <gsAssembler/gsGaussRule.h>
+
+namespace gismo
+{
+
+template<class T>
+gsFastDiagonalizationOp<T>::gsFastDiagonalizationOp(const std::vector< gsMatrix<T> > & stiff,
+                                                    const std::vector< gsMatrix<T> > & mass,
+                                                    T scaling)
+: m_U(stiff.size()), m_Ut(stiff.size())
+{
+    GISMO_ASSERT( stiff.size() == mass.size() && ! stiff.empty(),
+                  "Need one stiffness and one mass matrix per direction");
+    std::vector< gsMatrix<T> > eigs(stiff.size());
+    for (size_t k = 0; k != stiff.size(); ++k)
+    {
+        GISMO_ASSERT( stiff[k].rows() == mass[k].rows() && stiff[k].rows() == stiff[k].cols()
+                      && mass[k].rows() == mass[k].cols(), "Invalid matrices in direction "<<k);
+        typename gsMatrix<T>::GenSelfAdjEigenSolver ges(stiff[k], mass[k]);
+        GISMO_ENSURE( ges.info() == Eigen::Success,
+                      "Eigenproblem failed in direction "<< k);
+        gsMatrix<T> * U  = new gsMatrix<T>(ges.eigenvectors());
+        gsMatrix<T> * Ut = new gsMatrix<T>(U->transpose());
+        m_U [k] = makeMatrixOp( memory::shared_ptr< gsMatrix<T> >(U ) );
+        m_Ut[k] = makeMatrixOp( memory::shared_ptr< gsMatrix<T> >(Ut) );
+
+        // In the eigenbasis the factors are the identity and the
+        // diagonal of the eigenvalues
+        eigs[k] = ges.eigenvalues().asDiagonal();
+    }
+
+    std::vector< gsMatrix<T> > ids(stiff.size());
+    for (size_t k = 0; k != stiff.size(); ++k)
+        ids[k].setIdentity(stiff[k].rows(), stiff[k].rows());
+    kroneckerSumDiagonal(eigs, ids, m_diag);
+    m_diag = m_diag.cwiseInverse() / scaling;
+}
+
+template<class T>
+void gsFastDiagonalizationOp<T>::apply(const gsMatrix<T> & input, gsMatrix<T> & x) const
+{
+    gsMatrix<T> tmp;
+    gsKroneckerOp<T>::apply(m_Ut, input, tmp);
+    tmp = m_diag.asDiagonal() * tmp;
+    gsKroneckerOp<T>::apply(m_U, tmp, x);
+}
+
+template<class T>
+void gsFastDiagonalizationOp<T>::kroneckerSumDiagonal(const std::vector< gsMatrix<T> > & stiff,
+                                                      const std::vector< gsMatrix<T> > & mass,
+                                                      gsVector<T> & result)
+{
+    const index_t d = stiff.size();
+    gsVector<index_t> sz(d), idx(d);
+    for (index_t k = 0; k != d; ++k)
+        sz[k] = stiff[k].rows();
+    idx.setZero();
+
+    result.resize(sz.prod());
+    for (index_t t = 0; t != result.size(); ++t)
+    {
+        T sum = 0;
+        for (index_t k = 0; k != d; ++k)
+        {
+            T prod = stiff[k](idx[k], idx[k]);
+            for (index_t l = 0; l != d; ++l)
+                if ( l != k )
+                    prod *= mass[l](idx[l], idx[l]);
+            sum += prod;
+        }
+        result[t] = sum;
+
+        // Next multi-index, the first one running fastest
+        for (index_t k = 0; k != d && ++idx[k] == sz[k]; ++k)
+            idx[k] = 0;
+    }
+}
+
+template<class T>
+typename gsKroneckerOp<T>::uPtr
+makeKroneckerSolver(const std::vector< gsSparseMatrix<T> > & mats)
+{
+    std::vector<typename gsLinearOperator<T>::Ptr> ops(mats.size());
+    for (size_t k = 0; k != mats.size(); ++k)
+    {
+        GISMO_ASSERT( mats[k].rows() == mats[k].cols(), "Need square matrices");
+        gsSparseMatrix<T> m = mats[k];
+        m.makeCompressed();
+        ops[k] = makeSparseLUSolver(m);
+    }
+    return gsKroneckerOp<T>::make(ops);
+}
+
+namespace internal
+{
+
+// Gram matrix of the values (der = false) or of the derivatives of a
+// univariate basis
+template<class T>
+void univariateGramMatrix(const gsBasis<T> & basis, bool der,
+                          gsSparseMatrix<T> & result)
+{
+    GISMO_ASSERT( 1 == basis.dim(), "Need a univariate basis");
+    gsGaussRule<T> quad(basis.maxDegree() + 1);
+    gsMatrix<T> nodes, vals;
+    gsVector<T> weights;
+    gsMatrix<unsigned> act;
+    gsSparseEntries<T> entries;
+
+    const typename gsBasis<T>::domainIter it = basis.makeDomainIterator();
+    for (; it->good(); it->next())
+    {
+        quad.mapTo(it->lowerCorner(), it->upperCorner(), nodes, weights);
+        if ( der )
+            basis.deriv_into(nodes, vals);
+        else
+            basis.eval_into(nodes, vals);
+        basis.active_into(it->centerPoint(), act);
+        const gsMatrix<T> loc = vals * weights.asDiagonal() * vals.transpose();
+        for (index_t i = 0; i != act.rows(); ++i)
+            for (index_t j = 0; j != act.rows(); ++j)
+                entries.add(act(i,0), act(j,0), loc(i,j));
+    }
+
+    result.resize(basis.size(), basis.size());
+    result.setFrom(entries);
+    result.makeCompressed();
+}
+
+} // namespace internal
+
+template<class T>
+void univariateMassMatrix(const gsBasis<T> & basis, gsSparseMatrix<T> & result)
+{ internal::univariateGramMatrix(basis, false, result); }
+
+template<class T>
+void univariateStiffnessMatrix(const gsBasis<T> & basis, gsSparseMatrix<T> & result)
+{ internal::univariateGramMatrix(basis, true, result); }
+
+namespace internal
+{
+
+template<unsigned d, class T>
+bool tensorMassMatrices(const gsBasis<T> & basis, std::vector< gsSparseMatrix<T> > & mats)
+{
+    const gsTensorBasis<d,T> * tb = dynamic_cast<const gsTensorBasis<d,T> *>(&basis);
+    if ( NULL == tb )
+        return false;
+    mats.resize(d);
+    for (unsigned k = 0; k != d; ++k)
+        univariateMassMatrix(tb->component(k), mats[k]);
+    return true;
+}
+
+} // namespace internal
+
+template<class T>
+typename gsKroneckerOp<T>::uPtr makeTensorMassSolver(const gsBasis<T> & basis)
+{
+    std::vector< gsSparseMatrix<T> > mats;
+    const bool isTensor =
+        internal::tensorMassMatrices<1,T>(basis, mats) ||
+        internal::tensorMassMatrices<2,T>(basis, mats) ||
+        internal::tensorMassMatrices<3,T>(basis, mats) ||
+        internal::tensorMassMatrices<4,T>(basis, mats);
+    GISMO_ENSURE( isTensor, "makeTensorMassSolver needs a tensor-product basis");
+    return makeKroneckerSolver(mats);
+}
+
+} // namespace gismo
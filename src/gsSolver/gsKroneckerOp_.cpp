@@ -0,0 +1,22 @@
+#include <gsCore/gsTemplateTools.h>
+
+#include <gsSolver/gsKroneckerOp.h>
+#include <gsSolver/gsKroneckerOp.hpp>
+
+namespace gismo
+{
+
+CLASS_TEMPLATE_INST gsKroneckerOp<real_t>;
+
+CLASS_TEMPLATE_INST gsFastDiagonalizationOp<real_t>;
+
+TEMPLATE_INST gsKroneckerOp<real_t>::uPtr
+makeKroneckerSolver(const std::vector< gsSparseMatrix<real_t> > & mats);
+
+TEMPLATE_INST gsKroneckerOp<real_t>::uPtr makeTensorMassSolver(const gsBasis<real_t> & basis);
+
+TEMPLATE_INST void univariateMassMatrix(const gsBasis<real_t> & basis, gsSparseMatrix<real_t> & result);
+
+TEMPLATE_INST void univariateStiffnessMatrix(const gsBasis<real_t> & basis, gsSparseMatrix<real_t> & result);
+
+} // namespace gismo
@@ -53,6 +53,16 @@ public:
     /// Returns the number of columns of the operator
     virtual index_t cols() const = 0;
 
+    /// @brief Sums up the \a n entries of \a values over the processes
+    /// which share the operator, in place.
+    ///
+    /// A distributed operator (eg. gsDistributedMatrix) acts on the
+    /// parts of the vectors which are owned by the process. The
+    /// iterative solvers call this function to turn their local dot
+    /// products and norms into global ones. This implementation does
+    /// nothing.
+    virtual void sumReduce(T * /*values*/, index_t /*n*/) const { }
+
     // NOTE: this is rather inefficient and is only provided for debugging and testing purposes
     void toMatrix(gsMatrix<T>& result)
     {
@@ -14,6 +14,7 @@
 
 #include <gsCore/gsLinearAlgebra.h>
 #include <gsSolver/gsLinearOperator.h>
+#include <gsSolver/gsSolverKernels.h>
 
 namespace gismo
 {
@@ -76,7 +77,7 @@ public:
         if (m_symmetric)
             x.noalias() = m_expr.template selfadjointView<Lower>() * input;
         else
-            x.noalias() = m_expr * input;
+            multiply(m_expr, input, x);
     }
 
     index_t rows() const {return m_expr.rows();}
@@ -86,6 +87,24 @@ public:
     ///Returns the matrix
     NestedMatrix matrix() const { return m_expr; }
 
+private:
+
+    template<class Derived>
+    static void multiply(const Eigen::EigenBase<Derived> & mat,
+                         const gsMatrix<T> & input, gsMatrix<T> & x)
+    { x.noalias() = mat.derived() * input; }
+
+    // Sparse matrices are multiplied by the threaded kernel
+    template<int _Opt, typename _Index>
+    static void multiply(const Eigen::SparseMatrix<T,_Opt,_Index> & mat,
+                         const gsMatrix<T> & input, gsMatrix<T> & x)
+    {
+        if ( 1 == input.cols() )
+            gsSolverKernels<T>::spmv(mat, input, x);
+        else
+            x.noalias() = mat * input;
+    }
+
 private:
     const MatrixPtr m_mat; ///< Shared pointer to matrix (if needed)
     NestedMatrix   m_expr; ///< Nested Eigen expression
@@ -0,0 +1,180 @@
+/** @file gsMultiGrid.h
+
+    @brief Geometric multigrid solver and preconditioner
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#pragma once
+
+#include <gsSolver/gsSimpleOps.h>
+#include <gsSolver/gsMatrixOp.h>
+#include <gsCore/gsMultiBasis.h>
+
+namespace gismo
+{
+
+/**
+   @brief Geometric multigrid method on a hierarchy of nested spline
+   spaces.
+
+   The hierarchy is given by the system matrix on the finest level
+   and the transfer (prolongation) matrices between consecutive
+   levels, as produced by gsMultiBasis::uniformRefine_withTransfer.
+   The coarse operators are the Galerkin products
+   \f$ A_{\ell-1} = P_\ell^T A_\ell P_\ell \f$, the problem on the
+   coarsest level is solved by a sparse direct solver.
+
+   The operator performs one multigrid cycle (V-cycle, or W-cycle for
+   NumCycles = 2) per step(). It can therefore be used as a solver, by
+   setting the number of sweeps, or as a preconditioner, eg. for
+   gsConjugateGradient. In the latter case the smoother should be
+   symmetric (Jacobi or SymmetricGaussSeidel).
+
+   Example:
+   \code
+   gsMultiBasis<> bases(patches);
+   std::vector< gsSparseMatrix<real_t,RowMajor> > transfers;
+   gsMultiGridOp<>::buildHierarchy(bases, bc, assemblerOptions, 4, transfers);
+   // ... assemble the matrix A on the refined bases
+   gsMultiGridOp<>::Ptr mg = gsMultiGridOp<>::make(A, transfers);
+   gsConjugateGradient cg(A, mg);
+   \endcode
+
+   \ingroup Solver
+*/
+template<class T = real_t>
+class gsMultiGridOp : public gsSteppableOperator<T>
+{
+public:
+
+    /// Shared pointer for gsMultiGridOp
+    typedef memory::shared_ptr<gsMultiGridOp> Ptr;
+
+    /// Unique pointer for gsMultiGridOp
+    typedef memory::unique_ptr<gsMultiGridOp> uPtr;
+
+    /// Base class
+    typedef gsSteppableOperator<T> Base;
+
+    /// Matrix type of the system matrices
+    typedef gsSparseMatrix<T> SpMatrix;
+
+    /// Matrix type of the transfer matrices
+    typedef gsSparseMatrix<T,RowMajor> SpMatrixRowMajor;
+
+    /// Shared pointer to a system matrix
+    typedef memory::shared_ptr<SpMatrix> SpMatrixPtr;
+
+public:
+
+    /**
+       @brief Constructor
+
+       @param fineMatrix the system matrix on the finest level
+       @param transferMatrices transferMatrices[i] maps level i to
+       level i+1, where level 0 is the coarsest one
+       @param opt options, see defaultOptions()
+    */
+    gsMultiGridOp(const SpMatrix & fineMatrix,
+                  const std::vector<SpMatrixRowMajor> & transferMatrices,
+                  const gsOptionList & opt = defaultOptions());
+
+    /// Make function returning a smart pointer
+    static uPtr make(const SpMatrix & fineMatrix,
+                     const std::vector<SpMatrixRowMajor> & transferMatrices,
+                     const gsOptionList & opt = defaultOptions())
+    { return memory::make_unique( new gsMultiGridOp(fineMatrix, transferMatrices, opt) ); }
+
+    /**
+       @brief Refines \a bases uniformly \a numLevels-1 times and
+       stores the transfer matrices of the resulting grid hierarchy.
+
+       The given \a bases are the coarsest level, after the call they
+       are the finest one. The degrees of freedom are numbered
+       according to the Dirichlet and interface strategies of the
+       assembler options \a assemblerOptions (see
+       gsAssembler::defaultOptions).
+    */
+    static void buildHierarchy(gsMultiBasis<T> & bases,
+                               const gsBoundaryConditions<T> & bc,
+                               const gsOptionList & assemblerOptions,
+                               index_t numLevels,
+                               std::vector<SpMatrixRowMajor> & transferMatrices);
+
+public:
+
+    /// Performs one multigrid cycle for the right-hand side \a rhs,
+    /// updating the iterate \a x
+    void step(const gsMatrix<T> & rhs, gsMatrix<T> & x) const
+    { multiGridStep(numLevels() - 1, rhs, x); }
+
+    index_t rows() const { return m_ops.back()->rows(); }
+    index_t cols() const { return m_ops.back()->cols(); }
+
+    /// Returns the number of levels
+    index_t numLevels() const { return m_ops.size(); }
+
+    /// Returns the system matrix on level \a lvl (0 is the coarsest)
+    const SpMatrix & matrix(index_t lvl) const { return *m_ops[lvl]; }
+
+    /// Returns the transfer matrix from level \a lvl-1 to level \a lvl
+    const SpMatrixRowMajor & prolongation(index_t lvl) const
+    { return m_prolong[lvl-1]; }
+
+    /// Sets the smoother on level \a lvl (1 <= lvl < numLevels())
+    void setSmoother(index_t lvl, const typename Base::Ptr & sm)
+    {
+        GISMO_ASSERT( lvl > 0 && lvl < numLevels(), "Invalid level");
+        m_smoother[lvl] = sm;
+    }
+
+    /// Sets the solver on the coarsest level
+    void setCoarseSolver(const typename gsLinearOperator<T>::Ptr & solver)
+    { m_coarseSolver = solver; }
+
+    /// Get the default options as gsOptionList object
+    static gsOptionList defaultOptions();
+
+    /// Set options based on a gsOptionList object
+    virtual void setOptions(const gsOptionList & opt);
+
+private:
+
+    /// Performs one cycle on level \a lvl
+    void multiGridStep(index_t lvl, const gsMatrix<T> & rhs, gsMatrix<T> & x) const;
+
+    /// Creates the smoothers of type \a m_smootherType
+    void createSmoothers();
+
+private:
+
+    using Base::m_num_of_sweeps;
+
+    /// System matrices, from the coarsest to the finest level
+    std::vector<SpMatrixPtr> m_ops;
+
+    /// Transfer matrices, m_prolong[i] maps level i to level i+1
+    std::vector<SpMatrixRowMajor> m_prolong;
+
+    /// Smoothers on each level (the entry of the coarsest level is unused)
+    std::vector<typename Base::Ptr> m_smoother;
+
+    /// Direct solver on the coarsest level
+    typename gsLinearOperator<T>::Ptr m_coarseSolver;
+
+    std::string m_smootherType;
+    index_t     m_numPreSmooth;
+    index_t     m_numPostSmooth;
+    index_t     m_numCycles;
+    T           m_damping;
+};
+
+} // namespace gismo
+
+#ifndef GISMO_BUILD_LIB
+#include GISMO_HPP_HEADER(gsMultiGrid.hpp)
+#endif
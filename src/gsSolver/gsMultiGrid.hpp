@@ -0,0 +1,148 @@
+/** @file gsMultiGrid.hpp
+
+    @brief Geometric multigrid solver and preconditioner
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#pragma once
+
+#include <gsSolver/gsMultiGrid.h>
+
+namespace gismo
+{
+
+template<class T>
+gsMultiGridOp<T>::gsMultiGridOp(const SpMatrix & fineMatrix,
+                                const std::vector<SpMatrixRowMajor> & transferMatrices,
+                                const gsOptionList & opt)
+: m_prolong(transferMatrices),
+  m_smootherType("SymmetricGaussSeidel"),
+  m_numPreSmooth(1), m_numPostSmooth(1), m_numCycles(1), m_damping(0.8)
+{
+    const index_t nLevels = transferMatrices.size() + 1;
+    m_ops.resize(nLevels);
+    m_ops[nLevels-1] = memory::make_shared( new SpMatrix(fineMatrix) );
+
+    // Galerkin projection of the operator to the coarser levels
+    for (index_t i = nLevels - 2; i >= 0; --i)
+    {
+        const SpMatrixRowMajor & P = m_prolong[i];
+        GISMO_ENSURE( P.rows() == m_ops[i+1]->rows(),
+                      "Transfer matrix "<<i<<" does not match the operator on level "<<i+1);
+        m_ops[i] = memory::make_shared( new SpMatrix( P.transpose() * (*m_ops[i+1] * P) ) );
+        m_ops[i]->makeCompressed();
+    }
+
+    m_coarseSolver = typename gsLinearOperator<T>::Ptr( makeSparseLUSolver(m_ops.front()).release() );
+
+    Base::setOptions(opt);
+    m_smootherType  = opt.askString("Smoother"     , m_smootherType );
+    m_numPreSmooth  = opt.askInt   ("NumPreSmooth" , m_numPreSmooth );
+    m_numPostSmooth = opt.askInt   ("NumPostSmooth", m_numPostSmooth);
+    m_numCycles     = opt.askInt   ("NumCycles"    , m_numCycles    );
+    m_damping       = opt.askReal  ("Damping"      , m_damping      );
+    createSmoothers();
+}
+
+template<class T>
+void gsMultiGridOp<T>::buildHierarchy(gsMultiBasis<T> & bases,
+                                      const gsBoundaryConditions<T> & bc,
+                                      const gsOptionList & assemblerOptions,
+                                      index_t numLevels,
+                                      std::vector<SpMatrixRowMajor> & transferMatrices)
+{
+    GISMO_ASSERT( numLevels > 0, "At least one level is needed");
+    const dirichlet::strategy ds = static_cast<dirichlet::strategy>(
+        assemblerOptions.getInt("DirichletStrategy") );
+    const iFace::strategy     is = static_cast<iFace::strategy>(
+        assemblerOptions.getInt("InterfaceStrategy") );
+
+    transferMatrices.resize(numLevels - 1);
+    for (index_t i = 0; i < numLevels - 1; ++i)
+        bases.uniformRefine_withTransfer(transferMatrices[i], bc, ds, is);
+}
+
+template<class T>
+gsOptionList gsMultiGridOp<T>::defaultOptions()
+{
+    gsOptionList opt = Base::defaultOptions();
+    opt.addString("Smoother"     , "Smoother: Jacobi, GaussSeidel or SymmetricGaussSeidel", "SymmetricGaussSeidel");
+    opt.addInt   ("NumPreSmooth" , "Number of pre-smoothing steps" , 1);
+    opt.addInt   ("NumPostSmooth", "Number of post-smoothing steps", 1);
+    opt.addInt   ("NumCycles"    , "Number of coarse grid corrections per level: 1 for V-cycle, 2 for W-cycle", 1);
+    opt.addReal  ("Damping"      , "Damping parameter of the Jacobi smoother", 0.8);
+    return opt;
+}
+
+template<class T>
+void gsMultiGridOp<T>::setOptions(const gsOptionList & opt)
+{
+    Base::setOptions(opt);
+    const std::string smootherType = opt.askString("Smoother", m_smootherType);
+    const T           damping      = opt.askReal  ("Damping" , m_damping     );
+    m_numPreSmooth  = opt.askInt("NumPreSmooth" , m_numPreSmooth );
+    m_numPostSmooth = opt.askInt("NumPostSmooth", m_numPostSmooth);
+    m_numCycles     = opt.askInt("NumCycles"    , m_numCycles    );
+
+    if ( smootherType != m_smootherType || damping != m_damping )
+    {
+        m_smootherType = smootherType;
+        m_damping      = damping;
+        createSmoothers();
+    }
+}
+
+template<class T>
+void gsMultiGridOp<T>::createSmoothers()
+{
+    m_smoother.resize(numLevels());
+    for (index_t i = 1; i < numLevels(); ++i)
+    {
+        if ( m_smootherType == "Jacobi" )
+        {
+            typename gsJacobiOp<SpMatrix>::uPtr sm = gsJacobiOp<SpMatrix>::make(m_ops[i]);
+            sm->setScaling(m_damping);
+            m_smoother[i] = typename Base::Ptr( sm.release() );
+        }
+        else if ( m_smootherType == "GaussSeidel" )
+            m_smoother[i] = typename Base::Ptr( gsGaussSeidelOp<SpMatrix>::make(m_ops[i]).release() );
+        else if ( m_smootherType == "SymmetricGaussSeidel" )
+            m_smoother[i] = typename Base::Ptr( gsSymmetricGaussSeidelOp<SpMatrix>::make(m_ops[i]).release() );
+        else
+            GISMO_ERROR("Unknown smoother: "<< m_smootherType);
+    }
+}
+
+template<class T>
+void gsMultiGridOp<T>::multiGridStep(index_t lvl, const gsMatrix<T> & rhs,
+                                     gsMatrix<T> & x) const
+{
+    if ( 0 == lvl )
+    {
+        m_coarseSolver->apply(rhs, x);
+        return;
+    }
+
+    const SpMatrix         & A = *m_ops[lvl];
+    const SpMatrixRowMajor & P = m_prolong[lvl-1];
+
+    for (index_t i = 0; i < m_numPreSmooth; ++i)
+        m_smoother[lvl]->step(rhs, x);
+
+    // Coarse grid correction
+    const gsMatrix<T> coarseRhs = P.transpose() * (rhs - A * x);
+    gsMatrix<T> coarseCorr;
+    coarseCorr.setZero(P.cols(), rhs.cols());
+    for (index_t i = 0; i < m_numCycles; ++i)
+        multiGridStep(lvl - 1, coarseRhs, coarseCorr);
+    x.noalias() += P * coarseCorr;
+
+    for (index_t i = 0; i < m_numPostSmooth; ++i)
+        m_smoother[lvl]->step(rhs, x);
+}
+
+} // namespace gismo
@@ -0,0 +1,19 @@
+/** @file gsMultiGrid_.cpp
+
+    @brief Geometric multigrid solver and preconditioner
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <gsSolver/gsMultiGrid.hpp>
+
+namespace gismo
+{
+
+CLASS_TEMPLATE_INST gsMultiGridOp<real_t>;
+
+} // namespace gismo
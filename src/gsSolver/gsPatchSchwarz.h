@@ -0,0 +1,187 @@
+/** @file gsPatchSchwarz.h
+
+    @brief Patch-wise additive Schwarz preconditioner for multipatch
+    systems.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#pragma once
+
+#include <gsSolver/gsLinearOperator.h>
+#include <gsCore/gsMultiBasis.h>
+#include <gsCore/gsDofMapper.h>
+
+namespace gismo
+{
+
+/**
+   @brief Two-level additive Schwarz preconditioner whose subdomains
+   are the patches of a multipatch domain.
+
+   The subdomain of a patch consists of the free degrees of freedom
+   (dofs) of its basis, including the ones on its interfaces, which
+   are therefore shared with the neighbouring patches. With the option
+   "Overlap" > 0 the subdomains are extended by further layers of
+   dofs, following the graph of the matrix. The preconditioner is
+   \f[ P^{-1} = R_0^T A_0^{-1} R_0 + \sum_k R_k^T A_k^{-1} R_k, \f]
+   where \f$ R_k \f$ restricts to subdomain \a k and
+   \f$ A_k = R_k A R_k^T \f$.
+
+   The coarse space has one function per patch vertex. On every patch
+   it is the multilinear function which is one at the vertex and zero
+   at the other vertices of the patch, interpolated at the anchors
+   (Greville points) of the basis, such that the coarse functions of
+   a vertex shared by several patches are glued across the
+   interfaces. Together they reproduce the constants, and
+   \f$ A_0 = R_0 A R_0^T \f$. With the coarse space, the number of
+   iterations of a preconditioned Krylov method stays bounded as the
+   number of patches grows (for a fixed number of elements per
+   patch).
+
+   The local systems are factorized by a sparse LU solver. With the
+   option "LocalSolver" = "FastDiagonalization" the patches with a
+   tensor-product basis instead use the inverse of the Laplacian on
+   the parameter domain (see gsFastDiagonalizationOp), which is much
+   cheaper for large patches and requires no factorization; it is a
+   preconditioner for the stiffness matrix of the patch rather than
+   an exact solver. It acts on the dofs of one patch only, hence it
+   is not used if "Overlap" > 0: the extended subdomains are then
+   factorized by the sparse LU solver, and a warning is printed.
+   Other local solvers can be set by setLocalSolver().
+
+   The local problems are set up and solved concurrently over the
+   patches.
+
+   The matrix \a A must be given with all its entries (not only the
+   lower triangle). The operator is symmetric if \a A is, and then
+   suitable for gsConjugateGradient.
+
+   Example:
+   \code
+   gsPoissonAssembler<> assembler(patches, bases, bc, f);
+   assembler.assemble();
+   gsSparseMatrix<> A = assembler.fullMatrix();
+   gsPatchSchwarzOp<>::Ptr prec = gsPatchSchwarzOp<>::make(A, bases,
+                                      assembler.system().colMapper(0));
+   gsConjugateGradient cg(A, prec);
+   \endcode
+
+   \ingroup Solver
+*/
+template<class T = real_t>
+class gsPatchSchwarzOp : public gsLinearOperator<T>
+{
+public:
+
+    /// Shared pointer for gsPatchSchwarzOp
+    typedef memory::shared_ptr<gsPatchSchwarzOp> Ptr;
+
+    /// Unique pointer for gsPatchSchwarzOp
+    typedef memory::unique_ptr<gsPatchSchwarzOp> uPtr;
+
+    /// Shared pointer for gsLinearOperator
+    typedef typename gsLinearOperator<T>::Ptr BasePtr;
+
+    /// Matrix type of the system matrix
+    typedef gsSparseMatrix<T> SpMatrix;
+
+    /// Matrix type of the restriction to the coarse space
+    typedef gsSparseMatrix<T,RowMajor> SpMatrixRowMajor;
+
+public:
+
+    /**
+       @brief Constructor
+
+       @param A the system matrix, numbered by \a mapper
+       @param mb the bases of the patches
+       @param mapper the dof mapper of the system
+       @param opt options, see defaultOptions()
+    */
+    gsPatchSchwarzOp(const SpMatrix & A, const gsMultiBasis<T> & mb,
+                     const gsDofMapper & mapper,
+                     const gsOptionList & opt = defaultOptions());
+
+    /// Make function returning a smart pointer
+    static uPtr make(const SpMatrix & A, const gsMultiBasis<T> & mb,
+                     const gsDofMapper & mapper,
+                     const gsOptionList & opt = defaultOptions())
+    { return memory::make_unique( new gsPatchSchwarzOp(A, mb, mapper, opt) ); }
+
+    /// Get the default options as gsOptionList object
+    static gsOptionList defaultOptions();
+
+public:
+
+    void apply(const gsMatrix<T> & input, gsMatrix<T> & x) const;
+
+    index_t rows() const { return m_size; }
+
+    index_t cols() const { return m_size; }
+
+    /// Returns the number of subdomains, ie. of patches
+    index_t numSubdomains() const { return m_dofs.size(); }
+
+    /// Returns the dofs of subdomain \a k, in the order of its local
+    /// system
+    const std::vector<index_t> & subdomainDofs(index_t k) const
+    { return m_dofs[k]; }
+
+    /// @brief Sets the solver of subdomain \a k. It acts on the
+    /// vectors of the dofs subdomainDofs(k)
+    void setLocalSolver(index_t k, const BasePtr & solver)
+    {
+        GISMO_ASSERT( solver->rows() == static_cast<index_t>(m_dofs[k].size()),
+                      "The solver does not match the subdomain");
+        m_local[k] = solver;
+    }
+
+    /// @brief Returns the restriction to the coarse space, one row
+    /// per coarse function. The matrix is empty without coarse space
+    const SpMatrixRowMajor & coarseRestriction() const { return m_coarse; }
+
+private:
+
+    /// Collects the dofs of the subdomains
+    void computeSubdomains(const SpMatrix & A, const gsMultiBasis<T> & mb,
+                           const gsDofMapper & mapper, index_t overlap);
+
+    /// Computes the coarse space of the patch vertices
+    void computeCoarseSpace(const SpMatrix & A, const gsMultiBasis<T> & mb,
+                            const gsDofMapper & mapper);
+
+    /// Orders the dofs of patch \a k as a tensor and creates a
+    /// gsFastDiagonalizationOp, returns false if this is not possible
+    bool makeFastDiagonalization(index_t k, const SpMatrix & A,
+                                 const gsBasis<T> & basis,
+                                 const gsDofMapper & mapper);
+
+private:
+
+    index_t m_size;
+
+    /// The dofs of every subdomain
+    std::vector< std::vector<index_t> > m_dofs;
+
+    /// The solvers of the subdomains
+    std::vector<BasePtr> m_local;
+
+    /// Restriction to the coarse space
+    SpMatrixRowMajor m_coarse;
+
+    /// Solver of the coarse problem
+    BasePtr m_coarseSolver;
+
+    /// Local right-hand sides and corrections of apply()
+    mutable std::vector< gsMatrix<T> > m_lrhs, m_lsol;
+};
+
+} // namespace gismo
+
+#ifndef GISMO_BUILD_LIB
+#include GISMO_HPP_HEADER(gsPatchSchwarz.hpp)
+#endif
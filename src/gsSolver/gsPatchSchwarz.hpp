@@ -0,0 +1,415 @@
+/** @file gsPatchSchwarz.hpp
+
+    @brief Patch-wise additive Schwarz preconditioner for multipatch
+    systems.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#pragma once
+
+#include <gsSolver/gsPatchSchwarz.h>
+#include <gsSolver/gsMatrixOp.h>
+#include <gsSolver/gsKroneckerOp.h>
+#include <gsTensor/gsTensorBasis.h>
+#include <gsMpi/gsOpenMP.h>
+
+namespace gismo
+{
+
+namespace internal
+{
+
+// Collects the univariate components of a d-variate tensor basis
+template<unsigned d, class T>
+bool tensorComponents(const gsBasis<T> & basis, std::vector<const gsBasis<T> *> & comps)
+{
+    const gsTensorBasis<d,T> * tb = dynamic_cast<const gsTensorBasis<d,T> *>(&basis);
+    if ( NULL == tb )
+        return false;
+    comps.resize(d);
+    for (unsigned k = 0; k != d; ++k)
+        comps[k] = &tb->component(k);
+    return true;
+}
+
+} // namespace internal
+
+template<class T>
+gsPatchSchwarzOp<T>::gsPatchSchwarzOp(const SpMatrix & A, const gsMultiBasis<T> & mb,
+                                      const gsDofMapper & mapper,
+                                      const gsOptionList & opt)
+: m_size(A.rows())
+{
+    GISMO_ENSURE( A.rows() == A.cols() && A.rows() == mapper.freeSize(),
+                  "The matrix does not match the dof mapper");
+    const index_t     overlap = opt.askInt   ("Overlap"    , 0);
+    const bool        coarse  = opt.askSwitch("CoarseSpace", true);
+    const std::string solver  = opt.askString("LocalSolver", "Direct");
+    GISMO_ENSURE( solver == "Direct" || solver == "FastDiagonalization",
+                  "Unknown local solver: "<< solver);
+    const bool fastDiag = ( solver == "FastDiagonalization" && 0 == overlap );
+    if ( solver == "FastDiagonalization" && 0 != overlap )
+        gsWarn << "gsPatchSchwarzOp: FastDiagonalization needs Overlap = 0, "
+               << "the subdomains are factorized by sparse LU instead.\n";
+
+    computeSubdomains(A, mb, mapper, overlap);
+
+    const index_t np = m_dofs.size();
+    m_local.resize(np);
+    m_lrhs .resize(np);
+    m_lsol .resize(np);
+
+    // Set up the local solvers. Every thread marks the dofs of the
+    // current subdomain by their local index in its own array
+#   pragma omp parallel
+    {
+        std::vector<index_t> loc(m_size, -1);
+        gsSparseEntries<T> entries;
+
+#       pragma omp for schedule(dynamic)
+        for (index_t k = 0; k < np; ++k)
+        {
+            if ( fastDiag && makeFastDiagonalization(k, A, mb[k], mapper) )
+                continue;
+
+            const std::vector<index_t> & dofs = m_dofs[k];
+            const index_t nk = dofs.size();
+            for (index_t i = 0; i != nk; ++i)
+                loc[dofs[i]] = i;
+
+            entries.clear();
+            for (index_t j = 0; j != nk; ++j)
+                for (typename SpMatrix::InnerIterator it(A, dofs[j]); it; ++it)
+                    if ( -1 != loc[it.row()] )
+                        entries.add(loc[it.row()], j, it.value());
+
+            SpMatrix Ak(nk, nk);
+            Ak.setFrom(entries);
+            Ak.makeCompressed();
+            m_local[k] = makeSparseLUSolver(Ak);
+
+            for (index_t i = 0; i != nk; ++i)
+                loc[dofs[i]] = -1;
+        }
+    }
+
+    if ( coarse )
+        computeCoarseSpace(A, mb, mapper);
+}
+
+template<class T>
+gsOptionList gsPatchSchwarzOp<T>::defaultOptions()
+{
+    gsOptionList opt;
+    opt.addInt   ("Overlap"    , "Number of layers of dofs added to the patches", 0);
+    opt.addSwitch("CoarseSpace", "Use the coarse space of the patch vertices", true);
+    opt.addString("LocalSolver", "Solver of the patch problems: Direct or FastDiagonalization "
+                  "(only without overlap, otherwise Direct is used)", "Direct");
+    return opt;
+}
+
+template<class T>
+void gsPatchSchwarzOp<T>::computeSubdomains(const SpMatrix & A, const gsMultiBasis<T> & mb,
+                                            const gsDofMapper & mapper, index_t overlap)
+{
+    const index_t np = mb.nBases();
+    m_dofs.resize(np);
+
+#   pragma omp parallel
+    {
+        std::vector<bool> mark(m_size, false);
+        std::vector<index_t> layer;
+
+#       pragma omp for schedule(dynamic)
+        for (index_t k = 0; k < np; ++k)
+        {
+            std::vector<index_t> & dofs = m_dofs[k];
+            dofs.clear();
+            for (index_t i = 0; i != mb[k].size(); ++i)
+            {
+                const index_t ii = mapper.index(i, k);
+                if ( mapper.is_free_index(ii) && ! mark[ii] )
+                {
+                    mark[ii] = true;
+                    dofs.push_back(ii);
+                }
+            }
+
+            // Add the neighbours of the last layer, the matrix
+            // having a symmetric pattern
+            size_t first = 0;
+            for (index_t l = 0; l < overlap; ++l)
+            {
+                layer.clear();
+                for (size_t i = first; i != dofs.size(); ++i)
+                    for (typename SpMatrix::InnerIterator it(A, dofs[i]); it; ++it)
+                        if ( ! mark[it.row()] )
+                        {
+                            mark[it.row()] = true;
+                            layer.push_back(it.row());
+                        }
+                first = dofs.size();
+                dofs.insert(dofs.end(), layer.begin(), layer.end());
+            }
+
+            for (size_t i = 0; i != dofs.size(); ++i)
+                mark[dofs[i]] = false;
+            std::sort(dofs.begin(), dofs.end());
+        }
+    }
+}
+
+template<class T>
+void gsPatchSchwarzOp<T>::computeCoarseSpace(const SpMatrix & A, const gsMultiBasis<T> & mb,
+                                             const gsDofMapper & mapper)
+{
+    const index_t np = mb.nBases();
+    const index_t d  = mb.dim();
+    const index_t nc = 1 << d; // corners per patch
+    const T       tol = 1e-10;
+
+    // A vertex is identified by the (global) index of the function
+    // interpolating at the patch corner, which is shared by the
+    // patches meeting at the vertex. The coarse functions of a patch
+    // are the columns of the weights
+    std::vector< gsMatrix<T> > weights(np);
+    std::vector< std::vector<index_t> > vertex(np);
+    std::vector<index_t> keys;
+#   pragma omp parallel for schedule(dynamic)
+    for (index_t k = 0; k < np; ++k)
+    {
+        const gsMatrix<T> anchors = mb[k].anchors();
+        const gsMatrix<T> supp    = mb[k].support();
+        const index_t n = anchors.cols();
+        gsMatrix<T> & w = weights[k];
+        w.setOnes(n, nc);
+        for (index_t j = 0; j != d; ++j)
+        {
+            const T a = supp(j,0), len = supp(j,1) - supp(j,0);
+            for (index_t i = 0; i != n; ++i)
+            {
+                const T xi = ( anchors(j,i) - a ) / len;
+                for (index_t c = 0; c != nc; ++c)
+                    w(i,c) *= ( (c >> j) & 1 ) ? xi : 1 - xi;
+            }
+        }
+
+        // The key of corner c is the index of the function with
+        // weight one, or a negative key (not shared) if there is none
+        vertex[k].assign(nc, -1);
+        for (index_t c = 0; c != nc; ++c)
+        {
+            index_t i;
+            if ( w.col(c).maxCoeff(&i) > 1 - tol )
+                vertex[k][c] = mapper.index(i, k);
+            else
+                vertex[k][c] = - 1 - (k * nc + c);
+        }
+    }
+
+    for (index_t k = 0; k != np; ++k)
+        keys.insert(keys.end(), vertex[k].begin(), vertex[k].end());
+    std::sort(keys.begin(), keys.end());
+    keys.erase( std::unique(keys.begin(), keys.end()), keys.end() );
+
+    // Every dof takes its weights from the first patch which
+    // contains it. On a conforming interface the weights of both
+    // patches coincide
+    std::vector<bool> done(m_size, false);
+    gsSparseEntries<T> entries;
+    for (index_t k = 0; k != np; ++k)
+    {
+        const gsMatrix<T> & w = weights[k];
+        for (index_t i = 0; i != w.rows(); ++i)
+        {
+            const index_t ii = mapper.index(i, k);
+            if ( ! mapper.is_free_index(ii) || done[ii] )
+                continue;
+            done[ii] = true;
+            for (index_t c = 0; c != nc; ++c)
+                if ( w(i,c) > tol )
+                {
+                    const index_t v = std::lower_bound(keys.begin(), keys.end(),
+                                                       vertex[k][c]) - keys.begin();
+                    entries.add(v, ii, w(i,c));
+                }
+        }
+    }
+
+    SpMatrixRowMajor R(keys.size(), m_size);
+    R.setFrom(entries);
+
+    // Drop the vertices without free dofs
+    std::vector<index_t> nonEmpty;
+    for (index_t v = 0; v != R.rows(); ++v)
+        if ( 0 != R.row(v).nonZeros() )
+            nonEmpty.push_back(v);
+    entries.clear();
+    for (size_t v = 0; v != nonEmpty.size(); ++v)
+        for (typename SpMatrixRowMajor::InnerIterator it(R, nonEmpty[v]); it; ++it)
+            entries.add(v, it.col(), it.value());
+    m_coarse.resize(nonEmpty.size(), m_size);
+    m_coarse.setFrom(entries);
+    m_coarse.makeCompressed();
+
+    SpMatrix A0 = m_coarse * A * m_coarse.transpose();
+    A0.makeCompressed();
+    m_coarseSolver = makeSparseLUSolver(A0);
+}
+
+template<class T>
+bool gsPatchSchwarzOp<T>::makeFastDiagonalization(index_t k, const SpMatrix & A,
+                                                  const gsBasis<T> & basis,
+                                                  const gsDofMapper & mapper)
+{
+    std::vector<const gsBasis<T> *> comps;
+    const bool isTensor =
+        internal::tensorComponents<1,T>(basis, comps) ||
+        internal::tensorComponents<2,T>(basis, comps) ||
+        internal::tensorComponents<3,T>(basis, comps) ||
+        internal::tensorComponents<4,T>(basis, comps);
+    if ( ! isTensor )
+        return false;
+
+    const index_t d = comps.size();
+    gsVector<index_t> sz(d), idx(d), lo(d), hi(d);
+    for (index_t j = 0; j != d; ++j)
+        sz[j] = comps[j]->size();
+
+    // A side is dropped if none of its functions is free (eg. on
+    // eliminated Dirichlet sides). A side is an interface if its
+    // functions are coupled to another patch
+    gsVector<index_t> freeLo(d), freeHi(d), ifaceLo(d), ifaceHi(d);
+    freeLo.setZero(); freeHi.setZero();
+    ifaceLo.setZero(); ifaceHi.setZero();
+    idx.setZero();
+    for (index_t i = 0; i != basis.size(); ++i)
+    {
+        const bool isFree    = mapper.is_free(i, k);
+        const bool isCoupled = isFree && mapper.is_coupled(i, k);
+        for (index_t j = 0; j != d; ++j)
+        {
+            if ( 0 == idx[j] )
+            {
+                freeLo [j] |= isFree;
+                ifaceLo[j] |= isCoupled;
+            }
+            if ( sz[j] - 1 == idx[j] )
+            {
+                freeHi [j] |= isFree;
+                ifaceHi[j] |= isCoupled;
+            }
+        }
+        for (index_t j = 0; j != d && ++idx[j] == sz[j]; ++j)
+            idx[j] = 0;
+    }
+    for (index_t j = 0; j != d; ++j)
+    {
+        lo[j] = 1 - freeLo[j];
+        hi[j] = sz[j] - 1 + freeHi[j];
+        if ( hi[j] <= lo[j] )
+            return false;
+    }
+
+    // The free dofs must be the tensor product of the remaining
+    // ranges, they are ordered as the tensor
+    std::vector<index_t> dofs;
+    idx.setZero();
+    for (index_t i = 0; i != basis.size(); ++i)
+    {
+        bool inside = true;
+        for (index_t j = 0; j != d; ++j)
+            inside = inside && lo[j] <= idx[j] && idx[j] < hi[j];
+        if ( inside != mapper.is_free(i, k) )
+            return false;
+        if ( inside )
+            dofs.push_back( mapper.index(i, k) );
+        for (index_t j = 0; j != d && ++idx[j] == sz[j]; ++j)
+            idx[j] = 0;
+    }
+    std::vector<index_t> sorted = dofs;
+    std::sort(sorted.begin(), sorted.end());
+    if ( std::unique(sorted.begin(), sorted.end()) != sorted.end() )
+        return false; // eg. periodic
+
+    std::vector< gsMatrix<T> > stiff(d), mass(d);
+    gsSparseMatrix<T> K, M;
+    for (index_t j = 0; j != d; ++j)
+    {
+        univariateStiffnessMatrix(*comps[j], K);
+        univariateMassMatrix     (*comps[j], M);
+        const index_t nj = hi[j] - lo[j];
+        stiff[j] = K.toDense().block(lo[j], lo[j], nj, nj);
+        mass [j] = M.toDense().block(lo[j], lo[j], nj, nj);
+
+        // The patch matrix has the contributions of the neighbouring
+        // patch on the interface dofs, which are modelled by the
+        // mirrored first (last) element. Without them the Laplacian
+        // of an interior patch would be singular
+        if ( ifaceLo[j] )
+        {
+            stiff[j](0,0) *= 2;
+            mass [j](0,0) *= 2;
+        }
+        if ( ifaceHi[j] )
+        {
+            stiff[j](nj-1,nj-1) *= 2;
+            mass [j](nj-1,nj-1) *= 2;
+        }
+    }
+
+    // Scale the parametric Laplacian to the diagonal of the patch matrix
+    gsVector<T> diag;
+    gsFastDiagonalizationOp<T>::kroneckerSumDiagonal(stiff, mass, diag);
+    T sum = 0;
+    for (size_t i = 0; i != dofs.size(); ++i)
+        sum += A.coeff(dofs[i], dofs[i]);
+
+    m_dofs [k] = dofs;
+    m_local[k] = gsFastDiagonalizationOp<T>::make(stiff, mass, sum / diag.sum());
+    return true;
+}
+
+template<class T>
+void gsPatchSchwarzOp<T>::apply(const gsMatrix<T> & input, gsMatrix<T> & x) const
+{
+    GISMO_ASSERT( input.rows() == m_size, "Wrong size of the input");
+    const index_t np = m_dofs.size();
+    const index_t nc = input.cols();
+
+    // Local solves
+#   pragma omp parallel for schedule(dynamic)
+    for (index_t k = 0; k < np; ++k)
+    {
+        const std::vector<index_t> & dofs = m_dofs[k];
+        gsMatrix<T> & r = m_lrhs[k];
+        r.resize(dofs.size(), nc);
+        for (size_t i = 0; i != dofs.size(); ++i)
+            r.row(i) = input.row(dofs[i]);
+        m_local[k]->apply(r, m_lsol[k]);
+    }
+
+    // Sum up the corrections
+    x.setZero(m_size, nc);
+    for (index_t k = 0; k != np; ++k)
+    {
+        const std::vector<index_t> & dofs = m_dofs[k];
+        const gsMatrix<T> & s = m_lsol[k];
+        for (size_t i = 0; i != dofs.size(); ++i)
+            x.row(dofs[i]) += s.row(i);
+    }
+
+    // Coarse correction
+    if ( 0 != m_coarse.rows() )
+    {
+        gsMatrix<T> r0 = m_coarse * input, s0;
+        m_coarseSolver->apply(r0, s0);
+        x.noalias() += m_coarse.transpose() * s0;
+    }
+}
+
+} // namespace gismo
@@ -0,0 +1,20 @@
+/** @file gsPatchSchwarz_.cpp
+
+    @brief Patch-wise additive Schwarz preconditioner for multipatch
+    systems.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <gsSolver/gsPatchSchwarz.hpp>
+
+namespace gismo
+{
+
+CLASS_TEMPLATE_INST gsPatchSchwarzOp<real_t>;
+
+} // namespace gismo
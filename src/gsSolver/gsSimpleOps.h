@@ -114,7 +114,7 @@ public:
     void setScaling(const T tau) { m_tau = tau;  }
     
     /// Get scaling parameter
-    void getScaling()            { return m_tau; }
+    T getScaling() const         { return m_tau; }
 
     /// Get the default options as gsOptionList object
     static gsOptionList defaultOptions()
@@ -138,7 +138,7 @@ private:
     const MatrixPtr m_mat;  ///< Shared pointer to matrix (if needed)
     NestedMatrix    m_expr; ///< Nested Eigen expression
 
-    using gsLinearOperator<T>::m_num_of_sweeps;
+    using Base::m_num_of_sweeps;
     T m_tau;
 };
 
@@ -220,7 +220,7 @@ public:
     void setScaling(const T tau) { m_tau = tau;  }
     
     /// Get scaling parameter
-    void getScaling()            { return m_tau; }
+    T getScaling() const         { return m_tau; }
 
     /// Get the default options as gsOptionList object
     static gsOptionList defaultOptions()
@@ -243,7 +243,7 @@ public:
 private:
     const MatrixPtr m_mat;  ///< Shared pointer to matrix (if needed)
     NestedMatrix    m_expr; ///< Nested Eigen expression
-    using gsLinearOperator<T>::m_num_of_sweeps;
+    using Base::m_num_of_sweeps;
     T m_tau;
 };
 
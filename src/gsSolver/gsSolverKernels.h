@@ -0,0 +1,303 @@
+/** @file gsSolverKernels.h
+
+    @brief Multi-threaded vector and sparse matrix kernels used by the
+    iterative solvers.
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#pragma once
+
+#include <gsCore/gsLinearAlgebra.h>
+#include <gsMpi/gsOpenMP.h>
+
+namespace gismo
+{
+
+/**
+   @brief Vector operations and sparse matrix-vector products, threaded
+   with OpenMP.
+
+   The number of threads is the OpenMP runtime setting
+   (omp_get_max_threads(), eg. set by omp_set_num_threads() or by the
+   environment variable OMP_NUM_THREADS), the same which is used by
+   the parallel assembly. Short vectors are treated serially.
+
+   The reductions (dot products, norms) are computed as sums of
+   partial sums over blocks of fixed length, which are added in a
+   fixed order. Therefore the results do not depend on the number of
+   threads or on the scheduling.
+
+   All vectors are single columns.
+
+   \ingroup Solver
+*/
+template<class T>
+class gsSolverKernels
+{
+public:
+    typedef gsMatrix<T> VectorType;
+
+    enum
+    {
+        /// Length of the blocks of the reductions
+        blockSize = 4096,
+        /// Minimal length of the vectors for using threads
+        minParallelSize = 16384
+    };
+
+private:
+    gsSolverKernels() { }
+
+public:
+
+    /// Returns true if a vector of length \a n is treated in parallel
+    static bool isParallel(index_t n)
+    { return n >= minParallelSize && omp_get_max_threads() > 1; }
+
+    /// Returns the dot product of \a a and \a b
+    static T dot(const VectorType & a, const VectorType & b)
+    {
+        GISMO_ASSERT( a.rows() == b.rows() && 1 == a.cols() && 1 == b.cols(),
+                      "Invalid vectors");
+        const index_t n  = a.rows();
+        const index_t nb = numBlocks(n);
+        const T * pa = a.data();
+        const T * pb = b.data();
+        gsVector<T> partial(nb);
+
+#       pragma omp parallel for schedule(static) if ( isParallel(n) )
+        for (index_t k = 0; k < nb; ++k)
+        {
+            T sum = 0;
+            for (index_t i = k * blockSize; i < blockEnd(k, n); ++i)
+                sum += pa[i] * pb[i];
+            partial[k] = sum;
+        }
+        return sumInOrder(partial);
+    }
+
+    /// Returns the squared Euclidean norm of \a a
+    static T squaredNorm(const VectorType & a) { return dot(a, a); }
+
+    /// Returns the Euclidean norm of \a a
+    static T norm(const VectorType & a) { return math::sqrt(dot(a, a)); }
+
+    /// Computes \f$ y \leftarrow y + \alpha x \f$
+    static void axpy(const T alpha, const VectorType & x, VectorType & y)
+    {
+        GISMO_ASSERT( x.rows() == y.rows() && 1 == x.cols() && 1 == y.cols(),
+                      "Invalid vectors");
+        const index_t n = x.rows();
+        const T * px = x.data();
+        T * py = y.data();
+
+#       pragma omp parallel for schedule(static) if ( isParallel(n) )
+        for (index_t i = 0; i < n; ++i)
+            py[i] += alpha * px[i];
+    }
+
+    /// Computes \f$ y \leftarrow x + \beta y \f$
+    static void xpby(const VectorType & x, const T beta, VectorType & y)
+    {
+        GISMO_ASSERT( x.rows() == y.rows() && 1 == x.cols() && 1 == y.cols(),
+                      "Invalid vectors");
+        const index_t n = x.rows();
+        const T * px = x.data();
+        T * py = y.data();
+
+#       pragma omp parallel for schedule(static) if ( isParallel(n) )
+        for (index_t i = 0; i < n; ++i)
+            py[i] = px[i] + beta * py[i];
+    }
+
+    /// Computes \f$ r \leftarrow b - r \f$ and returns the squared
+    /// norm of the result
+    static T residualSquaredNorm(const VectorType & b, VectorType & r)
+    {
+        GISMO_ASSERT( b.rows() == r.rows() && 1 == b.cols() && 1 == r.cols(),
+                      "Invalid vectors");
+        const index_t n  = b.rows();
+        const index_t nb = numBlocks(n);
+        const T * pb = b.data();
+        T * pr = r.data();
+        gsVector<T> partial(nb);
+
+#       pragma omp parallel for schedule(static) if ( isParallel(n) )
+        for (index_t k = 0; k < nb; ++k)
+        {
+            T sum = 0;
+            for (index_t i = k * blockSize; i < blockEnd(k, n); ++i)
+            {
+                pr[i] = pb[i] - pr[i];
+                sum  += pr[i] * pr[i];
+            }
+            partial[k] = sum;
+        }
+        return sumInOrder(partial);
+    }
+
+    /**
+       @brief Computes \f$ x \leftarrow x + \alpha p \f$ and
+       \f$ r \leftarrow r - \alpha q \f$ in one pass and returns the
+       squared norm of the updated \a r
+
+       This is the update of the iterate and of the residual in the
+       conjugate gradient method.
+    */
+    static T updateAndSquaredNorm(const T alpha, const VectorType & p, VectorType & x,
+                                  const VectorType & q, VectorType & r)
+    {
+        GISMO_ASSERT( p.rows() == x.rows() && q.rows() == r.rows() && p.rows() == q.rows(),
+                      "Invalid vectors");
+        const index_t n  = p.rows();
+        const index_t nb = numBlocks(n);
+        const T * pp = p.data();
+        const T * pq = q.data();
+        T * px = x.data();
+        T * pr = r.data();
+        gsVector<T> partial(nb);
+
+#       pragma omp parallel for schedule(static) if ( isParallel(n) )
+        for (index_t k = 0; k < nb; ++k)
+        {
+            T sum = 0;
+            for (index_t i = k * blockSize; i < blockEnd(k, n); ++i)
+            {
+                px[i] += alpha * pp[i];
+                pr[i] -= alpha * pq[i];
+                sum   += pr[i] * pr[i];
+            }
+            partial[k] = sum;
+        }
+        return sumInOrder(partial);
+    }
+
+    /**
+       @brief Computes the sparse matrix-vector product \f$ y = A x \f$
+
+       For row-major matrices the rows are distributed among the
+       threads. For column-major matrices every thread multiplies a
+       range of columns (of roughly equal number of non-zeros) into a
+       private buffer which covers the rows touched by these columns;
+       the buffers are then added row-wise in the order of the
+       threads. For the banded matrices arising from finite element
+       discretizations the buffers are only slightly larger than the
+       vector. The result is reproducible for a given number of
+       threads. Uncompressed matrices are multiplied serially.
+    */
+    template<int _Opt, typename _Index>
+    static void spmv(const Eigen::SparseMatrix<T,_Opt,_Index> & A,
+                     const VectorType & x, VectorType & y)
+    {
+        GISMO_ASSERT( A.cols() == x.rows() && 1 == x.cols(), "Invalid vectors");
+        if ( ! isParallel(A.rows()) || ! A.isCompressed() )
+        {
+            y.noalias() = A * x;
+            return;
+        }
+
+        y.resize(A.rows(), 1);
+        const _Index * outer = A.outerIndexPtr();
+        const _Index * inner = A.innerIndexPtr();
+        const T      * vals  = A.valuePtr();
+        const T      * px    = x.data();
+        T            * py    = y.data();
+
+        if ( _Opt & Eigen::RowMajorBit )
+        {
+#           pragma omp parallel for schedule(static, 1024)
+            for (index_t i = 0; i < A.rows(); ++i)
+            {
+                T sum = 0;
+                for (_Index k = outer[i]; k < outer[i+1]; ++k)
+                    sum += vals[k] * px[inner[k]];
+                py[i] = sum;
+            }
+            return;
+        }
+
+        std::vector<index_t> colStart, rowStart;
+        std::vector<gsVector<T> > buf;
+
+#       pragma omp parallel
+        {
+            const int nt = omp_get_num_threads();
+            const int t  = omp_get_thread_num();
+
+            // Column ranges with balanced number of non-zeros
+#           pragma omp single
+            {
+                const index_t nc = A.cols();
+                colStart.resize(nt + 1, nc);
+                colStart[0] = 0;
+                for (int s = 1; s < nt; ++s)
+                    colStart[s] = math::max( colStart[s-1], static_cast<index_t>(
+                        std::upper_bound(outer, outer + nc,
+                                         static_cast<_Index>( (A.nonZeros() * s) / nt ) )
+                        - outer - 1 ) );
+                rowStart.resize(nt);
+                buf.resize(nt);
+            }
+
+            // Rows touched by the columns of this thread
+            index_t rmin = A.rows(), rmax = -1;
+            for (index_t j = colStart[t]; j < colStart[t+1]; ++j)
+                if ( outer[j] != outer[j+1] )
+                {
+                    rmin = math::min(rmin, static_cast<index_t>(inner[outer[j]]      ));
+                    rmax = math::max(rmax, static_cast<index_t>(inner[outer[j+1] - 1]));
+                }
+            rowStart[t] = rmin;
+            buf[t].setZero( rmax < rmin ? 0 : rmax - rmin + 1 );
+
+            T * pb = buf[t].data() - rmin;
+            for (index_t j = colStart[t]; j < colStart[t+1]; ++j)
+            {
+                const T xj = px[j];
+                for (_Index k = outer[j]; k < outer[j+1]; ++k)
+                    pb[inner[k]] += vals[k] * xj;
+            }
+
+#           pragma omp barrier
+
+            // Add the buffers in a fixed order
+#           pragma omp for schedule(static, 1024)
+            for (index_t i = 0; i < A.rows(); ++i)
+            {
+                T sum = 0;
+                for (int s = 0; s < nt; ++s)
+                {
+                    const index_t li = i - rowStart[s];
+                    if ( li >= 0 && li < buf[s].size() )
+                        sum += buf[s][li];
+                }
+                py[i] = sum;
+            }
+        }
+    }
+
+private:
+
+    static index_t numBlocks(index_t n)
+    { return (n + blockSize - 1) / blockSize; }
+
+    static index_t blockEnd(index_t k, index_t n)
+    {
+        const index_t e = (k + 1) * blockSize;
+        return e < n ? e : n;
+    }
+
+    static T sumInOrder(const gsVector<T> & partial)
+    {
+        T sum = 0;
+        for (index_t k = 0; k < partial.size(); ++k)
+            sum += partial[k];
+        return sum;
+    }
+};
+
+} // namespace gismo
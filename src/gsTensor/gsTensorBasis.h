@@ -143,10 +143,10 @@ public:
     {
         GISMO_ASSERT( u.rows() == d, "Wrong vector dimension");
 
-        int ElIndex = m_bases[d-1]->elementIndex( u.col(d-1) );
+        int ElIndex = m_bases[d-1]->elementIndex( u.row(d-1) );
         for ( int i=d-2; i>=0; --i )
             ElIndex = ElIndex * m_bases[i]->numElements() 
-                    + m_bases[i]->elementIndex( u.col(i) );
+                    + m_bases[i]->elementIndex( u.row(i) );
 
         return ElIndex;        
     }
@@ -245,8 +245,38 @@ public:
     // (or vector) u
     void evalSingle_into(unsigned i, const gsMatrix<T> & u, gsMatrix<T>& result) const ;
 
-    /// Evaluate an element of the space given by coefs at points u
-    virtual void eval_into(const gsMatrix<T> & u, const gsMatrix<T> & coefs, gsMatrix<T>& result ) const;
+    /// Evaluate an element of the space given by coefs at points u,
+    /// same as evalFunc_into()
+    virtual void eval_into(const gsMatrix<T> & u, const gsMatrix<T> & coefs, gsMatrix<T>& result ) const
+    { evalFunc_into(u, coefs, result); }
+
+    /// \brief Evaluate an element of the space given by coefs at
+    /// points u. The coefficients of the active functions at a point
+    /// are contracted with the univariate values one direction at a
+    /// time, without forming the tensor-product basis values.
+    void evalFunc_into(const gsMatrix<T> & u, const gsMatrix<T> & coefs, gsMatrix<T>& result) const;
+
+    /// Evaluate the derivatives of an element of the space given by
+    /// coefs at points u, see evalFunc_into()
+    void derivFunc_into(const gsMatrix<T> & u, const gsMatrix<T> & coefs, gsMatrix<T>& result) const;
+
+    /// Evaluate the second derivatives of an element of the space
+    /// given by coefs at points u, see evalFunc_into()
+    void deriv2Func_into(const gsMatrix<T> & u, const gsMatrix<T> & coefs, gsMatrix<T>& result) const;
+
+    /// Evaluate an element of the space given by coefs and its
+    /// derivatives up to order n at points u, see evalFunc_into().
+    /// Orders higher than two use the generic implementation.
+    void evalAllDersFunc_into(const gsMatrix<T> & u, const gsMatrix<T> & coefs,
+                              const unsigned n, std::vector< gsMatrix<T> >& result) const;
+
+    /// \brief Evaluate an element of the space given by coefs on the
+    /// tensor grid \a cwise. The values are the product of the
+    /// Kronecker product of the univariate collocation matrices with
+    /// \a coefs, applied direction by direction (see gsApplyKroneckerProduct);
+    /// every univariate basis is evaluated once per coordinate.
+    void evalFuncOnGrid_into(const std::vector< gsVector<T> > & cwise,
+                             const gsMatrix<T> & coefs, gsMatrix<T>& result) const;
 
     // see gsBasis for doxygen documentation
     // Evaluate the nonzero basis functions and their derivatives up to
@@ -277,6 +307,15 @@ private:
                    const gsVector<unsigned, d> & size,
                    gsMatrix<T>& result);
 
+    // Internal function
+    //
+    // Evaluates the derivatives of orders lo,...,hi (hi<=2) of the
+    // function given by coefs at the columns of u into result[lo],
+    // ..., result[hi], in the format of derivFunc_into and
+    // deriv2Func_into.
+    void evalDersFunc_tp(const gsMatrix<T> & u, const gsMatrix<T> & coefs,
+                         int lo, int hi, std::vector< gsMatrix<T> > & result) const;
+
 public:
     // see gsBasis for doxygen documentation
     // Evaluate the i-th basis function derivative at all columns of
@@ -284,9 +323,6 @@ public:
 
     virtual void deriv2Single_into(unsigned i, const gsMatrix<T> & u, gsMatrix<T>& result) const ;
 
-    // Evaluates the (partial) derivatives of an element given by coefs at (the columns of) u.
-    //void deriv_into(const gsMatrix<T> & u, const gsMatrix<T> & coefs, gsMatrix<T>& result ) const ;
-
     // Look at gsBasis class for documentation 
     typename gsBasis<T>::domainIter makeDomainIterator() const
     {
@@ -559,57 +559,233 @@ void gsTensorBasis<d,T>::eval_into(const gsMatrix<T> & u,
 };
 
 template<unsigned d, class T>
-void gsTensorBasis<d,T>::eval_into(const gsMatrix<T> & u, 
-                                         const gsMatrix<T> & coefs, 
-                                         gsMatrix<T>& result ) const
+void gsTensorBasis<d,T>::evalFunc_into(const gsMatrix<T> & u,
+                                       const gsMatrix<T> & coefs,
+                                       gsMatrix<T>& result) const
 {
+    std::vector< gsMatrix<T> > ders;
+    evalDersFunc_tp(u, coefs, 0, 0, ders);
+    result.swap(ders[0]);
+}
 
-#if (0)
-    //~ version using the tensor structure; uses more memory, check
-    result.resize( coefs.cols(), u.cols() ) ;
+template<unsigned d, class T>
+void gsTensorBasis<d,T>::derivFunc_into(const gsMatrix<T> & u,
+                                        const gsMatrix<T> & coefs,
+                                        gsMatrix<T>& result) const
+{
+    std::vector< gsMatrix<T> > ders;
+    evalDersFunc_tp(u, coefs, 1, 1, ders);
+    result.swap(ders[1]);
+}
 
-    unsigned sz = this->size()/m_bases[0]->size();
-    unsigned n  = coefs.cols();
-    gsAsMatrix<T> cc(coefs.data(), m_bases[0]->size(),  n * sz);
-    gsMatrix<T> e0,e1; 
+template<unsigned d, class T>
+void gsTensorBasis<d,T>::deriv2Func_into(const gsMatrix<T> & u,
+                                         const gsMatrix<T> & coefs,
+                                         gsMatrix<T>& result) const
+{
+    std::vector< gsMatrix<T> > ders;
+    evalDersFunc_tp(u, coefs, 2, 2, ders);
+    result.swap(ders[2]);
+}
 
-    for ( index_t j=0; j< u.cols() ; j++ ) // for all points (columns of u)
-    { // to try:: all points at once instead
-        gsMatrix<T> uu = u.col(j);
-        //gsDebug<< "uu : \n"<< uu <<std::endl;
-        //gsDebug<< "coefs: \n"<< cc <<std::endl;
-        
-        m_bases[0]->eval_into(uu.row(0), cc, e0);
-        
-        for ( unsigned i=1; i< d ; ++i )
+template<unsigned d, class T>
+void gsTensorBasis<d,T>::evalAllDersFunc_into(const gsMatrix<T> & u,
+                                              const gsMatrix<T> & coefs,
+                                              const unsigned n,
+                                              std::vector< gsMatrix<T> >& result) const
+{
+    if ( n > 2 )
+        gsBasis<T>::evalAllDersFunc_into(u, coefs, n, result);
+    else
+        evalDersFunc_tp(u, coefs, 0, n, result);
+}
+
+template<unsigned d, class T>
+void gsTensorBasis<d,T>::evalDersFunc_tp(const gsMatrix<T> & u,
+                                         const gsMatrix<T> & coefs,
+                                         const int lo, const int hi,
+                                         std::vector< gsMatrix<T> > & result) const
+{
+    GISMO_ASSERT( u.rows() == d,
+                  "Attempted to evaluate the tensor-basis on points with the wrong dimension" );
+    GISMO_ASSERT( coefs.rows() == this->size(), "Wrong number of coefficients" );
+    GISMO_ASSERT( 0 <= lo && lo <= hi && hi <= 2, "Derivatives up to order two only" );
+
+    const index_t numPts = u.cols();
+    const index_t tdim   = coefs.cols();
+
+    // Univariate values/derivatives and active functions
+    std::vector< gsMatrix<T> > ev[d];
+    gsMatrix<unsigned> act[d];
+    gsVector<index_t, d> na, str; // numbers of active functions, strides of the indices
+    index_t nb = 1, s = 1;
+    for (unsigned i = 0; i < d; ++i)
+    {
+        m_bases[i]->evalAllDers_into(u.row(i), hi, ev[i]);
+        m_bases[i]->active_into(u.row(i), act[i]);
+        na[i]  = act[i].rows();
+        nb    *= na[i];
+        str[i] = s;
+        s     *= m_bases[i]->size();
+    }
+
+    // The local coefficients (na[0] x ... x na[d-1] x tdim, the first
+    // index running fastest) are contracted with the univariate
+    // values/derivatives one direction at a time. Contracting a
+    // direction i turns every intermediate tensor, which carries the
+    // orders of derivation in the directions before i, into one
+    // tensor per order in direction i (up to a total order hi). The
+    // intermediate tensors are stored one after the other, level[i]
+    // holds the total order of the tensors before contracting
+    // direction i and ords the orders of every tensor in all
+    // directions contracted so far.
+    std::vector<int> level[d+1], ords, nextOrds;
+    level[0].assign(1, 0);
+    index_t maxSize = 0, len = nb * tdim;
+    for (unsigned i = 0; i < d; ++i)
+    {
+        len /= na[i];
+        nextOrds.clear();
+        for (size_t t = 0; t != level[i].size(); ++t)
+            for (int o = 0; o <= hi - level[i][t]; ++o)
+            {
+                level[i+1].push_back(level[i][t] + o);
+                nextOrds.insert(nextOrds.end(), ords.begin() + t*i, ords.begin() + (t+1)*i);
+                nextOrds.push_back(o);
+            }
+        ords.swap(nextOrds);
+        maxSize = math::max(maxSize, static_cast<index_t>(level[i+1].size()) * len);
+    }
+
+    // Row of every contracted tensor in the result, in the order of
+    // deriv_into and deriv2_into: pure derivatives first, then mixed
+    // ones in lexicographic order (-1 for orders below lo)
+    const index_t nTen = level[d].size();
+    std::vector<index_t> row(nTen, -1);
+    for (index_t t = 0; t != nTen; ++t)
+    {
+        const int * o = &ords[t*d];
+        if ( level[d][t] < lo )
+            continue;
+        if ( 0 == level[d][t] )
         {
-            sz /= m_bases[i]->size();
-            e0.resize( m_bases[i]->size(),  n * sz );
-            //gsDebug<< "e0 : \n"<< e0  <<"\n";
-            m_bases[i]->eval(uu.row(i), e0, e1);
-            //gsDebug<< "e1 : \n"<< e1 <<"\n";
-            std::swap(e0, e1);
+            row[t] = 0;
+            continue;
+        }
+        index_t k = 0;
+        while ( 0 == o[k] ) ++k;
+        if ( 1 == level[d][t] || 2 == o[k] )
+            row[t] = k; // first or pure second derivative
+        else
+        {
+            index_t l = k + 1;
+            while ( 0 == o[l] ) ++l;
+            row[t] = d + k*(2*d-k-1)/2 + l-k-1; // mixed derivative
         }
-        result->col(j) = e0;
     }
-    //gsDebug<< "final: \n"<< *result  <<std::endl;
-#endif
-  
-    // Default version - linear combination of basis functions
-    // Basis_t:: eval_into(u,coefs,result);
-    result.resize( coefs.cols(), u.cols() ) ;
-    gsMatrix<T> B ;
-    gsMatrix<unsigned> ind;
-    
-    this->eval_into(u, B);   // col j = nonzero basis functions at column point u(..,j)
-    this->active_into(u,ind);// col j = indices of active functions at column point u(..,j)
-    
-    for ( index_t j=0; j< u.cols() ; j++ ) // for all points (columns of u)
+
+    result.resize(hi+1);
+    for (int k = lo; k <= hi; ++k)
+        result[k].resize(tdim * (0 == k ? 1 : (1 == k ? d : d + d*(d-1)/2)), numPts);
+
+    // Workspace for the local coefficients and the intermediate
+    // tensors, on the stack for small degrees
+    const index_t N = nb * tdim;
+    const int stackSize = 1024;
+    T stackBuf[stackSize];
+    gsMatrix<T> heapBuf;
+    T * loc = stackBuf;
+    if ( N + 2 * maxSize > stackSize )
+    {
+        heapBuf.resize(N + 2 * maxSize, 1);
+        loc = heapBuf.data();
+    }
+    T * const w0 = loc + N;
+    T * const w1 = w0  + maxSize;
+
+    // Global indices of the active functions at a point
+    std::vector<index_t> ind(nb);
+
+    for (index_t j = 0; j != numPts; ++j) // for all points
+    {
+        // Global indices of the active functions, the first direction
+        // running fastest
+        ind[0] = 0;
+        index_t cnt = 1;
+        for (unsigned i = 0; i < d; ++i)
+        {
+            for (index_t a = na[i] - 1; a >= 0; --a) // block a = 0 is updated in place last
+                for (index_t r = 0; r != cnt; ++r)
+                    ind[a * cnt + r] = ind[r] + act[i](a, j) * str[i];
+            cnt *= na[i];
+        }
+
+        // Gather their coefficients
+        for (index_t c = 0; c != tdim; ++c)
+            for (index_t r = 0; r != nb; ++r)
+                loc[r + c * nb] = coefs(ind[r], c);
+
+        // Contract the leading index of every tensor
+        const T * in = loc;
+        T * out = w0;
+        len = N;
+        for (unsigned i = 0; i < d; ++i)
+        {
+            const index_t n = na[i], next = len / n;
+            T * pos = out;
+            for (size_t t = 0; t != level[i].size(); ++t)
+            {
+                const T * ten = in + t * len;
+                for (int o = 0; o <= hi - level[i][t]; ++o, pos += next)
+                {
+                    const T * e = ev[i][o].col(j).data();
+                    for (index_t q = 0; q != next; ++q, ten += n)
+                    {
+                        T val = ten[0] * e[0];
+                        for (index_t a = 1; a < n; ++a)
+                            val += ten[a] * e[a];
+                        pos[q] = val;
+                    }
+                    ten -= len;
+                }
+            }
+            in  = out;
+            out = (out == w0 ? w1 : w0);
+            len = next;
+        }
+
+        for (index_t t = 0; t != nTen; ++t)
+            if ( row[t] != -1 )
+            {
+                gsMatrix<T> & res = result[level[d][t]];
+                const index_t nd = res.rows() / tdim;
+                for (index_t c = 0; c != tdim; ++c)
+                    res(c * nd + row[t], j) = in[t * tdim + c];
+            }
+    }
+}
+
+template<unsigned d, class T>
+void gsTensorBasis<d,T>::evalFuncOnGrid_into(const std::vector< gsVector<T> > & cwise,
+                                             const gsMatrix<T> & coefs,
+                                             gsMatrix<T>& result) const
+{
+    GISMO_ASSERT( cwise.size() == d, "The grid has wrong dimension" );
+    GISMO_ASSERT( coefs.rows() == this->size(), "Wrong number of coefficients" );
+
+    // Univariate collocation matrices, m_bases[i] at cwise[i]
+    std::vector< gsSparseMatrix<T> > colloc(d);
+    gsMatrix<T> u;
+    for (unsigned i = 0; i < d; ++i)
     {
-        result.col(j) = coefs.row( ind(0,j) ) * B(0,j);
-        for ( index_t i = 1; i < ind.rows(); ++i ) // for all non-zero basis functions
-            result.col(j) += coefs.row( ind(i,j) ) * B(i,j); 
+        u = cwise[i].transpose();
+        m_bases[i]->collocationMatrix(u, colloc[i]);
     }
+
+    // The values at the grid points (rows) are the Kronecker product
+    // of the collocation matrices times the coefficients
+    gsApplyKroneckerProduct(colloc, coefs, result);
+    result.transposeInPlace();
 }
 
 
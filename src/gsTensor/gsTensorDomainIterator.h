@@ -107,6 +107,34 @@ public:
         return m_isGood;
     }
 
+    // Documentation in gsDomainIterator.h
+    // Jumps to the element by its lexicographic position, in O(d)
+    bool next(index_t increment)
+    {
+        if ( 0 == increment || ! m_isGood ) return m_isGood;
+
+        index_t pos = 0, numEl = 1;
+        for (int i = 0; i < d; ++i)
+        {
+            pos   += numEl * (curElement[i] - meshStart[i]);
+            numEl *= meshEnd[i] - meshStart[i];
+        }
+        pos += increment;
+
+        m_isGood = pos < numEl;
+        if (m_isGood)
+        {
+            for (int i = 0; i < d; ++i)
+            {
+                const index_t n = meshEnd[i] - meshStart[i];
+                curElement[i] = meshStart[i] + pos % n;
+                pos /= n;
+            }
+            update();
+        }
+        return m_isGood;
+    }
+
     // Documentation in gsDomainIterator.h
     void reset()
     {
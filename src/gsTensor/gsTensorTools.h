@@ -300,5 +300,104 @@ void gsSparseKroneckerProduct(const gsSparseMatrix<T> & m1, const gsSparseMatrix
     //result.makeCompressed();
 }
 
+namespace internal
+{
+
+/// Access to a factor of gsApplyKroneckerProduct. The default is for
+/// dense and sparse matrices; other factors (eg. linear operators)
+/// specialize it.
+template<class Factor>
+struct gsKroneckerFactor
+{
+    static index_t rows(const Factor & f) { return f.rows(); }
+    static index_t cols(const Factor & f) { return f.cols(); }
+
+    template<class T>
+    static void apply(const Factor & f, const gsMatrix<T> & in, gsMatrix<T> & out)
+    { out.noalias() = f * in; }
+};
+
+} // namespace internal
+
+/** \brief Applies the Kronecker product \f$ A_{d-1} \otimes \cdots
+    \otimes A_0 \f$ of the factors \a ops to (every column of) \a input,
+    without forming the product.
+
+    The entries of \a input are numbered as the functions of a
+    tensor-product basis, ie. the first index runs fastest, and
+    ops[k] acts on the index in direction \a k. Every factor is
+    applied once to all fibers of the tensor in its direction.
+
+    \param[in]  ops    the factors, dense or sparse matrices
+    \param[in]  input  matrix with as many rows as the product of the
+                       numbers of columns of the factors
+    \param[out] x      the result, one column per column of \a input
+
+    \ingroup Tensor
+*/
+template<class T, class Factor>
+void gsApplyKroneckerProduct(const std::vector<Factor> & ops,
+                             const gsMatrix<T> & input, gsMatrix<T> & x)
+{
+    typedef internal::gsKroneckerFactor<Factor> F;
+    const index_t d  = ops.size();
+    const index_t nc = input.cols();
+
+    // Current size of the tensor in every direction
+    gsVector<index_t> sz(d);
+    for (index_t k = 0; k != d; ++k)
+        sz[k] = F::cols(ops[k]);
+    GISMO_ASSERT( input.rows() == sz.prod(), "Wrong size of the input: "
+                  << input.rows() << " instead of " << sz.prod() );
+
+    x = input;
+    gsMatrix<T> fib, res;
+    for (index_t k = 0; k != d; ++k)
+    {
+        // The tensor is a x n x b (first index fastest)
+        const index_t a = sz.head(k).prod();
+        const index_t n = sz[k];
+        const index_t b = sz.tail(d-k-1).prod();
+
+        // Gather the fibers in direction k as the columns of fib
+        if ( 1 == a )
+            fib = gsAsConstMatrix<T>(x.data(), n, b * nc);
+        else
+        {
+            fib.resize(n, a * b * nc);
+            for (index_t c = 0; c != nc; ++c)
+                for (index_t l = 0; l != b; ++l)
+                    for (index_t i = 0; i != n; ++i)
+                    {
+                        const T * src = x.col(c).data() + a * (i + n * l);
+                        for (index_t m = 0; m != a; ++m)
+                            fib(i, (c * b + l) * a + m) = src[m];
+                    }
+        }
+
+        F::apply(ops[k], fib, res);
+        const index_t r = res.rows();
+        GISMO_ASSERT( r == F::rows(ops[k]) && res.cols() == fib.cols(),
+                      "Factor "<< k <<" returned a result of wrong size");
+
+        // Scatter back
+        sz[k] = r;
+        if ( 1 == a )
+            x = gsAsConstMatrix<T>(res.data(), r * b, nc);
+        else
+        {
+            x.resize(a * r * b, nc);
+            for (index_t c = 0; c != nc; ++c)
+                for (index_t l = 0; l != b; ++l)
+                    for (index_t i = 0; i != r; ++i)
+                    {
+                        T * dst = x.col(c).data() + a * (i + r * l);
+                        for (index_t m = 0; m != a; ++m)
+                            dst[m] = res(i, (c * b + l) * a + m);
+                    }
+        }
+    }
+}
+
 
 } // namespace gismo
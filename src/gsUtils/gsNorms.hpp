@@ -758,10 +758,11 @@ T igaFieldDGDistance(const gsField<T>& u, const gsFunction<T>& v, bool v_isParam
 template <typename T>
 T computeMaximumNorm(const gsFunction<T>& f, const gsVector<T>& lower, const gsVector<T>& upper, int numSamples)
 {
-    gsMatrix<T> points = uniformPointGrid(lower, upper, numSamples);
+    std::vector< gsVector<T> > cwise;
+    uniformCwisePoints(lower, upper, uniformSampleCount(lower, upper, numSamples), cwise);
 
     gsMatrix<T> values;
-    f.eval_into( points, values );
+    f.evalOnGrid_into( cwise, values );
 
     return values.array().abs().maxCoeff();
 }
@@ -786,11 +787,12 @@ T computeMaximumDistance(const gsFunction<T>& f1, const gsFunction<T>& f2, const
     GISMO_ASSERT( f1.domainDim() == f2.domainDim(), "Functions need to have same domain dimension");
     GISMO_ASSERT( f1.targetDim() == f2.targetDim(), "Functions need to have same target dimension");
 
-    gsMatrix<T> points = uniformPointGrid(lower, upper, numSamples);
+    std::vector< gsVector<T> > cwise;
+    uniformCwisePoints(lower, upper, uniformSampleCount(lower, upper, numSamples), cwise);
 
     gsMatrix<T> values1, values2;
-    f1.eval_into( points, values1 );
-    f2.eval_into( points, values2 );
+    f1.evalOnGrid_into( cwise, values1 );
+    f2.evalOnGrid_into( cwise, values2 );
 
     return (values1 - values2).array().abs().maxCoeff();
 }
@@ -803,15 +805,16 @@ T computeMaximumDistance(const gsGeometry<T>& geo, const gsFunction<T>& u, bool
     // compute the point grid
     gsMatrix<T> range = geo.basis().support();
     gsVector<T> lower = range.col(0), upper = range.col(1);
-    gsMatrix<T> points = uniformPointGrid(lower, upper, numSamples);
+    std::vector< gsVector<T> > cwise;
+    uniformCwisePoints(lower, upper, uniformSampleCount(lower, upper, numSamples), cwise);
 
     // only compute the geometry points if either function is not parametrized
     gsMatrix<T> geo_pts =  (!isParametrized_u || !isParametrized_v) ?
-                geo.eval(points) : gsMatrix<T>();
+                geo.evalOnGrid(cwise) : gsMatrix<T>();
 
     // evaluate u and v
-    gsMatrix<T> u_val = isParametrized_u ? u.eval(points) : u.eval(geo_pts),
-            v_val = isParametrized_v ? v.eval(points) : v.eval(geo_pts);
+    gsMatrix<T> u_val = isParametrized_u ? u.evalOnGrid(cwise) : u.eval(geo_pts),
+            v_val = isParametrized_v ? v.evalOnGrid(cwise) : v.eval(geo_pts);
 
     return (u_val - v_val).array().abs().maxCoeff();
 }
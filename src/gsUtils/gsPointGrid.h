@@ -70,6 +70,30 @@ typename gsMatrix<T>::uPtr uniformPointGrid(const gsVector<T>& lower, // note: s
                                             const gsVector<T>& upper,
                                             int numPoints = 1000);
 
+/** @brief Computes the coordinate vectors \a cwise of the grid
+ * gsPointGrid(a, b, np), ie. <em>cwise[i]</em> contains
+ * <em>np[i]</em> uniformly spaced points in \f$[a_i,b_i]\f$.
+ *
+ * The grid can be evaluated by gsFunction::evalOnGrid_into().
+ *
+ * \ingroup Utils
+ */
+template<class T> inline
+void uniformCwisePoints(gsVector<T> const & a, gsVector<T> const & b,
+                        gsVector<unsigned> const & np,
+                        std::vector< gsVector<T> > & cwise)
+{
+    cwise.resize(a.size());
+    for (index_t i = 0; i != a.size(); ++i)
+    {
+        const index_t n = np[i];
+        const T step = (b[i] - a[i]) / math::max(n - 1, static_cast<index_t>(1));
+        cwise[i].resize(n);
+        for (index_t k = 0; k != n; ++k)
+            cwise[i][k] = ( 0 == k ? a[i] : ( n - 1 == k ? b[i] : a[i] + k * step ) );
+    }
+}
+
 /**
    Returns an approximately uniformly spaced grid in every direction,
    with approximately numPoints total points. 
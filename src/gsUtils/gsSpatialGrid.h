@@ -0,0 +1,193 @@
+/** @file gsSpatialGrid.h
+
+    @brief Provides a uniform grid for finding coincident points
+
+    This file is part of the G+Smo library.
+
+    This Source Code Form is subject to the terms of the Mozilla Public
+    License, v. 2.0. If a copy of the MPL was not distributed with this
+    file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <gsCore/gsLinearAlgebra.h>
+
+namespace gismo
+{
+
+/**
+   \brief Spatial index of a point set for finding all points which
+   lie closer than a tolerance to a given point.
+
+   The space is subdivided into cubic cells of side length equal to
+   the tolerance and the points are sorted by the (integer)
+   coordinates of their cell. The points which are closer than the
+   tolerance to a query point lie in the \f$3^d\f$ cells around the
+   cell of the query point, each of which is found by a binary
+   search. Building the index costs \f$O(n\log n)\f$ and a query
+   costs \f$O(3^d\log n)\f$ plus the number of points found,
+   independently of the extent of the point set.
+
+   \code
+   gsSpatialGrid<real_t> grid(points, 1e-4); // points: d x N matrix
+   std::vector<index_t> close;
+   grid.query(points.col(0), close); // contains at least 0
+   \endcode
+
+   \ingroup Utils
+*/
+template<class T>
+class gsSpatialGrid
+{
+public:
+
+    /// Empty index
+    gsSpatialGrid() : m_tol(0) { }
+
+    /// Builds the index of the columns of \a points, see build()
+    gsSpatialGrid(const gsMatrix<T> & points, const T tol)
+    { build(points, tol); }
+
+    /// \brief Builds the index of the columns of \a points with
+    /// tolerance \a tol (positive). The points are referred to by
+    /// their column index.
+    void build(const gsMatrix<T> & points, const T tol)
+    {
+        GISMO_ENSURE( tol > 0, "The tolerance must be positive");
+        m_tol  = tol;
+        m_pts  = points;
+        m_cell = (points.array() / tol).floor().matrix();
+
+        m_order.resize(points.cols());
+        for (index_t i = 0; i != points.cols(); ++i)
+            m_order[i] = i;
+        std::sort(m_order.begin(), m_order.end(), cellLess(m_cell));
+    }
+
+    /// Swaps with \a other
+    void swap(gsSpatialGrid & other)
+    {
+        std::swap(m_tol, other.m_tol);
+        m_pts  .swap(other.m_pts);
+        m_cell .swap(other.m_cell);
+        m_order.swap(other.m_order);
+    }
+
+    /// Number of points in the index
+    index_t size() const { return m_pts.cols(); }
+
+    /// Dimension of the points
+    index_t dim() const { return m_pts.rows(); }
+
+    /// The tolerance of the index
+    T tolerance() const { return m_tol; }
+
+    /// Returns the \a i-th point of the index
+    typename gsMatrix<T>::constColumn point(index_t i) const
+    { return m_pts.col(i); }
+
+    /// Returns the points of the index (one per column)
+    const gsMatrix<T> & points() const { return m_pts; }
+
+    /// \brief Returns in \a result the indices (sorted increasingly)
+    /// of all points whose Euclidean distance to \a pt is less than
+    /// the tolerance
+    template<class Derived>
+    void query(const Eigen::MatrixBase<Derived> & pt, std::vector<index_t> & result) const
+    {
+        GISMO_ASSERT( pt.size() == dim(), "Wrong dimension of the query point");
+        result.clear();
+        if ( 0 == size() )
+            return;
+
+        const index_t d = dim();
+        const T tol2 = m_tol * m_tol;
+        const gsVector<T> c = (pt.derived().array() / m_tol).floor().matrix();
+        gsVector<T> cur(d);
+        gsVector<index_t> off(d); // offsets of the current cell, in {-1,0,1}
+        off.setConstant(-1);
+        const cellLess less(m_cell);
+
+        // Visit the 3^d neighbouring cells
+        do
+        {
+            cur = c + off.template cast<T>();
+            const std::pair<std::vector<index_t>::const_iterator,
+                            std::vector<index_t>::const_iterator> range =
+                std::equal_range(m_order.begin(), m_order.end(), cur, less);
+
+            for (std::vector<index_t>::const_iterator it = range.first;
+                 it != range.second; ++it)
+                if ( (m_pts.col(*it) - pt).squaredNorm() < tol2 )
+                    result.push_back(*it);
+        }
+        while ( nextOffset(off) );
+
+        std::sort(result.begin(), result.end());
+    }
+
+private:
+
+    // Advances \a off lexicographically in {-1,0,1}^d, returns false
+    // after the last offset
+    static bool nextOffset(gsVector<index_t> & off)
+    {
+        for (index_t i = 0; i != off.size(); ++i)
+        {
+            if ( off[i] < 1 )
+            {
+                ++off[i];
+                return true;
+            }
+            off[i] = -1;
+        }
+        return false;
+    }
+
+    // Lexicographic order of the cells of the points (given by their
+    // index) and of cell coordinates
+    struct cellLess
+    {
+        explicit cellLess(const gsMatrix<T> & cell) : m_cell(cell) { }
+
+        bool operator()(const index_t a, const index_t b) const
+        { return lexLess(m_cell.col(a), m_cell.col(b)); }
+
+        bool operator()(const index_t a, const gsVector<T> & c) const
+        { return lexLess(m_cell.col(a), c); }
+
+        bool operator()(const gsVector<T> & c, const index_t b) const
+        { return lexLess(c, m_cell.col(b)); }
+
+        template<class A, class B>
+        static bool lexLess(const A & a, const B & b)
+        {
+            for (index_t i = 0; i != a.size(); ++i)
+            {
+                if ( a[i] < b[i] ) return true;
+                if ( b[i] < a[i] ) return false;
+            }
+            return false;
+        }
+
+        const gsMatrix<T> & m_cell;
+    };
+
+private:
+
+    /// Tolerance, equal to the side length of the cells
+    T m_tol;
+
+    /// The points (columns)
+    gsMatrix<T> m_pts;
+
+    /// Integer coordinates of the cells of the points, stored as
+    /// reals to avoid overflow for small tolerances
+    gsMatrix<T> m_cell;
+
+    /// The point indices, sorted by cell
+    std::vector<index_t> m_order;
+};
+
+} // namespace gismo